@@ -9,9 +9,16 @@
 #include "parsec/arena.h"
 #include "parsec/class/lifo.h"
 #include "parsec/data_internal.h"
+#include "parsec/execution_stream.h"
+#include "parsec/scheduling.h"
 #include "parsec/utils/debug.h"
 #include "parsec/papi_sde.h"
+#include "parsec/parsec_hwloc.h"
+#include "parsec/parsec_comm_engine.h"
 #include <limits.h>
+#if defined(PARSEC_HAVE_SYS_MMAN_H)
+#include <sys/mman.h>
+#endif  /* defined(PARSEC_HAVE_SYS_MMAN_H) */
 
 #if defined(PARSEC_PROF_TRACE_ACTIVE_ARENA_SET)
 
@@ -54,6 +61,422 @@ extern int arena_memory_used_key, arena_memory_unused_key;
 
 size_t parsec_arena_max_allocated_memory = SIZE_MAX;  /* unlimited */
 size_t parsec_arena_max_cached_memory    = 256*1024*1024; /* limited to 256MB */
+int    parsec_arena_backing              = PARSEC_ARENA_BACKING_MALLOC;
+size_t parsec_arena_taskpool_budget      = 0;  /* unlimited */
+
+/* Alignment of the chunks carved from the slabs */
+#define PARSEC_ARENA_SLAB_ALIGNMENT 64
+
+/* What backs a slab */
+#define PARSEC_ARENA_SLAB_NORMAL   0  /**< Normal pages */
+#define PARSEC_ARENA_SLAB_THP      1  /**< Advised to use transparent huge pages, only a hint */
+#define PARSEC_ARENA_SLAB_HUGETLB  2  /**< Huge pages (MAP_HUGETLB) */
+
+typedef struct parsec_arena_slab_s {
+    struct parsec_arena_slab_s *next;
+    void                       *base;
+    size_t                      size;
+} parsec_arena_slab_t;
+
+/**
+ * The chunks carved from the slabs of a NUMA node always return to the
+ * free list of this node, and are reused by the execution streams of the
+ * same node.
+ */
+struct parsec_arena_node_s {
+    parsec_lifo_t         chunks;   /**< Free chunks carved from the slabs of this node */
+    parsec_atomic_lock_t  lock;     /**< Protects the slabs and the free space */
+    char                 *cursor;   /**< Free space in the current slab */
+    char                 *end;
+    int                   huge;     /**< PARSEC_ARENA_SLAB_* backing of the current slab */
+    parsec_arena_slab_t  *slabs;
+    char                  pad[PARSEC_ARENA_SLAB_ALIGNMENT];
+};
+
+static inline size_t parsec_arena_page_size(int backing)
+{
+    return (PARSEC_ARENA_BACKING_HUGETLB_1G == backing) ? ((size_t)1 << 30) : ((size_t)2 << 20);
+}
+
+/* Maps size bytes (a multiple of page), and sets huge to the
+ * PARSEC_ARENA_SLAB_* backing of the area. Returns the area, or NULL. */
+static void *parsec_arena_slab_map(int backing, size_t size, size_t page, int *huge)
+{
+#if defined(PARSEC_HAVE_SYS_MMAN_H) && defined(MAP_ANONYMOUS)
+    char *addr, *aligned;
+
+    *huge = PARSEC_ARENA_SLAB_NORMAL;
+#if defined(MAP_HUGETLB)
+    if( backing >= PARSEC_ARENA_BACKING_HUGETLB_2M ) {
+        int flags = MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB;
+#if defined(MAP_HUGE_SHIFT)
+        flags |= ((PARSEC_ARENA_BACKING_HUGETLB_1G == backing) ? 30 : 21) << MAP_HUGE_SHIFT;
+#endif  /* defined(MAP_HUGE_SHIFT) */
+        addr = mmap(NULL, size, PROT_READ | PROT_WRITE, flags, -1, 0);
+        if( MAP_FAILED != addr ) {
+            *huge = PARSEC_ARENA_SLAB_HUGETLB;
+            return addr;
+        }
+        /* No huge pages reserved, fall back on transparent huge pages */
+    }
+#endif  /* defined(MAP_HUGETLB) */
+    /* Transparent huge pages need an area aligned on a huge page */
+    page = parsec_arena_page_size(PARSEC_ARENA_BACKING_THP);
+    addr = mmap(NULL, size + page, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if( MAP_FAILED == addr )
+        return NULL;
+    aligned = PARSEC_ALIGN_PTR(addr, page, char*);
+    if( aligned != addr )
+        munmap(addr, aligned - addr);
+    munmap(aligned + size, page - (aligned - addr));
+#if defined(MADV_HUGEPAGE)
+    if( 0 == madvise(aligned, size, MADV_HUGEPAGE) )
+        *huge = PARSEC_ARENA_SLAB_THP;
+#endif  /* defined(MADV_HUGEPAGE) */
+    return aligned;
+#else
+    (void)backing; (void)size; (void)page; (void)huge;
+    return NULL;
+#endif  /* defined(PARSEC_HAVE_SYS_MMAN_H) && defined(MAP_ANONYMOUS) */
+}
+
+static void parsec_arena_slab_unmap(parsec_arena_slab_t *slab)
+{
+    parsec_ce_mem_reg_cache_invalidate(slab->base, slab->size);
+#if defined(PARSEC_HAVE_SYS_MMAN_H)
+    munmap(slab->base, slab->size);
+#else
+    (void)slab;
+#endif  /* defined(PARSEC_HAVE_SYS_MMAN_H) */
+}
+
+/* Carves a chunk of size bytes from the current slab of node n, mapping a
+ * new slab bound to the node if needed. Returns NULL if no slab can be
+ * mapped. */
+static parsec_list_item_t *parsec_arena_slab_carve(parsec_arena_t *arena, int n, size_t size)
+{
+    parsec_arena_node_t *node = &arena->nodes[n];
+    parsec_arena_slab_t *slab;
+    size_t page, slab_size;
+    char *chunk;
+    int huge;
+
+    size = PARSEC_ALIGN(size, PARSEC_ARENA_SLAB_ALIGNMENT, size_t);
+    parsec_atomic_lock(&node->lock);
+    if( (size_t)(node->end - node->cursor) < size ) {
+        page = parsec_arena_page_size(arena->backing);
+        slab_size = PARSEC_ALIGN(size, page, size_t);
+        chunk = (char*)parsec_arena_slab_map(arena->backing, slab_size, page, &huge);
+        if( NULL == chunk ) {
+            parsec_atomic_unlock(&node->lock);
+            return NULL;
+        }
+        /* Bind before the first touch */
+        (void)parsec_hwloc_membind_numa(chunk, slab_size, n);
+        slab = (parsec_arena_slab_t*)malloc(sizeof(parsec_arena_slab_t));
+        slab->base = chunk;
+        slab->size = slab_size;
+        slab->next = node->slabs;
+        node->slabs = slab;
+        node->cursor = chunk;
+        node->end = chunk + slab_size;
+        node->huge = huge;
+        parsec_atomic_fetch_inc_int64(&arena->nb_slabs);
+        parsec_atomic_fetch_add_int64(&arena->slab_bytes, slab_size);
+        PARSEC_DEBUG_VERBOSE(10, parsec_debug_output, "Arena:	map a slab of %zu bytes on NUMA node %d for arena %p (%s)",
+                             slab_size, n, arena,
+                             (PARSEC_ARENA_SLAB_HUGETLB == huge) ? "huge pages" :
+                             (PARSEC_ARENA_SLAB_THP == huge) ? "transparent huge pages" : "normal pages");
+    }
+    chunk = node->cursor;
+    node->cursor += size;
+    huge = node->huge;
+    parsec_atomic_unlock(&node->lock);
+    if( PARSEC_ARENA_SLAB_HUGETLB == huge )
+        parsec_atomic_fetch_inc_int64(&arena->nb_hugepage_chunks);
+    else if( PARSEC_ARENA_SLAB_THP == huge )
+        parsec_atomic_fetch_inc_int64(&arena->nb_thp_chunks);
+    else
+        parsec_atomic_fetch_inc_int64(&arena->nb_fallback_chunks);
+    return (parsec_list_item_t*)chunk;
+}
+
+static void parsec_arena_nodes_destruct(parsec_arena_t *arena)
+{
+    parsec_arena_slab_t *slab;
+    int n;
+
+    for( n = 0; n < arena->nb_nodes; n++ ) {
+        /* The chunks live in the slabs */
+        while( NULL != parsec_lifo_pop(&arena->nodes[n].chunks) );
+        PARSEC_OBJ_DESTRUCT(&arena->nodes[n].chunks);
+        while( NULL != (slab = arena->nodes[n].slabs) ) {
+            arena->nodes[n].slabs = slab->next;
+            parsec_arena_slab_unmap(slab);
+            free(slab);
+        }
+    }
+    free(arena->nodes);
+    arena->nodes = NULL;
+    arena->nb_nodes = 0;
+}
+
+int parsec_arena_set_backing(parsec_arena_t *arena, int backing)
+{
+    int n;
+
+    if( (backing < PARSEC_ARENA_BACKING_MALLOC) || (backing > PARSEC_ARENA_BACKING_HUGETLB_1G) )
+        return PARSEC_ERR_BAD_PARAM;
+    if( 0 != arena->nb_slabs )
+        return PARSEC_ERR_BAD_PARAM;
+    if( NULL != arena->nodes )
+        parsec_arena_nodes_destruct(arena);
+    arena->backing = backing;
+    if( PARSEC_ARENA_BACKING_MALLOC == backing )
+        return PARSEC_SUCCESS;
+
+    arena->nb_nodes = parsec_hwloc_nb_numa_nodes();
+    arena->nodes = (parsec_arena_node_t*)calloc(arena->nb_nodes, sizeof(parsec_arena_node_t));
+    for( n = 0; n < arena->nb_nodes; n++ ) {
+        PARSEC_OBJ_CONSTRUCT(&arena->nodes[n].chunks, parsec_lifo_t);
+        parsec_atomic_lock_init(&arena->nodes[n].lock);
+    }
+    return PARSEC_SUCCESS;
+}
+
+struct parsec_arena_waiter_s {
+    parsec_arena_waiter_t    *next;
+    parsec_arena_resume_fn_t  resume;
+    void                     *cb_data;
+    parsec_arena_budget_t    *budget;   /**< Budget of the held back work, if any */
+    int64_t                   amount;   /**< Elements (arena) or bytes (budget) the work needs */
+};
+
+static void parsec_arena_waitq_construct(parsec_arena_waitq_t *waitq)
+{
+    parsec_atomic_lock_init(&waitq->lock);
+    waitq->nb_waiters = 0;
+    waitq->first = NULL;
+    waitq->last = NULL;
+}
+
+/* Resumes, in order, the work waiting on waitq that fits in amount: at
+ * least one if amount is what was released, possibly none if amount is
+ * the room left (fit). Must be called after the memory was released, the
+ * read of nb_waiters is ordered by the fence. */
+static void parsec_arena_waitq_resume(parsec_arena_waitq_t *waitq, int64_t amount, int fit,
+                                      volatile int64_t *nb_resumed)
+{
+    parsec_arena_waiter_t *waiter, *next, **last;
+
+    parsec_mfence();
+    if( 0 == waitq->nb_waiters )
+        return;
+    parsec_atomic_lock(&waitq->lock);
+    waiter = waitq->first;
+    last = &waitq->first;
+    while( NULL != *last ) {
+        if( fit && ((*last)->amount > amount) ) break;
+        amount -= (*last)->amount;
+        last = &(*last)->next;
+        waitq->nb_waiters--;
+        if( amount <= 0 ) break;
+    }
+    if( last == &waitq->first ) {  /* none fits */
+        parsec_atomic_unlock(&waitq->lock);
+        return;
+    }
+    waitq->first = *last;
+    *last = NULL;
+    if( NULL == waitq->first )
+        waitq->last = NULL;
+    parsec_atomic_unlock(&waitq->lock);
+    for( ; NULL != waiter; waiter = next ) {
+        next = waiter->next;
+        parsec_atomic_fetch_inc_int64(nb_resumed);
+        if( (NULL != waiter->budget) && (nb_resumed != &waiter->budget->nb_resumed) )
+            parsec_atomic_fetch_inc_int64(&waiter->budget->nb_resumed);
+        waiter->resume(waiter->cb_data);
+        free(waiter);
+    }
+}
+
+/* Whether parsec_arena_get_chunk can serve count elements: it must only
+ * look at the free lists get_chunk pops, otherwise the waiters of the arena
+ * would be told to retry an allocation that fails again. */
+static inline int parsec_arena_has_room(parsec_arena_t *arena, size_t count)
+{
+    int n;
+
+    if( INT32_MAX == arena->max_used )
+        return 1;
+    if( 1 == count ) {
+        if( !parsec_lifo_is_empty(&arena->area_lifo) )
+            return 1;
+        /* get_chunk falls back to the chunks of every node at the cap */
+        if( arena->data_malloc == parsec_data_allocate )
+            for( n = 0; n < arena->nb_nodes; n++ )
+                if( !parsec_lifo_is_empty(&arena->nodes[n].chunks) )
+                    return 1;
+    }
+    return (arena->used + (int64_t)count) <= arena->max_used;
+}
+
+static inline int parsec_arena_budget_has_room(parsec_arena_budget_t *budget, int64_t bytes)
+{
+    if( (NULL == budget) || (0 == budget->max_used) || (0 == budget->used) )
+        return 1;
+    return (budget->used + bytes) <= budget->max_used;
+}
+
+/* Resumes the work waiting on the budget that fits in the room left: work
+ * that gave memory back to wait for more must not be resumed to give it
+ * back again and resume the next one. An empty budget resumes at least
+ * one, that may be larger than the budget. */
+static void parsec_arena_budget_resume(parsec_arena_budget_t *budget)
+{
+    int64_t used = budget->used;
+
+    if( 0 == budget->max_used )
+        parsec_arena_waitq_resume(&budget->waitq, INT64_MAX, 1, &budget->nb_resumed);
+    else
+        parsec_arena_waitq_resume(&budget->waitq, budget->max_used - used, 0 != used, &budget->nb_resumed);
+}
+
+int parsec_arena_wait(parsec_arena_t *arena, size_t count, size_t given_back,
+                      parsec_arena_budget_t *budget,
+                      parsec_arena_resume_fn_t resume, void *cb_data)
+{
+    int64_t bytes = (int64_t)(count * arena->elem_size + given_back);
+    parsec_arena_waitq_t *waitq;
+    parsec_arena_waiter_t *waiter;
+    int room;
+
+    if( (INT32_MAX != arena->max_used) && (count > (size_t)arena->max_used) )
+        return PARSEC_ERR_VALUE_OUT_OF_BOUNDS;
+    /* Only a single allocation may be larger than the budget */
+    if( (0 != given_back) && (NULL != budget) && (0 != budget->max_used) && (bytes > budget->max_used) )
+        return PARSEC_ERR_VALUE_OUT_OF_BOUNDS;
+    if( !parsec_arena_has_room(arena, count) )
+        waitq = &arena->waitq;
+    else if( !parsec_arena_budget_has_room(budget, bytes) )
+        waitq = &budget->waitq;
+    else
+        return PARSEC_ERR_EXISTS;
+
+    waiter = (parsec_arena_waiter_t*)malloc(sizeof(parsec_arena_waiter_t));
+    waiter->next    = NULL;
+    waiter->resume  = resume;
+    waiter->cb_data = cb_data;
+    waiter->budget  = budget;
+    waiter->amount  = (waitq == &arena->waitq) ? (int64_t)count : bytes;
+
+    parsec_atomic_lock(&waitq->lock);
+    parsec_atomic_fetch_inc_int32(&waitq->nb_waiters);
+    /* Some memory may have been released since we checked */
+    room = (waitq == &arena->waitq) ? parsec_arena_has_room(arena, count)
+                                    : parsec_arena_budget_has_room(budget, bytes);
+    if( room ) {
+        parsec_atomic_fetch_dec_int32(&waitq->nb_waiters);
+        parsec_atomic_unlock(&waitq->lock);
+        free(waiter);
+        return PARSEC_ERR_EXISTS;
+    }
+    if( NULL == waitq->last )
+        waitq->first = waiter;
+    else
+        waitq->last->next = waiter;
+    waitq->last = waiter;
+    parsec_atomic_unlock(&waitq->lock);
+    parsec_atomic_fetch_inc_int64(&arena->nb_deferred);
+    PARSEC_DEBUG_VERBOSE(20, parsec_debug_output, "Arena:	hold back %p until %zu elements fit in arena %p (used %d/%d)%s",
+                         cb_data, count, arena, arena->used, arena->max_used,
+                         (waitq == &arena->waitq) ? "" : " and its budget");
+    return PARSEC_SUCCESS;
+}
+
+static void parsec_arena_resume_task(void *cb_data)
+{
+    parsec_task_t *task = (parsec_task_t*)cb_data;
+    parsec_execution_stream_t *es = parsec_my_execution_stream();
+
+    /* The memory may be released by a thread that is not an execution stream
+     * of the context, such as the communication thread */
+    if( (NULL == es) || (NULL == es->scheduler_object) ||
+        (es->virtual_process->parsec_context != task->taskpool->context) )
+        es = task->taskpool->context->virtual_processes[0]->execution_streams[0];
+    PARSEC_LIST_ITEM_SINGLETON(task);
+    __parsec_schedule(es, task, 0);
+}
+
+int parsec_arena_defer_task(parsec_execution_stream_t *es,
+                            parsec_arena_t *arena, size_t count, size_t given_back,
+                            parsec_task_t *task)
+{
+    parsec_arena_budget_t *budget = task->taskpool->arena_budget;
+    char tmp[MAX_TASK_STRLEN];
+    int rc;
+
+    (void)es;
+    rc = parsec_arena_wait(arena, count, given_back, budget, parsec_arena_resume_task, task);
+    if( PARSEC_ERR_EXISTS == rc )
+        return PARSEC_HOOK_RETURN_AGAIN;
+    if( PARSEC_SUCCESS != rc ) {
+        if( (INT32_MAX != arena->max_used) && (count > (size_t)arena->max_used) )
+            parsec_warning("Task %s needs %zu elements of %zu bytes, more than the %d elements arena %p can hold",
+                           parsec_task_snprintf(tmp, MAX_TASK_STRLEN, task), count, arena->elem_size,
+                           arena->max_used, arena);
+        else
+            parsec_warning("Task %s needs %zu bytes for its outputs, more than the budget of %"PRId64" bytes of its taskpool",
+                           parsec_task_snprintf(tmp, MAX_TASK_STRLEN, task), count * arena->elem_size + given_back,
+                           budget->max_used);
+        return PARSEC_HOOK_RETURN_ERROR;
+    }
+    if( NULL != budget )
+        parsec_atomic_fetch_inc_int64(&budget->nb_deferred_tasks);
+    return PARSEC_HOOK_RETURN_ASYNC;
+}
+
+static void parsec_arena_budget_construct(parsec_arena_budget_t *budget)
+{
+    budget->used = 0;
+    budget->max_used = 0;
+    budget->nb_deferred_tasks = 0;
+    budget->nb_deferred_gets = 0;
+    budget->nb_resumed = 0;
+    parsec_arena_waitq_construct(&budget->waitq);
+}
+
+static void parsec_arena_budget_destruct(parsec_arena_budget_t *budget)
+{
+    assert(0 == budget->used);
+    assert(NULL == budget->waitq.first);
+    (void)budget;
+}
+
+PARSEC_OBJ_CLASS_INSTANCE(parsec_arena_budget_t, parsec_object_t,
+                          parsec_arena_budget_construct, parsec_arena_budget_destruct);
+
+parsec_arena_budget_t *parsec_arena_budget_new(size_t max_used)
+{
+    parsec_arena_budget_t *budget = PARSEC_OBJ_NEW(parsec_arena_budget_t);
+    budget->max_used = (int64_t)max_used;
+    return budget;
+}
+
+void parsec_arena_get_stats(parsec_arena_t *arena, parsec_arena_stats_t *stats)
+{
+    stats->used               = arena->used;
+    stats->released           = arena->released;
+    stats->nb_hugepage_chunks = arena->nb_hugepage_chunks;
+    stats->nb_thp_chunks      = arena->nb_thp_chunks;
+    stats->nb_fallback_chunks = arena->nb_fallback_chunks;
+    stats->nb_slabs           = arena->nb_slabs;
+    stats->slab_bytes         = arena->slab_bytes;
+    stats->nb_deferred        = arena->nb_deferred;
+    stats->nb_resumed         = arena->nb_resumed;
+    stats->nb_waiting         = arena->waitq.nb_waiters;
+}
 
 
 int parsec_arena_construct_ex(parsec_arena_t* arena,
@@ -83,7 +506,18 @@ int parsec_arena_construct_ex(parsec_arena_t* arena,
     arena->max_released = (max_cached_memory / elem_size > (size_t)INT32_MAX)? INT32_MAX: max_cached_memory / elem_size;
     arena->data_malloc  = parsec_data_allocate;
     arena->data_free    = parsec_data_free;
-    return PARSEC_SUCCESS;
+    arena->backing      = PARSEC_ARENA_BACKING_MALLOC;
+    arena->nb_nodes     = 0;
+    arena->nodes        = NULL;
+    arena->nb_hugepage_chunks = 0;
+    arena->nb_thp_chunks = 0;
+    arena->nb_fallback_chunks = 0;
+    arena->nb_slabs     = 0;
+    arena->slab_bytes   = 0;
+    arena->nb_deferred  = 0;
+    arena->nb_resumed   = 0;
+    parsec_arena_waitq_construct(&arena->waitq);
+    return parsec_arena_set_backing(arena, parsec_arena_backing);
 }
 
 int parsec_arena_construct(parsec_arena_t* arena,
@@ -112,20 +546,52 @@ static void parsec_arena_destructor(parsec_arena_t* arena)
             PARSEC_DEBUG_VERBOSE(20, parsec_debug_output, "Arena:\tfree element base ptr %p, data ptr %p (from arena %p)",
                                 item, ((parsec_arena_chunk_t*)item)->data, arena);
             TRACE_FREE(arena_memory_free_key, -arena->elem_size, item);
+            parsec_ce_mem_reg_cache_invalidate(((parsec_arena_chunk_t*)item)->data, arena->elem_size);
             arena->data_free(item);
         }
         PARSEC_OBJ_DESTRUCT(&arena->area_lifo);
+        if( NULL != arena->nodes ) {
+            PARSEC_DEBUG_VERBOSE(4, parsec_debug_output, "Arena:	arena %p carved %"PRId64" chunks from huge pages, "
+                                 "%"PRId64" chunks from transparent huge pages, %"PRId64" chunks from normal pages, "
+                                 "in %"PRId64" slabs (%"PRId64" bytes)",
+                                 arena, arena->nb_hugepage_chunks, arena->nb_thp_chunks, arena->nb_fallback_chunks,
+                                 arena->nb_slabs, arena->slab_bytes);
+            parsec_arena_nodes_destruct(arena);
+        }
     }
 }
 
 PARSEC_OBJ_CLASS_INSTANCE(parsec_arena_t, parsec_object_t, NULL, parsec_arena_destructor);
 
+/* Pops a chunk released on another NUMA node than node */
+static inline parsec_list_item_t*
+parsec_arena_steal_chunk( parsec_arena_t *arena, int node )
+{
+    parsec_list_item_t *item;
+    int n;
+
+    for( n = 1; n < arena->nb_nodes; n++ ) {
+        if( NULL != (item = parsec_lifo_pop(&arena->nodes[(node + n) % arena->nb_nodes].chunks)) )
+            return item;
+    }
+    return NULL;
+}
+
 static inline parsec_list_item_t*
 parsec_arena_get_chunk( parsec_arena_t *arena, size_t size, parsec_data_allocate_t alloc )
 {
     parsec_lifo_t *list = &arena->area_lifo;
-    parsec_list_item_t *item;
-    item = parsec_lifo_pop(list);
+    parsec_list_item_t *item = NULL;
+    parsec_execution_stream_t *es;
+    int node = -1;
+
+    if( (NULL != arena->nodes) && (alloc == parsec_data_allocate) ) {
+        es = parsec_my_execution_stream();
+        node = (NULL == es) ? 0 : (es->numa_id % arena->nb_nodes);
+        item = parsec_lifo_pop(&arena->nodes[node].chunks);
+    }
+    if( NULL == item )
+        item = parsec_lifo_pop(list);
     if( NULL != item ) {
         if( arena->max_released != INT32_MAX )
             (void)parsec_atomic_fetch_dec_int32(&arena->released);
@@ -135,12 +601,25 @@ parsec_arena_get_chunk( parsec_arena_t *arena, size_t size, parsec_data_allocate
             int32_t current = parsec_atomic_fetch_inc_int32(&arena->used) + 1;
             if(current > arena->max_used) {
                 (void)parsec_atomic_fetch_dec_int32(&arena->used);
-                return NULL;
+                /* The chunks cached on the other nodes count in used, reuse
+                 * one of them rather than strand the budget */
+                if( (node < 0) || (NULL == (item = parsec_arena_steal_chunk(arena, node))) )
+                    return NULL;
+                if( arena->max_released != INT32_MAX )
+                    (void)parsec_atomic_fetch_dec_int32(&arena->released);
+                return item;
             }
         }
         if( size < sizeof( parsec_list_item_t ) )
             size = sizeof( parsec_list_item_t );
-        item = (parsec_list_item_t *)alloc( size );
+        if( (node >= 0) && (NULL != (item = parsec_arena_slab_carve(arena, node, size))) ) {
+            ((parsec_arena_chunk_t*)item)->node = node;
+        } else {
+            if( node >= 0 )
+                parsec_atomic_fetch_inc_int64(&arena->nb_fallback_chunks);
+            item = (parsec_list_item_t *)alloc( size );
+            ((parsec_arena_chunk_t*)item)->node = -1;
+        }
         TRACE_MALLOC(arena_memory_alloc_key, size, item);
         PARSEC_OBJ_CONSTRUCT(item, parsec_list_item_t);
         assert(NULL != item);
@@ -155,8 +634,26 @@ static void
 parsec_arena_release_chunk(parsec_arena_t* arena,
                           parsec_arena_chunk_t *chunk)
 {
+    parsec_arena_budget_t *budget = chunk->budget;
+    uint32_t count = chunk->count;  /* the chunk cannot be read once pushed or freed */
+
     TRACE_FREE(arena_memory_unused_key, -arena->elem_size*chunk->count, chunk);
 
+    if( NULL != budget ) {
+        chunk->budget = NULL;
+        parsec_atomic_fetch_add_int64(&budget->used, -(int64_t)(arena->elem_size * count));
+        parsec_arena_budget_resume(budget);
+        PARSEC_OBJ_RELEASE(budget);
+    }
+    if( chunk->node >= 0 ) {
+        /* Chunks carved from a slab cannot be freed, they are always cached */
+        if(arena->max_released != INT32_MAX) {
+            (void)parsec_atomic_fetch_inc_int32(&arena->released);
+        }
+        parsec_lifo_push(&arena->nodes[chunk->node].chunks, &chunk->item);
+        parsec_arena_waitq_resume(&arena->waitq, count, 0, &arena->nb_resumed);
+        return;
+    }
     if( (chunk->count == 1) && (arena->released < arena->max_released) ) {
         PARSEC_DEBUG_VERBOSE(10, parsec_debug_output, "Arena:\tpush a data of size %zu from arena %p, aligned by %zu, base ptr %p, data ptr %p, sizeof prefix %zu(%zd)",
                 arena->elem_size, arena, arena->alignment, chunk, chunk->data, sizeof(parsec_arena_chunk_t),
@@ -165,6 +662,7 @@ parsec_arena_release_chunk(parsec_arena_t* arena,
             (void)parsec_atomic_fetch_inc_int32(&arena->released);
         }
         parsec_lifo_push(&arena->area_lifo, &chunk->item);
+        parsec_arena_waitq_resume(&arena->waitq, count, 0, &arena->nb_resumed);
         return;
     }
     PARSEC_DEBUG_VERBOSE(10, parsec_debug_output, "Arena:\tdeallocate a tile of size %zu x %zu from arena %p, aligned by %zu, base ptr %p, data ptr %p, sizeof prefix %zu(%zd)",
@@ -173,7 +671,10 @@ parsec_arena_release_chunk(parsec_arena_t* arena,
     TRACE_FREE(arena_memory_free_key, -arena->elem_size*chunk->count, chunk);
     if(arena->max_used != 0 && arena->max_used != INT32_MAX)
         (void)parsec_atomic_fetch_sub_int32(&arena->used, chunk->count);
+    /* The registrations of the tile must not outlive it */
+    parsec_ce_mem_reg_cache_invalidate(chunk->data, arena->elem_size * chunk->count);
     arena->data_free(chunk);
+    parsec_arena_waitq_resume(&arena->waitq, count, 0, &arena->nb_resumed);
 }
 
 int  parsec_arena_allocate_device_private(parsec_data_copy_t *copy,
@@ -205,10 +706,14 @@ int  parsec_arena_allocate_device_private(parsec_data_copy_t *copy,
                             arena->alignment, size_t);
         chunk = (parsec_arena_chunk_t*)arena->data_malloc(size);
         PARSEC_OBJ_CONSTRUCT(&chunk->item, parsec_list_item_t);
+        chunk->node = -1;
+        if( NULL != arena->nodes )
+            parsec_atomic_fetch_inc_int64(&arena->nb_fallback_chunks);
 
         TRACE_MALLOC(arena_memory_alloc_key, size, chunk);
     }
     if(NULL == chunk) return PARSEC_ERR_OUT_OF_RESOURCE;  /* no more */
+    chunk->budget = NULL;
 
 #if defined(PARSEC_DEBUG_PARANOID)
     PARSEC_LIST_ITEM_SINGLETON( &chunk->item );
@@ -235,18 +740,54 @@ int  parsec_arena_allocate_device_private(parsec_data_copy_t *copy,
     return PARSEC_SUCCESS;
 }
 
+size_t parsec_arena_copy_bytes(const parsec_data_copy_t *copy)
+{
+    if( !(copy->flags & PARSEC_DATA_FLAG_ARENA) || (NULL == copy->arena_chunk) )
+        return 0;
+    return copy->arena_chunk->count * copy->arena_chunk->origin->elem_size;
+}
+
+void parsec_arena_release_device_private(parsec_data_copy_t *copy)
+{
+    parsec_arena_chunk_t *chunk = copy->arena_chunk;
+
+    assert(copy->flags & PARSEC_DATA_FLAG_ARENA);
+    copy->flags &= ~(PARSEC_DATA_FLAG_ARENA | PARSEC_DATA_FLAG_PARSEC_OWNED);
+    copy->device_private = NULL;
+    copy->arena_chunk = NULL;
+    parsec_arena_release_chunk(chunk->origin, chunk);
+}
+
 parsec_data_copy_t *parsec_arena_get_copy(parsec_arena_t *arena,
                                           size_t count, int device,
                                           parsec_datatype_t dtt)
+{
+    return parsec_arena_get_copy_budget(arena, count, device, dtt, NULL);
+}
+
+parsec_data_copy_t *parsec_arena_get_copy_budget(parsec_arena_t *arena,
+                                                 size_t count, int device,
+                                                 parsec_datatype_t dtt,
+                                                 parsec_arena_budget_t *budget)
 {
     parsec_data_t *data;
     parsec_data_copy_t *copy;
+    int64_t bytes = (int64_t)(count * arena->elem_size), used;
     int rc;
 
-    
+    if( NULL != budget ) {
+        do {
+            used = budget->used;
+            /* A single allocation larger than the budget must not wait forever */
+            if( (0 != budget->max_used) && (0 != used) && ((used + bytes) > budget->max_used) )
+                return NULL;
+        } while( !parsec_atomic_cas_int64(&budget->used, used, used + bytes) );
+    }
+
     data = parsec_data_new();
     if( NULL == data ) {
-        return NULL;
+        copy = NULL;
+        goto release_budget;
     }
 
     copy = parsec_data_copy_new( data, device, dtt,
@@ -256,7 +797,7 @@ parsec_data_copy_t *parsec_arena_get_copy(parsec_arena_t *arena,
 
     if(NULL == copy) {
         PARSEC_OBJ_RELEASE(data);
-        return NULL;
+        goto release_budget;
     }
 
     rc = parsec_arena_allocate_device_private(copy, arena, count, device, dtt);
@@ -268,10 +809,23 @@ parsec_data_copy_t *parsec_arena_get_copy(parsec_arena_t *arena,
     PARSEC_OBJ_RELEASE(data);
 
     if( PARSEC_SUCCESS != rc ) {
+        /* There is no chunk to give back to the arena */
+        copy->flags &= ~PARSEC_DATA_FLAG_ARENA;
         PARSEC_OBJ_RELEASE(copy);
-        return NULL;
+        copy = NULL;
+        goto release_budget;
     }
+    if( NULL != budget ) {
+        PARSEC_OBJ_RETAIN(budget);
+        copy->arena_chunk->budget = budget;
+    }
+    return copy;
 
+  release_budget:
+    if( NULL != budget ) {
+        parsec_atomic_fetch_add_int64(&budget->used, -bytes);
+        parsec_arena_budget_resume(budget);
+    }
     return copy;
 }
 
@@ -35,6 +35,73 @@ extern size_t parsec_arena_max_allocated_memory;
  */
 extern size_t parsec_arena_max_cached_memory;
 
+/**
+ * Default arena budget of each taskpool, 0 for unlimited.
+ */
+extern size_t parsec_arena_taskpool_budget;
+
+/**
+ * Backing of the chunks of an arena. With a huge page backing, the chunks
+ * of one element are carved from slabs of huge pages, bound to the NUMA
+ * node of the execution stream that requested them, and cached per NUMA
+ * node. The slabs are only returned to the system when the arena is
+ * destructed. When huge pages cannot be obtained, the chunks are carved
+ * from slabs of normal pages, and if slabs cannot be mapped they are
+ * allocated with the data_malloc of the arena. Slabs are at least one huge
+ * page: with PARSEC_ARENA_BACKING_HUGETLB_1G, every NUMA node that
+ * allocates from the arena maps a whole 1 GiB slab, even for small chunks.
+ */
+#define PARSEC_ARENA_BACKING_MALLOC      0  /**< data_malloc of the arena */
+#define PARSEC_ARENA_BACKING_THP         1  /**< Transparent huge pages (madvise) */
+#define PARSEC_ARENA_BACKING_HUGETLB_2M  2  /**< 2 MiB huge pages (MAP_HUGETLB), or THP */
+#define PARSEC_ARENA_BACKING_HUGETLB_1G  3  /**< 1 GiB huge pages (MAP_HUGETLB), or THP */
+
+/**
+ * Backing of the arenas that use the default allocator.
+ */
+extern int parsec_arena_backing;
+
+typedef struct parsec_arena_node_s parsec_arena_node_t;
+
+/**
+ * Function called to resume some work held back because an arena, or an
+ * arena budget, had no room for its data. It is called once, by the
+ * thread that released the memory, and it should retry the allocation.
+ */
+typedef void (*parsec_arena_resume_fn_t)(void *cb_data);
+
+typedef struct parsec_arena_waiter_s parsec_arena_waiter_t;
+
+/**
+ * Work waiting for some memory to be released. All the waiters are
+ * resumed every time some memory is released, those that still do not
+ * fit wait again.
+ */
+typedef struct parsec_arena_waitq_s {
+    parsec_atomic_lock_t   lock;
+    volatile int32_t       nb_waiters;
+    parsec_arena_waiter_t *first;
+    parsec_arena_waiter_t *last;
+} parsec_arena_waitq_t;
+
+/**
+ * Memory budget of the arena data of a taskpool, across all the arenas
+ * it uses. The data allocated with a budget hold a reference on it until
+ * they are released, so the budget can outlive its taskpool.
+ */
+typedef struct parsec_arena_budget_s {
+    parsec_object_t        super;
+    volatile int64_t       used;               /**< Bytes of arena data currently held */
+    int64_t                max_used;           /**< Maximum bytes, 0 for unlimited. A single allocation
+                                                *   larger than the budget is allowed when nothing else
+                                                *   is held. */
+    volatile int64_t       nb_deferred_tasks;  /**< Tasks held back because their output did not fit */
+    volatile int64_t       nb_deferred_gets;   /**< Incoming GETs held back because their target did not fit */
+    volatile int64_t       nb_resumed;         /**< Held back work resumed after some memory was released */
+    parsec_arena_waitq_t   waitq;
+} parsec_arena_budget_t;
+PARSEC_DECLSPEC PARSEC_OBJ_CLASS_DECLARATION(parsec_arena_budget_t);
+
 #define PARSEC_ALIGN(x,a,t) (((x)+((t)(a)-1)) & ~(((t)(a)-1)))
 #define PARSEC_ALIGN_PTR(x,a,t) ((t)PARSEC_ALIGN((uintptr_t)x, a, uintptr_t))
 #define PARSEC_ALIGN_PAD_AMOUNT(x,s) ((~((uintptr_t)(x))+1) & ((uintptr_t)(s)-1))
@@ -62,6 +129,18 @@ struct parsec_arena_s {
      */
     parsec_data_allocate_t data_malloc;
     parsec_data_free_t     data_free;
+    int                    backing;       /**< PARSEC_ARENA_BACKING_* */
+    int                    nb_nodes;      /**< Number of NUMA nodes in nodes */
+    parsec_arena_node_t   *nodes;         /**< Slabs and cached chunks of each NUMA node,
+                                           *   NULL with the malloc backing */
+    volatile int64_t       nb_hugepage_chunks;  /**< Chunks carved from MAP_HUGETLB slabs */
+    volatile int64_t       nb_thp_chunks;       /**< Chunks carved from slabs advised to use transparent huge pages */
+    volatile int64_t       nb_fallback_chunks;  /**< Chunks of a huge page arena that are not backed by huge pages */
+    volatile int64_t       nb_slabs;            /**< Slabs mapped */
+    volatile int64_t       slab_bytes;          /**< Memory mapped in slabs */
+    volatile int64_t       nb_deferred;         /**< Work held back because the arena reached max_used */
+    volatile int64_t       nb_resumed;          /**< Held back work resumed after some chunks were released */
+    parsec_arena_waitq_t   waitq;               /**< Work waiting for the arena to release chunks */
 };
 PARSEC_DECLSPEC PARSEC_OBJ_CLASS_DECLARATION(parsec_arena_t);
 
@@ -74,8 +153,28 @@ struct parsec_arena_chunk_s {
     uint32_t           count;    /**< Number of basic elements pointed by param in this chunck */
     parsec_arena_t    *origin;   /**< Arena in which this chunck should be released */
     void              *data;     /**< Actual data pointed by this chunck */
+    int32_t            node;     /**< NUMA node of the slab this chunk was carved from,
+                                  *   -1 if it was allocated with data_malloc */
+    parsec_arena_budget_t *budget;  /**< Budget charged for this chunk, if any */
 };
 
+/**
+ * Statistics of an arena, see parsec_arena_get_stats
+ */
+typedef struct parsec_arena_stats_s {
+    int32_t used;                /**< Elements allocated (if the arena has a max_used) */
+    int32_t released;            /**< Elements cached (if the arena has a max_released) */
+    int64_t nb_hugepage_chunks;  /**< Chunks carved from MAP_HUGETLB slabs (TLB friendly) */
+    int64_t nb_thp_chunks;       /**< Chunks carved from slabs advised to use transparent huge pages,
+                                  *   which the kernel may still back with normal pages */
+    int64_t nb_fallback_chunks;  /**< Chunks of a huge page arena that are not backed by huge pages */
+    int64_t nb_slabs;            /**< Slabs mapped */
+    int64_t slab_bytes;          /**< Memory mapped in slabs */
+    int64_t nb_deferred;         /**< Work held back because the arena reached max_used */
+    int64_t nb_resumed;          /**< Held back work resumed */
+    int32_t nb_waiting;          /**< Work currently held back */
+} parsec_arena_stats_t;
+
 /* for SSE, 16 is mandatory, most cache are 64 bit aligned */
 #define PARSEC_ARENA_ALIGNMENT_64b 8
 #define PARSEC_ARENA_ALIGNMENT_INT sizeof(int)
@@ -137,6 +236,68 @@ parsec_data_copy_t *parsec_arena_get_copy(parsec_arena_t *arena,
                                           size_t count, int device,
                                           parsec_datatype_t dtt);
 
+/**
+ * @brief Same as parsec_arena_get_copy, and charges the data to @p budget
+ *   (if not NULL) until it is released.
+ *
+ * @return parsec_data_copy_t* the new data copy, or NULL if the arena
+ *   reached its max_used or the budget is exhausted. The caller can then
+ *   hold its work back with parsec_arena_wait.
+ */
+parsec_data_copy_t *parsec_arena_get_copy_budget(parsec_arena_t *arena,
+                                                 size_t count, int device,
+                                                 parsec_datatype_t dtt,
+                                                 parsec_arena_budget_t *budget);
+
+/**
+ * @brief Holds some work back until @p arena and @p budget have room for
+ *   @p count elements.
+ *
+ * @details @p resume is called once with @p cb_data, by the thread that
+ *   releases some memory of the arena or of the budget, and it should
+ *   retry the allocation (and possibly wait again).
+ *
+ *   Work that needs several allocations must not keep the memory it
+ *   already got while it waits for the rest, otherwise two of them can
+ *   wait for each other forever: it gives that memory back first and
+ *   passes its size in @p given_back, so that it is only resumed once
+ *   @p budget has room for all of it.
+ *
+ * @return PARSEC_SUCCESS if the work is held back, PARSEC_ERR_EXISTS if
+ *   there is room for the allocation (the caller should retry now and
+ *   resume is not called), or PARSEC_ERR_VALUE_OUT_OF_BOUNDS if the
+ *   allocation can never fit in the arena, or the allocations together
+ *   in the budget.
+ */
+int parsec_arena_wait(parsec_arena_t *arena, size_t count, size_t given_back,
+                      parsec_arena_budget_t *budget,
+                      parsec_arena_resume_fn_t resume, void *cb_data);
+
+/**
+ * @brief Holds back a task whose output did not fit in @p arena, or in
+ *   the arena budget of its taskpool, until some memory is released. The
+ *   task is then scheduled again to retry its prepare_input.
+ *
+ * @details A held back task keeps no memory of an arena: the caller gives
+ *   back what it already got for the other outputs of the task (@p
+ *   given_back bytes, see parsec_arena_wait) and allocates it again when
+ *   the task is resumed. The PTG data lookup gives back its NEW copies,
+ *   the DTD one its tiles created on demand, and held back GETs their
+ *   receive buffers.
+ *
+ * @return the value prepare_input should return: PARSEC_HOOK_RETURN_ASYNC
+ *   if the task is held back, PARSEC_HOOK_RETURN_AGAIN if the allocation
+ *   can be retried now, or PARSEC_HOOK_RETURN_ERROR if it can never fit.
+ */
+int parsec_arena_defer_task(parsec_execution_stream_t *es,
+                            parsec_arena_t *arena, size_t count, size_t given_back,
+                            parsec_task_t *task);
+
+/**
+ * @brief Creates a budget of @p max_used bytes (0 for unlimited).
+ */
+parsec_arena_budget_t *parsec_arena_budget_new(size_t max_used);
+
 /**
  * @brief Allocates memory for a given data copy. This is a function used by
  *  DSLs to set the memory associated with a data copy they have created.
@@ -158,8 +319,42 @@ int  parsec_arena_allocate_device_private(parsec_data_copy_t *copy,
                                           size_t count, int device,
                                           parsec_datatype_t dtt);
 
+/**
+ * @brief Bytes of arena memory held by @p copy, 0 if it holds none.
+ */
+size_t parsec_arena_copy_bytes(const parsec_data_copy_t *copy);
+
+/**
+ * @brief Gives back to its arena the memory parsec_arena_allocate_device_private
+ *   set on @p copy, that stays attached to its data without memory.
+ */
+void parsec_arena_release_device_private(parsec_data_copy_t *copy);
+
 void parsec_arena_release(parsec_data_copy_t* ptr);
 
+/**
+ * @brief Changes the backing of the chunks of an arena.
+ *
+ * @details Must be called before the first chunk is allocated from the
+ *   arena. The huge page backings only apply to arenas that use the default
+ *   allocator (parsec_data_allocate), the other arenas keep their
+ *   data_malloc.
+ *
+ * @param arena the arena
+ * @param backing one of the PARSEC_ARENA_BACKING_*
+ * @return PARSEC_SUCCESS, or PARSEC_ERR_BAD_PARAM if the backing is unknown
+ *   or chunks were already allocated
+ */
+int parsec_arena_set_backing(parsec_arena_t *arena, int backing);
+
+/**
+ * @brief Gets the statistics of an arena.
+ *
+ * @param arena the arena
+ * @param stats the statistics of the arena
+ */
+void parsec_arena_get_stats(parsec_arena_t *arena, parsec_arena_stats_t *stats);
+
 END_C_DECLS
 
 /** @} */
@@ -8,7 +8,8 @@
 #define FIFO_H_HAS_BEEN_INCLUDED
 
 #include "parsec/parsec_config.h"
-#include "parsec/class/list.h"
+#include "parsec/class/list_item.h"
+#include "parsec/class/lifo.h"
 
 /**
  * @defgroup parsec_internal_classes_fifo First In First Out
@@ -17,21 +18,60 @@
  *
  *  @brief First In First out parsec_list_item_t management functions
  *
- *  @details Although the current implementation is a pure remap to
- *     the list (see @ref parsec_internal_classes_list "list.h"), it
- *     is not garanteed as such. If you need to use both FIFO and non
- *     FIFO access, list.h contains convenience functions to emulate a
- *     fifo that is garanteed to be compatible with list accessors.
+ *  @details The FIFO is lock-free, for any number of producers and
+ *     consumers. It is a linked list of segments, each holding an
+ *     array of PARSEC_FIFO_SEGMENT_SIZE items. Producers and consumers
+ *     take a slot of the current segment with an atomic ticket (a
+ *     fetch-and-add of the segment index), so that they only contend
+ *     on the ticket counters. A consumer that takes the ticket of a slot
+ *     before its producer has filled it marks the slot as skipped, and
+ *     the producer tries again with another ticket.
+ *
+ *     Exhausted segments are recycled once no thread references them
+ *     anymore, and released when the FIFO is destructed: the memory of
+ *     the FIFO follows its peak size. The FIFO can also be bounded with
+ *     parsec_fifo_set_capacity(), pushes then wait (or fail, with
+ *     parsec_fifo_try_push()) while it is full.
+ *
+ *     The FIFO is not a list anymore: items can only be accessed
+ *     through the functions below, and the list_next and list_prev
+ *     fields of the items are not used while the items are in a FIFO.
  */
 
 BEGIN_C_DECLS
 
+/**
+ * @brief Number of items in each segment of a FIFO
+ */
+#define PARSEC_FIFO_SEGMENT_SIZE 256
+
+typedef struct parsec_fifo_segment_s parsec_fifo_segment_t;
+
 /**
  * @brief A fifo object
  */
-typedef parsec_list_t parsec_fifo_t;
+typedef struct parsec_fifo_s {
+    parsec_object_t                  super;
+    parsec_fifo_segment_t * volatile head;      /**< Segment the consumers work on */
+    parsec_fifo_segment_t * volatile tail;      /**< Segment the producers work on */
+    parsec_lifo_t                    free_segments;  /**< Exhausted segments, ready to be reused */
+    volatile int32_t                 nb_segments;    /**< Number of segments allocated */
+    int32_t                          max_segments;   /**< Bound on nb_segments, 0 if unbounded */
+} parsec_fifo_t;
 PARSEC_DECLSPEC PARSEC_OBJ_CLASS_DECLARATION(parsec_fifo_t);
 
+/**
+ * @brief Bound the memory used by a FIFO
+ *
+ * @details Once bounded, the FIFO holds at least capacity items, and
+ *    never more than capacity plus two segments of items. It must be
+ *    called before any item is pushed in the FIFO.
+ *
+ * @param[inout] fifo the FIFO to bound
+ * @param[in] capacity the number of items, 0 for an unbounded FIFO
+ */
+void parsec_fifo_set_capacity(parsec_fifo_t* fifo, size_t capacity);
+
 /**
  * @brief tests if the FIFO is empty
  *
@@ -40,10 +80,7 @@ PARSEC_DECLSPEC PARSEC_OBJ_CLASS_DECLARATION(parsec_fifo_t);
  *
  * @remark this is a thread safe operation
  */
-static inline int
-parsec_fifo_is_empty( parsec_fifo_t* fifo ) {
-    return parsec_list_is_empty((parsec_list_t*)fifo);
-}
+int parsec_fifo_is_empty(parsec_fifo_t* fifo);
 
 /**
  * @brief test if the FIFO is empty without taking the lock on it
@@ -51,26 +88,37 @@ parsec_fifo_is_empty( parsec_fifo_t* fifo ) {
  * @param[in] fifo the FIFO to test
  * @return 0 if fifo is not empty, 1 otherwise
  *
- * @remark this is not a thread safe operation
+ * @remark the FIFO has no lock, this is the same as parsec_fifo_is_empty
  */
 static inline int
 parsec_fifo_nolock_is_empty( parsec_fifo_t* fifo)
 {
-    return parsec_list_nolock_is_empty((parsec_list_t*)fifo);
+    return parsec_fifo_is_empty(fifo);
 }
 
+/**
+ * @brief Try to push an element in the FIFO
+ *
+ * @param[inout] fifo the FIFO in which item should be pushed
+ * @param[inout] item the element to add to fifo
+ * @return 1 if item was pushed, 0 if the FIFO is bounded and full
+ *
+ * @remark this is a thread safe operation
+ */
+int parsec_fifo_try_push(parsec_fifo_t* fifo, parsec_list_item_t* item);
+
 /**
  * @brief Push an element in the FIFO
  *
+ * @details if the FIFO is bounded, this function waits until there is
+ *    room for the element
+ *
  * @param[inout] fifo the FIFO in which item should be pushed
  * @param[inout] item the element to add to fifo
  *
  * @remark this is a thread safe operation
  */
-static inline void
-parsec_fifo_push(parsec_fifo_t* fifo, parsec_list_item_t* item) {
-    parsec_list_push_back((parsec_list_t*)fifo, item);
-}
+void parsec_fifo_push(parsec_fifo_t* fifo, parsec_list_item_t* item);
 
 /**
  * @brief Push an element in the FIFO without checking the lock on it
@@ -78,11 +126,11 @@ parsec_fifo_push(parsec_fifo_t* fifo, parsec_list_item_t* item) {
  * @param[inout] fifo the FIFO in which item should be pushed
  * @param[inout] item the element to add to fifo
  *
- * @remark this is not a thread safe operation
+ * @remark the FIFO has no lock, this is the same as parsec_fifo_push
  */
 static inline void
 parsec_fifo_nolock_push(parsec_fifo_t* fifo, parsec_list_item_t* item) {
-    parsec_list_nolock_push_back((parsec_list_t*)fifo, item);
+    parsec_fifo_push(fifo, item);
 }
 
 /**
@@ -90,68 +138,56 @@ parsec_fifo_nolock_push(parsec_fifo_t* fifo, parsec_list_item_t* item) {
  *
  * @details items is a ring of elements, ordered. They are all pushed at
  *     the end of the FIFO, preserving the order between them (as if a
- *     call to push had been issued for each item in the ring).
+ *     call to push had been issued for each item in the ring). Elements
+ *     pushed concurrently by other threads may be interleaved with them.
  *
  * @param[inout] fifo the FIFO to which the ring of items should be pushed
  * @param[inout] items a ring of elements add to fifo
  *
  * @remark this is a thread safe operation
  */
-static inline void
-parsec_fifo_chain(parsec_fifo_t* fifo, parsec_list_item_t* items) {
-    parsec_list_chain_back((parsec_list_t*)fifo, items);
-}
+void parsec_fifo_chain(parsec_fifo_t* fifo, parsec_list_item_t* items);
 
 /**
  * @brief Chain a ring of elements at the end of a FIFO without
  *        taking the lock
  *
- * @details items is a ring of elements, ordered. They are all pushed at
- *     the end of the FIFO, preserving the order between them (as if a
- *     call to push had been issued for each item in the ring).
- *
  * @param[inout] fifo the FIFO to which the ring of items should be pushed
  * @param[inout] items a ring of elements add to fifo
  *
- * @remark this is not a thread safe operation
+ * @remark the FIFO has no lock, this is the same as parsec_fifo_chain
  */
 static inline void
 parsec_fifo_nolock_chain(parsec_fifo_t* fifo, parsec_list_item_t* items) {
-    parsec_list_nolock_chain_back((parsec_list_t*)fifo, items);
+    parsec_fifo_chain(fifo, items);
 }
 
 /**
- * @brief Extracts the first element in a FIFO
+ * @brief Try to extract the first element in a FIFO
  *
- * @details this function may wait until other threads are done
- *    pushing or extracting elements from the FIFO
+ * @details this function never waits for other threads. It may return
+ *    NULL while an element is being pushed concurrently.
  *
- * @param[inout] fifo the FIFO from which to extract the first element
+ * @param[inout] fifo the FIFO from which to try to extract the first element
  * @return NULL if fifo is empty, the first element that was removed from
  *        fifo otherwise.
  *
  * @remark this is a thread safe operation
  */
-static inline parsec_list_item_t*
-parsec_fifo_pop(parsec_fifo_t* fifo) {
-    return parsec_list_pop_front((parsec_list_t*)fifo);
-}
+parsec_list_item_t* parsec_fifo_try_pop(parsec_fifo_t* fifo);
 
 /**
- * @brief Try to extract the first element in a FIFO
- *
- * @details this function will not wait if other threads are done
- *    pushing or extracting elements from the FIFO
+ * @brief Extracts the first element in a FIFO
  *
- * @param[inout] fifo the FIFO from which to try to extract the first element
- * @return NULL if fifo is empty, or if another thread is holding the lock
- *        on fifo. The first element that was removed from fifo otherwise.
+ * @param[inout] fifo the FIFO from which to extract the first element
+ * @return NULL if fifo is empty, the first element that was removed from
+ *        fifo otherwise.
  *
  * @remark this is a thread safe operation
  */
 static inline parsec_list_item_t*
-parsec_fifo_try_pop(parsec_fifo_t* fifo) {
-    return parsec_list_try_pop_front((parsec_list_t*)fifo);
+parsec_fifo_pop(parsec_fifo_t* fifo) {
+    return parsec_fifo_try_pop(fifo);
 }
 
 /**
@@ -161,11 +197,11 @@ parsec_fifo_try_pop(parsec_fifo_t* fifo) {
  * @return NULL if fifo is empty, the first element that was removed from
  *        fifo otherwise.
  *
- * @remark this is not a thread safe operation
+ * @remark the FIFO has no lock, this is the same as parsec_fifo_pop
  */
 static inline parsec_list_item_t*
 parsec_fifo_nolock_pop(parsec_fifo_t* fifo) {
-    return parsec_list_nolock_pop_front((parsec_list_t*)fifo);
+    return parsec_fifo_try_pop(fifo);
 }
 
 END_C_DECLS
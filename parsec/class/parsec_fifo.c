@@ -6,6 +6,232 @@
 
 #include "parsec/parsec_config.h"
 #include "parsec/class/fifo.h"
+#include "parsec/sys/atomic.h"
 
-PARSEC_OBJ_CLASS_INSTANCE(parsec_fifo_t, parsec_list_t,
-                   NULL, NULL);
+#include <sched.h>
+
+/* Set in the state of a segment once the head has moved past it */
+#define SEGMENT_RETIRED  (1 << 30)
+/* Marks a slot that a consumer gave up on before its producer filled it */
+#define ITEM_SKIPPED     ((parsec_list_item_t*)(uintptr_t)1)
+/* Number of times a consumer re-reads a slot whose producer holds the ticket */
+#define SLOT_SPIN        64
+
+struct parsec_fifo_segment_s {
+    parsec_list_item_t               super;     /**< To be kept in the free segments */
+    volatile int32_t                 enq_idx;   /**< Next ticket for the producers */
+    volatile int32_t                 deq_idx;   /**< Next ticket for the consumers */
+    volatile int32_t                 state;     /**< References on the segment, and SEGMENT_RETIRED */
+    parsec_fifo_segment_t * volatile next;
+    parsec_list_item_t * volatile    items[PARSEC_FIFO_SEGMENT_SIZE];
+};
+
+static inline void
+parsec_fifo_segment_reset(parsec_fifo_segment_t *seg)
+{
+    int i;
+    for(i = 0; i < PARSEC_FIFO_SEGMENT_SIZE; i++)
+        seg->items[i] = NULL;
+    seg->enq_idx = 0;
+    seg->deq_idx = 0;
+    seg->next    = NULL;
+}
+
+static parsec_fifo_segment_t*
+parsec_fifo_segment_new(parsec_fifo_t *fifo)
+{
+    parsec_fifo_segment_t *seg;
+
+    seg = (parsec_fifo_segment_t*)parsec_lifo_pop(&fifo->free_segments);
+    if( NULL != seg )
+        return seg;
+    if( parsec_atomic_fetch_inc_int32(&fifo->nb_segments) >= fifo->max_segments &&
+        0 != fifo->max_segments ) {
+        parsec_atomic_fetch_dec_int32(&fifo->nb_segments);
+        return NULL;
+    }
+    seg = (parsec_fifo_segment_t*)parsec_lifo_item_alloc(&fifo->free_segments,
+                                                         sizeof(parsec_fifo_segment_t));
+    seg->state = 0;
+    parsec_fifo_segment_reset(seg);
+    return seg;
+}
+
+/* The segment is not referenced anymore, keep it for a future use. Threads
+ * that still read the head or the tail may take a spurious reference on
+ * it, but they will drop it once they see that the segment moved. */
+static inline void
+parsec_fifo_segment_recycle(parsec_fifo_t *fifo, parsec_fifo_segment_t *seg)
+{
+    parsec_fifo_segment_reset(seg);
+    parsec_lifo_push(&fifo->free_segments, &seg->super);
+}
+
+static inline void
+parsec_fifo_segment_release(parsec_fifo_t *fifo, parsec_fifo_segment_t *seg)
+{
+    if( (parsec_atomic_fetch_dec_int32(&seg->state) - 1) != SEGMENT_RETIRED )
+        return;
+    /* Only one of the threads that see the last reference of a retired
+     * segment disappear can clear the retired flag */
+    if( parsec_atomic_cas_int32(&seg->state, SEGMENT_RETIRED, 0) )
+        parsec_fifo_segment_recycle(fifo, seg);
+}
+
+/* Takes a reference on the segment pointed by where, so that it cannot be
+ * recycled while it is used */
+static inline parsec_fifo_segment_t*
+parsec_fifo_segment_acquire(parsec_fifo_t *fifo, parsec_fifo_segment_t * volatile *where)
+{
+    parsec_fifo_segment_t *seg;
+
+    for(;;) {
+        seg = *where;
+        parsec_atomic_fetch_inc_int32(&seg->state);
+        if( seg == *where )
+            return seg;
+        parsec_fifo_segment_release(fifo, seg);
+    }
+}
+
+void parsec_fifo_set_capacity(parsec_fifo_t* fifo, size_t capacity)
+{
+    fifo->max_segments = (0 == capacity) ? 0 :
+        (int32_t)((capacity + PARSEC_FIFO_SEGMENT_SIZE - 1) / PARSEC_FIFO_SEGMENT_SIZE) + 1;
+}
+
+int parsec_fifo_is_empty(parsec_fifo_t* fifo)
+{
+    parsec_fifo_segment_t *head = parsec_fifo_segment_acquire(fifo, &fifo->head);
+    int32_t enq_idx = head->enq_idx;
+    int empty;
+
+    if( enq_idx > PARSEC_FIFO_SEGMENT_SIZE ) enq_idx = PARSEC_FIFO_SEGMENT_SIZE;
+    empty = (head->deq_idx >= enq_idx) && (NULL == head->next);
+    parsec_fifo_segment_release(fifo, head);
+    return empty;
+}
+
+int parsec_fifo_try_push(parsec_fifo_t* fifo, parsec_list_item_t* item)
+{
+    parsec_fifo_segment_t *tail, *next, *seg;
+    int32_t idx;
+
+    PARSEC_ITEM_ATTACH(fifo, item);
+    for(;;) {
+        tail = parsec_fifo_segment_acquire(fifo, &fifo->tail);
+        idx = parsec_atomic_fetch_inc_int32(&tail->enq_idx);
+        if( idx < PARSEC_FIFO_SEGMENT_SIZE ) {
+            if( parsec_atomic_cas_ptr(&tail->items[idx], NULL, item) ) {
+                parsec_fifo_segment_release(fifo, tail);
+                return 1;
+            }
+            /* A consumer skipped this slot, take another ticket */
+            parsec_fifo_segment_release(fifo, tail);
+            continue;
+        }
+        /* The segment is full, append a new one starting with our item */
+        if( NULL == (next = tail->next) ) {
+            if( NULL == (seg = parsec_fifo_segment_new(fifo)) ) {
+                parsec_fifo_segment_release(fifo, tail);
+                PARSEC_ITEM_DETACH(item);
+                return 0;
+            }
+            seg->items[0] = item;
+            seg->enq_idx  = 1;
+            if( parsec_atomic_cas_ptr(&tail->next, NULL, seg) ) {
+                parsec_atomic_cas_ptr(&fifo->tail, tail, seg);
+                parsec_fifo_segment_release(fifo, tail);
+                return 1;
+            }
+            parsec_fifo_segment_recycle(fifo, seg);
+            next = tail->next;
+        }
+        parsec_atomic_cas_ptr(&fifo->tail, tail, next);
+        parsec_fifo_segment_release(fifo, tail);
+    }
+}
+
+void parsec_fifo_push(parsec_fifo_t* fifo, parsec_list_item_t* item)
+{
+    while( !parsec_fifo_try_push(fifo, item) )
+        sched_yield();
+}
+
+void parsec_fifo_chain(parsec_fifo_t* fifo, parsec_list_item_t* items)
+{
+    parsec_list_item_t *item;
+
+    while( NULL != items ) {
+        item  = items;
+        items = parsec_list_item_ring_chop(item);
+        parsec_fifo_push(fifo, item);
+    }
+}
+
+parsec_list_item_t* parsec_fifo_try_pop(parsec_fifo_t* fifo)
+{
+    parsec_fifo_segment_t *head, *next;
+    parsec_list_item_t *item;
+    int32_t idx, enq_idx;
+    int spin;
+
+    for(;;) {
+        head = parsec_fifo_segment_acquire(fifo, &fifo->head);
+        enq_idx = head->enq_idx;
+        if( enq_idx > PARSEC_FIFO_SEGMENT_SIZE ) enq_idx = PARSEC_FIFO_SEGMENT_SIZE;
+        if( (head->deq_idx >= enq_idx) && (NULL == head->next) ) {
+            parsec_fifo_segment_release(fifo, head);
+            return NULL;
+        }
+        idx = parsec_atomic_fetch_inc_int32(&head->deq_idx);
+        if( idx < PARSEC_FIFO_SEGMENT_SIZE ) {
+            /* The slot is ours, unless its producer is late */
+            for(spin = 0; NULL == (item = head->items[idx]) && (spin < SLOT_SPIN); spin++) {
+                if( idx >= head->enq_idx ) break;  /* no producer has this ticket yet */
+            }
+            if( (NULL == item) && parsec_atomic_cas_ptr(&head->items[idx], NULL, ITEM_SKIPPED) ) {
+                parsec_fifo_segment_release(fifo, head);
+                continue;
+            }
+            item = head->items[idx];
+            parsec_fifo_segment_release(fifo, head);
+            PARSEC_ITEM_DETACH(item);
+            return item;
+        }
+        /* The segment is exhausted, move the head to the next one */
+        if( NULL == (next = head->next) ) {
+            parsec_fifo_segment_release(fifo, head);
+            return NULL;
+        }
+        /* The tail never lags behind the head */
+        parsec_atomic_cas_ptr(&fifo->tail, head, next);
+        if( parsec_atomic_cas_ptr(&fifo->head, head, next) )
+            parsec_atomic_fetch_add_int32(&head->state, SEGMENT_RETIRED);
+        parsec_fifo_segment_release(fifo, head);
+    }
+}
+
+static void parsec_fifo_construct(parsec_fifo_t* fifo)
+{
+    PARSEC_OBJ_CONSTRUCT(&fifo->free_segments, parsec_lifo_t);
+    fifo->nb_segments  = 0;
+    fifo->max_segments = 0;
+    fifo->head = fifo->tail = parsec_fifo_segment_new(fifo);
+}
+
+static void parsec_fifo_destruct(parsec_fifo_t* fifo)
+{
+    parsec_fifo_segment_t *seg, *next;
+
+    for(seg = fifo->head; NULL != seg; seg = next) {
+        next = seg->next;
+        parsec_lifo_item_free(&seg->super);
+    }
+    while( NULL != (seg = (parsec_fifo_segment_t*)parsec_lifo_pop(&fifo->free_segments)) )
+        parsec_lifo_item_free(&seg->super);
+    PARSEC_OBJ_DESTRUCT(&fifo->free_segments);
+}
+
+PARSEC_OBJ_CLASS_INSTANCE(parsec_fifo_t, parsec_object_t,
+                   parsec_fifo_construct, parsec_fifo_destruct);
@@ -11,21 +11,43 @@
 #include "parsec/utils/mca_param.h"
 #include "parsec/utils/debug.h"
 #include <stdio.h>
+#include <string.h>
 
-#undef HELPFIRST
+/* Number of items stored directly in a bucket, before they are chained */
+#define PARSEC_HASH_TABLE_BUCKET_SLOTS 4
+/* Buckets are aligned on, and fill, one cache line */
+#define PARSEC_HASH_TABLE_BUCKET_SIZE  64
 
 /**
  * @brief Bucket for hash tables. There is no need to have this structure public, it
  *        should only be used in this file.
+ *
+ * @details The first items of a bucket are stored in slots, together with
+ *   a one-byte fingerprint of their hash in tags: a lookup only dereferences
+ *   the items whose fingerprint matches, instead of walking a list through
+ *   the (usually cold) objects that contain the items. The other items are
+ *   chained from first_item. The fields are ordered by decreasing alignment
+ *   so the padding is the only hole.
  */
 struct parsec_hash_table_bucket_s {
+    parsec_hash_table_item_t *slots[PARSEC_HASH_TABLE_BUCKET_SLOTS]; /**< Items stored in the bucket itself */
+    parsec_hash_table_item_t *first_item;       /**< Other items are simply chained lists */
+    int32_t                   cur_len;          /**< Number of elements currently in this bucket */
+    volatile int32_t          migrated;         /**< Set once the elements of this bucket have been moved
+                                                 *   to the bigger table: the bucket remains empty after that */
+    uint32_t                  tags;             /**< One byte per slot: 0 if the slot is empty, the
+                                                 *   fingerprint of the item otherwise */
     parsec_atomic_lock_t      lock;             /**< Buckets are lockable for multithread access
                                                  *   We also use this lock to atomically update the
                                                  *   list of elements when needed. */
-    int32_t                   cur_len;          /**< Number of elements currently in this bucket */
-    parsec_hash_table_item_t *first_item;       /**< Otherwise they are simply chained lists */
+    char                      pad[PARSEC_HASH_TABLE_BUCKET_SIZE - (PARSEC_HASH_TABLE_BUCKET_SLOTS + 1) * sizeof(void*)
+                                  - 3 * sizeof(int32_t) - sizeof(parsec_atomic_lock_t)];
 };
 
+/* How many buckets of the table being migrated each thread tries to move when it
+ * enters the hash table */
+#define PARSEC_HASH_TABLE_MIGRATION_CHUNK 2
+
 #define BASEADDROF(item, ht)  (void*)(  ( (char*)(item) ) - ( (ht)->elt_hashitem_offset ) )
 #define ITEMADDROF(ptr, ht)   (parsec_hash_table_item_t*)( ((char*)(ptr)) + ( (ht)->elt_hashitem_offset ) )
 
@@ -35,6 +57,8 @@ static int      parsec_hash_table_mca_param_mnb_index = -1;
 static int32_t  parsec_hash_table_max_table_nb_bits   = 24; /* We will never create a sub-table with more than 1<<parsec_hash_table_max_table_nb_bits buckets
                                                              * NB: if the user calls parsec_hash_table_init with nb_bits > parsec_hash_table_max_table_nb_bits,
                                                              *     we *will* create the first-level table with 1<<nb_bits buckets, despite this value. */
+static int      parsec_hash_table_mca_param_slots_index = -1;
+static int32_t  parsec_hash_table_use_slots           = 1;  /* Store the first items of the buckets in fingerprinted slots */
 
 void *parsec_hash_table_item_lookup(parsec_hash_table_t *ht, parsec_hash_table_item_t *item)
 {
@@ -61,6 +85,8 @@ int parsec_hash_tables_init(void)
 {
     int v = parsec_hash_table_max_collisions_hint;
 
+    assert( sizeof(parsec_hash_table_bucket_t) == PARSEC_HASH_TABLE_BUCKET_SIZE );
+
     parsec_hash_table_mca_param_mch_index =
         parsec_mca_param_reg_int_name("parsec", "hash_table_max_collisions_hint",
                                       "Sets a hint for the dynamic hash tables implementation: "
@@ -84,14 +110,45 @@ int parsec_hash_tables_init(void)
         return PARSEC_ERROR;
     }
 
+    v = parsec_hash_table_use_slots;
+    parsec_hash_table_mca_param_slots_index =
+        parsec_mca_param_reg_int_name("parsec", "hash_table_slots",
+                                      "Store the first items of each bucket of the hash tables in the bucket itself, "
+                                      "with a fingerprint of their hash, so that lookups only touch the items whose "
+                                      "fingerprint matches. If 0, buckets are only chained lists of items.\n",
+                                      false, false, v, &v);
+    parsec_hash_table_use_slots = v;
+    if( PARSEC_ERROR == parsec_hash_table_mca_param_slots_index ) {
+        return PARSEC_ERROR;
+    }
+
     return PARSEC_SUCCESS;
 }
 
-void parsec_hash_table_init(parsec_hash_table_t *ht, int64_t offset, int nb_bits, parsec_key_fn_t key_functions, void *data)
+static parsec_hash_table_head_t *parsec_hash_table_head_new(int nb_bits, parsec_hash_table_head_t *next)
 {
-    parsec_atomic_rwlock_t unlock = PARSEC_RWLOCK_UNLOCKED;
     parsec_hash_table_head_t *head;
-    size_t i;
+
+    head = malloc(sizeof(parsec_hash_table_head_t));
+    if( 0 != posix_memalign((void**)&head->buckets, PARSEC_HASH_TABLE_BUCKET_SIZE,
+                            (1ULL<<nb_bits) * sizeof(parsec_hash_table_bucket_t)) ) {
+        parsec_fatal("Unable to allocate a hash table with %lu buckets", (1UL<<nb_bits));
+    }
+    head->nb_bits        = nb_bits;
+    head->migrate_cursor = 0;
+    head->nb_migrated    = 0;
+    head->next           = next;
+    head->next_to_free   = next;
+
+    for( size_t i = 0; i < (1ULL<<nb_bits); i++) {
+        memset(&head->buckets[i], 0, sizeof(parsec_hash_table_bucket_t));
+        parsec_atomic_lock_init(&head->buckets[i].lock);
+    }
+    return head;
+}
+
+void parsec_hash_table_init(parsec_hash_table_t *ht, int64_t offset, int nb_bits, parsec_key_fn_t key_functions, void *data)
+{
     int v;
 
     if( parsec_hash_table_mca_param_mch_index != PARSEC_ERROR ) {
@@ -112,59 +169,214 @@ void parsec_hash_table_init(parsec_hash_table_t *ht, int64_t offset, int nb_bits
     ht->hash_data = data;
     ht->elt_hashitem_offset = offset;
     ht->warning_issued = 0;
+    ht->nb_resizes = 0;
+    ht->use_slots = parsec_hash_table_use_slots;
+    if( parsec_hash_table_mca_param_slots_index != PARSEC_ERROR ) {
+        if( parsec_mca_param_lookup_int(parsec_hash_table_mca_param_slots_index, &v) != PARSEC_ERROR ) {
+            ht->use_slots = v;
+        }
+    }
+    ht->rw_hash = parsec_hash_table_head_new(nb_bits, NULL);
+}
 
-    head = malloc(sizeof(parsec_hash_table_head_t));
-    head->buckets      = malloc( (1ULL<<nb_bits) * sizeof(parsec_hash_table_bucket_t));
-    head->nb_bits      = nb_bits;
-    head->used_buckets = 0;
-    head->next         = NULL;
-    head->next_to_free = NULL;
-    ht->rw_hash        = head;
-    ht->rw_lock        = unlock;
-
-    for( i = 0; i < (1ULL<<nb_bits); i++) {
-        parsec_atomic_lock_init(&head->buckets[i].lock);
-        head->buckets[i].cur_len = 0;
-        head->buckets[i].first_item = NULL;
+/**
+ * Scrambles the 64-bits hash of a key. The bucket of the key in a table of
+ * 1<<M buckets is given by the M lower bits of the result, so a bucket i of
+ * a table splits into the buckets i and i+(1<<M) of the table twice as big,
+ * which is what allows to migrate the buckets of a table independently when
+ * it is resized. The 7 upper bits provide the fingerprint of the key.
+ * The key is folded on 32 bits, and multiplied by the golden ratio: the high
+ * half of the product, where every bit of the folded key contributes, is
+ * folded back on the lower bits. This costs one multiplication, and the
+ * result is computed once per operation, whatever the number of tables.
+ */
+static inline uint64_t parsec_hash_table_mix(uint64_t hash64)
+{
+    uint64_t h = (hash64 ^ (hash64 >> 32)) * 0x9e3779b97f4a7c15ULL;
+    return h ^ (h >> 32);
+}
+
+#define PARSEC_HASH_TABLE_INDEX(_MIX, _HEAD)  ((_MIX) & ((1ULL<<(_HEAD)->nb_bits) - 1))
+/* Fingerprints always have their high bit set, so 0 marks an empty slot */
+#define PARSEC_HASH_TABLE_TAG(_MIX)          ((uint32_t)((_MIX) >> 57) | 0x80)
+
+/**
+ * Compares the fingerprint with the tags of all the slots of a bucket at
+ * once (SIMD within a register), and returns a mask where the high bit of
+ * the byte of each candidate slot is set. A slot whose fingerprint differs
+ * by the low bit from a matching slot below it may also be reported, but
+ * that slot is never empty: the candidates must be checked anyway.
+ */
+static inline uint32_t parsec_hash_table_match_tags(uint32_t tags, uint32_t tag)
+{
+    uint32_t x = tags ^ (tag * 0x01010101U);
+    return (x - 0x01010101U) & ~x & 0x80808080U;
+}
+
+#define PARSEC_HASH_TABLE_SLOT_MATCHES(_MASK, _S)  (((_MASK) >> (8 * (_S) + 7)) & 1)
+
+/* Adds an item to a locked bucket */
+static inline void parsec_hash_table_bucket_push(parsec_hash_table_t *ht,
+                                                 parsec_hash_table_bucket_t *bucket,
+                                                 parsec_hash_table_item_t *item,
+                                                 uint64_t mix)
+{
+    uint32_t free_slots;
+
+    bucket->cur_len++;
+    if( ht->use_slots ) {
+        free_slots = parsec_hash_table_match_tags(bucket->tags, 0);
+        for( int s = 0; s < PARSEC_HASH_TABLE_BUCKET_SLOTS; s++ ) {
+            /* The lowest match is exact */
+            if( PARSEC_HASH_TABLE_SLOT_MATCHES(free_slots, s) ) {
+                bucket->slots[s] = item;
+                bucket->tags |= PARSEC_HASH_TABLE_TAG(mix) << (8 * s);
+                return;
+            }
+        }
     }
+    item->next_item = bucket->first_item;
+    bucket->first_item = item;
 }
 
-static uint64_t parsec_hash_table_universal_rehash(parsec_key_t key, int nb_bits) {
-    /* Scramble the bits using a universal hash function, implementing
-     * the universal hash function described in
-     * https://en.wikipedia.org/wiki/Universal_hashing#Avoiding_modular_arithmetic.
-     * The 64bit key is mapped into 32bit, expanded back into 64bit using two random
-     * 64bit integers, and then contracted into nb_bits bits, i.e.,
-     * h(x) = ((a*x+b) mod 2^(w+M)) div 2^w), with w being the word size (32 in our case)
-     * and M being the number of bits for the hash (nb_bits).
-     * This scheme requires arithmetic in 2w bits, which is why we first fold k into 32bit.
-     * Thus, we can remain in 2w = 64bit, instead of using non-standardized 128bit integer
-     * arithmetic.
-     * The div and mod operations use powers-of-2 so compilers are able to optimize them.
-     */
-
-    const uint64_t k = (uint64_t)(uintptr_t)key;
-    /* randomly chosen integers (max 48 bits) */
-    const uint64_t a = 0xaa88564915aULL;
-    const uint64_t b = 0x165e44f1fc94ULL;
-    /* 2^(w+M) */
-    const uint64_t wm2 = ((uint64_t)1)<<(32+nb_bits);
-    /* 2^(w) */
-    const uint64_t w2 = ((uint64_t)1)<<32;
-    /* fold k into lower 32bit but leave upper bits intact, they may flow out anyway */
-    const uint64_t k32 = (k>>32) ^ k;
-    /* (a*x+b) mod 2^(w+M)) div 2^w */
-    return (((a*k32)+b)%wm2)/w2;
+/**
+ * Moves the elements of the bucket idx of old_head into the two buckets of
+ * head it splits into. The caller must hold the lock of the bucket of
+ * old_head; the buckets of head are only try-locked, so this never blocks
+ * and never creates a lock dependency. Returns 1 if the bucket is migrated
+ * when the function returns, 0 if it must be tried again later.
+ */
+static int parsec_hash_table_migrate_bucket(parsec_hash_table_t *ht,
+                                            parsec_hash_table_head_t *head,
+                                            parsec_hash_table_head_t *old_head,
+                                            uint64_t idx)
+{
+    parsec_hash_table_bucket_t *src = &old_head->buckets[idx], *low, *high;
+    parsec_hash_table_item_t *current_item, *next_item;
+    uint64_t mix;
+
+    if( src->migrated )
+        return 1;
+    assert( head->nb_bits == old_head->nb_bits + 1 );
+    low  = &head->buckets[idx];
+    high = &head->buckets[idx + (1ULL<<old_head->nb_bits)];
+    if( !parsec_atomic_trylock(&low->lock) )
+        return 0;
+    if( !parsec_atomic_trylock(&high->lock) ) {
+        parsec_atomic_unlock(&low->lock);
+        return 0;
+    }
+    for( int s = 0; s < PARSEC_HASH_TABLE_BUCKET_SLOTS; s++ ) {
+        if( NULL == (current_item = src->slots[s]) ) continue;
+        mix = parsec_hash_table_mix(current_item->hash64);
+        parsec_hash_table_bucket_push(ht, (PARSEC_HASH_TABLE_INDEX(mix, head) == idx) ? low : high, current_item, mix);
+        src->slots[s] = NULL;
+    }
+    for(current_item = src->first_item; NULL != current_item; current_item = next_item) {
+        next_item = current_item->next_item;
+        mix = parsec_hash_table_mix(current_item->hash64);
+        parsec_hash_table_bucket_push(ht, (PARSEC_HASH_TABLE_INDEX(mix, head) == idx) ? low : high, current_item, mix);
+    }
+    src->first_item = NULL;
+    src->tags = 0;
+    src->cur_len = 0;
+    src->migrated = 1;
+    parsec_atomic_unlock(&high->lock);
+    parsec_atomic_unlock(&low->lock);
+
+    if( (int32_t)(1ULL<<old_head->nb_bits) == parsec_atomic_fetch_inc_int32(&old_head->nb_migrated) + 1 ) {
+        /* Last bucket: lookups stop considering the old table. It is not
+         * released before the hash table, as other threads may still read it */
+        parsec_atomic_cas_ptr(&head->next, old_head, NULL);
+        PARSEC_DEBUG_VERBOSE(20, parsec_debug_output, "Hash table %p: migration to %d buckets completed",
+                             ht, 1<<head->nb_bits);
+    }
+    return 1;
+}
+
+/**
+ * Threads entering the hash table without holding any bucket lock help
+ * migrating a few buckets of the table being migrated, if any.
+ */
+static inline void parsec_hash_table_help_migration(parsec_hash_table_t *ht)
+{
+    parsec_hash_table_head_t *head = ht->rw_hash;
+    parsec_hash_table_head_t *old_head = head->next;
+    uint64_t idx;
+
+    if( PARSEC_LIKELY(NULL == old_head) )
+        return;
+    for( int n = 0; n < PARSEC_HASH_TABLE_MIGRATION_CHUNK; n++ ) {
+        idx = (uint32_t)parsec_atomic_fetch_inc_int32(&old_head->migrate_cursor) & ((1ULL<<old_head->nb_bits) - 1);
+        if( old_head->buckets[idx].migrated )
+            continue;
+        if( !parsec_atomic_trylock(&old_head->buckets[idx].lock) )
+            continue;
+        parsec_hash_table_migrate_bucket(ht, head, old_head, idx);
+        parsec_atomic_unlock(&old_head->buckets[idx].lock);
+    }
+}
+
+/**
+ * Finds the table that holds the bucket of a key: the table being migrated
+ * if the bucket of the key has not been migrated yet, the current table
+ * otherwise. This is stable as long as the caller holds the lock on that
+ * bucket, since locked buckets are never migrated.
+ */
+static inline parsec_hash_table_head_t *parsec_hash_table_find_home(parsec_hash_table_t *ht, uint64_t hash64, uint64_t *hash)
+{
+    parsec_hash_table_head_t *head = ht->rw_hash;
+    parsec_hash_table_head_t *old_head = head->next;
+    uint64_t mix = parsec_hash_table_mix(hash64);
+
+    if( NULL != old_head ) {
+        *hash = PARSEC_HASH_TABLE_INDEX(mix, old_head);
+        if( !old_head->buckets[*hash].migrated )
+            return old_head;
+    }
+    *hash = PARSEC_HASH_TABLE_INDEX(mix, head);
+    return head;
+}
+
+/**
+ * Locks the bucket of a key and returns the table that holds it. The
+ * bucket of the table being migrated is locked first: if it was migrated
+ * in the meantime, the bucket of the current table is tried next, and if
+ * the table was resized again the lookup restarts from the new table.
+ */
+static parsec_hash_table_head_t *parsec_hash_table_lock_home(parsec_hash_table_t *ht, uint64_t hash64, uint64_t *phash)
+{
+    parsec_hash_table_head_t *head, *old_head;
+    uint64_t hash, mix = parsec_hash_table_mix(hash64);
+
+    parsec_hash_table_help_migration(ht);
+    while( 1 ) {
+        head = ht->rw_hash;
+        old_head = head->next;
+        if( NULL != old_head ) {
+            hash = PARSEC_HASH_TABLE_INDEX(mix, old_head);
+            parsec_atomic_lock(&old_head->buckets[hash].lock);
+            if( !old_head->buckets[hash].migrated ) {
+                *phash = hash;
+                return old_head;
+            }
+            parsec_atomic_unlock(&old_head->buckets[hash].lock);
+        }
+        hash = PARSEC_HASH_TABLE_INDEX(mix, head);
+        parsec_atomic_lock(&head->buckets[hash].lock);
+        if( !head->buckets[hash].migrated ) {
+            *phash = hash;
+            return head;
+        }
+        parsec_atomic_unlock(&head->buckets[hash].lock);
+    }
 }
 
 void parsec_hash_table_lock_bucket(parsec_hash_table_t *ht, parsec_key_t key )
 {
     uint64_t hash;
 
-    parsec_atomic_rwlock_rdlock(&ht->rw_lock);
-    hash = parsec_hash_table_universal_rehash(ht->key_functions.key_hash(key, ht->hash_data), ht->rw_hash->nb_bits);
-    assert( hash < (1ULL<<ht->rw_hash->nb_bits) );
-    parsec_atomic_lock(&ht->rw_hash->buckets[hash].lock);
+    parsec_hash_table_lock_home(ht, ht->key_functions.key_hash(key, ht->hash_data), &hash);
 }
 
 void parsec_hash_table_lock_bucket_handle(parsec_hash_table_t *ht,
@@ -173,53 +385,43 @@ void parsec_hash_table_lock_bucket_handle(parsec_hash_table_t *ht,
 {
     uint64_t hash64, hash;
 
-    parsec_atomic_rwlock_rdlock(&ht->rw_lock);
     hash64 = ht->key_functions.key_hash(key, ht->hash_data);
-    hash = parsec_hash_table_universal_rehash(hash64, ht->rw_hash->nb_bits);
-    assert( hash < (1ULL<<ht->rw_hash->nb_bits) );
-    parsec_atomic_lock(&ht->rw_hash->buckets[hash].lock);
+    handle->head = parsec_hash_table_lock_home(ht, hash64, &hash);
+    assert( hash < (1ULL<<handle->head->nb_bits) );
     handle->key = key;
     handle->hash64 = hash64;
     handle->hash = hash;
 }
 
-static void parsec_hash_table_resize(parsec_hash_table_t *ht)
+/**
+ * Publishes a table twice as big as old_head, unless the table has been
+ * resized already or a migration is still in progress. The buckets of
+ * old_head are then migrated by the threads accessing the hash table.
+ */
+static void parsec_hash_table_resize(parsec_hash_table_t *ht, parsec_hash_table_head_t *old_head)
 {
-    parsec_atomic_lock_t unlocked = PARSEC_ATOMIC_UNLOCKED;
     parsec_hash_table_head_t *head;
-    parsec_hash_table_head_t *old_head = ht->rw_hash;
     int nb_bits = old_head->nb_bits + 1;
     assert(nb_bits < 32);
 
-    /* count the number of used buckets */
-    int32_t used_buckets = 0;
-    for (size_t i = 0; i < (1ULL << old_head->nb_bits); ++i) {
-        if (NULL != old_head->buckets[i].first_item) {
-            ++used_buckets;
-        }
-    }
-    old_head->used_buckets = used_buckets;
-
-    head = malloc(sizeof(parsec_hash_table_head_t));
-    head->buckets      = malloc((1ULL<<nb_bits) * sizeof(parsec_hash_table_bucket_t));
-    head->nb_bits      = nb_bits;
-    head->used_buckets = 0;
-    head->next         = old_head;
-    head->next_to_free = old_head;
-    ht->rw_hash        = head;
-
-    for( size_t i = 0; i < (1ULL<<nb_bits); i++) {
-        head->buckets[i].lock = unlocked;
-        head->buckets[i].cur_len = 0;
-        head->buckets[i].first_item = NULL;
+    if( ht->rw_hash != old_head || NULL != old_head->next )
+        return;
+    head = parsec_hash_table_head_new(nb_bits, old_head);
+    parsec_atomic_wmb();
+    if( !parsec_atomic_cas_ptr(&ht->rw_hash, old_head, head) ) {
+        /* Somebody else resized the table */
+        free(head->buckets);
+        free(head);
+        return;
     }
+    parsec_atomic_fetch_inc_int32(&ht->nb_resizes);
 }
 
 void parsec_hash_table_unlock_bucket_impl(parsec_hash_table_t *ht, parsec_key_t key, const char *file, int line)
 {
     uint64_t hash64 = ht->key_functions.key_hash(key, ht->hash_data);
-    uint64_t hash = parsec_hash_table_universal_rehash(hash64, ht->rw_hash->nb_bits);
-    parsec_key_handle_t handle = {.key = key, .hash64 = hash64, .hash = hash};
+    parsec_key_handle_t handle = {.key = key, .hash64 = hash64};
+    handle.head = parsec_hash_table_find_home(ht, hash64, &handle.hash);
     parsec_hash_table_unlock_bucket_handle_impl(ht, &handle, file, line);
 }
 
@@ -229,37 +431,51 @@ void parsec_hash_table_unlock_bucket_handle_impl(parsec_hash_table_t *ht,
                                                  const char *file, int line)
 {
     int resize = 0;
-    parsec_hash_table_head_t *cur_head;
+    parsec_hash_table_head_t *head = handle->head;
     uint64_t hash = handle->hash;
 
-    assert( hash < (1ULL<<ht->rw_hash->nb_bits) );
-    if( ht->rw_hash->buckets[hash].cur_len > ht->max_collisions_hint ) {
-        if( (int)ht->rw_hash->nb_bits + 1 < ht->max_table_nb_bits )
+    assert( hash < (1ULL<<head->nb_bits) );
+    if( head != ht->rw_hash ) {
+        /* The bucket belongs to the table being migrated, and we hold its
+         * lock: move it to the current table now */
+        assert( ht->rw_hash->next == head );
+        parsec_hash_table_migrate_bucket(ht, ht->rw_hash, head, hash);
+    } else if( head->buckets[hash].cur_len > ht->max_collisions_hint ) {
+        if( (int)head->nb_bits + 1 < ht->max_table_nb_bits )
             resize = 1;
         else {
             if( !ht->warning_issued ) {
                 parsec_warning("%s:%d -- Hash table has %d collisions in bucket %lu, but it already spans over %lu buckets. Performance might get very bad if more elements continue to stack in this bucket. Consider allowing larger resize with the MCA parameter parsec_hash_table_max_table_nb_bits",
-                               file, line, ht->rw_hash->buckets[hash].cur_len, hash, (1UL<<ht->rw_hash->nb_bits));
+                               file, line, head->buckets[hash].cur_len, hash, (1UL<<head->nb_bits));
                 ht->warning_issued = 1;
             }
         }
     }
-    cur_head = ht->rw_hash;
-    parsec_atomic_unlock(&ht->rw_hash->buckets[hash].lock);
-    parsec_atomic_rwlock_rdunlock(&ht->rw_lock);
+    parsec_atomic_unlock(&head->buckets[hash].lock);
 
     if( resize ) {
-        parsec_atomic_rwlock_wrlock(&ht->rw_lock);
-        if( cur_head == ht->rw_hash ) {
-            /* Barring ABA problems, nobody resized the hash table;
-             * Good enough hint that it's our role to do so */
-            parsec_hash_table_resize(ht);
-        }
-        /* Otherwise, let's assume somebody resized already */
-        parsec_atomic_rwlock_wrunlock(&ht->rw_lock);
+        parsec_hash_table_resize(ht, head);
     }
 }
 
+/**
+ * Moves all the remaining buckets of the table being migrated. This
+ * blocks on the bucket locks, and is only used when no other thread
+ * accesses the hash table.
+ */
+static void parsec_hash_table_migrate_all(parsec_hash_table_t *ht)
+{
+    parsec_hash_table_head_t *head = ht->rw_hash;
+    parsec_hash_table_head_t *old_head;
+
+    while( NULL != (old_head = head->next) ) {
+        for( uint64_t i = 0; i < (1ULL<<old_head->nb_bits); i++ ) {
+            parsec_atomic_lock(&old_head->buckets[i].lock);
+            parsec_hash_table_migrate_bucket(ht, head, old_head, i);
+            parsec_atomic_unlock(&old_head->buckets[i].lock);
+        }
+    }
+}
 
 void parsec_hash_table_fini(parsec_hash_table_t *ht)
 {
@@ -268,7 +484,7 @@ void parsec_hash_table_fini(parsec_hash_table_t *ht)
     while( NULL != head ) {
         if(NULL != head->buckets) {
             for(size_t i = 0; i < (1ULL<<head->nb_bits); i++) {
-                assert(NULL == head->buckets[i].first_item);
+                assert(0 == head->buckets[i].cur_len);
             }
             free(head->buckets);
             head->buckets = NULL;
@@ -283,11 +499,11 @@ void parsec_hash_table_fini(parsec_hash_table_t *ht)
 
 void parsec_hash_table_nolock_insert(parsec_hash_table_t *ht, parsec_hash_table_item_t *item)
 {
-    uint64_t hash, hash64;
+    uint64_t hash64;
     parsec_key_t key = item->key;
     hash64 = ht->key_functions.key_hash(key, ht->hash_data);
-    hash = parsec_hash_table_universal_rehash(hash64, ht->rw_hash->nb_bits);
-    parsec_key_handle_t handle = {.key = key, .hash64 = hash64, .hash = hash};
+    parsec_key_handle_t handle = {.key = key, .hash64 = hash64};
+    handle.head = parsec_hash_table_find_home(ht, hash64, &handle.hash);
     parsec_hash_table_nolock_insert_handle(ht, &handle, item);
 }
 
@@ -296,154 +512,23 @@ void parsec_hash_table_nolock_insert_handle(parsec_hash_table_t *ht,
                                             const parsec_key_handle_t *handle,
                                             parsec_hash_table_item_t *item)
 {
-    uint64_t hash;
-    hash = handle->hash;
-    item->next_item = ht->rw_hash->buckets[hash].first_item;
     item->hash64 = handle->hash64;
-    ht->rw_hash->buckets[hash].first_item = item;
-    ht->rw_hash->buckets[hash].cur_len++;
+    parsec_hash_table_bucket_push(ht, &handle->head->buckets[handle->hash], item,
+                                  parsec_hash_table_mix(handle->hash64));
 #if defined(PARSEC_DEBUG_NOISIER)
     {
         char estr[64];
-        PARSEC_DEBUG_VERBOSE(20, parsec_debug_output, "Added item %p/%s into hash table %p in bucket %d",
-                             item, ht->key_functions.key_print(estr, 64, item->key, ht->hash_data), ht, hash);
+        PARSEC_DEBUG_VERBOSE(20, parsec_debug_output, "Added item %p/%s into hash table %p/%p in bucket %d",
+                             item, ht->key_functions.key_print(estr, 64, item->key, ht->hash_data), ht, handle->head, handle->hash);
     }
 #endif
 }
 
-
-static void *parsec_hash_table_nolock_remove_from_old_tables(parsec_hash_table_t *ht, parsec_key_t key)
-{
-    parsec_hash_table_head_t *head, *prev_head;
-    parsec_hash_table_item_t *current_item, *prev_item;
-    int32_t res;
-    uint64_t hash;
-    uint64_t hash64 = ht->key_functions.key_hash(key, ht->hash_data);
-#if defined(HELPFIRST)
-    uint64_t hash_main_bucket = parsec_hash_table_universal_rehash(hash64, ht->rw_hash->nb_bits);
-#endif
-    prev_head = ht->rw_hash;
-    for(head = ht->rw_hash->next; NULL != head; head = head->next) {
-        hash = parsec_hash_table_universal_rehash(ht->key_functions.key_hash(key, ht->hash_data), head->nb_bits);
-        prev_item = NULL;
-        parsec_atomic_lock(&head->buckets[hash].lock );
-        current_item = head->buckets[hash].first_item;
-        while( NULL != current_item ) {
-            if( OPTIMIZED_EQUAL_TEST(current_item, key, hash64, ht) ) {
-#if defined(PARSEC_DEBUG_NOISIER)
-                char estr[64];
-                PARSEC_DEBUG_VERBOSE(20, parsec_debug_output, "Removed item %p/%s from (old) hash table %p/%p in bucket %d",
-                                     BASEADDROF(current_item, ht), ht->key_functions.key_print(estr, 64, key, ht->hash_data), ht, head, hash);
-#endif
-                if( NULL == prev_item ) {
-                    head->buckets[hash].first_item = current_item->next_item;
-                } else {
-                    prev_item->next_item = current_item->next_item;
-                }
-                res = --(head->buckets[hash].cur_len);
-                if( 0 == res ) {
-                    res = parsec_atomic_fetch_dec_int32(&head->used_buckets);
-                    if( 1 == res ) {
-                        parsec_atomic_cas_ptr(&prev_head->next, head, head->next);
-                    }
-                }
-                parsec_atomic_unlock(&head->buckets[hash].lock );
-                return BASEADDROF(current_item, ht);
-            }
-#if defined(HELPFIRST)
-            if( ht->key_functions.key_hash(current_item->key, ht->rw_hash->nb_bits, ht->hash_data) == hash_main_bucket ) {
-                /* It's not the target item, but it's an item that goes in the
-                 * same bucket as the target item, so we already have the lock
-                 * on that bucket in the main table: insert it there costs not
-                 * much and would help getting rid of old tables */
-                 if( NULL == prev_item ) {
-                     head->buckets[hash].first_item = current_item->next_item;
-                 } else {
-                     prev_item->next_item = current_item->next_item;
-                 }
-                 res = --(head->buckets[hash].cur_len);
-                 if( 0 == res ) {
-                     res = parsec_atomic_fetch_dec_int32(&head->used_buckets);
-                     if( 1 == res ) {
-                         parsec_atomic_cas_ptr(&prev_head->next, head, head->next);
-                     }
-                 }
-                 parsec_hash_table_nolock_insert(ht, current_item);
-                 if( NULL == prev_item )
-                     current_item = head->buckets[hash].first_item;
-                 else
-                     current_item = prev_item->next_item;
-            } else
-#endif
-            {
-                prev_item = current_item;
-                current_item = prev_item->next_item;
-            }
-        }
-        parsec_atomic_unlock(&head->buckets[hash].lock );
-        prev_head = head;
-    }
-    return NULL;
-}
-
-#if !defined(HELPFIRST)
-static void *parsec_hash_table_nolock_find_in_old_tables(parsec_hash_table_t *ht, parsec_key_t key)
-{
-    parsec_hash_table_head_t *head, *prev_head = ht->rw_hash;
-    parsec_hash_table_item_t *current_item, *prev_item = NULL;
-    int res = 0;
-    uint64_t hash, hash64 = ht->key_functions.key_hash(key, ht->hash_data);
-    for(head = ht->rw_hash->next; NULL != head; head = head->next) {
-        prev_item = NULL;
-        hash = parsec_hash_table_universal_rehash(hash64, head->nb_bits);
-        // We need the lock on the old tables, as some other thread might
-        // be removing elements in this bucket, through remove_from_old_tables
-        // and that thread relies on the low-level table locks
-        parsec_atomic_lock( &head->buckets[hash].lock );
-        for(current_item = head->buckets[hash].first_item;
-            NULL != current_item;
-            current_item = current_item->next_item) {
-            if( OPTIMIZED_EQUAL_TEST(current_item, key, hash64, ht) ) {
-#if defined(PARSEC_DEBUG_NOISIER)
-                char estr[64];
-                PARSEC_DEBUG_VERBOSE(20, parsec_debug_output, "Found item %p/%s into (old) hash table %p/%p in bucket %d",
-                                     BASEADDROF(current_item, ht), ht->key_functions.key_print(estr, 64, key, ht->hash_data), ht, head, hash);
-#endif
-                // We already have the lock on the toplevel table bucket,
-                // and we have the lock on the low-level table bucket... So
-                // use the opportunity to move the element in the toplevel
-                if(NULL == prev_item) {
-                    head->buckets[hash].first_item = current_item->next_item;
-                } else {
-                    prev_item->next_item = current_item->next_item;
-                }
-                current_item->next_item = NULL;
-                res = --(head->buckets[hash].cur_len);
-                if( 0 == res ) {
-                    res = parsec_atomic_fetch_dec_int32(&head->used_buckets);
-                    if( 1 == res ) {
-                        parsec_atomic_cas_ptr(&prev_head->next, head, head->next);
-                    }
-                }
-                parsec_hash_table_nolock_insert(ht, current_item);
-                parsec_atomic_unlock( &head->buckets[hash].lock );
-                return BASEADDROF(current_item, ht);
-            }
-            prev_item = current_item;
-        }
-        parsec_atomic_unlock( &head->buckets[hash].lock );
-        prev_head = head;
-    }
-    return NULL;
-}
-#endif
-
 void *parsec_hash_table_nolock_find(parsec_hash_table_t *ht, parsec_key_t key)
 {
-    uint64_t hash;
     uint64_t hash64 = ht->key_functions.key_hash(key, ht->hash_data);
-    hash = parsec_hash_table_universal_rehash(hash64, ht->rw_hash->nb_bits);
-    parsec_key_handle_t handle = {.key = key, .hash64 = hash64, .hash = hash};
+    parsec_key_handle_t handle = {.key = key, .hash64 = hash64};
+    handle.head = parsec_hash_table_find_home(ht, hash64, &handle.hash);
     return parsec_hash_table_nolock_find_handle(ht, &handle);
 }
 
@@ -451,41 +536,41 @@ void *parsec_hash_table_nolock_find(parsec_hash_table_t *ht, parsec_key_t key)
 void *parsec_hash_table_nolock_find_handle(parsec_hash_table_t *ht,
                                            const parsec_key_handle_t* handle)
 {
+    parsec_hash_table_bucket_t *bucket = &handle->head->buckets[handle->hash];
     parsec_hash_table_item_t *current_item;
-    uint64_t hash;
-    void *item;
     uint64_t hash64 = handle->hash64;
-    hash = handle->hash;
-    for(current_item = ht->rw_hash->buckets[hash].first_item;
+    uint32_t candidates;
+    /* The bucket identified by the handle holds all the items of that key,
+     * whether it belongs to the table being migrated or to the current one */
+    candidates = parsec_hash_table_match_tags(bucket->tags, PARSEC_HASH_TABLE_TAG(parsec_hash_table_mix(hash64)));
+    for( int s = 0; 0 != candidates && s < PARSEC_HASH_TABLE_BUCKET_SLOTS; s++ ) {
+        if( !PARSEC_HASH_TABLE_SLOT_MATCHES(candidates, s) ) continue;
+        current_item = bucket->slots[s];
+        assert(NULL != current_item);
+        if( OPTIMIZED_EQUAL_TEST(current_item, handle->key, hash64, ht) )
+            return BASEADDROF(current_item, ht);
+    }
+    for(current_item = bucket->first_item;
         NULL != current_item;
         current_item = current_item->next_item) {
         if( OPTIMIZED_EQUAL_TEST(current_item, handle->key, hash64, ht) ) {
 #if defined(PARSEC_DEBUG_NOISIER)
             char estr[64];
-            PARSEC_DEBUG_VERBOSE(20, parsec_debug_output, "Found item %p/%s into hash table %p in bucket %d",
+            PARSEC_DEBUG_VERBOSE(20, parsec_debug_output, "Found item %p/%s into hash table %p/%p in bucket %d",
                                  BASEADDROF(current_item, ht),
-                                 ht->key_functions.key_print(estr, 64, handle->key, ht->hash_data), ht, hash);
+                                 ht->key_functions.key_print(estr, 64, handle->key, ht->hash_data), ht, handle->head, handle->hash);
 #endif
             return BASEADDROF(current_item, ht);
         }
     }
-#if defined(HELPFIRST)
-    item = parsec_hash_table_nolock_remove_from_old_tables(ht, key);
-    if( NULL != item ) {
-        current_item = ITEMADDROF(item, ht);
-        parsec_hash_table_nolock_insert(ht, current_item);
-    }
-#else
-    item = parsec_hash_table_nolock_find_in_old_tables(ht, handle->key);
-#endif
-    return item;
+    return NULL;
 }
 
 void *parsec_hash_table_nolock_remove(parsec_hash_table_t *ht, parsec_key_t key)
 {
     uint64_t hash64 = ht->key_functions.key_hash(key, ht->hash_data);
-    uint64_t hash = parsec_hash_table_universal_rehash(hash64, ht->rw_hash->nb_bits);
-    parsec_key_handle_t handle = {.key = key, .hash64 = hash64, .hash = hash};
+    parsec_key_handle_t handle = {.key = key, .hash64 = hash64};
+    handle.head = parsec_hash_table_find_home(ht, hash64, &handle.hash);
     return parsec_hash_table_nolock_remove_handle(ht, &handle);
 }
 
@@ -493,96 +578,75 @@ void *parsec_hash_table_nolock_remove(parsec_hash_table_t *ht, parsec_key_t key)
 void *parsec_hash_table_nolock_remove_handle(parsec_hash_table_t *ht,
                                              const parsec_key_handle_t* handle)
 {
+    parsec_hash_table_bucket_t *bucket = &handle->head->buckets[handle->hash];
     parsec_hash_table_item_t *current_item, *prev_item;
     uint64_t hash64 = handle->hash64;
-    uint64_t hash = handle->hash;
+    uint32_t candidates;
+
+    candidates = parsec_hash_table_match_tags(bucket->tags, PARSEC_HASH_TABLE_TAG(parsec_hash_table_mix(hash64)));
+    for( int s = 0; 0 != candidates && s < PARSEC_HASH_TABLE_BUCKET_SLOTS; s++ ) {
+        if( !PARSEC_HASH_TABLE_SLOT_MATCHES(candidates, s) ) continue;
+        current_item = bucket->slots[s];
+        assert(NULL != current_item);
+        if( OPTIMIZED_EQUAL_TEST(current_item, handle->key, hash64, ht) ) {
+            /* The slot is not refilled from the chain, so iterations that
+             * remove the current item do not miss any item */
+            bucket->slots[s] = NULL;
+            bucket->tags &= ~(0xffU << (8 * s));
+            --(bucket->cur_len);
+            return BASEADDROF(current_item, ht);
+        }
+    }
     prev_item = NULL;
-    for(current_item = ht->rw_hash->buckets[hash].first_item;
+    for(current_item = bucket->first_item;
         NULL != current_item;
         current_item = prev_item->next_item) {
         if( OPTIMIZED_EQUAL_TEST(current_item, handle->key, hash64, ht) ) {
             if( NULL == prev_item ) {
-                ht->rw_hash->buckets[hash].first_item = current_item->next_item;
+                bucket->first_item = current_item->next_item;
             } else {
                 prev_item->next_item = current_item->next_item;
             }
-            --(ht->rw_hash->buckets[hash].cur_len);
+            --(bucket->cur_len);
 #if defined(PARSEC_DEBUG_NOISIER)
             char estr[64];
-            PARSEC_DEBUG_VERBOSE(20, parsec_debug_output, "Removed item %p/%s from hash table %p in bucket %d",
+            PARSEC_DEBUG_VERBOSE(20, parsec_debug_output, "Removed item %p/%s from hash table %p/%p in bucket %d",
                                  BASEADDROF(current_item, ht),
-                                 ht->key_functions.key_print(estr, 64, handle->key, ht->hash_data), ht, hash);
+                                 ht->key_functions.key_print(estr, 64, handle->key, ht->hash_data), ht, handle->head, handle->hash);
 #endif
             return BASEADDROF(current_item, ht);
         }
         prev_item = current_item;
     }
-    return parsec_hash_table_nolock_remove_from_old_tables(ht, handle->key);
+    return NULL;
 }
 
 
 void parsec_hash_table_insert_impl(parsec_hash_table_t *ht, parsec_hash_table_item_t *item, const char *file, int line)
 {
-    uint64_t hash;
-    parsec_hash_table_head_t *cur_head;
-    int resize = 0;
-    parsec_atomic_rwlock_rdlock(&ht->rw_lock);
-    cur_head = ht->rw_hash;
-    hash = parsec_hash_table_universal_rehash(ht->key_functions.key_hash(item->key, ht->hash_data), ht->rw_hash->nb_bits);
-    assert( hash < (1ULL<<ht->rw_hash->nb_bits) );
-    parsec_atomic_lock(&ht->rw_hash->buckets[hash].lock);
-    parsec_hash_table_nolock_insert(ht, item);
-    if( ht->rw_hash->buckets[hash].cur_len > ht->max_collisions_hint ) {
-        if( (int)ht->rw_hash->nb_bits + 1 < ht->max_table_nb_bits )
-            resize = 1;
-        else {
-            if( !ht->warning_issued ) {
-                parsec_warning("%s:%d -- Hash table has %d collisions in bucket %lu, but it already spans over %lu buckets. Performance might get very bad if more elements continue to stack in this bucket. Consider allowing larger resize with the MCA parameter parsec_hash_table_max_table_nb_bits",
-                               file, line, ht->rw_hash->buckets[hash].cur_len, hash, (1UL<<ht->rw_hash->nb_bits));
-                ht->warning_issued = 1;
-            }
-        }
-    }
-    parsec_atomic_unlock(&ht->rw_hash->buckets[hash].lock);
-    parsec_atomic_rwlock_rdunlock(&ht->rw_lock);
-
-    if( resize ) {
-        parsec_atomic_rwlock_wrlock(&ht->rw_lock);
-        if( cur_head == ht->rw_hash ) {
-            /* Barring ABA problems, nobody resized the hash table;
-             * Good enough hint that it's our role to do so */
-            parsec_hash_table_resize(ht);
-        }
-        /* Otherwise, let's asssume somebody resized already */
-        parsec_atomic_rwlock_wrunlock(&ht->rw_lock);
-    }
+    parsec_key_handle_t handle;
+    parsec_hash_table_lock_bucket_handle(ht, item->key, &handle);
+    parsec_hash_table_nolock_insert_handle(ht, &handle, item);
+    parsec_hash_table_unlock_bucket_handle_impl(ht, &handle, file, line);
 }
 
 void *parsec_hash_table_find(parsec_hash_table_t *ht, parsec_key_t key)
 {
-    uint64_t hash;
+    parsec_key_handle_t handle;
     void *ret;
-    parsec_atomic_rwlock_rdlock(&ht->rw_lock);
-    hash = parsec_hash_table_universal_rehash(ht->key_functions.key_hash(key, ht->hash_data), ht->rw_hash->nb_bits);
-    assert( hash < (1ULL<<ht->rw_hash->nb_bits) );
-    parsec_atomic_lock(&ht->rw_hash->buckets[hash].lock);
-    ret = parsec_hash_table_nolock_find(ht, key);
-    parsec_atomic_unlock(&ht->rw_hash->buckets[hash].lock);
-    parsec_atomic_rwlock_rdunlock(&ht->rw_lock);
+    parsec_hash_table_lock_bucket_handle(ht, key, &handle);
+    ret = parsec_hash_table_nolock_find_handle(ht, &handle);
+    parsec_hash_table_unlock_bucket_handle_impl(ht, &handle, __FILE__, __LINE__);
     return ret;
 }
 
 void *parsec_hash_table_remove(parsec_hash_table_t *ht, parsec_key_t key)
 {
-    uint64_t hash;
+    parsec_key_handle_t handle;
     void *ret;
-    parsec_atomic_rwlock_rdlock(&ht->rw_lock);
-    hash = parsec_hash_table_universal_rehash(ht->key_functions.key_hash(key, ht->hash_data), ht->rw_hash->nb_bits);
-    assert( hash < (1ULL<<ht->rw_hash->nb_bits) );
-    parsec_atomic_lock(&ht->rw_hash->buckets[hash].lock);
-    ret = parsec_hash_table_nolock_remove(ht, key);
-    parsec_atomic_unlock(&ht->rw_hash->buckets[hash].lock);
-    parsec_atomic_rwlock_rdunlock(&ht->rw_lock);
+    parsec_hash_table_lock_bucket_handle(ht, key, &handle);
+    ret = parsec_hash_table_nolock_remove_handle(ht, &handle);
+    parsec_hash_table_unlock_bucket_handle_impl(ht, &handle, __FILE__, __LINE__);
     return ret;
 }
 
@@ -603,6 +667,10 @@ void parsec_hash_table_stat(parsec_hash_table_t *ht)
         M2 = 0.0;
         for(i = 0; i < (1ULL<<head->nb_bits); i++) {
             nb = 0;
+            for(int s = 0; s < PARSEC_HASH_TABLE_BUCKET_SLOTS; s++) {
+                if( NULL != head->buckets[i].slots[s] )
+                    nb++;
+            }
             for(current_item = head->buckets[i].first_item;
                 current_item != NULL;
                 current_item = current_item->next_item) {
@@ -620,8 +688,9 @@ void parsec_hash_table_stat(parsec_hash_table_t *ht)
             if( max == -1 || nb > max )
                 max = nb;
         }
-        printf("table %p level %d: %d lists, of length %d to %d average length: %g and variance %g\n",
-               ht, j, n, min, max, mean, M2/(n-1));
+        printf("table %p level %d: %d lists, of length %d to %d average length: %g and variance %g (%d resizes%s)\n",
+               ht, j, n, min, max, mean, M2/(n-1), ht->nb_resizes,
+               (0 == j && NULL != head->next) ? ", migration in progress" : "");
     }
 }
 
@@ -631,15 +700,21 @@ void parsec_hash_table_for_all(parsec_hash_table_t* ht, parsec_hash_elem_fct_t f
     parsec_hash_table_item_t *current_item;
     void* user_item;
 
-    for( head = ht->rw_hash; NULL != head; head = head->next ) {
-        for( size_t i = 0; i < (1ULL<<head->nb_bits); i++ ) {
-            current_item = head->buckets[i].first_item;
-            /* Iterating the list to check if we have the element */
-            while( NULL != current_item ) {
-                user_item = parsec_hash_table_item_lookup(ht, current_item);
-                current_item = current_item->next_item;
-                fct( user_item, cb_data );
-            }
+    /* Otherwise, helpers could move items that were already visited to
+     * buckets that are not visited yet */
+    parsec_hash_table_migrate_all(ht);
+    head = ht->rw_hash;
+    for( size_t i = 0; i < (1ULL<<head->nb_bits); i++ ) {
+        for( int s = 0; s < PARSEC_HASH_TABLE_BUCKET_SLOTS; s++ ) {
+            if( NULL == (current_item = head->buckets[i].slots[s]) ) continue;
+            fct( parsec_hash_table_item_lookup(ht, current_item), cb_data );
+        }
+        current_item = head->buckets[i].first_item;
+        /* Iterating the list to check if we have the element */
+        while( NULL != current_item ) {
+            user_item = parsec_hash_table_item_lookup(ht, current_item);
+            current_item = current_item->next_item;
+            fct( user_item, cb_data );
         }
     }
 }
@@ -65,8 +65,11 @@ typedef struct parsec_key_fn_s {
 struct parsec_key_handle_s {
     uint64_t                  hash64;           /**< Is a 64-bits hash of the key */
     uint64_t                  hash;             /**< Is a 64-bits hash of the key,
-                                                     trimmed to the current size of the table */
+                                                     trimmed to the size of the table holding the bucket */
     parsec_key_t              key;              /**< Items are identified with this key */
+    struct parsec_hash_table_head_s *head;      /**< The table holding the locked bucket: this is
+                                                     the table being migrated as long as the bucket
+                                                     of the key has not been moved to the new table */
 };
 
 typedef struct parsec_key_handle_s parsec_key_handle_t;
@@ -77,13 +80,24 @@ typedef struct parsec_hash_table_bucket_s parsec_hash_table_bucket_t;/**< Bucket
 
 
 /**
- * @brief
+ * @brief A table of buckets.
+ *
+ * @details
+ *   When a table is resized, a table with twice as many buckets is
+ *   published, and the buckets of the smaller table are migrated
+ *   incrementally, one at a time, by the threads that access the hash
+ *   table. Bucket i of the smaller table splits into the buckets i and
+ *   i + (1<<nb_bits) of the bigger table, so a key is always either in
+ *   its bucket of the smaller table (if that bucket has not been migrated
+ *   yet), or in its bucket of the bigger table. There is at most one
+ *   migration in progress, and only two tables are ever searched.
  */
 typedef struct parsec_hash_table_head_s {
-    struct parsec_hash_table_head_s *next;                 /**< Table of smaller size that is not empty */
+    struct parsec_hash_table_head_s * volatile next;       /**< Table of smaller size being migrated into this one, if any */
     struct parsec_hash_table_head_s *next_to_free;         /**< Table of smaller size, chained in allocation order */
     uint32_t                         nb_bits;              /**< This hash table has 1<<nb_bits buckets */
-    int32_t                          used_buckets;         /**< Number of buckets still in use in this hash table */
+    volatile int32_t                 migrate_cursor;       /**< Next bucket to migrate when this table is the smaller one */
+    volatile int32_t                 nb_migrated;          /**< Number of buckets of this table already migrated */
     parsec_hash_table_bucket_t      *buckets;              /**< These are the buckets (that are lists of items) of this table */
 } parsec_hash_table_head_t;
 
@@ -92,9 +106,6 @@ typedef struct parsec_hash_table_head_s {
  */
 struct parsec_hash_table_s {
     parsec_object_t           super;                /**< A Hash Table is a PaRSEC object */
-    parsec_atomic_rwlock_t    rw_lock;              /**< 'readers' are threads that manipulate rw_hash (add, delete, find)
-                                                     *   but do not resize it; 'writers' are threads that resize
-                                                     *   rw_hash */
     int64_t                   elt_hashitem_offset;  /**< Elements belonging to this hash table have a parsec_hash_table_item_t
                                                      *   at this offset */
     parsec_key_fn_t           key_functions;        /**< How to acccess and modify the keys */
@@ -104,7 +115,11 @@ struct parsec_hash_table_s {
                                                      *   is reached, a warning is issued (once), and elements just get stacked
                                                      *   in the same buckets. */
     int                       warning_issued;       /**< Number of times the warning mentionned above has been issued */
-    parsec_hash_table_head_t *rw_hash;              /**< Added elements go in this hash table */
+    int32_t                   nb_resizes;           /**< Number of times this hash table has been resized */
+    int                       use_slots;            /**< Whether the first items of a bucket are stored in the bucket
+                                                     *   with a fingerprint of their hash (see parsec_hash_table_slots) */
+    parsec_hash_table_head_t * volatile rw_hash;    /**< Added elements go in this hash table, once
+                                                     *   their bucket of rw_hash->next has been migrated */
 };
 PARSEC_DECLSPEC PARSEC_OBJ_CLASS_DECLARATION(parsec_hash_table_t);
 
@@ -149,7 +164,8 @@ void parsec_hash_table_init(parsec_hash_table_t *ht, int64_t offset, int nb_bits
  *
  * @details Waits until the bucket corresponding to the key can be locked
  *  and locks it preventing other threads to update this bucket.
- *  The table cannot be resized as long as any bucket is locked.
+ *  The table can be resized while buckets are locked, but a locked bucket
+ *  is never migrated to the resized table before it is unlocked.
  *  @arg[inout] ht  the parsec_hash_table
  *  @arg[in]    key the key for which to lock the bucket
  */
@@ -161,7 +177,8 @@ void parsec_hash_table_lock_bucket(parsec_hash_table_t *ht, parsec_key_t key );
  *
  * @details Waits until the bucket corresponding to the key can be locked
  *  and locks it preventing other threads to update this bucket.
- *  The table cannot be resized as long as any bucket is locked.
+ *  The table can be resized while buckets are locked, but a locked bucket
+ *  is never migrated to the resized table before it is unlocked.
  *  @arg[inout] ht  the parsec_hash_table
  *  @arg[in]    key the key for which to lock the bucket
  *  @arg[out]   handle the handle identifying the locked bucket
@@ -173,8 +190,9 @@ void parsec_hash_table_lock_bucket_handle(parsec_hash_table_t *ht, parsec_key_t
  * @brief unlocks the bucket corresponding to this key.
  *
  * @details allow other threads to update this bucket.
- *  This operation might block and resize the table, if non-locking
- *  insertions during the critical section added too many elements.
+ *  This operation might resize the table, if non-locking insertions
+ *  during the critical section added too many elements, or migrate
+ *  the bucket if the table is being resized. It never blocks.
  *  Use it through the parsec_hash_table_unlock_bucket macro
  *  @arg[inout] ht  the parsec_hash_table
  *  @arg[in]    key the key for which to unlock the bucket
@@ -188,8 +206,9 @@ void parsec_hash_table_unlock_bucket_impl(parsec_hash_table_t *ht, parsec_key_t
  * @brief unlocks the bucket identified by the handle.
  *
  * @details allow other threads to update this bucket.
- *  This operation might block and resize the table, if non-locking
- *  insertions during the critical section added too many elements.
+ *  This operation might resize the table, if non-locking insertions
+ *  during the critical section added too many elements, or migrate
+ *  the bucket if the table is being resized. It never blocks.
  *  Use it through the parsec_hash_table_unlock_bucket_handle macro.
  *  The handle becomes invalid after this call.
  *  @arg[inout] ht  the parsec_hash_table
@@ -302,8 +321,9 @@ void *parsec_hash_table_nolock_remove_handle(parsec_hash_table_t *ht,
  * @details
  *  Inserts an element in the hash, assuming it is not already in the hash
  *  table. This function is thread-safe but assumes that the element does
- *  not belong to the table. This might lock the table to redimension it,
- *  if a bucket holds more than parsec_hash_table_max_collisions MCA parameter
+ *  not belong to the table. This might redimension the table, if a bucket
+ *  holds more than parsec_hash_table_max_collisions MCA parameter: the
+ *  buckets are then migrated incrementally by the threads accessing the table
  *  Use this through the parsec_hash_table_insert macro.
  *  @arg[inout] ht the hash table
  *  @arg[inout] item the pointer to the structure with a parsec_hash_table_item_t
@@ -371,7 +391,8 @@ typedef void (*parsec_hash_elem_fct_t)(void *item, void*cb_data);
  *
  * @details This function is safe for items removal. In order to allow
  *         items removal, this function does not protect the hash
- *         table, and it is therefore not thread safe.
+ *         table, and it is therefore not thread safe. A migration in
+ *         progress is completed before iterating over the items.
  *
  *  @arg[in] ht    the hash table
  *  @arg[in] fct   function to apply to all items in the hash table
@@ -27,7 +27,9 @@
 #include <stdio.h>
 
 #include "parsec/sys/atomic.h"
+#include "parsec/sys/tls.h"
 #include "parsec/class/parsec_object.h"
+#include <pthread.h>
 
 /*
  * Instantiation of class descriptor for the base class.  This is
@@ -43,7 +45,8 @@ parsec_class_t parsec_object_t_class = {
     0,                    /* class hierarchy depth */
     NULL,                 /* array of constructors */
     NULL,                 /* array of destructors */
-    sizeof(parsec_object_t) /* size of the opal object */
+    sizeof(parsec_object_t), /* size of the opal object */
+    0                     /* biased reference counting */
 };
 
 /*
@@ -69,9 +72,209 @@ static void expand_array(void);
  */
 int parsec_obj_update_not_inline(parsec_object_t *object, int inc)
 {
+    if( 0 != object->obj_biased ) {
+        return parsec_obj_biased_update(object, inc);
+    }
     return parsec_atomic_fetch_add_int32(&(object->obj_reference_count), inc ) + inc;
 }
 
+/*
+ * Biased reference counting.
+ *
+ * obj_biased holds PARSEC_OBJ_BIASED, the identifier of the owner thread
+ * and the count of the owner. Only the owner updates the count, the other
+ * threads only read the owner, that is cleared when the counts are merged.
+ *
+ * obj_reference_count holds the shared count, in units of
+ * PARSEC_OBJ_SHARED_ONE, and two flags: MERGED once the count of the owner
+ * has been added to the shared count (all the threads then update the
+ * shared count), and QUEUED once a thread other than the owner made the
+ * shared count negative and queued the object to its owner. The shared
+ * count is decremented and QUEUED set in the same atomic operation, and
+ * the owner does not merge a queued object before flushing its queue, so
+ * the object cannot be freed before it has been queued.
+ */
+#define PARSEC_OBJ_BIASED              0x80000000U
+#define PARSEC_OBJ_BIASED_OWNER_SHIFT  20
+#define PARSEC_OBJ_BIASED_MAX_THREADS  2047
+#if !defined(PARSEC_OBJ_BIASED_COUNT_MASK)
+#define PARSEC_OBJ_BIASED_COUNT_MASK   ((1U << PARSEC_OBJ_BIASED_OWNER_SHIFT) - 1)
+#endif
+#define PARSEC_OBJ_BIASED_OWNER(b)     (((b) & ~PARSEC_OBJ_BIASED) >> PARSEC_OBJ_BIASED_OWNER_SHIFT)
+#define PARSEC_OBJ_BIASED_COUNT(b)     ((b) & PARSEC_OBJ_BIASED_COUNT_MASK)
+
+#define PARSEC_OBJ_SHARED_MERGED       0x1
+#define PARSEC_OBJ_SHARED_QUEUED       0x2
+#define PARSEC_OBJ_SHARED_ONE          0x4
+#define PARSEC_OBJ_SHARED_COUNT(s)     ((s) >> 2)  /* Rounds down with the flags */
+
+typedef struct parsec_obj_thread_s {
+    uint32_t                   id;
+    parsec_atomic_lock_t       lock;        /**< Protects the queue */
+    volatile int32_t           nb_pending;
+    int32_t                    size;
+    parsec_object_t          **pending;     /**< Objects queued by the other threads */
+} parsec_obj_thread_t;
+
+static parsec_obj_thread_t * volatile parsec_obj_threads[PARSEC_OBJ_BIASED_MAX_THREADS + 1];
+static volatile int32_t parsec_obj_nb_threads = 0;
+static PARSEC_TLS_DECLARE(parsec_obj_tls_thread);
+#if defined(PARSEC_HAVE_THREAD_LOCAL)
+PARSEC_TLS_DECLARE(parsec_obj_biased_self) = NULL;
+#endif  /* defined(PARSEC_HAVE_THREAD_LOCAL) */
+#if !defined(PARSEC_HAVE_THREAD_LOCAL)
+static pthread_once_t parsec_obj_tls_once = PTHREAD_ONCE_INIT;
+static void parsec_obj_tls_init(void)
+{
+    PARSEC_TLS_KEY_CREATE(parsec_obj_tls_thread);
+}
+#endif  /* !defined(PARSEC_HAVE_THREAD_LOCAL) */
+
+/* Returns the descriptor of the calling thread, or NULL if there are
+ * too many threads to give it an identifier */
+static inline parsec_obj_thread_t *parsec_obj_thread(int create)
+{
+    parsec_obj_thread_t *me;
+    int32_t id;
+
+#if !defined(PARSEC_HAVE_THREAD_LOCAL)
+    pthread_once(&parsec_obj_tls_once, parsec_obj_tls_init);
+#endif  /* !defined(PARSEC_HAVE_THREAD_LOCAL) */
+    me = (parsec_obj_thread_t*)PARSEC_TLS_GET_SPECIFIC(parsec_obj_tls_thread);
+    if( PARSEC_LIKELY(NULL != me) || !create )
+        return me;
+    /* Identifiers start at 1, 0 is the owner of merged objects */
+    id = 1 + parsec_atomic_fetch_inc_int32(&parsec_obj_nb_threads);
+    if( id > PARSEC_OBJ_BIASED_MAX_THREADS )
+        return NULL;
+    me = (parsec_obj_thread_t*)calloc(1, sizeof(parsec_obj_thread_t));
+    me->id = id;
+    parsec_atomic_lock_init(&me->lock);
+    parsec_obj_threads[id] = me;
+    PARSEC_TLS_SET_SPECIFIC(parsec_obj_tls_thread, me);
+#if defined(PARSEC_HAVE_THREAD_LOCAL)
+    PARSEC_TLS_SET_SPECIFIC(parsec_obj_biased_self,
+                            (void*)(uintptr_t)(PARSEC_OBJ_BIASED | ((uint32_t)id << PARSEC_OBJ_BIASED_OWNER_SHIFT)));
+#endif  /* defined(PARSEC_HAVE_THREAD_LOCAL) */
+    return me;
+}
+
+void parsec_obj_biased_construct(parsec_object_t *object)
+{
+    parsec_obj_thread_t *me = parsec_obj_thread(1);
+
+    if( NULL == me ) {
+        /* No owner: the object starts merged */
+        object->obj_reference_count = PARSEC_OBJ_SHARED_ONE | PARSEC_OBJ_SHARED_MERGED;
+        object->obj_biased = PARSEC_OBJ_BIASED;
+        return;
+    }
+    object->obj_reference_count = 0;
+    object->obj_biased = PARSEC_OBJ_BIASED | (me->id << PARSEC_OBJ_BIASED_OWNER_SHIFT) | 1;
+}
+
+static void parsec_obj_biased_enqueue(uint32_t owner, parsec_object_t *object)
+{
+    parsec_obj_thread_t *th = parsec_obj_threads[owner];
+
+    parsec_atomic_lock(&th->lock);
+    if( th->nb_pending == th->size ) {
+        th->size = (0 == th->size) ? 64 : 2 * th->size;
+        th->pending = (parsec_object_t**)realloc(th->pending, th->size * sizeof(parsec_object_t*));
+    }
+    th->pending[th->nb_pending] = object;
+    parsec_atomic_wmb();
+    th->nb_pending++;
+    parsec_atomic_unlock(&th->lock);
+}
+
+int parsec_obj_biased_update(parsec_object_t *object, int inc)
+{
+    parsec_obj_thread_t *me = parsec_obj_thread(0);
+    uint32_t biased = object->obj_biased, owner;
+    int32_t old, new;
+
+    owner = PARSEC_OBJ_BIASED_OWNER(biased);
+    /* The owner goes through the shared count when its own count would
+     * overflow, or when it releases a reference it got from another thread
+     * after its own count dropped to 0 */
+    if( (NULL != me) && (owner == me->id) &&
+        (((inc > 0) && (PARSEC_OBJ_BIASED_COUNT(biased) + inc <= PARSEC_OBJ_BIASED_COUNT_MASK)) ||
+         ((inc < 0) && (PARSEC_OBJ_BIASED_COUNT(biased) >= (uint32_t)-inc))) ) {
+        biased += inc;
+        assert(PARSEC_OBJ_BIASED_OWNER(biased) == me->id);
+        object->obj_biased = biased;
+        if( 0 != PARSEC_OBJ_BIASED_COUNT(biased) )
+            return 1;
+        /* The owner released its references: merge, unless the object waits
+         * in the queue, the merge then happens in parsec_obj_biased_flush */
+        do {
+            old = object->obj_reference_count;
+            if( old & PARSEC_OBJ_SHARED_QUEUED )
+                return 1;
+        } while( !parsec_atomic_cas_int32(&object->obj_reference_count, old, old | PARSEC_OBJ_SHARED_MERGED) );
+        object->obj_biased = PARSEC_OBJ_BIASED;
+        return PARSEC_OBJ_SHARED_COUNT(old);
+    }
+
+    old = object->obj_reference_count;
+    if( (old & PARSEC_OBJ_SHARED_MERGED) || (inc > 0) ) {
+        old = parsec_atomic_fetch_add_int32(&object->obj_reference_count, inc * PARSEC_OBJ_SHARED_ONE);
+        new = old + inc * PARSEC_OBJ_SHARED_ONE;
+        if( new & PARSEC_OBJ_SHARED_MERGED )
+            return PARSEC_OBJ_SHARED_COUNT(new);
+        /* The owner holds references */
+        return 1;
+    }
+    do {
+        old = object->obj_reference_count;
+        new = old + inc * PARSEC_OBJ_SHARED_ONE;
+        if( !(old & PARSEC_OBJ_SHARED_MERGED) && (PARSEC_OBJ_SHARED_COUNT(new) < 0) )
+            new |= PARSEC_OBJ_SHARED_QUEUED;
+    } while( !parsec_atomic_cas_int32(&object->obj_reference_count, old, new) );
+    if( new & PARSEC_OBJ_SHARED_MERGED )
+        return PARSEC_OBJ_SHARED_COUNT(new);
+    if( (new & PARSEC_OBJ_SHARED_QUEUED) && !(old & PARSEC_OBJ_SHARED_QUEUED) ) {
+        /* The owner was read before the object was queued, so it was not
+         * merged yet */
+        parsec_obj_biased_enqueue(owner, object);
+    }
+    return 1;
+}
+
+int parsec_obj_biased_flush(void)
+{
+    parsec_obj_thread_t *me = parsec_obj_thread(0);
+    parsec_object_t **pending, *object;
+    int32_t i, nb, old, count;
+
+    if( (NULL == me) || (0 == me->nb_pending) )
+        return 0;
+    parsec_atomic_lock(&me->lock);
+    pending = me->pending;
+    nb = me->nb_pending;
+    me->pending = NULL;
+    me->nb_pending = 0;
+    me->size = 0;
+    parsec_atomic_unlock(&me->lock);
+
+    for( i = 0; i < nb; i++ ) {
+        object = pending[i];
+        count = PARSEC_OBJ_BIASED_COUNT(object->obj_biased);
+        /* Merged first, then the owner is cleared, so the other threads
+         * cannot read a cleared owner on an object that is not merged */
+        old = parsec_atomic_fetch_add_int32(&object->obj_reference_count,
+                                            count * PARSEC_OBJ_SHARED_ONE + PARSEC_OBJ_SHARED_MERGED);
+        object->obj_biased = PARSEC_OBJ_BIASED;
+        if( 0 == PARSEC_OBJ_SHARED_COUNT(old) + count ) {
+            parsec_obj_run_destructors(object);
+            free(object);
+        }
+    }
+    free(pending);
+    return nb;
+}
+
 /*
  * Lazy initialization of class descriptor.
  */
@@ -112,6 +315,9 @@ void parsec_class_initialize(parsec_class_t *cls)
     cls_construct_array_count = 0;
     cls_destruct_array_count  = 0;
     for (c = cls; c; c = c->cls_parent) {
+        if( c->cls_biased ) {
+            cls->cls_biased = 1;
+        }
         if( NULL != c->cls_construct ) {
             cls_construct_array_count++;
         }
@@ -122,6 +122,24 @@
  * @code
  *   PARSEC_OBJ_DESTRUCT(&sally);
  * @endcode
+ *
+ * (d) Biased reference counting
+ *
+ * The reference count of an object is updated with an atomic operation
+ * by default. Objects that are mostly retained and released by the thread
+ * that constructed them can use a biased reference count instead, by
+ * declaring their class with PARSEC_OBJ_CLASS_INSTANCE_BIASED: the owner
+ * thread updates a private count without atomic operations, and the other
+ * threads update the shared count (obj_reference_count). When the shared
+ * count of an object becomes negative, the object is queued to its owner,
+ * which merges the two counts the next time it calls
+ * parsec_obj_biased_flush, and frees the object if no reference remains.
+ * The runtime calls parsec_obj_biased_flush from the idle loop of the
+ * execution streams. A thread that constructs biased objects outside of
+ * the runtime must call it itself, or the objects that it owns and that
+ * are released by other threads are never freed. The obj_reference_count
+ * of a biased object only holds the shared part of the count, it must
+ * not be read or updated directly.
  */
 
 BEGIN_C_DECLS
@@ -159,6 +177,8 @@ struct parsec_class_t {
     parsec_destruct_t *cls_destruct_array;
                                     /**< array of parent class destructors */
     size_t cls_sizeof;              /**< size of an object instance */
+    int cls_biased;                 /**< objects use biased reference counting,
+                                       inherited by the children classes */
 };
 
 /**
@@ -167,7 +187,7 @@ struct parsec_class_t {
  * @param BASE_CLASS   Name of the class to initialize
  */
 #if defined(PARSEC_DEBUG_PARANOID)
-#define PARSEC_OBJ_STATIC_INIT(BASE_CLASS) { PARSEC_OBJ_MAGIC_ID, PARSEC_OBJ_CLASS(BASE_CLASS), 1, __FILE__, __LINE__ }
+#define PARSEC_OBJ_STATIC_INIT(BASE_CLASS) { PARSEC_OBJ_MAGIC_ID, PARSEC_OBJ_CLASS(BASE_CLASS), 1, 0, __FILE__, __LINE__ }
 #else
 #define PARSEC_OBJ_STATIC_INIT(BASE_CLASS) { PARSEC_OBJ_CLASS(BASE_CLASS), 1 }
 #endif  /* defined(PARSEC_DEBUG_PARANOID) */
@@ -185,6 +205,8 @@ struct parsec_object_t {
 #endif  /* defined(PARSEC_DEBUG_PARANOID) */
     parsec_class_t *obj_class;            /**< class descriptor */
     volatile int32_t obj_reference_count;   /**< reference count */
+    uint32_t obj_biased;                    /**< owner and count of the owner, if the class
+                                               uses biased reference counting, 0 otherwise */
 #if defined(PARSEC_DEBUG_PARANOID)
     const char* cls_init_file_name;        /**< In debug mode store the file where the object get contructed */
     int   cls_init_lineno;           /**< In debug mode store the line number where the object get contructed */
@@ -220,7 +242,31 @@ struct parsec_object_t {
         (parsec_construct_t) CONSTRUCTOR,                                 \
         (parsec_destruct_t) DESTRUCTOR,                                   \
         0, 0, NULL, NULL,                                               \
-        sizeof(NAME)                                                    \
+        sizeof(NAME),                                                   \
+        0                                                               \
+    }
+
+
+/**
+ * Static initializer for the descriptor of a class that uses biased
+ * reference counting (see above).
+ *
+ * @param NAME          Name of class
+ * @param PARENT        Name of parent class
+ * @param CONSTRUCTOR   Pointer to constructor
+ * @param DESTRUCTOR    Pointer to destructor
+ *
+ * Put this in NAME.c
+ */
+#define PARSEC_OBJ_CLASS_INSTANCE_BIASED(NAME, PARENT, CONSTRUCTOR, DESTRUCTOR) \
+    parsec_class_t NAME ## _class = {                                     \
+        # NAME,                                                         \
+        PARSEC_OBJ_CLASS(PARENT),                                              \
+        (parsec_construct_t) CONSTRUCTOR,                                 \
+        (parsec_destruct_t) DESTRUCTOR,                                   \
+        0, 0, NULL, NULL,                                               \
+        sizeof(NAME),                                                   \
+        1                                                               \
     }
 
 
@@ -270,7 +316,8 @@ static inline parsec_object_t *parsec_obj_new_debug(parsec_class_t* type, const
         assert(NULL != ((parsec_object_t *) (object))->obj_class);        \
         assert(PARSEC_OBJ_MAGIC_ID == ((parsec_object_t *) (object))->obj_magic_id); \
         parsec_obj_update((parsec_object_t *) (object), 1);                 \
-        assert(((parsec_object_t *) (object))->obj_reference_count >= 0); \
+        assert((0 != ((parsec_object_t *) (object))->obj_biased) ||       \
+               (((parsec_object_t *) (object))->obj_reference_count >= 0)); \
     } while (0)
 #else
 #define PARSEC_OBJ_RETAIN(object)  parsec_obj_update((parsec_object_t *) (object), 1);
@@ -350,6 +397,10 @@ do {                                                            \
     }                                                           \
     ((parsec_object_t *) (object))->obj_class = (type);          \
     ((parsec_object_t *) (object))->obj_reference_count = 1;     \
+    ((parsec_object_t *) (object))->obj_biased = 0;              \
+    if( (type)->cls_biased ) {                                  \
+        parsec_obj_biased_construct((parsec_object_t *) (object)); \
+    }                                                           \
     parsec_obj_run_constructors((parsec_object_t *) (object));    \
     PARSEC_OBJ_REMEMBER_FILE_AND_LINENO( object, __FILE__, __LINE__ ); \
 } while (0)
@@ -401,6 +452,40 @@ PARSEC_DECLSPEC void parsec_class_initialize(parsec_class_t *cls);
  */
 PARSEC_DECLSPEC void parsec_class_finalize(void);
 
+/**
+ * Make the calling thread the owner of an object of a class that uses
+ * biased reference counting, with a reference count of 1.
+ *
+ * Do not use this function directly: it is called by PARSEC_OBJ_NEW()
+ * and PARSEC_OBJ_CONSTRUCT().
+ *
+ * @param object          Pointer to the object.
+ */
+PARSEC_DECLSPEC void parsec_obj_biased_construct(parsec_object_t *object);
+
+/**
+ * Update the reference count of an object that uses biased reference
+ * counting.
+ *
+ * Do not use this function directly: it is called via the macros
+ * PARSEC_OBJ_RETAIN and PARSEC_OBJ_RELEASE
+ *
+ * @param object        Pointer to the object
+ * @param inc           Increment by which to update reference count
+ * @return              0 if the object must be destructed by the caller,
+ *                      a positive value otherwise
+ */
+PARSEC_DECLSPEC int parsec_obj_biased_update(parsec_object_t *object, int inc);
+
+/**
+ * Merge the reference counts of the objects owned by the calling thread
+ * that were queued by other threads, and free those that have no
+ * reference left.
+ *
+ * @return              Number of objects merged
+ */
+PARSEC_DECLSPEC int parsec_obj_biased_flush(void);
+
 /**
  * Run the hierarchy of class constructors for this object, in a
  * parent-first order.
@@ -470,6 +555,10 @@ static inline parsec_object_t *parsec_obj_new(parsec_class_t * cls)
     if (NULL != object) {
         object->obj_class = cls;
         object->obj_reference_count = 1;
+        object->obj_biased = 0;
+        if( cls->cls_biased ) {
+            parsec_obj_biased_construct(object);
+        }
         parsec_obj_run_constructors(object);
     }
     return object;
@@ -477,6 +566,13 @@ static inline parsec_object_t *parsec_obj_new(parsec_class_t * cls)
 
 #if defined(BUILDING_PARSEC)
 #include "parsec/sys/atomic.h"
+#include "parsec/sys/tls.h"
+
+#if defined(PARSEC_HAVE_THREAD_LOCAL)
+/* obj_biased of the objects owned by the calling thread, without the count */
+extern PARSEC_TLS_DECLARE(parsec_obj_biased_self);
+#define PARSEC_OBJ_BIASED_COUNT_MASK   0xfffffU
+#endif  /* defined(PARSEC_HAVE_THREAD_LOCAL) */
 
 /**
  * Atomically update the object's reference count by some increment.
@@ -486,11 +582,26 @@ static inline parsec_object_t *parsec_obj_new(parsec_class_t * cls)
  *
  * @param object        Pointer to the object
  * @param inc           Increment by which to update reference count
- * @return              New value of the reference count
+ * @return              New value of the reference count, or for objects
+ *                      that use biased reference counting 0 if the object
+ *                      must be destructed and a positive value otherwise
  */
 static inline int parsec_obj_update(parsec_object_t *object, int inc) __parsec_attribute_always_inline__;
 static inline int parsec_obj_update(parsec_object_t *object, int inc)
 {
+    if( PARSEC_UNLIKELY(0 != object->obj_biased) ) {
+#if defined(PARSEC_HAVE_THREAD_LOCAL)
+        uint32_t self = (uint32_t)(uintptr_t)PARSEC_TLS_GET_SPECIFIC(parsec_obj_biased_self);
+        uint32_t biased = object->obj_biased + inc;
+        /* The owner updates its count, as long as it stays positive */
+        if( (((object->obj_biased ^ self) | (biased ^ self)) <= PARSEC_OBJ_BIASED_COUNT_MASK) &&
+            (0 != (biased & PARSEC_OBJ_BIASED_COUNT_MASK)) ) {
+            object->obj_biased = biased;
+            return 1;
+        }
+#endif  /* defined(PARSEC_HAVE_THREAD_LOCAL) */
+        return parsec_obj_biased_update(object, inc);
+    }
     return parsec_atomic_fetch_add_int32(&(object->obj_reference_count), inc ) + inc;
 }
 #else
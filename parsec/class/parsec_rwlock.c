@@ -102,7 +102,7 @@ void parsec_atomic_rwlock_wrunlock( parsec_atomic_rwlock_t* atomic_rwlock )
     } while( !parsec_atomic_cas_int32(atomic_rwlock, old_state, new_state) );
 }
 
-#elif PARSEC_RWLOCK_IMPL == PARSEC_RWLOCK_IMPL_TICKET
+#elif (PARSEC_RWLOCK_IMPL == PARSEC_RWLOCK_IMPL_TICKET) || (PARSEC_RWLOCK_IMPL == PARSEC_RWLOCK_IMPL_BIASED)
 
 /* Ticket based (phase-fair) implementation
  *    http://dl.acm.org/citation.cfm?id=1842604
@@ -117,12 +117,7 @@ void parsec_atomic_rwlock_wrunlock( parsec_atomic_rwlock_t* atomic_rwlock )
 #define PRES   0x2
 #define PHID   0x1
 
-void parsec_atomic_rwlock_init(parsec_atomic_rwlock_t *L)
-{
-    memset((void*)L, 0, sizeof(parsec_atomic_rwlock_t));
-}
-
-void parsec_atomic_rwlock_rdlock(parsec_atomic_rwlock_t *L)
+static inline void parsec_atomic_rwlock_ticket_rdlock(parsec_atomic_rwlock_ticket_t *L)
 {
     int32_t w;
     int count = 0;
@@ -136,13 +131,13 @@ void parsec_atomic_rwlock_rdlock(parsec_atomic_rwlock_t *L)
     parsec_atomic_rmb(); // acquire
 }
 
-void parsec_atomic_rwlock_rdunlock(parsec_atomic_rwlock_t *L)
+static inline void parsec_atomic_rwlock_ticket_rdunlock(parsec_atomic_rwlock_ticket_t *L)
 {
     parsec_atomic_wmb(); // release
     parsec_atomic_fetch_add_int32(&L->rout, RINC);
 }
 
-void parsec_atomic_rwlock_wrlock(parsec_atomic_rwlock_t *L)
+static inline void parsec_atomic_rwlock_ticket_wrlock(parsec_atomic_rwlock_ticket_t *L)
 {
     int32_t ticket, w;
     int count = 0;
@@ -160,7 +155,7 @@ void parsec_atomic_rwlock_wrlock(parsec_atomic_rwlock_t *L)
     parsec_atomic_rmb(); // acquire
 }
 
-void parsec_atomic_rwlock_wrunlock(parsec_atomic_rwlock_t *L)
+static inline void parsec_atomic_rwlock_ticket_wrunlock(parsec_atomic_rwlock_ticket_t *L)
 {
     /* This is slightly different from the code in the cited paper:
      *   - to ensure order of operations (update of L->rin must happen before the
@@ -176,6 +171,204 @@ void parsec_atomic_rwlock_wrunlock(parsec_atomic_rwlock_t *L)
     L->wout = L->wout+1;
 }
 
+#if PARSEC_RWLOCK_IMPL == PARSEC_RWLOCK_IMPL_TICKET
+
+void parsec_atomic_rwlock_init(parsec_atomic_rwlock_t *L)
+{
+    memset((void*)L, 0, sizeof(parsec_atomic_rwlock_t));
+}
+
+void parsec_atomic_rwlock_rdlock(parsec_atomic_rwlock_t *L)
+{
+    parsec_atomic_rwlock_ticket_rdlock(L);
+}
+
+void parsec_atomic_rwlock_rdunlock(parsec_atomic_rwlock_t *L)
+{
+    parsec_atomic_rwlock_ticket_rdunlock(L);
+}
+
+void parsec_atomic_rwlock_wrlock(parsec_atomic_rwlock_t *L)
+{
+    parsec_atomic_rwlock_ticket_wrlock(L);
+}
+
+void parsec_atomic_rwlock_wrunlock(parsec_atomic_rwlock_t *L)
+{
+    parsec_atomic_rwlock_ticket_wrunlock(L);
+}
+
+#else  /* PARSEC_RWLOCK_IMPL == PARSEC_RWLOCK_IMPL_BIASED */
+
+/* Reader-biased implementation on top of the phase-fair RWLock
+ *    (BRAVO, https://www.usenix.org/conference/atc19/presentation/dice)
+ * The visible readers table has one cache line of slots per thread: a
+ * thread publishes the locks it holds in read mode in the slot of its line
+ * selected by the address of the lock. A line is handed back when its thread
+ * exits, so the table bounds the number of threads alive at once. Threads
+ * beyond the size of the table, and readers that find their slot busy
+ * (nested read locks, or two locks sharing a slot), go through the ticket
+ * lock.
+ */
+
+#include "parsec/sys/tls.h"
+#include <pthread.h>
+
+#define PARSEC_RWLOCK_SLOTS_PER_LINE  8    /* Pointers per cache line */
+#define PARSEC_RWLOCK_NB_LINES        256  /* Threads that can use the fast path */
+/* Number of reads through the ticket lock before a revoked bias is restored */
+#define PARSEC_RWLOCK_BIAS_INHIBIT    1024
+
+static parsec_atomic_rwlock_t * volatile parsec_rwlock_visible_readers[PARSEC_RWLOCK_NB_LINES * PARSEC_RWLOCK_SLOTS_PER_LINE];
+static volatile int32_t parsec_rwlock_nb_lines = 0;  /**< Lines handed out at least once */
+static PARSEC_TLS_DECLARE(parsec_rwlock_tls_line);
+#if !defined(PARSEC_HAVE_THREAD_LOCAL)
+static pthread_once_t parsec_rwlock_tls_once = PTHREAD_ONCE_INIT;
+static void parsec_rwlock_tls_init(void)
+{
+    PARSEC_TLS_KEY_CREATE(parsec_rwlock_tls_line);
+}
+#endif  /* !defined(PARSEC_HAVE_THREAD_LOCAL) */
+
+/* Lines of the exited threads, handed out again before the unused ones */
+static parsec_atomic_lock_t parsec_rwlock_lines_lock = PARSEC_ATOMIC_UNLOCKED;
+static int32_t parsec_rwlock_free_lines[PARSEC_RWLOCK_NB_LINES];
+static int32_t parsec_rwlock_nb_free_lines = 0;
+/* Only used for its destructor, which returns the line of an exiting thread */
+static pthread_key_t  parsec_rwlock_exit_key;
+static pthread_once_t parsec_rwlock_exit_once = PTHREAD_ONCE_INIT;
+
+static void parsec_rwlock_line_release(void *line)
+{
+    /* A thread holds no read lock when it exits, its line is empty */
+    parsec_atomic_lock(&parsec_rwlock_lines_lock);
+    assert(parsec_rwlock_nb_free_lines < PARSEC_RWLOCK_NB_LINES);
+    parsec_rwlock_free_lines[parsec_rwlock_nb_free_lines++] = (int32_t)(intptr_t)line;
+    parsec_atomic_unlock(&parsec_rwlock_lines_lock);
+    /* In case a later destructor takes a read lock */
+    PARSEC_TLS_SET_SPECIFIC(parsec_rwlock_tls_line, (void*)(intptr_t)(PARSEC_RWLOCK_NB_LINES + 1));
+}
+
+static void parsec_rwlock_exit_key_create(void)
+{
+    pthread_key_create(&parsec_rwlock_exit_key, parsec_rwlock_line_release);
+}
+
+/* Lines are numbered from 1, PARSEC_RWLOCK_NB_LINES + 1 means no line */
+static intptr_t parsec_rwlock_line_acquire(void)
+{
+    intptr_t line = PARSEC_RWLOCK_NB_LINES + 1;
+
+    pthread_once(&parsec_rwlock_exit_once, parsec_rwlock_exit_key_create);
+    parsec_atomic_lock(&parsec_rwlock_lines_lock);
+    if( parsec_rwlock_nb_free_lines > 0 )
+        line = parsec_rwlock_free_lines[--parsec_rwlock_nb_free_lines];
+    else if( parsec_rwlock_nb_lines < PARSEC_RWLOCK_NB_LINES )
+        line = ++parsec_rwlock_nb_lines;  /* published before the first CAS in the line */
+    parsec_atomic_unlock(&parsec_rwlock_lines_lock);
+    if( line <= PARSEC_RWLOCK_NB_LINES )
+        pthread_setspecific(parsec_rwlock_exit_key, (void*)line);
+    return line;
+}
+
+static inline int parsec_rwlock_slot_in_line(parsec_atomic_rwlock_t *L)
+{
+    uintptr_t a = (uintptr_t)L;
+    return (int)(((a >> 4) ^ (a >> 10)) & (PARSEC_RWLOCK_SLOTS_PER_LINE - 1));
+}
+
+/* Returns the slot of the calling thread for L, or NULL if the thread has no line */
+static inline parsec_atomic_rwlock_t * volatile *parsec_rwlock_visible_slot(parsec_atomic_rwlock_t *L)
+{
+    intptr_t line;
+
+#if !defined(PARSEC_HAVE_THREAD_LOCAL)
+    pthread_once(&parsec_rwlock_tls_once, parsec_rwlock_tls_init);
+#endif  /* !defined(PARSEC_HAVE_THREAD_LOCAL) */
+    line = (intptr_t)PARSEC_TLS_GET_SPECIFIC(parsec_rwlock_tls_line);
+    if( PARSEC_UNLIKELY(0 == line) ) {
+        /* 0 means not assigned yet */
+        line = parsec_rwlock_line_acquire();
+        PARSEC_TLS_SET_SPECIFIC(parsec_rwlock_tls_line, (void*)line);
+    }
+    if( line > PARSEC_RWLOCK_NB_LINES )
+        return NULL;
+    return &parsec_rwlock_visible_readers[(line - 1) * PARSEC_RWLOCK_SLOTS_PER_LINE + parsec_rwlock_slot_in_line(L)];
+}
+
+void parsec_atomic_rwlock_init(parsec_atomic_rwlock_t *L)
+{
+    memset((void*)L, 0, sizeof(parsec_atomic_rwlock_t));
+}
+
+void parsec_atomic_rwlock_rdlock(parsec_atomic_rwlock_t *L)
+{
+    parsec_atomic_rwlock_t * volatile *slot;
+
+    if( L->rbias && (NULL != (slot = parsec_rwlock_visible_slot(L))) ) {
+        if( parsec_atomic_cas_ptr(slot, NULL, L) ) {
+            /* The CAS is a full barrier: either the writer sees the slot,
+             * or we see that it revoked the bias */
+            if( L->rbias ) {
+                parsec_atomic_rmb(); // acquire
+                return;
+            }
+            *slot = NULL;
+        }
+    }
+    parsec_atomic_rwlock_ticket_rdlock(&L->lock);
+    if( !L->rbias ) {
+        /* Racy on purpose: this is only a heuristic */
+        if( L->inhibit > 0 )
+            L->inhibit--;
+        else
+            L->rbias = 1;
+    }
+}
+
+void parsec_atomic_rwlock_rdunlock(parsec_atomic_rwlock_t *L)
+{
+    parsec_atomic_rwlock_t * volatile *slot = parsec_rwlock_visible_slot(L);
+
+    /* Only the calling thread publishes L in its slot */
+    if( (NULL != slot) && (L == *slot) ) {
+        parsec_atomic_wmb(); // release
+        *slot = NULL;
+        return;
+    }
+    parsec_atomic_rwlock_ticket_rdunlock(&L->lock);
+}
+
+void parsec_atomic_rwlock_wrlock(parsec_atomic_rwlock_t *L)
+{
+    int nb_lines, slot_in_line, i, count = 0;
+    struct timespec ts = { .tv_sec = 0, .tv_nsec = 100 };
+
+    parsec_atomic_rwlock_ticket_wrlock(&L->lock);
+    /* The bias is restored only after enough reads since the last write */
+    L->inhibit = PARSEC_RWLOCK_BIAS_INHIBIT;
+    if( L->rbias ) {
+        L->rbias = 0;
+        parsec_mfence();
+        /* Wait for the readers of the fast path to drain */
+        nb_lines = parsec_rwlock_nb_lines;
+        slot_in_line = parsec_rwlock_slot_in_line(L);
+        for( i = 0; i < nb_lines; i++ ) {
+            while( L == parsec_rwlock_visible_readers[i * PARSEC_RWLOCK_SLOTS_PER_LINE + slot_in_line] )
+                if( count++ > 1000 )
+                    nanosleep( &ts, NULL );
+        }
+        parsec_atomic_rmb(); // acquire
+    }
+}
+
+void parsec_atomic_rwlock_wrunlock(parsec_atomic_rwlock_t *L)
+{
+    parsec_atomic_rwlock_ticket_wrunlock(&L->lock);
+}
+
+#endif  /* PARSEC_RWLOCK_IMPL == PARSEC_RWLOCK_IMPL_TICKET */
+
 #elif PARSEC_RWLOCK_IMPL == PARSEC_RWLOCK_IMPL_2LOCKS
 
 /* Traditional (e.g. http://www.springer.com/us/book/9783642320262)
@@ -21,12 +21,14 @@ BEGIN_C_DECLS
                                         *   (Enables paranoid checks by recording what threads are in read or write state when
                                         *   PARSEC_DEBUG_PARANOID is on) */
 #define PARSEC_RWLOCK_IMPL_MYTICKET 4  /**< Simpler (more portable?) version of the phase-fair RWLock */
+#define PARSEC_RWLOCK_IMPL_BIASED 5    /**< Reader-biased RWLock with per-thread reader slots, on top of the
+                                        *   phase-fair RWLock (BRAVO, https://www.usenix.org/conference/atc19/presentation/dice) */
 
 /**
- * There are 4 implementations of the RWLocks.
+ * There are 5 implementations of the RWLocks.
  * The following define chooses which one we use.
  */
-#define PARSEC_RWLOCK_IMPL PARSEC_RWLOCK_IMPL_TICKET
+#define PARSEC_RWLOCK_IMPL PARSEC_RWLOCK_IMPL_BIASED
 
 #if PARSEC_RWLOCK_IMPL == PARSEC_RWLOCK_IMPL_STATE
 
@@ -41,20 +43,43 @@ typedef volatile uint32_t parsec_atomic_rwlock_t;
 
 #define PARSEC_RWLOCK_UNLOCKED { 0 }
 
-#elif PARSEC_RWLOCK_IMPL == PARSEC_RWLOCK_IMPL_TICKET
+#elif (PARSEC_RWLOCK_IMPL == PARSEC_RWLOCK_IMPL_TICKET) || (PARSEC_RWLOCK_IMPL == PARSEC_RWLOCK_IMPL_BIASED)
 
 /**
  *  Ticket based (phase-fair) implementation
  *    http://dl.acm.org/citation.cfm?id=1842604
  */
-typedef volatile struct parsec_atomic_rwlock_s {
+typedef volatile struct parsec_atomic_rwlock_ticket_s {
     int32_t rin;    /**< How many readers requested to enter (3 high bytes, low byte used for writer requests) */
     int32_t rout;   /**< How many readers left (compared only to rin read values with equal) */
     int32_t win;    /**< How many writers requested to enter (3 high bytes, low byte unused) */
     int32_t wout;   /**< How many writers left (compared only to rin read values with equal) */
-} parsec_atomic_rwlock_t;
+} parsec_atomic_rwlock_ticket_t;
+
+#if PARSEC_RWLOCK_IMPL == PARSEC_RWLOCK_IMPL_TICKET
+typedef parsec_atomic_rwlock_ticket_t parsec_atomic_rwlock_t;
 
 #define PARSEC_RWLOCK_UNLOCKED { 0, 0, 0, 0 }
+#else
+
+/**
+ * Reader-biased implementation: while the lock is biased towards the
+ * readers, a reader only publishes the lock in a slot of its own cache
+ * line of a global table of visible readers, instead of updating the
+ * ticket lock shared by all the readers. A writer takes the ticket lock,
+ * revokes the bias, and waits until the lock disappears from the
+ * visible readers table. Readers go through the ticket lock while the
+ * bias is revoked, and restore it after enough read acquisitions without
+ * a writer, so locks that are often written stay on the ticket lock.
+ */
+typedef struct parsec_atomic_rwlock_s {
+    parsec_atomic_rwlock_ticket_t lock;     /**< Taken by writers, and by readers when the lock is not biased */
+    volatile int32_t              rbias;    /**< Readers can use the visible readers table */
+    volatile int32_t              inhibit;  /**< Number of slow read acquisitions before the bias is restored */
+} parsec_atomic_rwlock_t;
+
+#define PARSEC_RWLOCK_UNLOCKED { { 0, 0, 0, 0 }, 0, 0 }
+#endif
 
 #elif PARSEC_RWLOCK_IMPL == PARSEC_RWLOCK_IMPL_2LOCKS
 
@@ -0,0 +1,206 @@
+/*
+ * Copyright (c) 2023      The University of Tennessee and The University
+ *                         of Tennessee Research Foundation.  All rights
+ *                         reserved.
+ */
+
+#include "parsec/parsec_config.h"
+#include "parsec/sys/atomic.h"
+#include "parsec/class/wsdeque.h"
+
+#include <stdlib.h>
+#include <assert.h>
+
+static parsec_wsdeque_array_t*
+parsec_wsdeque_array_new(int64_t size, parsec_wsdeque_array_t *prev)
+{
+    parsec_wsdeque_array_t *a;
+    assert( 0 == (size & (size - 1)) );
+    a = (parsec_wsdeque_array_t*)malloc(sizeof(parsec_wsdeque_array_t) +
+                                        (size - 1) * sizeof(parsec_list_item_t*));
+    a->prev = prev;
+    a->mask = size - 1;
+    return a;
+}
+
+static void parsec_wsdeque_construct( parsec_wsdeque_t *deque )
+{
+    deque->top = 0;
+    deque->bottom = 0;
+    deque->array = parsec_wsdeque_array_new(PARSEC_WSDEQUE_INITIAL_SIZE, NULL);
+}
+
+static void parsec_wsdeque_destruct( parsec_wsdeque_t *deque )
+{
+    parsec_wsdeque_array_t *a = deque->array, *prev;
+    assert( deque->top >= deque->bottom );
+    while( NULL != a ) {
+        prev = a->prev;
+        free(a);
+        a = prev;
+    }
+    deque->array = NULL;
+}
+
+PARSEC_OBJ_CLASS_INSTANCE(parsec_wsdeque_t, parsec_object_t,
+                          parsec_wsdeque_construct, parsec_wsdeque_destruct);
+
+/**
+ * Make room for nb more elements in the deque. The elements in [t, b)
+ * are copied in a new array, twice as large as needed, and the previous
+ * array is kept for thieves that are still reading from it. Only
+ * the owner can call this function.
+ */
+static parsec_wsdeque_array_t*
+parsec_wsdeque_reserve(parsec_wsdeque_t *deque, int64_t t, int64_t b, int64_t nb)
+{
+    parsec_wsdeque_array_t *a = deque->array, *na;
+    int64_t size = a->mask + 1, i;
+
+    if( b - t + nb <= size )
+        return a;
+    while( b - t + nb > size ) size *= 2;
+    na = parsec_wsdeque_array_new(size, a);
+    for( i = t; i < b; i++ ) {
+        na->items[i & na->mask] = a->items[i & a->mask];
+    }
+    /* The copy must be visible before thieves can see the new array */
+    parsec_atomic_wmb();
+    deque->array = na;
+    return na;
+}
+
+int parsec_wsdeque_is_empty( parsec_wsdeque_t *deque )
+{
+    return deque->bottom <= deque->top;
+}
+
+int64_t parsec_wsdeque_size( parsec_wsdeque_t *deque )
+{
+    int64_t t = deque->top;
+    int64_t b = deque->bottom;
+    return b > t ? b - t : 0;
+}
+
+void parsec_wsdeque_push( parsec_wsdeque_t *deque, parsec_list_item_t *item )
+{
+    int64_t b = deque->bottom;
+    int64_t t = deque->top;
+    parsec_wsdeque_array_t *a = parsec_wsdeque_reserve(deque, t, b, 1);
+
+    a->items[b & a->mask] = item;
+    /* The element must be visible before the new bottom */
+    parsec_atomic_wmb();
+    deque->bottom = b + 1;
+}
+
+void parsec_wsdeque_chain( parsec_wsdeque_t *deque, parsec_list_item_t *ring )
+{
+    int64_t b = deque->bottom;
+    int64_t t = deque->top;
+    int64_t nb = 0;
+    parsec_wsdeque_array_t *a;
+    parsec_list_item_t *item;
+
+    _LIST_ITEM_ITERATOR(ring, ring, it, { nb++; });
+    a = parsec_wsdeque_reserve(deque, t, b, nb);
+
+    /* Push from the last element of the ring, so that the first one
+     * is the next to be popped by the owner */
+    item = (parsec_list_item_t*)ring->list_prev;
+    for( int64_t i = 0; i < nb; i++ ) {
+        a->items[(b + i) & a->mask] = item;
+        item = (parsec_list_item_t*)item->list_prev;
+    }
+    parsec_atomic_wmb();
+    deque->bottom = b + nb;
+}
+
+/**
+ * Take up to n elements from the top of the deque, in a ring.
+ * The elements are read before the CAS on top: if the CAS succeeds,
+ * top did not change since it was read, so the owner could not reuse
+ * the slots, and no other thread took these elements.
+ */
+static parsec_list_item_t*
+parsec_wsdeque_take_top( parsec_wsdeque_t *deque, int max, int *nb )
+{
+    parsec_list_item_t *items[PARSEC_WSDEQUE_MAX_STEAL];
+    parsec_wsdeque_array_t *a;
+    int64_t t, b, n, i;
+
+    if( max > PARSEC_WSDEQUE_MAX_STEAL ) max = PARSEC_WSDEQUE_MAX_STEAL;
+    if( max < 1 ) max = 1;
+    do {
+        t = deque->top;
+        parsec_mfence();
+        b = deque->bottom;
+        if( t >= b ) {
+            if( NULL != nb ) *nb = 0;
+            return NULL;
+        }
+        parsec_atomic_rmb();
+        a = deque->array;
+        n = (b - t + 1) / 2;
+        if( n > max ) n = max;
+        for( i = 0; i < n; i++ ) {
+            items[i] = a->items[(t + i) & a->mask];
+        }
+        /* Element loads must complete before we claim them */
+        parsec_atomic_rmb();
+    } while( !parsec_atomic_cas_int64(&deque->top, t, t + n) );
+
+    for( i = 1; i < n; i++ ) {
+        items[i-1]->list_next = items[i];
+        items[i]->list_prev = items[i-1];
+    }
+    if( NULL != nb ) *nb = (int)n;
+    return parsec_list_item_ring(items[0], items[n-1]);
+}
+
+parsec_list_item_t* parsec_wsdeque_pop( parsec_wsdeque_t *deque )
+{
+    parsec_list_item_t *items[PARSEC_WSDEQUE_MAX_STEAL];
+    parsec_wsdeque_array_t *a = deque->array;
+    int64_t b = deque->bottom - 1;
+    int64_t t, i;
+
+    deque->bottom = b;
+    parsec_mfence();
+    t = deque->top;
+    if( b - t >= PARSEC_WSDEQUE_MAX_STEAL ) {
+        /* No batched steal in progress can reach slot b: the element
+         * is ours without any atomic operation */
+        return parsec_list_item_singleton(a->items[b & a->mask]);
+    }
+    /* Few elements left: a thief may be taking slot b. Claim all the
+     * remaining elements at once, keep the newest, and give back the
+     * others. */
+    while( t <= b ) {
+        if( parsec_atomic_cas_int64(&deque->top, t, b + 1) ) {
+            for( i = t; i < b; i++ ) {
+                items[i - t] = a->items[i & a->mask];
+            }
+            for( i = t; i < b; i++ ) {
+                a->items[(i - t + b + 1) & a->mask] = items[i - t];
+            }
+            parsec_atomic_wmb();
+            deque->bottom = b + 1 + (b - t);
+            return parsec_list_item_singleton(a->items[b & a->mask]);
+        }
+        t = deque->top;
+    }
+    /* Thieves emptied the deque */
+    deque->bottom = t;
+    return NULL;
+}
+
+parsec_list_item_t* parsec_wsdeque_steal( parsec_wsdeque_t *deque )
+{
+    return parsec_wsdeque_take_top(deque, 1, NULL);
+}
+
+parsec_list_item_t* parsec_wsdeque_steal_half( parsec_wsdeque_t *deque, int max, int *nb )
+{
+    return parsec_wsdeque_take_top(deque, max, nb);
+}
@@ -0,0 +1,184 @@
+/*
+ * Copyright (c) 2023      The University of Tennessee and The University
+ *                         of Tennessee Research Foundation.  All rights
+ *                         reserved.
+ */
+
+#ifndef WSDEQUE_H_HAS_BEEN_INCLUDED
+#define WSDEQUE_H_HAS_BEEN_INCLUDED
+
+#include "parsec/parsec_config.h"
+#include "parsec/class/parsec_object.h"
+#include "parsec/class/list_item.h"
+
+/**
+ * @defgroup parsec_internal_classes_wsdeque Work-Stealing Deque
+ * @ingroup parsec_internal_classes
+ * @{
+ *
+ *  @brief Lock-free owner/thief deque of parsec_list_item_t
+ *
+ *  @details This is a Chase-Lev deque: a growable circular array
+ *     indexed by two monotonic counters. A single thread, the owner,
+ *     pushes and pops at the bottom without any atomic operation in
+ *     the common case. Any other thread, a thief, removes elements
+ *     from the top with a compare-and-swap, either one at a time or
+ *     by batches (steal-half).
+ *
+ *     To keep the owner pop free of atomic operations in the presence
+ *     of batched steals, the owner only competes with thieves (CAS on
+ *     the top) when less than PARSEC_WSDEQUE_MAX_STEAL elements remain.
+ *     In that case the owner claims all the remaining elements with a
+ *     single CAS, and pushes back all of them but the newest one, so
+ *     the owner always pops in LIFO order. Batched steals never take
+ *     more than PARSEC_WSDEQUE_MAX_STEAL elements.
+ *
+ *     The array grows when full. Previous arrays are kept until the
+ *     deque is destructed, so a thief holding a stale array can still
+ *     read valid elements from it.
+ *
+ *     Elements stored in the deque are not chained: their list_next and
+ *     list_prev fields are free to be used once they are popped. Rings
+ *     returned by the steal operations are well-formed rings.
+ */
+
+BEGIN_C_DECLS
+
+/**
+ * @brief Maximal number of elements a batched steal can take, and
+ *        minimal number of elements in the deque for the owner pop
+ *        to avoid the compare-and-swap.
+ */
+#define PARSEC_WSDEQUE_MAX_STEAL 16
+
+/**
+ * @brief Initial number of elements in the circular array (must be a power of 2)
+ */
+#define PARSEC_WSDEQUE_INITIAL_SIZE 256
+
+/**
+ * @brief Padding between the thief and owner counters, to avoid
+ *        false sharing between the owner and the thieves.
+ */
+#define PARSEC_WSDEQUE_PADDING 64
+
+typedef struct parsec_wsdeque_array_s parsec_wsdeque_array_t;
+
+/**
+ * @brief Circular array used to store the elements of the deque
+ */
+struct parsec_wsdeque_array_s {
+    parsec_wsdeque_array_t *prev;   /**< Array this one replaced, kept until destruction */
+    int64_t                 mask;   /**< Number of elements in items, minus one */
+    parsec_list_item_t     *items[1];
+};
+
+/**
+ * @brief Work-stealing deque
+ */
+typedef struct parsec_wsdeque_s {
+    parsec_object_t                   super;
+    volatile int64_t                  top;     /**< Next element to steal. Modified by thieves (and the owner) with CAS */
+    char                              pad[PARSEC_WSDEQUE_PADDING - sizeof(int64_t)];
+    volatile int64_t                  bottom;  /**< Next free slot. Modified only by the owner */
+    parsec_wsdeque_array_t * volatile array;   /**< Current circular array. Modified only by the owner */
+} parsec_wsdeque_t;
+
+PARSEC_DECLSPEC PARSEC_OBJ_CLASS_DECLARATION(parsec_wsdeque_t);
+
+/**
+ * @brief check if the deque is empty
+ *
+ * @param[in] deque the deque to check
+ * @return 0 if the deque is not empty, 1 otherwise
+ *
+ * @remark this function is thread safe, but the answer can be outdated
+ *         when the function returns
+ */
+PARSEC_DECLSPEC int
+parsec_wsdeque_is_empty( parsec_wsdeque_t *deque );
+
+/**
+ * @brief approximate number of elements in the deque
+ *
+ * @param[in] deque the deque
+ * @return the number of elements in the deque when it was inspected
+ *
+ * @remark this function is thread safe, but the answer can be outdated
+ *         when the function returns
+ */
+PARSEC_DECLSPEC int64_t
+parsec_wsdeque_size( parsec_wsdeque_t *deque );
+
+/**
+ * @brief Push an element at the bottom of the deque
+ *
+ * @param[inout] deque the deque
+ * @param[inout] item the element to push
+ *
+ * @remark this function can only be called by the owner of the deque
+ */
+PARSEC_DECLSPEC void
+parsec_wsdeque_push( parsec_wsdeque_t *deque, parsec_list_item_t *item );
+
+/**
+ * @brief Push a ring of elements at the bottom of the deque
+ *
+ * @details The elements are pushed in reverse order, so that the first
+ *          element of the ring is the next one the owner pops. The ring
+ *          is published to thieves at once.
+ *
+ * @param[inout] deque the deque
+ * @param[inout] ring the ring of elements to push
+ *
+ * @remark this function can only be called by the owner of the deque
+ */
+PARSEC_DECLSPEC void
+parsec_wsdeque_chain( parsec_wsdeque_t *deque, parsec_list_item_t *ring );
+
+/**
+ * @brief Pop the most recently pushed element of the deque
+ *
+ * @param[inout] deque the deque
+ * @return the element, or NULL if the deque is empty
+ *
+ * @remark this function can only be called by the owner of the deque
+ */
+PARSEC_DECLSPEC parsec_list_item_t*
+parsec_wsdeque_pop( parsec_wsdeque_t *deque );
+
+/**
+ * @brief Steal the oldest element of the deque
+ *
+ * @param[inout] deque the deque
+ * @return the element, or NULL if the deque was found empty
+ *
+ * @remark this function is thread safe
+ */
+PARSEC_DECLSPEC parsec_list_item_t*
+parsec_wsdeque_steal( parsec_wsdeque_t *deque );
+
+/**
+ * @brief Steal up to half of the elements of the deque
+ *
+ * @details Take at once the min(max, PARSEC_WSDEQUE_MAX_STEAL, ceil(size/2))
+ *          oldest elements of the deque.
+ *
+ * @param[inout] deque the deque
+ * @param[in] max the maximal number of elements to steal
+ * @param[out] nb if not NULL, the number of elements stolen
+ * @return a ring of elements, oldest first, or NULL if the deque was
+ *         found empty
+ *
+ * @remark this function is thread safe
+ */
+PARSEC_DECLSPEC parsec_list_item_t*
+parsec_wsdeque_steal_half( parsec_wsdeque_t *deque, int max, int *nb );
+
+END_C_DECLS
+
+/**
+ * @}
+ */
+
+#endif  /* WSDEQUE_H_HAS_BEEN_INCLUDED */
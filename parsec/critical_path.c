@@ -0,0 +1,285 @@
+/*
+ * Copyright (c) 2023      The University of Tennessee and The University
+ *                         of Tennessee Research Foundation.  All rights
+ *                         reserved.
+ */
+
+#include "parsec/parsec_config.h"
+#include "parsec/parsec_internal.h"
+#include "parsec/execution_stream.h"
+#include "parsec/remote_dep.h"
+#include "parsec/class/parsec_hash_table.h"
+#include "parsec/mca/device/device.h"
+#include "parsec/utils/debug.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+
+/**
+ * Bottom levels are saturated well below INT_MAX, to leave room for the
+ * taskpool priority that is added to them.
+ */
+#define PARSEC_CRITICAL_PATH_MAX_LEVEL ((int64_t)(INT_MAX / 4))
+
+/**
+ * Memoized bottom level of a task, stored in the hash table of its task class
+ */
+typedef struct parsec_critical_path_entry_s {
+    parsec_hash_table_item_t ht_item;
+    int64_t                  bottom_level;
+} parsec_critical_path_entry_t;
+
+struct parsec_critical_path_s {
+    parsec_device_module_t *cpu_device;  /**< Device used to query time_estimate */
+    volatile int32_t        disabled;    /**< The DAG could not be explored within the bound */
+    uint32_t                nb_task_classes;
+    parsec_hash_table_t     tables[1];   /**< One table per task class */
+};
+
+/**
+ * A task of the DAG, reduced to what is needed to iterate its successors
+ */
+typedef struct parsec_critical_path_task_s {
+    const parsec_task_class_t *task_class;
+    parsec_assignment_t        locals[MAX_LOCAL_COUNT];
+} parsec_critical_path_task_t;
+
+/**
+ * A task of the depth-first traversal, with the successors that remain to
+ * be visited. The traversal is iterative: the DAG can be much deeper than
+ * the stack of a compute thread.
+ */
+typedef struct parsec_critical_path_frame_s {
+    parsec_critical_path_task_t  task;
+    parsec_key_t                 key;
+    int64_t                      cost;       /**< Cost of the task itself */
+    int64_t                      best;       /**< Largest bottom level of the successors visited so far */
+    int                          nb_succ, next_succ, size_succ;
+    parsec_critical_path_task_t *succ;
+} parsec_critical_path_frame_t;
+
+static parsec_critical_path_t *parsec_critical_path_new(parsec_taskpool_t *tp)
+{
+    parsec_critical_path_t *cp;
+    const parsec_task_class_t *tc;
+
+    cp = (parsec_critical_path_t*)calloc(1, sizeof(parsec_critical_path_t) +
+                                         (tp->nb_task_classes - 1) * sizeof(parsec_hash_table_t));
+    cp->nb_task_classes = tp->nb_task_classes;
+    cp->cpu_device = NULL;
+    for( uint32_t i = 0; i < parsec_nb_devices; i++ ) {
+        parsec_device_module_t *dev = parsec_mca_device_get(i);
+        if( (NULL != dev) && (PARSEC_DEV_CPU & dev->type) ) {
+            cp->cpu_device = dev;
+            break;
+        }
+    }
+    for( uint32_t i = 0; i < cp->nb_task_classes; i++ ) {
+        tc = tp->task_classes_array[i];
+        PARSEC_OBJ_CONSTRUCT(&cp->tables[i], parsec_hash_table_t);
+        parsec_hash_table_init(&cp->tables[i], offsetof(parsec_critical_path_entry_t, ht_item),
+                               10, *tc->key_functions, tp);
+    }
+    return cp;
+}
+
+static void parsec_critical_path_free_entry(void *item, void *cb_data)
+{
+    parsec_hash_table_t *ht = (parsec_hash_table_t*)cb_data;
+    parsec_critical_path_entry_t *entry = (parsec_critical_path_entry_t*)item;
+    parsec_hash_table_nolock_remove(ht, entry->ht_item.key);
+    free(entry);
+}
+
+void parsec_critical_path_free(parsec_critical_path_t *cp)
+{
+    if( NULL == cp ) return;
+    for( uint32_t i = 0; i < cp->nb_task_classes; i++ ) {
+        parsec_hash_table_for_all(&cp->tables[i], parsec_critical_path_free_entry, &cp->tables[i]);
+        parsec_hash_table_fini(&cp->tables[i]);
+        PARSEC_OBJ_DESTRUCT(&cp->tables[i]);
+    }
+    free(cp);
+}
+
+static int64_t
+parsec_critical_path_find(parsec_critical_path_t *cp, uint32_t tc_id, parsec_key_t key)
+{
+    parsec_critical_path_entry_t *entry;
+    entry = (parsec_critical_path_entry_t*)parsec_hash_table_find(&cp->tables[tc_id], key);
+    return (NULL == entry) ? -1 : entry->bottom_level;
+}
+
+static void
+parsec_critical_path_save(parsec_critical_path_t *cp, uint32_t tc_id, parsec_key_t key, int64_t bottom_level)
+{
+    parsec_critical_path_entry_t *entry;
+    parsec_key_handle_t kh;
+
+    parsec_hash_table_lock_bucket_handle(&cp->tables[tc_id], key, &kh);
+    /* Another thread may have computed the same task concurrently */
+    if( NULL == parsec_hash_table_nolock_find_handle(&cp->tables[tc_id], &kh) ) {
+        entry = (parsec_critical_path_entry_t*)malloc(sizeof(parsec_critical_path_entry_t));
+        entry->ht_item.key = key;
+        entry->bottom_level = bottom_level;
+        parsec_hash_table_nolock_insert_handle(&cp->tables[tc_id], &kh, &entry->ht_item);
+    }
+    parsec_hash_table_unlock_bucket_handle(&cp->tables[tc_id], &kh);
+}
+
+static parsec_ontask_iterate_t
+parsec_critical_path_collect(parsec_execution_stream_t *es,
+                             const parsec_task_t *newcontext,
+                             const parsec_task_t *oldcontext,
+                             const parsec_dep_t *dep,
+                             parsec_dep_data_description_t *data,
+                             int rank_src, int rank_dst, int vpid_dst,
+                             data_repo_t *successor_repo, parsec_key_t successor_repo_key,
+                             void *param)
+{
+    parsec_critical_path_frame_t *frame = (parsec_critical_path_frame_t*)param;
+    parsec_critical_path_task_t *succ;
+
+    if( frame->nb_succ == frame->size_succ ) {
+        frame->size_succ = (0 == frame->size_succ) ? 4 : 2 * frame->size_succ;
+        frame->succ = (parsec_critical_path_task_t*)realloc(frame->succ, frame->size_succ * sizeof(parsec_critical_path_task_t));
+    }
+    succ = &frame->succ[frame->nb_succ++];
+    succ->task_class = newcontext->task_class;
+    memcpy(succ->locals, newcontext->locals, sizeof(succ->locals));
+
+    (void)es; (void)oldcontext; (void)dep; (void)data; (void)rank_src; (void)rank_dst; (void)vpid_dst;
+    (void)successor_repo; (void)successor_repo_key;
+    return PARSEC_ITERATE_CONTINUE;
+}
+
+/**
+ * Cost of a task: the simulation cost if any, the time estimate on the
+ * CPU (in micro-seconds) if any, and 1 otherwise.
+ */
+static int64_t
+parsec_critical_path_cost(parsec_critical_path_t *cp, parsec_task_t *task)
+{
+    int64_t cost = 1;
+#if defined(PARSEC_SIM)
+    if( NULL != task->task_class->sim_cost_fct ) {
+        cost = task->task_class->sim_cost_fct(task);
+    } else
+#endif  /* defined(PARSEC_SIM) */
+    if( (NULL != task->task_class->time_estimate) && (NULL != cp->cpu_device) ) {
+        cost = task->task_class->time_estimate(task, cp->cpu_device) / 1000;
+    }
+    return (cost < 1) ? 1 : cost;
+}
+
+static void
+parsec_critical_path_push(parsec_critical_path_frame_t **stack, int *depth, int *size,
+                          parsec_taskpool_t *tp, const parsec_critical_path_task_t *task)
+{
+    parsec_critical_path_frame_t *frame;
+
+    if( *depth == *size ) {
+        *size = (0 == *size) ? 64 : 2 * *size;
+        *stack = (parsec_critical_path_frame_t*)realloc(*stack, *size * sizeof(parsec_critical_path_frame_t));
+    }
+    frame = &(*stack)[(*depth)++];
+    frame->task = *task;
+    frame->key = task->task_class->make_key(tp, task->locals);
+    frame->cost = 0;
+    frame->best = 0;
+    frame->nb_succ = frame->next_succ = 0;
+    frame->size_succ = 0;
+    frame->succ = NULL;
+}
+
+static int64_t
+parsec_critical_path_compute(parsec_critical_path_t *cp, parsec_taskpool_t *tp,
+                             const parsec_critical_path_task_t *root)
+{
+    parsec_execution_stream_t *es = parsec_my_execution_stream();
+    parsec_critical_path_frame_t *stack = NULL, *frame;
+    int depth = 0, size = 0, nb_visited = 0;
+    int64_t level = 0;
+    parsec_task_t task;
+
+    parsec_critical_path_push(&stack, &depth, &size, tp, root);
+    memset(&task, 0, sizeof(parsec_task_t));
+    task.taskpool = tp;
+    task.chore_mask = PARSEC_DEV_ALL;
+    while( depth > 0 ) {
+        frame = &stack[depth-1];
+        if( NULL == frame->succ ) {
+            if( cp->disabled ||
+                ((parsec_runtime_critical_path_max_tasks > 0) &&
+                 (++nb_visited > parsec_runtime_critical_path_max_tasks)) ) {
+                /* The DAG is too large, or depends on values only known at
+                 * runtime: give up on this taskpool */
+                if( 0 == parsec_atomic_fetch_inc_int32(&cp->disabled) ) {
+                    parsec_warning("The critical path of taskpool %u cannot be computed within %d tasks (runtime_critical_path_max_tasks): "
+                                   "its tasks get the taskpool priority", tp->taskpool_id, parsec_runtime_critical_path_max_tasks);
+                }
+                while( depth > 0 ) free(stack[--depth].succ);
+                level = 0;
+                break;
+            }
+            /* First visit: gather the successors (on all ranks) of the task */
+            task.task_class = frame->task.task_class;
+            memcpy(task.locals, frame->task.locals, sizeof(task.locals));
+            frame->size_succ = 1;
+            frame->succ = (parsec_critical_path_task_t*)malloc(sizeof(parsec_critical_path_task_t));
+            if( NULL != task.task_class->iterate_successors )
+                task.task_class->iterate_successors(es, &task, PARSEC_ACTION_DEPS_MASK,
+                                                    parsec_critical_path_collect, frame);
+            frame->cost = parsec_critical_path_cost(cp, &task);
+        }
+        while( frame->next_succ < frame->nb_succ ) {
+            parsec_critical_path_task_t *succ = &frame->succ[frame->next_succ];
+            level = parsec_critical_path_find(cp, succ->task_class->task_class_id,
+                                              succ->task_class->make_key(tp, succ->locals));
+            if( level < 0 ) break;
+            if( level > frame->best ) frame->best = level;
+            frame->next_succ++;
+        }
+        if( frame->next_succ < frame->nb_succ ) {
+            /* Visit the successor first. The stack may be reallocated. */
+            parsec_critical_path_task_t succ = frame->succ[frame->next_succ];
+            parsec_critical_path_push(&stack, &depth, &size, tp, &succ);
+            continue;
+        }
+        /* All the successors are known: the bottom level of the task is its
+         * cost plus the largest bottom level of its successors */
+        level = frame->cost + frame->best;
+        if( level > PARSEC_CRITICAL_PATH_MAX_LEVEL ) level = PARSEC_CRITICAL_PATH_MAX_LEVEL;
+        parsec_critical_path_save(cp, frame->task.task_class->task_class_id, frame->key, level);
+        free(frame->succ);
+        depth--;
+    }
+    free(stack);
+    return level;
+}
+
+int parsec_critical_path_priority(parsec_taskpool_t *tp,
+                                  const parsec_task_class_t *tc,
+                                  const parsec_assignment_t *locals)
+{
+    parsec_critical_path_t *cp = tp->critical_path;
+    parsec_critical_path_task_t root;
+    int64_t level;
+
+    if( PARSEC_UNLIKELY(NULL == cp) ) {
+        cp = parsec_critical_path_new(tp);
+        if( !parsec_atomic_cas_ptr(&tp->critical_path, NULL, cp) ) {
+            parsec_critical_path_free(cp);
+            cp = tp->critical_path;
+        }
+    }
+    if( cp->disabled ) return 0;
+    level = parsec_critical_path_find(cp, tc->task_class_id, tc->make_key(tp, locals));
+    if( level < 0 ) {
+        root.task_class = tc;
+        memcpy(root.locals, locals, sizeof(root.locals));
+        level = parsec_critical_path_compute(cp, tp, &root);
+    }
+    return (int)level;
+}
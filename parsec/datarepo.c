@@ -10,6 +10,10 @@
 #include "parsec/mempool.h"
 #include "parsec/execution_stream.h"
 
+#include <inttypes.h>
+
+size_t parsec_datarepo_dense_max_keys = 1 << 20;
+
 data_repo_t*
 data_repo_create_nothreadsafe(unsigned int hashsize_hint, parsec_key_fn_t key_functions, void *key_hash_data, unsigned int nbdata)
 {
@@ -25,12 +29,72 @@ data_repo_create_nothreadsafe(unsigned int hashsize_hint, parsec_key_fn_t key_fu
                            key_functions, key_hash_data);
 
     res->nbdata = nbdata;
+    res->nb_keys = 0;
+    res->slots = NULL;
     return res;
 }
 
+data_repo_t*
+data_repo_create_dense(uint64_t nb_keys, unsigned int hashsize_hint, parsec_key_fn_t key_functions, void *key_hash_data, unsigned int nbdata)
+{
+    data_repo_t *res;
+
+    if( (0 == nb_keys) || (nb_keys > parsec_datarepo_dense_max_keys) )
+        return data_repo_create_nothreadsafe(hashsize_hint, key_functions, key_hash_data, nbdata);
+    /* The hash table only holds the keys out of the dense range, if any */
+    res = data_repo_create_nothreadsafe(1, key_functions, key_hash_data, nbdata);
+    res->slots = (data_repo_entry_t * volatile *)calloc(nb_keys, sizeof(data_repo_entry_t*));
+    if( NULL == res->slots )
+        return res;
+    res->nb_keys = nb_keys;
+    PARSEC_DEBUG_VERBOSE(20, parsec_debug_output, "data repo %p directly indexes %"PRIu64" keys", res, nb_keys);
+    return res;
+}
+
+/**
+ * Locks the slot or the bucket of key, and returns its entry. The lowest
+ * bit of a slot is set while the slot is locked.
+ */
+static inline data_repo_entry_t*
+data_repo_lock_entry(data_repo_t *repo, parsec_key_t key, parsec_key_handle_t *kh)
+{
+    uintptr_t e;
+
+    if( key < repo->nb_keys ) {
+        do {
+            e = (uintptr_t)repo->slots[key] & ~(uintptr_t)1;
+        } while( !parsec_atomic_cas_ptr(&repo->slots[key], (void*)e, (void*)(e | 1)) );
+        return (data_repo_entry_t*)e;
+    }
+    parsec_hash_table_lock_bucket_handle(&repo->table, key, kh);
+    return (data_repo_entry_t*)parsec_hash_table_nolock_find_handle(&repo->table, kh);
+}
+
+/**
+ * Replaces the entry of key, that was old when it was locked, by e (NULL
+ * to remove it) and releases the lock.
+ */
+static inline void
+data_repo_unlock_entry(data_repo_t *repo, parsec_key_t key, parsec_key_handle_t *kh,
+                       data_repo_entry_t *old, data_repo_entry_t *e)
+{
+    if( key < repo->nb_keys ) {
+        parsec_atomic_wmb();
+        repo->slots[key] = e;
+        return;
+    }
+    if( old != e ) {
+        if( NULL != old ) parsec_hash_table_nolock_remove_handle(&repo->table, kh);
+        if( NULL != e ) parsec_hash_table_nolock_insert_handle(&repo->table, kh, &e->ht_item);
+    }
+    parsec_hash_table_unlock_bucket_handle(&repo->table, kh);
+}
+
 data_repo_entry_t*
 data_repo_lookup_entry(data_repo_t *repo, parsec_key_t key)
 {
+    if( key < repo->nb_keys )
+        return (data_repo_entry_t*)((uintptr_t)repo->slots[key] & ~(uintptr_t)1);
     return (data_repo_entry_t *) parsec_hash_table_find(&repo->table, key);
 }
 
@@ -48,14 +112,13 @@ __data_repo_lookup_entry_and_create(parsec_execution_stream_t *es, data_repo_t *
 #endif
 
     parsec_key_handle_t kh;
-    parsec_hash_table_lock_bucket_handle(&repo->table, key, &kh);
-    e = (data_repo_entry_t*)parsec_hash_table_nolock_find_handle(&repo->table, &kh);
+    e = data_repo_lock_entry(repo, key, &kh);
     if( NULL != e ) {
         e->retained++; /* Until we update the usage limit */
-        parsec_hash_table_unlock_bucket_handle(&repo->table, &kh);
+        data_repo_unlock_entry(repo, key, &kh, e, e);
         return e;
     }
-    parsec_hash_table_unlock_bucket_handle(&repo->table, &kh);
+    data_repo_unlock_entry(repo, key, &kh, NULL, NULL);
 
     e = (data_repo_entry_t*)parsec_thread_mempool_allocate( es->datarepo_mempools[repo->nbdata] );
     for(i = 0; i < repo->nbdata; e->data[i] = NULL, i++);
@@ -69,22 +132,20 @@ __data_repo_lookup_entry_and_create(parsec_execution_stream_t *es, data_repo_t *
     e->usagecnt = 0;
     e->retained = 1; /* Until we update the usage limit */
 
-    parsec_hash_table_lock_bucket_handle(&repo->table, key, &kh);
     /* When setting up future reshape promises the creation of repos for successors
      * tasks is advanced. Multiple threads may try to create the repo of the same
      * successor task at a given moment (each one targeting the reshape of a
      * different succesor's flow). Thus, we need to re-check before inserting.
      */
-    e2 = (data_repo_entry_t*)parsec_hash_table_nolock_find_handle(&repo->table, &kh);
+    e2 = data_repo_lock_entry(repo, key, &kh);
     if( NULL != e2 ) {
         parsec_thread_mempool_free( e->data_repo_mempool_owner, (void*) e );
         e2->retained++; /* Until we update the usage limit */
-        parsec_hash_table_unlock_bucket_handle(&repo->table, &kh);
+        data_repo_unlock_entry(repo, key, &kh, e2, e2);
         return e2;
     }
 
-    parsec_hash_table_nolock_insert_handle(&repo->table, &kh, &e->ht_item);
-    parsec_hash_table_unlock_bucket_handle(&repo->table, &kh);
+    data_repo_unlock_entry(repo, key, &kh, NULL, e);
     PARSEC_DEBUG_VERBOSE(20, parsec_debug_output, "entry %p/%s of hash table %s has been allocated with an usage count of %u/%u and is retained %d at %s:%d",
                          e, repo->table.key_functions.key_print(estr, 64, e->ht_item.key, repo->table.hash_data), tablename, e->usagecnt, e->usagelmt, e->retained, file, line);
 
@@ -105,8 +166,7 @@ __data_repo_entry_used_once(data_repo_t *repo, parsec_key_t key
 #endif
 
     parsec_key_handle_t kh;
-    parsec_hash_table_lock_bucket_handle(&repo->table, key, &kh);
-    e = (data_repo_entry_t*)parsec_hash_table_nolock_find_handle(&repo->table, &kh);
+    e = data_repo_lock_entry(repo, key, &kh);
 #if defined(PARSEC_DEBUG_NOISIER)
     if( NULL == e ) {
         PARSEC_DEBUG_VERBOSE(20, parsec_debug_output, "entry %s of hash table %s could not be found at %s:%d",
@@ -119,14 +179,13 @@ __data_repo_entry_used_once(data_repo_t *repo, parsec_key_t key
     if( (e->usagelmt == r) && (0 == e->retained) ) {
         PARSEC_DEBUG_VERBOSE(20, parsec_debug_output, "entry %p/%s of hash table %s has a usage count of %u/%u and is not retained: freeing it at %s:%d",
                              e, repo->table.key_functions.key_print(estr, 64, e->ht_item.key, repo->table.hash_data), tablename, r, r, file, line);
-        parsec_hash_table_nolock_remove_handle(&repo->table, &kh);
-        parsec_hash_table_unlock_bucket_handle(&repo->table, &kh);
+        data_repo_unlock_entry(repo, key, &kh, e, NULL);
 
         parsec_thread_mempool_free(e->data_repo_mempool_owner, e );
     } else {
         PARSEC_DEBUG_VERBOSE(20, parsec_debug_output, "entry %p/%s of hash table %s has %u/%u usage count and %s retained: not freeing it at %s:%d",
                              e, repo->table.key_functions.key_print(estr, 64, e->ht_item.key, repo->table.hash_data), tablename, r, e->usagelmt, e->retained ? "is" : "is not", file, line);
-        parsec_hash_table_unlock_bucket_handle(&repo->table, &kh);
+        data_repo_unlock_entry(repo, key, &kh, e, e);
     }
 }
 
@@ -144,8 +203,7 @@ __data_repo_entry_addto_usage_limit(data_repo_t *repo, parsec_key_t key, uint32_
 #endif
 
     parsec_key_handle_t kh;
-    parsec_hash_table_lock_bucket_handle(&repo->table, key, &kh);
-    e = parsec_hash_table_nolock_find_handle(&repo->table, &kh);
+    e = data_repo_lock_entry(repo, key, &kh);
     assert( NULL != e );
     assert(e->retained > 0);
     do {
@@ -159,14 +217,13 @@ __data_repo_entry_addto_usage_limit(data_repo_t *repo, parsec_key_t key, uint32_
                              "entry %p/%s of hash table %s has a usage count of %u/%u and is"
                              " not retained: freeing it at %s:%d",
                              e, repo->table.key_functions.key_print(estr, 64, e->ht_item.key, repo->table.hash_data),tablename, e->usagecnt, e->usagelmt, file, line);
-        parsec_hash_table_nolock_remove_handle(&repo->table, &kh);
-        parsec_hash_table_unlock_bucket_handle(&repo->table, &kh);
+        data_repo_unlock_entry(repo, key, &kh, e, NULL);
         parsec_thread_mempool_free(e->data_repo_mempool_owner, e );
     } else {
         PARSEC_DEBUG_VERBOSE(20, parsec_debug_output,
                              "entry %p/%s of hash table %s has a usage count of %u/%u and is %s retained at %s:%d",
                              e, repo->table.key_functions.key_print(estr, 64, e->ht_item.key, repo->table.hash_data), tablename, e->usagecnt, e->usagelmt, e->retained ? "still" : "no more", file, line);
-        parsec_hash_table_unlock_bucket_handle(&repo->table, &kh);
+        data_repo_unlock_entry(repo, key, &kh, e, e);
     }
 }
 
@@ -187,7 +244,11 @@ void data_repo_destroy_nothreadsafe(data_repo_t *repo)
 {
 #if defined(PARSEC_DEBUG_NOISIER)
     parsec_hash_table_for_all(&repo->table, print_data_repo_entry, repo);
+    for(uint64_t k = 0; k < repo->nb_keys; k++)
+        if( NULL != repo->slots[k] )
+            print_data_repo_entry((void*)repo->slots[k], repo);
 #endif  /* defined(PARSEC_DEBUG_NOISIER) */
     parsec_hash_table_fini(&repo->table);
+    free((void*)repo->slots);
     free(repo);
 }
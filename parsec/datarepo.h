@@ -85,17 +85,42 @@ struct data_repo_entry_s {
     struct parsec_data_copy_s *data[1];
 };
 
+/**
+ * Dense repositories:
+ *  When the keys of a repository are known to be a dense index (the key
+ *  of the PTG tasks whose execution space is a box of ranges), the entries
+ *  with a key below nb_keys are stored in a directly indexed array of
+ *  slots instead of the hash table. The lowest bit of a slot is used as a
+ *  lock, so that a slot is protected exactly like a bucket of the hash
+ *  table. Keys out of the dense range still go to the hash table.
+ */
 struct data_repo_s {
     parsec_hash_table_t table;
     unsigned int       nbdata;
+    uint64_t           nb_keys;   /**< Number of directly indexed keys, 0 if none */
+    data_repo_entry_t * volatile *slots;
 };
 typedef struct data_repo_s data_repo_t;
 
+/**
+ * Maximum number of keys of a dense repository. Repositories with a larger
+ * key space fall back to a hash table (0 disables dense repositories).
+ */
+extern size_t parsec_datarepo_dense_max_keys;
+
 BEGIN_C_DECLS
 
 data_repo_t*
 data_repo_create_nothreadsafe(unsigned int hashsize_hint, parsec_key_fn_t key_functions, void *key_hash_data, unsigned int nbdata);
 
+/**
+ * Create a repository for keys in [0, nb_keys), directly indexed when
+ * nb_keys is at most parsec_datarepo_dense_max_keys, or a hash table of
+ * hashsize_hint buckets otherwise.
+ */
+data_repo_t*
+data_repo_create_dense(uint64_t nb_keys, unsigned int hashsize_hint, parsec_key_fn_t key_functions, void *key_hash_data, unsigned int nbdata);
+
 data_repo_entry_t*
 data_repo_lookup_entry(data_repo_t *repo, parsec_key_t key);
 
@@ -6,6 +6,7 @@
 
 #include "parsec/parsec_config.h"
 #include "parsec/datatype.h"
+#include "parsec/parsec_comm_engine.h"
 
 #if !defined(PARSEC_HAVE_MPI)
 #error __FILE__ should only be used when MPI support is enabled.
@@ -36,7 +37,10 @@ parsec_type_extent( parsec_datatype_t type, ptrdiff_t* lb, ptrdiff_t* extent)
 int
 parsec_type_free( parsec_datatype_t* type )
 {
-    int rc = MPI_Type_free(type);
+    int rc;
+    /* Drop the cached registrations of data laid out with the type */
+    parsec_ce_mem_reg_cache_invalidate_datatype(*type);
+    rc = MPI_Type_free(type);
     return (MPI_SUCCESS == rc ? PARSEC_SUCCESS : PARSEC_ERROR);
 }
 
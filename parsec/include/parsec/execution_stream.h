@@ -30,6 +30,12 @@
 
 BEGIN_C_DECLS
 
+/**
+ * Maximal number of tasks an execution stream can obtain at once from a
+ * scheduler implementing select_batch (see runtime_select_batch).
+ */
+#define PARSEC_MAX_SELECT_BATCH 32
+
 /**
  *  Computational Thread-specific structure
  */
@@ -37,6 +43,7 @@ struct parsec_execution_stream_s {
     int32_t   th_id;        /**< Internal thread identifier. A thread belongs to a vp */
     int core_id;            /**< Core on which the thread is bound (hwloc in order numbering) */
     int socket_id;          /**< Socket on which the thread is bound (hwloc in order numerotation) */
+    int numa_id;            /**< NUMA node on which the thread is bound (hwloc logical index, 0 if unknown) */
 
     pthread_t pthread_id;     /**< POSIX thread identifier. */
 
@@ -52,6 +59,22 @@ struct parsec_execution_stream_s {
      * the scheduler decision.
      */
     struct parsec_task_s* next_task;
+    int32_t handoff_depth;  /**< Number of consecutive tasks executed from next_task,
+                             *   0 if the last task was selected from the scheduler */
+
+    /* Idle parking counters, in ns, reset at the end of each parsec_context_wait */
+    uint64_t park_count;            /**< Number of times this stream parked */
+    uint64_t park_time;             /**< Total time spent parked */
+    uint64_t wakeup_count;          /**< Number of times this stream was woken up by a new task */
+    uint64_t wakeup_latency;        /**< Total time between the wake-up requests and the resumes */
+
+    /* Tasks obtained from the scheduler by a batched selection, and not yet
+     * executed. They are private to this execution_stream.
+     */
+    struct parsec_task_s* ready_tasks[PARSEC_MAX_SELECT_BATCH];
+    int32_t ready_tasks_count;     /**< Number of tasks in ready_tasks */
+    int32_t ready_tasks_next;      /**< Index of the next task to execute in ready_tasks */
+    int32_t ready_tasks_distance;  /**< Distance returned by the scheduler for the batch */
 
 #if defined(PARSEC_SIM)
     int largest_simulation_date;
@@ -59,6 +82,7 @@ struct parsec_execution_stream_s {
 
 #if defined(PARSEC_PROF_PINS)
     struct parsec_pins_next_callback_s pins_events_cb[PARSEC_PINS_FLAG_COUNT];
+    int32_t select_distance;  /**< Distance reported by the scheduler for the last selected task */
 #endif  /* defined(PARSEC_PROF_PINS) */
 
 #if defined(PARSEC_PROF_RUSAGE_EU)
@@ -82,6 +106,9 @@ struct parsec_vp_s {
     parsec_context_t *parsec_context; /**< backlink to the global context */
     int32_t vp_id;                  /**< virtual process identifier of this vp */
     int32_t nb_cores;               /**< number of cores for this vp */
+    volatile int32_t nb_active_cores; /**< number of execution streams allowed to select tasks. The
+                                       *   streams with a th_id above are retired, and sleep on this
+                                       *   field until they are reactivated */
 
     /* Mempools are allocated per VP, and used per execution_stream
      * The last eu of this VP will create the mempools for all eus of this VP
@@ -93,6 +120,13 @@ struct parsec_vp_s {
     parsec_mempool_t         dependencies_mempool; /**< If using hashtables to store dependencies
                                                     *   those are allocated using this mempool */
 
+    /* Idle execution streams of this VP park on park_seq (a futex on Linux),
+     * and are woken by the threads inserting tasks in the scheduler of
+     * this VP. Any wake-up increases park_seq. */
+    volatile int32_t         park_seq;          /**< Futex word of the parked execution streams */
+    volatile int32_t         nb_parked;         /**< Number of execution streams parked or about to */
+    volatile uint64_t        park_wake_time;    /**< Date (in ns) of the last wake-up, for the latency counters */
+
     /* This field should always be the last one in the structure. Even if the
      * declared number of execution units is 1, when we allocate the memory
      * we will allocate more (as many as we need), so everything after this
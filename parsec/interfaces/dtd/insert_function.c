@@ -548,6 +548,8 @@ void parsec_dtd_fini(void)
 extern int __parsec_task_progress(parsec_execution_stream_t *es,
                                   parsec_task_t *task,
                                   int distance);
+extern parsec_task_t *__parsec_get_next_task(parsec_execution_stream_t *es,
+                                             int *distance);
 
 /* **************************************************************************** */
 /**
@@ -601,12 +603,7 @@ parsec_execute_and_come_back(parsec_taskpool_t *tp,
         }
         misses_in_a_row++;  /* assume we fail to extract a task */
 
-        if( NULL == (task = es->next_task) ) {
-            task = parsec_current_scheduler->module.select(es, &distance);
-        } else {
-            es->next_task = NULL;
-            distance = 1;
-        }
+        task = __parsec_get_next_task(es, &distance);
 
         if( task != NULL) {
             misses_in_a_row = 0;  /* reset the misses counter */
@@ -1936,8 +1933,9 @@ data_lookup_of_dtd_task(parsec_execution_stream_t *es,
 {
     (void)es;
 
-    int current_dep, op_type_on_current_flow;
+    int current_dep, dep, op_type_on_current_flow;
     parsec_dtd_task_t *current_task = (parsec_dtd_task_t *)this_task;
+    uint32_t allocated = 0;
 
     for( current_dep = 0; current_dep < current_task->super.task_class->nb_flows; current_dep++ ) {
         parsec_data_copy_t *copy;
@@ -1948,12 +1946,6 @@ data_lookup_of_dtd_task(parsec_execution_stream_t *es,
         if( NULL == copy ) {
             continue;
         }
-        if( PARSEC_DATA_CREATE_ON_DEMAND == copy->device_private ) {
-            parsec_arena_datatype_t *adt;
-            adt = parsec_hash_table_nolock_find(&this_task->taskpool->context->dtd_arena_datatypes_hash_table,
-                                                (FLOW_OF(current_task, current_dep))->arena_index);
-            parsec_arena_allocate_device_private(copy, adt->arena, 1, 0, adt->opaque_dtt);
-        }
 
         if( PARSEC_INOUT == op_type_on_current_flow ||
             PARSEC_OUTPUT == op_type_on_current_flow ) {
@@ -1966,6 +1958,31 @@ data_lookup_of_dtd_task(parsec_execution_stream_t *es,
         }
     }
 
+    /* The tiles created on demand are allocated once the task cannot be
+     * delayed for other reasons, and all together: a task held back does
+     * not keep the tiles it got for its other flows */
+    for( current_dep = 0; current_dep < current_task->super.task_class->nb_flows; current_dep++ ) {
+        parsec_data_copy_t *copy = current_task->super.data[current_dep].data_in;
+        parsec_arena_datatype_t *adt;
+
+        if( (NULL == copy) || (PARSEC_DATA_CREATE_ON_DEMAND != copy->device_private) ) {
+            continue;
+        }
+        adt = parsec_hash_table_nolock_find(&this_task->taskpool->context->dtd_arena_datatypes_hash_table,
+                                            (FLOW_OF(current_task, current_dep))->arena_index);
+        if( PARSEC_SUCCESS != parsec_arena_allocate_device_private(copy, adt->arena, 1, 0, adt->opaque_dtt) ) {
+            for( dep = 0; dep < current_dep; dep++ ) {
+                if( !((1U << dep) & allocated) ) continue;
+                copy = current_task->super.data[dep].data_in;
+                parsec_arena_release_device_private(copy);
+                copy->device_private = PARSEC_DATA_CREATE_ON_DEMAND;
+            }
+            /* hold the task back until the arena releases some memory */
+            return parsec_arena_defer_task(es, adt->arena, 1, 0, this_task);
+        }
+        allocated |= (1U << current_dep);
+    }
+
     return PARSEC_HOOK_RETURN_DONE;
 }
 
@@ -2402,6 +2419,18 @@ int parsec_dtd_task_class_add_chore(parsec_taskpool_t *tp,
     return PARSEC_SUCCESS;
 }
 
+int parsec_dtd_task_class_set_deadline(parsec_task_class_t *tc,
+                                       parsec_task_deadline_fct_t *deadline)
+{
+    if( tc->task_class_type != PARSEC_TASK_CLASS_TYPE_DTD ) {
+        parsec_warning("Called parsec_dtd_task_class_set_deadline on a non-DTD task class '%s'\n",
+                       tc->name);
+        return PARSEC_ERR_BAD_PARAM;
+    }
+    tc->deadline = deadline;
+    return PARSEC_SUCCESS;
+}
+
 static void
 parsec_dtd_destroy_task_class(parsec_dtd_taskpool_t *dtd_tp, parsec_task_class_t *tc)
 {
@@ -391,6 +391,15 @@ int parsec_dtd_task_class_add_chore(parsec_taskpool_t *tp,
                                     int device_type,
                                     void *function);
 
+/**
+ * Set the function returning the absolute deadline of the tasks of a
+ * task class (see parsec_task_deadline_fct_t). The function receives the
+ * DTD task, and can read its parameters with parsec_dtd_unpack_args().
+ * Passing NULL removes the deadlines of the task class.
+ */
+int parsec_dtd_task_class_set_deadline(parsec_task_class_t *tc,
+                                       parsec_task_deadline_fct_t *deadline);
+
 void
 parsec_dtd_insert_task_with_task_class(parsec_taskpool_t *tp,
                                        parsec_task_class_t *tc, int priority,
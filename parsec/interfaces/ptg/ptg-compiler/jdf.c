@@ -32,6 +32,7 @@ static char *FUNCTION_PROPERTY_KEYWORDS[] = {
     JDF_PROP_UD_ALLOC_DEPS_FN_NAME,
     JDF_PROP_UD_FREE_DEPS_FN_NAME,
     "time_estimate",
+    "deadline",
     NULL
 };
 
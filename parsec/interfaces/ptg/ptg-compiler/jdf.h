@@ -108,6 +108,7 @@ typedef struct jdf_compiler_global_args {
     int   noline;  /**< Don't dump the jdf line number in the generate .c file */
     struct jdf_name_list *ignore_properties; /**< Properties to ignore */
     int   termdet; /**< What termination detection to use (one of TERMDET_*) */
+    int   auto_priority; /**< Derive the priority of the tasks without one from the critical path */
 } jdf_compiler_global_args_t;
 extern jdf_compiler_global_args_t JDF_COMPILER_GLOBAL_ARGS;
 
@@ -209,6 +210,10 @@ typedef unsigned int jdf_flags_t;
 #define JDF_PROP_TERMDET_DYNAMIC               "dynamic"
 #define JDF_PROP_TERMDET_USER_TRIGGERED        "user-triggered"
 
+/* When set on the JDF, the tasks without a priority get their bottom level
+ * (length of the critical path to the end of the DAG) as priority */
+#define JDF_PROP_AUTO_PRIORITY_NAME            "auto_priority"
+
 #define JDF_BODY_PROP_EVALUATE                 "evaluate"
 #define JDF_BODY_PROP_HOOK                     "hook"
 
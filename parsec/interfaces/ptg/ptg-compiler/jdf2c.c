@@ -41,6 +41,7 @@ static const char *jdf_cfilename;
 static int jdf_expr_depends_on_symbol(const char *varname, const jdf_expr_t *expr);
 static void jdf_generate_code_hooks(const jdf_t *jdf, const jdf_function_entry_t *f, const char *fname);
 static void jdf_generate_code_time_estimate(const jdf_t *jdf, const jdf_function_entry_t *f, char *name);
+static void jdf_generate_code_deadline(const jdf_t *jdf, const jdf_function_entry_t *f, char *name);
 static void jdf_generate_code_data_lookup(const jdf_t *jdf, const jdf_function_entry_t *f, const char *fname);
 static void jdf_generate_code_release_deps(const jdf_t *jdf, const jdf_function_entry_t *f, const char *fname);
 static void jdf_generate_code_iterate_successors_or_predecessors(const jdf_t *jdf, const jdf_function_entry_t *f,
@@ -197,6 +198,17 @@ static void var_to_c_code(jdf_expr_t* expr)
     expr->jdf_c_code.function_context = NULL;
 }
 
+/**
+ * Tasks without a user-defined priority get their bottom level (critical
+ * path) as priority when requested on the command line or in the JDF.
+ */
+static int jdf_function_auto_priority( const jdf_t *jdf, const jdf_function_entry_t *f )
+{
+    if( NULL != f->priority ) return 0;
+    return JDF_COMPILER_GLOBAL_ARGS.auto_priority ||
+        jdf_property_get_int(jdf->global_properties, JDF_PROP_AUTO_PRIORITY_NAME, 0);
+}
+
 static int jdf_uses_dynamic_termdet( const jdf_t *jdf )
 {
     const char *pname = jdf_property_get_string(jdf->global_properties, JDF_PROP_TERMDET_NAME, NULL);
@@ -3187,6 +3199,9 @@ static void jdf_generate_startup_tasks(const jdf_t *jdf, const jdf_function_entr
     if( NULL != f->priority ) {
         coutput("%s  new_task->priority = __parsec_tp->super.super.priority + priority_of_%s_%s_as_expr_fct((__parsec_%s_internal_taskpool_t*)new_task->taskpool, &new_task->locals);\n",
                 indent(nesting), jdf_basename, f->fname, jdf_basename);
+    } else if( jdf_function_auto_priority(jdf, f) ) {
+        coutput("%s  new_task->priority = __parsec_tp->super.super.priority + parsec_critical_path_priority((parsec_taskpool_t*)__parsec_tp, new_task->task_class, (const parsec_assignment_t*)&new_task->locals);\n",
+                indent(nesting));
     } else {
         coutput("%s  new_task->priority = __parsec_tp->super.super.priority;\n", indent(nesting));
     }
@@ -3334,6 +3349,27 @@ static jdf_param_list_t *local_is_parameter(const jdf_function_entry_t *f, const
     return NULL;
 }
 
+/**
+ * Returns true if the keys generated by make_key for the task class are a
+ * dense index in the box of its parameter ranges: every parameter is a
+ * range (whose bounds may be affine in the previous parameters), and the
+ * user does not provide the key functions.
+ */
+static int jdf_function_has_boxed_space(const jdf_function_entry_t *f)
+{
+    const jdf_variable_list_t *vl;
+
+    if( (NULL == f->parameters) ||
+        (0 != (f->user_defines & (JDF_FUNCTION_HAS_UD_MAKE_KEY | JDF_FUNCTION_HAS_UD_HASH_STRUCT))) )
+        return 0;
+    for(vl = f->locals; vl != NULL; vl = vl->next) {
+        if( (NULL != local_is_parameter(f, vl)) &&
+            ((JDF_RANGE != vl->expr->op) || (NULL != vl->expr->local_variables)) )
+            return 0;
+    }
+    return 1;
+}
+
 static  void jdf_generate_deps_key_functions(const jdf_t *jdf, const jdf_function_entry_t *f, const char *sname)
 {
     jdf_variable_list_t *vl;
@@ -3809,10 +3845,27 @@ static void jdf_generate_internal_init(const jdf_t *jdf, const jdf_function_entr
      * - the own tasks use it when reshaping a datacopy directly read from desc
      * No longer only when if( !(f->flags & JDF_FUNCTION_FLAG_NO_SUCCESSORS) )
      */
-    coutput("  __parsec_tp->repositories[%d] = data_repo_create_nothreadsafe(%s, %s, (parsec_taskpool_t*)__parsec_tp, %d);\n",
-            f->task_class_id, need_to_count_tasks ? "nb_tasks" : "PARSEC_DEFAULT_DATAREPO_HASH_LENGTH",
-            jdf_property_get_string(f->properties, JDF_PROP_UD_HASH_STRUCT_NAME, NULL),
-            idx );
+    if( jdf_function_has_boxed_space(f) ) {
+        /* The keys are a dense index in the box of the parameter ranges:
+         * the repo can be directly indexed by the keys */
+        coutput("  {\n"
+                "    uint64_t nb_keys = 1;\n");
+        for(l2p_item = l2p; NULL != l2p_item; l2p_item = l2p_item->next) {
+            if( NULL == (pl = l2p_item->pl) ) continue;
+            coutput("    nb_keys *= (uint64_t)parsec_imax(__parsec_tp->%s_%s_range, 0);\n",
+                    f->fname, pl->name);
+        }
+        coutput("    __parsec_tp->repositories[%d] = data_repo_create_dense(nb_keys, %s, %s, (parsec_taskpool_t*)__parsec_tp, %d);\n"
+                "  }\n",
+                f->task_class_id, need_to_count_tasks ? "nb_tasks" : "PARSEC_DEFAULT_DATAREPO_HASH_LENGTH",
+                jdf_property_get_string(f->properties, JDF_PROP_UD_HASH_STRUCT_NAME, NULL),
+                idx );
+    } else {
+        coutput("  __parsec_tp->repositories[%d] = data_repo_create_nothreadsafe(%s, %s, (parsec_taskpool_t*)__parsec_tp, %d);\n",
+                f->task_class_id, need_to_count_tasks ? "nb_tasks" : "PARSEC_DEFAULT_DATAREPO_HASH_LENGTH",
+                jdf_property_get_string(f->properties, JDF_PROP_UD_HASH_STRUCT_NAME, NULL),
+                idx );
+    }
 
     coutput("%s"
             "  %s (void)__parsec_tp; (void)es;\n",
@@ -4327,6 +4380,9 @@ static void jdf_generate_one_function( const jdf_t *jdf, jdf_function_entry_t *f
     sprintf(prefix, "time_estimate_of_%s_%s", jdf_basename, f->fname);
     jdf_generate_code_time_estimate(jdf, f, prefix);
     string_arena_add_string(sa, "  .time_estimate = %s,\n", prefix);
+    sprintf(prefix, "deadline_of_%s_%s", jdf_basename, f->fname);
+    jdf_generate_code_deadline(jdf, f, prefix);
+    string_arena_add_string(sa, "  .deadline = %s,\n", prefix);
     sprintf(prefix, "datatype_lookup_of_%s_%s", jdf_basename, f->fname);
     jdf_generate_code_datatype_lookup(jdf, f, prefix);
     string_arena_add_string(sa, "  .get_datatype = %s,\n", prefix);
@@ -5462,6 +5518,73 @@ jdf_generate_code_consume_predecessor_setup(const jdf_t *jdf, const jdf_call_t *
     }
 }
 
+/**
+ * Returns 1 if the data lookup of the flow may allocate a NEW copy from an
+ * arena: pure outputs always do, other flows when one of their input deps
+ * is NEW.
+ */
+static int jdf_flow_may_be_new(const jdf_dataflow_t *flow)
+{
+    const jdf_dep_t *dl;
+
+    if( JDF_FLOW_TYPE_CTL & flow->flow_flags )
+        return 0;
+    if( !(JDF_FLOW_TYPE_READ & flow->flow_flags) )
+        return !!(JDF_FLOW_TYPE_WRITE & flow->flow_flags);
+    for(dl = flow->deps; dl != NULL; dl = dl->next) {
+        if( dl->dep_flags & JDF_DEP_FLOW_OUT ) continue;
+        if( (NULL != dl->guard->calltrue) && JDF_IS_CALL_WITH_NO_INPUT(dl->guard->calltrue) &&
+            (0 == strcmp(PARSEC_WRITE_MAGIC_NAME, dl->guard->calltrue->func_or_mem)) )
+            return 1;
+        if( (NULL != dl->guard->callfalse) && JDF_IS_CALL_WITH_NO_INPUT(dl->guard->callfalse) &&
+            (0 == strcmp(PARSEC_WRITE_MAGIC_NAME, dl->guard->callfalse->func_or_mem)) )
+            return 1;
+    }
+    return 0;
+}
+
+/**
+ * Generates the code holding the task back when the NEW copy of a flow does
+ * not fit in its arena. The NEW copies the other flows already got (their
+ * fulfill flag is 2) are given back first, so that a task waiting for memory
+ * never holds any: two tasks each holding a part of their outputs could
+ * otherwise wait for each other forever. They are allocated again when the
+ * task is resumed.
+ */
+static void jdf_generate_code_defer_task(const jdf_function_entry_t *f, const jdf_dataflow_t *flow,
+                                         const char *arena, const char *count,
+                                         const char *spaces)
+{
+    const jdf_dataflow_t *fl;
+    int given_back = 0;
+
+    coutput("%s    if( NULL == chunk ) {  /* hold the task back until some memory is released */\n",
+            spaces);
+    for( fl = f->dataflow; fl != NULL; fl = fl->next ) {
+        if( (fl == flow) || !jdf_flow_may_be_new(fl) ) continue;
+        if( !given_back ) {
+            coutput("%s      size_t given_back = 0;\n", spaces);
+            given_back = 1;
+        }
+        coutput("%s      if( 2 == this_task->data._f_%s.fulfill ) {  /* give back the new copy of %s */\n"
+                "%s        given_back += parsec_arena_copy_bytes(this_task->data._f_%s.data_in);\n"
+                "%s        PARSEC_DATA_COPY_RELEASE(this_task->data._f_%s.data_in);\n"
+                "%s        this_task->data._f_%s.data_in = this_task->data._f_%s.data_out = NULL;\n"
+                "%s        this_task->data._f_%s.fulfill = 0;\n"
+                "%s      }\n",
+                spaces, fl->varname, fl->varname,
+                spaces, fl->varname,
+                spaces, fl->varname,
+                spaces, fl->varname, fl->varname,
+                spaces, fl->varname,
+                spaces);
+    }
+    coutput("%s      return parsec_arena_defer_task(es, %s, %s, %s, (parsec_task_t*)this_task);\n"
+            "%s    }\n",
+            spaces, arena, count, given_back ? "given_back" : "0",
+            spaces);
+}
+
 static void
 jdf_generate_code_call_initialization(const jdf_t *jdf, const jdf_call_t *call,
                                       const jdf_function_entry_t* f, const jdf_dataflow_t *flow,
@@ -5593,12 +5716,18 @@ jdf_generate_code_call_initialization(const jdf_t *jdf, const jdf_call_t *call,
                 assert( dl->datatype_local.count != NULL );
                 string_arena_add_string(sa2, "%s", dump_expr((void**)dl->datatype_local.count, &info));
 
-                coutput("%s    chunk = parsec_arena_get_copy(%s->arena, %s, target_device, %s->opaque_dtt);\n"
-                        "%s    chunk->original->owner_device = target_device;\n"
-                        "%s    this_task->data._f_%s.data_out = chunk;\n",
+                coutput("%s    chunk = parsec_arena_get_copy_budget(%s->arena, %s, target_device, %s->opaque_dtt,\n"
+                        "%s                                         this_task->taskpool->arena_budget);\n",
                         spaces, string_arena_get_string(sa), string_arena_get_string(sa2), string_arena_get_string(sa),
+                        spaces);
+                string_arena_add_string(sa, "->arena");
+                jdf_generate_code_defer_task(f, flow, string_arena_get_string(sa), string_arena_get_string(sa2), spaces);
+                coutput("%s    chunk->original->owner_device = target_device;\n"
+                        "%s    this_task->data._f_%s.data_out = chunk;\n"
+                        "%s    new_copy = 1;\n",
                         spaces,
-                        spaces, flow->varname);
+                        spaces, flow->varname,
+                        spaces);
 
                 string_arena_free(info.sa);
             }
@@ -5642,6 +5771,7 @@ jdf_generate_code_call_initialization(const jdf_t *jdf, const jdf_call_t *call,
  * will be followed upon completion.
  */
 static void jdf_generate_code_call_init_output(const jdf_t *jdf, const jdf_call_t *call,
+                                               const jdf_function_entry_t *f,
                                                const jdf_dataflow_t *flow, const char *fname,
                                                const jdf_dep_t *dl,
                                                const char *spaces)
@@ -5703,13 +5833,19 @@ static void jdf_generate_code_call_init_output(const jdf_t *jdf, const jdf_call_
              spaces, flow->varname,
              spaces);
 
-    coutput("%s    chunk = parsec_arena_get_copy(%s->arena, %s, target_device, %s);\n"
-            "%s    chunk->original->owner_device = target_device;\n",
+    coutput("%s    chunk = parsec_arena_get_copy_budget(%s->arena, %s, target_device, %s,\n"
+            "%s                                         this_task->taskpool->arena_budget);\n",
             spaces, string_arena_get_string(sa_arena), string_arena_get_string(sa_count), string_arena_get_string(sa_datatype),
             spaces);
-    coutput("%s    this_task->data._f_%s.data_out = chunk;\n"
+    string_arena_add_string(sa_arena, "->arena");
+    jdf_generate_code_defer_task(f, flow, string_arena_get_string(sa_arena), string_arena_get_string(sa_count), spaces);
+    coutput("%s    chunk->original->owner_device = target_device;\n"
+            "%s    this_task->data._f_%s.data_out = chunk;\n"
+            "%s    new_copy = 1;\n"
             "%s  }\n",
+            spaces,
             spaces, flow->varname,
+            spaces,
             spaces);
 
 #if defined(PARSEC_DEBUG_NOISIER) || defined(PARSEC_DEBUG_PARANOID)
@@ -5759,7 +5895,8 @@ static void jdf_generate_code_flow_initialization(const jdf_t *jdf,
     coutput("  consumed_repo = NULL;\n"
             "  consumed_entry_key = 0;\n"
             "  consumed_entry = NULL;\n"
-            "  chunk = NULL;\n");
+            "  chunk = NULL;\n"
+            "  new_copy = 0;\n");
     
     for(dl = flow->deps; dl != NULL; dl = dl->next) {
         if ( dl->dep_flags & JDF_DEP_FLOW_OUT ) {
@@ -5835,22 +5972,22 @@ static void jdf_generate_code_flow_initialization(const jdf_t *jdf,
             switch( dl->guard->guard_type ) {
             case JDF_GUARD_UNCONDITIONAL:
                 if( 0 != cond_index ) coutput("    else {\n");
-                jdf_generate_code_call_init_output(jdf, dl->guard->calltrue, flow, f->fname, dl, "  ");
+                jdf_generate_code_call_init_output(jdf, dl->guard->calltrue, f, flow, f->fname, dl, "  ");
                 if( 0 != cond_index ) coutput("    }\n");
                 goto done_with_input;
             case JDF_GUARD_BINARY:
                 coutput( (0 == cond_index ? condition[0] : condition[1]),
                          dump_expr((void**)dl->guard->guard, &info));
-                jdf_generate_code_call_init_output(jdf, dl->guard->calltrue, flow, f->fname, dl, "  ");
+                jdf_generate_code_call_init_output(jdf, dl->guard->calltrue, f, flow, f->fname, dl, "  ");
                 coutput("    }\n");
                 cond_index++;
                 break;
             case JDF_GUARD_TERNARY:
                 coutput( (0 == cond_index ? condition[0] : condition[1]),
                          dump_expr((void**)dl->guard->guard, &info));
-                jdf_generate_code_call_init_output(jdf, dl->guard->calltrue, flow, f->fname, dl, "  ");
+                jdf_generate_code_call_init_output(jdf, dl->guard->calltrue, f, flow, f->fname, dl, "  ");
                 coutput("    } else {\n");
-                jdf_generate_code_call_init_output(jdf, dl->guard->callfalse, flow, f->fname, dl, "  ");
+                jdf_generate_code_call_init_output(jdf, dl->guard->callfalse, f, flow, f->fname, dl, "  ");
                 coutput("    }\n");
                 goto done_with_input;
             }
@@ -5877,7 +6014,8 @@ static void jdf_generate_code_flow_initialization(const jdf_t *jdf,
                 flow->varname,
                 flow->flow_index);
     }
-    coutput("    this_task->data._f_%s.fulfill = 1;\n"
+    /* 2 when the flow holds a NEW copy, given back if the task is held back */
+    coutput("    this_task->data._f_%s.fulfill = 1 + new_copy;\n"
             "}\n\n",
             flow->varname);/*    coutput("if(! this_task->data._f_%s.fulfill ){\n", flow->varname);*/
 
@@ -6437,6 +6575,24 @@ jdf_generate_code_time_estimate(const jdf_t *jdf,
     sprintf(name, "NULL");
 }
 
+static void
+jdf_generate_code_deadline(const jdf_t *jdf,
+                           const jdf_function_entry_t *f,
+                           char *name)
+{
+    jdf_def_list_t *prop = NULL;
+
+    (void)jdf;
+
+    jdf_find_property(f->properties, "deadline", &prop);
+    if(NULL != prop) {
+        sprintf(name, "%s", prop->expr->jdf_var);
+        return;
+    }
+
+    sprintf(name, "NULL");
+}
+
 static void
 jdf_generate_code_data_lookup(const jdf_t *jdf,
                               const jdf_function_entry_t *f,
@@ -6464,11 +6620,11 @@ jdf_generate_code_data_lookup(const jdf_t *jdf,
             "  parsec_key_t        reshape_entry_key = 0, consumed_entry_key = 0;\n"
             "  uint8_t             consumed_flow_index;\n"
             "  parsec_dep_data_description_t data;\n"
-            "  int ret;\n"
+            "  int ret, new_copy = 0;\n"
             "  (void)reshape_repo; (void)reshape_entry; (void)reshape_entry_key;\n"
             "  (void)consumed_repo; (void)consumed_entry; (void)consumed_entry_key;\n"
             "  (void)consumed_flow_index;\n"
-            "  (void)chunk; (void)data; (void)ret;\n"
+            "  (void)chunk; (void)data; (void)ret; (void)new_copy;\n"
             "%s",
             name, parsec_get_name(jdf, f, "task_t"),
             jdf_basename, jdf_basename,
@@ -7545,6 +7701,16 @@ static char *jdf_dump_context_assignment(string_arena_t *sa_open,
         string_arena_add_string(sa_open,
                                 "%s%s  %s.priority = __parsec_tp->super.super.priority + priority_of_%s_%s_as_expr_fct(__parsec_tp, &ncc->locals);\n",
                                 prefix, indent(nbopen), var, jdf_basename, targetf->fname);
+    } else if( jdf_function_auto_priority(jdf, targetf) ) {
+        /* Only the successors that are released need a priority. This also
+         * prevents the critical path exploration from recursing. */
+        string_arena_add_string(sa_open,
+                                "%s%s  %s.priority = __parsec_tp->super.super.priority;\n"
+                                "%s%s  if( action_mask & PARSEC_ACTION_RELEASE_LOCAL_DEPS )\n"
+                                "%s%s    %s.priority += parsec_critical_path_priority((parsec_taskpool_t*)__parsec_tp, %s.task_class, (const parsec_assignment_t*)&%s.locals);\n",
+                                prefix, indent(nbopen), var,
+                                prefix, indent(nbopen),
+                                prefix, indent(nbopen), var, var, var);
     } else {
         string_arena_add_string(sa_open, "%s%s  %s.priority = __parsec_tp->super.super.priority;\n",
                                 prefix, indent(nbopen), var);
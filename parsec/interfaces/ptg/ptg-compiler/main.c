@@ -35,6 +35,7 @@ static jdf_compiler_global_args_t DEFAULTS = {
     .compile = 1,  /* by default the file must be compiled */
     .dep_management = DEP_MANAGEMENT_DYNAMIC_HASH_TABLE,
     .termdet = TERMDET_DEFAULT,
+    .auto_priority = 0,
 #if defined(PARSEC_HAVE_INDENT) && !defined(PARSEC_HAVE_AWK)
     .noline = 1, /*< By default, don't print the #line per default if can't fix the line numbers with awk */
 #else
@@ -74,6 +75,10 @@ static void usage(void)
             "                     detection continue to rely on user-trigger termination detection.\n"
             "                     (default: use local termination detection)\n"
             "\n"
+            "  --auto-priority    Give the tasks without a user-defined priority the bottom\n"
+            "                     level of the task in the DAG (critical path priority), as\n"
+            "                     the global property '"JDF_PROP_AUTO_PRIORITY_NAME"' does\n"
+            "\n"
             "  --noline           Do not dump the JDF line number in the .c output file\n"
             "  --line             Force dumping the JDF line number in the .c output file\n"
             "                     Default: %s\n"
@@ -195,6 +200,7 @@ static void parse_args(int argc, char *argv[])
         { "force-profile", no_argument,             NULL,   2  },
         { "ignore-properties", required_argument,   NULL,  'I' },
         { "dynamic-termdet", no_argument,           NULL,  'D' },
+        { "auto-priority", no_argument,             NULL,   3  },
         { NULL,            0,                       NULL,   0  }
     };
 
@@ -251,6 +257,9 @@ static void parse_args(int argc, char *argv[])
         case 2:
             add_to_ignore_properties("profile");
             break;
+        case 3:
+            JDF_COMPILER_GLOBAL_ARGS.auto_priority = 1;
+            break;
         case 'E':
             /* Don't compile the preprocessed file, instead stop after the preprocessing stage */
             JDF_COMPILER_GLOBAL_ARGS.compile = 0;
@@ -140,18 +140,19 @@ mca_base_component_t **mca_components_open_bytype(char *type)
     return opened_components;
 }
 
-mca_base_component_t *mca_component_open_byname(char *type, char *name)
+static mca_base_component_t *mca_component_open_byname_internal(char *type, char *name, int check_user_list)
 {
     int i;
     mca_base_component_t *component = NULL;
-    char **list;
+    char **list = NULL;
 
-    list = mca_components_get_user_selection(type);
+    if( check_user_list )
+        list = mca_components_get_user_selection(type);
 
     for(i = 0; mca_static_components[i] != NULL; i++) {
         if( !strcmp( mca_static_components[i]->mca_type_name, type ) &&
             !strcmp( mca_static_components[i]->mca_component_name, name) &&
-            mca_components_belongs_to_user_list(list, mca_static_components[i]->mca_component_name) ) {
+            (!check_user_list || mca_components_belongs_to_user_list(list, mca_static_components[i]->mca_component_name)) ) {
             component = mca_static_components[i];
             break;
         }
@@ -168,6 +169,16 @@ mca_base_component_t *mca_component_open_byname(char *type, char *name)
     return component;
 }
 
+mca_base_component_t *mca_component_open_byname(char *type, char *name)
+{
+    return mca_component_open_byname_internal(type, name, 1);
+}
+
+mca_base_component_t *mca_component_open_byname_any(char *type, char *name)
+{
+    return mca_component_open_byname_internal(type, name, 0);
+}
+
 void mca_components_query(mca_base_component_t **opened_components,
                           mca_base_module_t **selected_module,
                           mca_base_component_t **selected_component)
@@ -13,6 +13,15 @@ void mca_components_free_user_list(char **list);
 char *mca_components_list_compiled(char* type_name);
 mca_base_component_t **mca_components_open_bytype(char *type);
 mca_base_component_t *mca_component_open_byname(char *type, char *name);
+/**
+ * @brief Opens a component by name, even if the user selection for this
+ *   type of components (mca_<type>) excludes it
+ *
+ * @details Used by components that host other components of the same type
+ *   (e.g. the auto scheduler, which is the only scheduler selected by the
+ *   user, but runs the schedulers listed in its own parameters).
+ */
+mca_base_component_t *mca_component_open_byname_any(char *type, char *name);
 
 /**
  * @brief Queries which component in a list of opened components can be
@@ -77,6 +77,8 @@ int parsec_pins_register_callback(struct parsec_execution_stream_s* es,
 
     cb_event->cb_func = cb_func;
     cb_event->cb_data = cb_data;
+    /* A registered callback is useless unless the corresponding event is triggered */
+    parsec_pins_enable_mask |= PARSEC_PINS_FLAG_MASK(method_flag);
 
     return PARSEC_SUCCESS;
 }
@@ -57,7 +57,7 @@ typedef enum PARSEC_PINS_FLAG {
 extern uint64_t parsec_pins_enable_mask;
 extern const char *parsec_pins_enable_default_names;
 
-#define PARSEC_PINS_FLAG_MASK(_flag) ((_flag)>>1)
+#define PARSEC_PINS_FLAG_MASK(_flag) (((uint64_t)1) << ((_flag)>>1))
 #define PARSEC_PINS_FLAG_ENABLED(_flag) (parsec_pins_enable_mask & PARSEC_PINS_FLAG_MASK(_flag))
 
 BEGIN_C_DECLS
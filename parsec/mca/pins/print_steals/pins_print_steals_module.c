@@ -26,6 +26,17 @@ const parsec_pins_module_t parsec_pins_print_steals_module = {
     { NULL }
 };
 
+/**
+ * Each execution stream counts the tasks it selected, indexed by the
+ * distance reported by the scheduler. For schedulers that steal from a
+ * hierarchy of queues this distance describes how far the victim was
+ * (0 being the local queue), so the counters report the locality of the
+ * steals. The next counter accounts for the selections that did not
+ * return any task. The last two counters account for the tasks obtained
+ * by hand-off from a completing predecessor (es->next_task), which are
+ * not counted per distance, and for the longest chain of consecutive
+ * hand-offs.
+ */
 typedef struct parsec_pins_print_steals_data_s {
     parsec_pins_next_callback_t cb_data;
     long steal_counters[1];
@@ -35,10 +46,6 @@ static void stop_print_steals_count(parsec_execution_stream_t* es,
                                     parsec_task_t* task,
                                     parsec_pins_next_callback_t* data);
 
-#define THREAD_NUM(exec_unit) (exec_unit->virtual_process->vp_id *      \
-                               exec_unit->virtual_process->parsec_context->nb_vp + \
-                               exec_unit->th_id )
-
 static int total_cores;
 
 static void pins_init_print_steals(parsec_context_t* master)
@@ -50,7 +57,7 @@ static void pins_thread_init_print_steals(parsec_execution_stream_t* es)
 {
     parsec_pins_print_steals_data_t* event_cb =
         (parsec_pins_print_steals_data_t*)calloc(1, sizeof(parsec_pins_print_steals_data_t) +
-                                                 (total_cores + 2) * sizeof(long));
+                                                 (total_cores + 4) * sizeof(long));
     PARSEC_PINS_REGISTER(es, SELECT_END, stop_print_steals_count,
                   (parsec_pins_next_callback_t*)event_cb);
 }
@@ -61,7 +68,8 @@ static void pins_thread_fini_print_steals(parsec_execution_stream_t* es)
     PARSEC_PINS_UNREGISTER(es, SELECT_END, stop_print_steals_count,
                   (parsec_pins_next_callback_t**)&event_cb);
 
-    for (int k = 0; k < total_cores + 2; k++)
+    printf("%d:%d ", es->virtual_process->vp_id, es->th_id);
+    for (int k = 0; k < total_cores + 4; k++)
         printf("%7ld ", event_cb->steal_counters[k]);
     printf("\n");
     free(event_cb);
@@ -72,15 +80,17 @@ static void stop_print_steals_count(parsec_execution_stream_t* es,
                                     parsec_pins_next_callback_t* data)
 {
     parsec_pins_print_steals_data_t* event_cb = (parsec_pins_print_steals_data_t*)data;
-    /**
-     * This is plain wrong and it could not have been working.
-     */
-    unsigned long long victim_core_num = 0;
+    int distance;
 
-    if (task != NULL)
-        event_cb->steal_counters[victim_core_num] += 1;
-    else
-        event_cb->steal_counters[victim_core_num + 1] += 1;
-    (void)es;
+    if (task != NULL && es->handoff_depth > 0) {
+        event_cb->steal_counters[total_cores + 2] += 1;
+        if( es->handoff_depth > event_cb->steal_counters[total_cores + 3] )
+            event_cb->steal_counters[total_cores + 3] = es->handoff_depth;
+    } else if (task != NULL) {
+        distance = es->select_distance;
+        if( distance < 0 ) distance = 0;
+        if( distance > total_cores ) distance = total_cores;
+        event_cb->steal_counters[distance] += 1;
+    } else
+        event_cb->steal_counters[total_cores + 1] += 1;
 }
-
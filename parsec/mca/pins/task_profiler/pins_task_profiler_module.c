@@ -104,7 +104,7 @@ static void pins_init_task_profiler(parsec_context_t *master_context)
         char *event = events[i];
         PARSEC_PINS_FLAG flag = parsec_pins_name_to_begin_flag(event);
         if (flag < PARSEC_PINS_FLAG_COUNT) {
-            parsec_pins_enable_mask |= flag;
+            parsec_pins_enable_mask |= PARSEC_PINS_FLAG_MASK(flag);
         }
         free(event);
         ++i;
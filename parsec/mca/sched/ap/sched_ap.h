@@ -35,6 +35,12 @@ PARSEC_DECLSPEC extern const parsec_sched_module_t parsec_sched_ap_module;
 /* static accessor */
 mca_base_component_t *sched_ap_static_component(void);
 
+/**
+ * If not zero, each execution stream keeps the tasks it schedules
+ * locally in its own work-stealing deque, in front of the shared queue.
+ */
+extern int sched_ap_owner_deque;
+
 
 END_C_DECLS
 #endif /* MCA_SCHED_AP_H */
@@ -0,0 +1,107 @@
+/*
+ * Copyright (c) 2023      The University of Tennessee and The University
+ *                         of Tennessee Research Foundation.  All rights
+ *                         reserved.
+ * $COPYRIGHT$
+ * 
+ * Additional copyrights may follow
+ * 
+ * $HEADER$
+ */
+
+/**
+ * @file
+ *
+ * Auto scheduler: a meta-scheduler that installs several candidate
+ * schedulers side by side, forwards the scheduling operations to one of
+ * them, and measures through PINS how efficiently the execution streams
+ * find work (time spent selecting versus executing tasks, steals, number
+ * of ready tasks). At the end of each parsec_context_wait, when the
+ * context is quiescent, it may switch to another candidate: it first
+ * measures each candidate over one window, then keeps the most efficient
+ * one until its efficiency drops, at which point it explores again.
+ *
+ */
+
+
+#ifndef MCA_SCHED_AUTO_H
+#define MCA_SCHED_AUTO_H
+
+#include "parsec/parsec_config.h"
+#include "parsec/mca/mca.h"
+#include "parsec/mca/sched/sched.h"
+
+
+BEGIN_C_DECLS
+
+/**
+ * Globally exported variable
+ */
+PARSEC_DECLSPEC extern const parsec_sched_base_component_t parsec_sched_auto_component;
+PARSEC_DECLSPEC extern const parsec_sched_module_t parsec_sched_auto_module;
+/* static accessor */
+mca_base_component_t *sched_auto_static_component(void);
+
+/**
+ * Comma-separated list of the candidate schedulers, the first one is
+ * active initially.
+ */
+extern char *sched_auto_candidates;
+/**
+ * Minimal number of executed tasks in a measurement window. A window
+ * spans as many parsec_context_wait as needed to reach it.
+ */
+extern int sched_auto_window;
+/**
+ * Drop of efficiency (in percent of the reference) of the selected
+ * candidate that triggers a new exploration of all the candidates.
+ */
+extern int sched_auto_tolerance;
+/**
+ * Report each measurement window and each switch.
+ */
+extern int sched_auto_verbose;
+
+/**
+ * Maximal number of candidate schedulers
+ */
+#define PARSEC_SCHED_AUTO_MAX_CANDIDATES 16
+
+/**
+ * State of the auto scheduler, and telemetry of the last measurement
+ * window
+ */
+typedef struct parsec_sched_auto_stats_s {
+    const char *active;         /**< Name of the active candidate */
+    int         nb_candidates;  /**< Number of candidate schedulers */
+    int         exploring;      /**< Whether the candidates are being measured */
+    int         nb_switches;    /**< Number of changes of the active candidate */
+    int         nb_windows;     /**< Number of completed measurement windows */
+    double      efficiency;     /**< Last window: fraction of the time of the execution
+                                 *   streams spent executing tasks rather than selecting them */
+    double      steal_ratio;    /**< Last window: fraction of the tasks selected at a
+                                 *   non-zero distance */
+    double      avg_ready;      /**< Last window: average number of ready tasks in the
+                                 *   scheduler of a virtual process, when a task is selected */
+    uint64_t    nb_tasks;       /**< Last window: number of tasks executed */
+    double      candidate_efficiency[PARSEC_SCHED_AUTO_MAX_CANDIDATES];
+                                /**< Last measured efficiency of each candidate, negative
+                                 *   if it was never measured */
+    const char *candidates[PARSEC_SCHED_AUTO_MAX_CANDIDATES];
+                                /**< Names of the candidates */
+} parsec_sched_auto_stats_t;
+
+/**
+ * @brief Get the state of the auto scheduler
+ *
+ * @param[in] context the parsec context
+ * @param[out] stats the state of the scheduler and the telemetry of the
+ *             last measurement window
+ * @return PARSEC_SUCCESS, or PARSEC_ERR_NOT_FOUND if the auto scheduler is
+ *         not in use.
+ */
+PARSEC_DECLSPEC int parsec_sched_auto_stats(parsec_context_t *context,
+                                            parsec_sched_auto_stats_t *stats);
+
+END_C_DECLS
+#endif /* MCA_SCHED_AUTO_H */
@@ -0,0 +1,108 @@
+/*
+ * Copyright (c) 2023      The University of Tennessee and The University
+ *                         of Tennessee Research Foundation.  All rights
+ *                         reserved.
+ * $COPYRIGHT$
+ * 
+ * Additional copyrights may follow
+ * 
+ * $HEADER$
+ *
+ * These symbols are in a file by themselves to provide nice linker
+ * semantics.  Since linkers generally pull in symbols by object
+ * files, keeping these symbols as the only symbols in this file
+ * prevents utility programs such as "ompi_info" from having to import
+ * entire components just to query their version and parameters.
+ */
+
+#include "parsec/parsec_config.h"
+#include "parsec/runtime.h"
+
+#include "parsec/mca/sched/sched.h"
+#include "parsec/mca/sched/auto/sched_auto.h"
+#include "parsec/utils/mca_param.h"
+
+char *sched_auto_candidates = NULL;
+int sched_auto_window = 2000;
+int sched_auto_tolerance = 10;
+int sched_auto_verbose = 0;
+
+/*
+ * Local function
+ */
+static int sched_auto_component_query(mca_base_module_t **module, int *priority);
+static int sched_auto_component_register(void);
+
+/*
+ * Instantiate the public struct with all of our public information
+ * and pointers to our public functions in it
+ */
+const parsec_sched_base_component_t parsec_sched_auto_component = {
+
+    /* First, the mca_component_t struct containing meta information
+       about the component itself */
+
+    {
+        PARSEC_SCHED_BASE_VERSION_2_0_0,
+
+        /* Component name and version */
+        "auto",
+        "", /* options */
+        PARSEC_VERSION_MAJOR,
+        PARSEC_VERSION_MINOR,
+
+        /* Component open and close functions */
+        NULL, /*< No open: sched_auto is always available, no need to check at runtime */
+        NULL, /*< No close: open did not allocate any resource, no need to release them */
+        sched_auto_component_query, 
+        /*< specific query to return the module and add it to the list of available modules */
+        sched_auto_component_register,
+        "", /*< no reserve */
+    },
+    {
+        /* The component has no metada */
+        MCA_BASE_METADATA_PARAM_NONE,
+        "", /*< no reserve */
+    }
+};
+
+mca_base_component_t *sched_auto_static_component(void)
+{
+    return (mca_base_component_t *)&parsec_sched_auto_component;
+}
+
+static int sched_auto_component_query(mca_base_module_t **module, int *priority)
+{
+    /* module type should be: const mca_base_module_t ** */
+    void *ptr = (void*)&parsec_sched_auto_module;
+    *priority = 0;
+    *module = (mca_base_module_t *)ptr;
+    return MCA_SUCCESS;
+}
+
+static int sched_auto_component_register(void)
+{
+    if( NULL != sched_auto_candidates ) {
+        free(sched_auto_candidates);
+        sched_auto_candidates = NULL;
+    }
+    parsec_mca_param_reg_string_name("sched_auto", "candidates",
+                                     "Comma-separated list of the schedulers the auto scheduler chooses from. "
+                                     "The first one is used until the first measurement window completes",
+                                     false, false, "lfq,ll,ap,gd", &sched_auto_candidates);
+    parsec_mca_param_reg_int_name("sched_auto", "window",
+                                  "Minimal number of tasks executed before the efficiency of the active scheduler "
+                                  "is evaluated. A window spans as many parsec_context_wait as needed",
+                                  false, false, sched_auto_window, &sched_auto_window);
+    if( sched_auto_window < 1 ) sched_auto_window = 1;
+    parsec_mca_param_reg_int_name("sched_auto", "tolerance",
+                                  "Drop of efficiency (in percent) of the selected scheduler that triggers "
+                                  "a new evaluation of all the candidates",
+                                  false, false, sched_auto_tolerance, &sched_auto_tolerance);
+    if( sched_auto_tolerance < 0 ) sched_auto_tolerance = 0;
+    if( sched_auto_tolerance > 100 ) sched_auto_tolerance = 100;
+    parsec_mca_param_reg_int_name("sched_auto", "verbose",
+                                  "Report the telemetry of each measurement window and each change of scheduler",
+                                  false, false, sched_auto_verbose, &sched_auto_verbose);
+    return MCA_SUCCESS;
+}
@@ -0,0 +1,560 @@
+/**
+ * Copyright (c) 2023      The University of Tennessee and The University
+ *                         of Tennessee Research Foundation.  All rights
+ *                         reserved.
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ *
+ */
+
+#include "parsec/parsec_config.h"
+#include "parsec/parsec_internal.h"
+#include "parsec/utils/debug.h"
+#include "parsec/class/barrier.h"
+#include "parsec/mca/mca_repository.h"
+
+#include "parsec/mca/sched/sched.h"
+#include "parsec/mca/sched/auto/sched_auto.h"
+#include "parsec/mca/pins/pins.h"
+#include "parsec/os-spec-timing.h"
+
+#include <string.h>
+
+/**
+ * Module functions
+ */
+static int sched_auto_install(parsec_context_t* master);
+static int sched_auto_schedule(parsec_execution_stream_t* es,
+                               parsec_task_t* new_context,
+                               int32_t distance);
+static parsec_task_t*
+sched_auto_select(parsec_execution_stream_t *es,
+                  int32_t* distance);
+static int sched_auto_select_batch(parsec_execution_stream_t *es,
+                                   parsec_task_t **tasks,
+                                   int max,
+                                   int32_t* distance);
+static void sched_auto_display_stats(parsec_execution_stream_t* es);
+static void sched_auto_remove(parsec_context_t* master);
+static void sched_auto_quiesce(parsec_context_t* master);
+static int flow_auto_init(parsec_execution_stream_t* es, struct parsec_barrier_t* barrier);
+
+const parsec_sched_module_t parsec_sched_auto_module = {
+    &parsec_sched_auto_component,
+    {
+        sched_auto_install,
+        flow_auto_init,
+        sched_auto_schedule,
+        sched_auto_select,
+        sched_auto_display_stats,
+        sched_auto_remove,
+        sched_auto_select_batch,
+        sched_auto_quiesce
+    }
+};
+
+/**
+ * All the candidates are installed, and each execution stream runs the
+ * flow_init of each of them, so every candidate has its own set of
+ * scheduler objects. Only the objects of the active candidate are
+ * pointed to by the execution streams: switching candidate consists in
+ * swapping all the scheduler_object pointers, which is only done when
+ * the context is quiescent (no ready task, no execution stream in the
+ * scheduler).
+ */
+typedef struct sched_auto_candidate_s {
+    mca_base_component_t        *component;
+    const parsec_sched_module_t *module;
+    void                       **objects;     /**< scheduler_object of each execution stream */
+    double                       efficiency;  /**< Last measure, negative if none */
+} sched_auto_candidate_t;
+
+/**
+ * Telemetry of an execution stream, collected through PINS (time spent
+ * selecting and executing tasks) and by the selection functions (steals
+ * and number of ready tasks).
+ */
+typedef struct sched_auto_es_s {
+    parsec_pins_next_callback_t select_begin_cb;
+    parsec_pins_next_callback_t select_end_cb;
+    parsec_pins_next_callback_t exec_begin_cb;
+    parsec_pins_next_callback_t exec_end_cb;
+    int                         registered;
+    int                         selecting;
+    int                         executing;
+    parsec_time_t               select_start;
+    parsec_time_t               exec_start;
+    uint64_t                    select_time;
+    uint64_t                    exec_time;
+    uint64_t                    nb_executed;
+    uint64_t                    nb_selected;
+    uint64_t                    nb_steals;
+    int64_t                     ready_sum;
+} sched_auto_es_t;
+
+static parsec_context_t       *sched_auto_context = NULL;
+static sched_auto_candidate_t  sched_auto_cands[PARSEC_SCHED_AUTO_MAX_CANDIDATES];
+static int                     sched_auto_nb_candidates = 0;
+static int                     sched_auto_active = 0;
+static int                     sched_auto_nb_es = 0;
+static int                    *sched_auto_vp_offset = NULL;  /**< Index of the first execution stream of each VP */
+static sched_auto_es_t       **sched_auto_es = NULL;
+static int32_t                *sched_auto_nb_ready = NULL;   /**< Ready tasks of each VP */
+
+/* Decision state, only accessed by the master thread at quiescent points */
+static int      sched_auto_exploring = 1;
+static int      sched_auto_nb_switches = 0;
+static int      sched_auto_nb_windows = 0;
+static double   sched_auto_reference = 0.0;
+static uint64_t sched_auto_win_select = 0, sched_auto_win_exec = 0, sched_auto_win_executed = 0;
+static uint64_t sched_auto_win_selected = 0, sched_auto_win_steals = 0;
+static int64_t  sched_auto_win_ready = 0;
+static double   sched_auto_last_efficiency = 0.0, sched_auto_last_steal_ratio = 0.0, sched_auto_last_avg_ready = 0.0;
+static uint64_t sched_auto_last_nb_tasks = 0;
+
+#define SCHED_AUTO_ES_INDEX(es) (sched_auto_vp_offset[(es)->virtual_process->vp_id] + (es)->th_id)
+#define SCHED_AUTO_ES(es)       (sched_auto_es[SCHED_AUTO_ES_INDEX(es)])
+#define SCHED_AUTO_ACTIVE()     (&sched_auto_cands[sched_auto_active].module->module)
+#define SCHED_AUTO_NAME(c)      (sched_auto_cands[(c)].component->mca_component_name)
+
+static int sched_auto_add_candidate(const char *name)
+{
+    mca_base_component_t *component;
+    mca_base_module_t *module;
+    int c;
+
+    if( !strcmp(name, "auto") || ('\0' == name[0]) )
+        return PARSEC_ERR_BAD_PARAM;
+    for( c = 0; c < sched_auto_nb_candidates; c++ ) {
+        if( !strcmp(name, SCHED_AUTO_NAME(c)) )
+            return PARSEC_ERR_EXISTS;
+    }
+    if( PARSEC_SCHED_AUTO_MAX_CANDIDATES == sched_auto_nb_candidates ) {
+        parsec_warning("sched_auto: too many candidate schedulers, %s is ignored", name);
+        return PARSEC_ERR_OUT_OF_RESOURCE;
+    }
+    component = mca_component_open_byname_any("sched", (char*)name);
+    if( NULL == component ) {
+        parsec_warning("sched_auto: unknown scheduler %s is ignored", name);
+        return PARSEC_ERR_NOT_FOUND;
+    }
+    module = mca_component_query(component);
+    if( NULL == module ) {
+        mca_component_close(component);
+        parsec_warning("sched_auto: scheduler %s cannot be used and is ignored", name);
+        return PARSEC_ERR_NOT_FOUND;
+    }
+    c = sched_auto_nb_candidates++;
+    sched_auto_cands[c].component = component;
+    sched_auto_cands[c].module = (const parsec_sched_module_t*)module;
+    sched_auto_cands[c].objects = (void**)calloc(sched_auto_nb_es, sizeof(void*));
+    sched_auto_cands[c].efficiency = -1.0;
+    return PARSEC_SUCCESS;
+}
+
+static int sched_auto_install( parsec_context_t *master )
+{
+    char *list, *name, *saveptr = NULL;
+    int p, c;
+
+    sched_auto_context = master;
+    sched_auto_vp_offset = (int*)malloc(master->nb_vp * sizeof(int));
+    sched_auto_nb_ready = (int32_t*)calloc(master->nb_vp, sizeof(int32_t));
+    for( sched_auto_nb_es = p = 0; p < master->nb_vp; p++ ) {
+        sched_auto_vp_offset[p] = sched_auto_nb_es;
+        sched_auto_nb_es += master->virtual_processes[p]->nb_cores;
+    }
+    sched_auto_es = (sched_auto_es_t**)calloc(sched_auto_nb_es, sizeof(sched_auto_es_t*));
+
+    sched_auto_nb_candidates = 0;
+    if( NULL != sched_auto_candidates ) {
+        list = strdup(sched_auto_candidates);
+        for( name = strtok_r(list, ", ", &saveptr); NULL != name; name = strtok_r(NULL, ", ", &saveptr) )
+            (void)sched_auto_add_candidate(name);
+        free(list);
+    }
+    if( 0 == sched_auto_nb_candidates ) {
+        (void)sched_auto_add_candidate("lfq");
+        if( 0 == sched_auto_nb_candidates ) {
+            parsec_fatal("sched_auto: no candidate scheduler can be used");
+            return PARSEC_ERR_NOT_FOUND;
+        }
+    }
+
+    sched_auto_active = 0;
+    sched_auto_exploring = 1;
+    sched_auto_nb_switches = sched_auto_nb_windows = 0;
+    sched_auto_reference = 0.0;
+    sched_auto_win_select = sched_auto_win_exec = sched_auto_win_executed = 0;
+    sched_auto_win_selected = sched_auto_win_steals = 0;
+    sched_auto_win_ready = 0;
+#if !defined(PARSEC_PROF_PINS)
+    if( sched_auto_nb_candidates > 1 )
+        parsec_warning("sched_auto: PaRSEC was compiled without PINS, the scheduler %s is used for the whole run",
+                       SCHED_AUTO_NAME(0));
+#endif  /* !defined(PARSEC_PROF_PINS) */
+
+    for( c = 0; c < sched_auto_nb_candidates; c++ ) {
+        sched_auto_cands[c].module->module.install(master);
+    }
+    return PARSEC_SUCCESS;
+}
+
+static int flow_auto_init(parsec_execution_stream_t* es, struct parsec_barrier_t* barrier)
+{
+    int c, idx = SCHED_AUTO_ES_INDEX(es), rc, ret = PARSEC_SUCCESS;
+
+    sched_auto_es[idx] = (sched_auto_es_t*)calloc(1, sizeof(sched_auto_es_t));
+    for( c = 0; c < sched_auto_nb_candidates; c++ ) {
+        es->scheduler_object = NULL;
+        if( NULL != sched_auto_cands[c].module->module.flow_init ) {
+            rc = sched_auto_cands[c].module->module.flow_init(es, barrier);
+            if( PARSEC_SUCCESS != rc ) ret = rc;
+        }
+        sched_auto_cands[c].objects[idx] = es->scheduler_object;
+        /* The next candidate must not replace the scheduler objects while
+         * the other execution streams may still look them up */
+        parsec_barrier_wait(barrier);
+    }
+    es->scheduler_object = sched_auto_cands[sched_auto_active].objects[idx];
+    return ret;
+}
+
+#if defined(PARSEC_PROF_PINS)
+static void sched_auto_select_begin(parsec_execution_stream_t *es, parsec_task_t *task,
+                                    parsec_pins_next_callback_t *data)
+{
+    sched_auto_es_t *st = SCHED_AUTO_ES(es);
+    st->select_start = take_time();
+    st->selecting = 1;
+    (void)task; (void)data;
+}
+
+static void sched_auto_select_end(parsec_execution_stream_t *es, parsec_task_t *task,
+                                  parsec_pins_next_callback_t *data)
+{
+    sched_auto_es_t *st = SCHED_AUTO_ES(es);
+    if( st->selecting ) {
+        st->select_time += diff_time(st->select_start, take_time());
+        st->selecting = 0;
+    }
+    (void)task; (void)data;
+}
+
+static void sched_auto_exec_begin(parsec_execution_stream_t *es, parsec_task_t *task,
+                                  parsec_pins_next_callback_t *data)
+{
+    sched_auto_es_t *st = SCHED_AUTO_ES(es);
+    st->exec_start = take_time();
+    st->executing = 1;
+    (void)task; (void)data;
+}
+
+static void sched_auto_exec_end(parsec_execution_stream_t *es, parsec_task_t *task,
+                                parsec_pins_next_callback_t *data)
+{
+    sched_auto_es_t *st = SCHED_AUTO_ES(es);
+    if( st->executing ) {
+        st->exec_time += diff_time(st->exec_start, take_time());
+        st->nb_executed++;
+        st->executing = 0;
+    }
+    (void)task; (void)data;
+}
+
+/**
+ * The PINS callbacks of the execution streams are reset after the
+ * flow_init, and must all be unregistered before the execution streams
+ * are finalized. Each execution stream registers its callbacks on its
+ * first selection. At each quiescent point, the master thread collects
+ * the telemetry and unregisters the callbacks of all the execution
+ * streams, then registers them again for the next round, unless the
+ * context is being finalized.
+ */
+static void sched_auto_register(parsec_execution_stream_t *es, sched_auto_es_t *st, int selecting)
+{
+    PARSEC_PINS_REGISTER(es, SELECT_BEGIN, sched_auto_select_begin, &st->select_begin_cb);
+    PARSEC_PINS_REGISTER(es, SELECT_END, sched_auto_select_end, &st->select_end_cb);
+    PARSEC_PINS_REGISTER(es, EXEC_BEGIN, sched_auto_exec_begin, &st->exec_begin_cb);
+    PARSEC_PINS_REGISTER(es, EXEC_END, sched_auto_exec_end, &st->exec_end_cb);
+    st->registered = 1;
+    st->executing = 0;
+    st->selecting = selecting;
+    if( selecting ) st->select_start = take_time();
+}
+
+static void sched_auto_unregister(parsec_execution_stream_t *es, sched_auto_es_t *st)
+{
+    parsec_pins_next_callback_t *cb_data;
+
+    PARSEC_PINS_UNREGISTER(es, SELECT_BEGIN, sched_auto_select_begin, &cb_data);
+    PARSEC_PINS_UNREGISTER(es, SELECT_END, sched_auto_select_end, &cb_data);
+    PARSEC_PINS_UNREGISTER(es, EXEC_BEGIN, sched_auto_exec_begin, &cb_data);
+    PARSEC_PINS_UNREGISTER(es, EXEC_END, sched_auto_exec_end, &cb_data);
+    st->registered = st->selecting = st->executing = 0;
+}
+#endif  /* defined(PARSEC_PROF_PINS) */
+
+static int sched_auto_schedule(parsec_execution_stream_t* es,
+                               parsec_task_t* new_context,
+                               int32_t distance)
+{
+    parsec_list_item_t *item = &new_context->super;
+    int32_t nb = 0;
+
+    do {
+        nb++;
+        item = (parsec_list_item_t*)item->list_next;
+    } while( item != &new_context->super );
+    parsec_atomic_fetch_add_int32(&sched_auto_nb_ready[es->virtual_process->vp_id], nb);
+    return SCHED_AUTO_ACTIVE()->schedule(es, new_context, distance);
+}
+
+static inline void sched_auto_selected(parsec_execution_stream_t *es, sched_auto_es_t *st,
+                                       int nb, int32_t distance)
+{
+    int32_t ready;
+
+    ready = parsec_atomic_fetch_sub_int32(&sched_auto_nb_ready[es->virtual_process->vp_id], nb) - nb;
+    st->nb_selected += nb;
+    if( distance > 0 ) st->nb_steals += nb;
+    st->ready_sum += nb * (int64_t)ready;
+}
+
+static parsec_task_t*
+sched_auto_select(parsec_execution_stream_t *es,
+                  int32_t* distance)
+{
+    sched_auto_es_t *st = SCHED_AUTO_ES(es);
+    parsec_task_t *task;
+
+#if defined(PARSEC_PROF_PINS)
+    if( PARSEC_UNLIKELY(!st->registered) ) sched_auto_register(es, st, 1);  /* this selection already started */
+#endif  /* defined(PARSEC_PROF_PINS) */
+    task = SCHED_AUTO_ACTIVE()->select(es, distance);
+    if( NULL != task )
+        sched_auto_selected(es, st, 1, *distance);
+    return task;
+}
+
+static int sched_auto_select_batch(parsec_execution_stream_t *es,
+                                   parsec_task_t **tasks,
+                                   int max,
+                                   int32_t* distance)
+{
+    const parsec_sched_base_module_t *active = SCHED_AUTO_ACTIVE();
+    sched_auto_es_t *st = SCHED_AUTO_ES(es);
+    int nb;
+
+#if defined(PARSEC_PROF_PINS)
+    if( PARSEC_UNLIKELY(!st->registered) ) sched_auto_register(es, st, 1);  /* this selection already started */
+#endif  /* defined(PARSEC_PROF_PINS) */
+    if( NULL != active->select_batch ) {
+        nb = active->select_batch(es, tasks, max, distance);
+    } else {
+        tasks[0] = active->select(es, distance);
+        nb = (NULL != tasks[0]);
+    }
+    if( nb > 0 )
+        sched_auto_selected(es, st, nb, *distance);
+    return nb;
+}
+
+static void sched_auto_switch(parsec_context_t *master, int next)
+{
+    parsec_execution_stream_t *es;
+    parsec_vp_t *vp;
+    int p, t;
+
+    if( sched_auto_verbose )
+        parsec_inform("sched_auto: switching from %s to %s", SCHED_AUTO_NAME(sched_auto_active), SCHED_AUTO_NAME(next));
+    for(p = 0; p < master->nb_vp; p++) {
+        vp = master->virtual_processes[p];
+        for(t = 0; t < vp->nb_cores; t++) {
+            es = vp->execution_streams[t];
+            if( NULL == es ) continue;
+            es->scheduler_object = sched_auto_cands[next].objects[sched_auto_vp_offset[p] + t];
+        }
+    }
+    sched_auto_active = next;
+    sched_auto_nb_switches++;
+}
+
+/**
+ * Closes the measurement window once it contains enough tasks, and
+ * decides which candidate runs the next one: while exploring, each
+ * candidate runs one window in turn, and the most efficient one is then
+ * selected. The selected candidate is kept as long as its efficiency
+ * stays within the tolerance of the reference efficiency, which follows
+ * its slow variations.
+ */
+static void sched_auto_decide(parsec_context_t *master)
+{
+    double efficiency;
+    int c, next = sched_auto_active;
+
+    if( (sched_auto_win_executed < (uint64_t)sched_auto_window) ||
+        (0 == sched_auto_win_exec + sched_auto_win_select) )
+        return;
+    efficiency = (double)sched_auto_win_exec / (double)(sched_auto_win_exec + sched_auto_win_select);
+    sched_auto_last_efficiency = efficiency;
+    sched_auto_last_steal_ratio = (0 == sched_auto_win_selected) ? 0.0 :
+        (double)sched_auto_win_steals / (double)sched_auto_win_selected;
+    sched_auto_last_avg_ready = (0 == sched_auto_win_selected) ? 0.0 :
+        (double)sched_auto_win_ready / (double)sched_auto_win_selected;
+    sched_auto_last_nb_tasks = sched_auto_win_executed;
+    sched_auto_nb_windows++;
+    sched_auto_win_select = sched_auto_win_exec = sched_auto_win_executed = 0;
+    sched_auto_win_selected = sched_auto_win_steals = 0;
+    sched_auto_win_ready = 0;
+    sched_auto_cands[sched_auto_active].efficiency = efficiency;
+
+    if( sched_auto_verbose )
+        parsec_inform("sched_auto: window %d with %s: %"PRIu64" tasks, efficiency %.3f, steal ratio %.3f, %.1f ready tasks",
+                      sched_auto_nb_windows, SCHED_AUTO_NAME(sched_auto_active), sched_auto_last_nb_tasks,
+                      efficiency, sched_auto_last_steal_ratio, sched_auto_last_avg_ready);
+    if( sched_auto_nb_candidates < 2 )
+        return;
+
+    if( !sched_auto_exploring ) {
+        if( efficiency * 100.0 < sched_auto_reference * (100 - sched_auto_tolerance) ) {
+            /* The workload changed: measure all the candidates again */
+            sched_auto_exploring = 1;
+            for( c = 0; c < sched_auto_nb_candidates; c++ ) {
+                if( c != sched_auto_active ) sched_auto_cands[c].efficiency = -1.0;
+            }
+        } else {
+            sched_auto_reference = 0.75 * sched_auto_reference + 0.25 * efficiency;
+        }
+    }
+    if( sched_auto_exploring ) {
+        for( next = -1, c = 0; c < sched_auto_nb_candidates; c++ ) {
+            if( sched_auto_cands[c].efficiency < 0.0 ) {
+                next = c;
+                break;
+            }
+        }
+        if( -1 == next ) {
+            for( next = c = 0; c < sched_auto_nb_candidates; c++ ) {
+                if( sched_auto_cands[c].efficiency > sched_auto_cands[next].efficiency )
+                    next = c;
+            }
+            sched_auto_exploring = 0;
+            sched_auto_reference = sched_auto_cands[next].efficiency;
+        }
+    }
+    if( next != sched_auto_active )
+        sched_auto_switch(master, next);
+}
+
+static void sched_auto_quiesce(parsec_context_t *master)
+{
+#if defined(PARSEC_PROF_PINS)
+    parsec_execution_stream_t *es;
+    sched_auto_es_t *st;
+    parsec_vp_t *vp;
+    int p, t, finalizing = master->__parsec_internal_finalization_in_progress;
+
+    for(p = 0; p < master->nb_vp; p++) {
+        vp = master->virtual_processes[p];
+        for(t = 0; t < vp->nb_cores; t++) {
+            es = vp->execution_streams[t];
+            st = sched_auto_es[sched_auto_vp_offset[p] + t];
+            if( (NULL == es) || (NULL == st) ) continue;
+            if( st->registered ) sched_auto_unregister(es, st);
+            sched_auto_win_select   += st->select_time;
+            sched_auto_win_exec     += st->exec_time;
+            sched_auto_win_executed += st->nb_executed;
+            sched_auto_win_selected += st->nb_selected;
+            sched_auto_win_steals   += st->nb_steals;
+            sched_auto_win_ready    += st->ready_sum;
+            st->select_time = st->exec_time = 0;
+            st->nb_executed = st->nb_selected = st->nb_steals = 0;
+            st->ready_sum = 0;
+            if( !finalizing ) sched_auto_register(es, st, 0);
+        }
+        /* All the tasks have been selected, even if not from the VP that
+         * scheduled them */
+        sched_auto_nb_ready[p] = 0;
+    }
+    if( !finalizing )
+        sched_auto_decide(master);
+#else
+    (void)master;
+#endif  /* defined(PARSEC_PROF_PINS) */
+}
+
+int parsec_sched_auto_stats(parsec_context_t *context,
+                            parsec_sched_auto_stats_t *stats)
+{
+    int c;
+
+    if( (NULL == sched_auto_context) || (context != sched_auto_context) )
+        return PARSEC_ERR_NOT_FOUND;
+    memset(stats, 0, sizeof(parsec_sched_auto_stats_t));
+    stats->active        = SCHED_AUTO_NAME(sched_auto_active);
+    stats->nb_candidates = sched_auto_nb_candidates;
+    stats->exploring     = sched_auto_exploring;
+    stats->nb_switches   = sched_auto_nb_switches;
+    stats->nb_windows    = sched_auto_nb_windows;
+    stats->efficiency    = sched_auto_last_efficiency;
+    stats->steal_ratio   = sched_auto_last_steal_ratio;
+    stats->avg_ready     = sched_auto_last_avg_ready;
+    stats->nb_tasks      = sched_auto_last_nb_tasks;
+    for( c = 0; c < sched_auto_nb_candidates; c++ ) {
+        stats->candidates[c] = SCHED_AUTO_NAME(c);
+        stats->candidate_efficiency[c] = sched_auto_cands[c].efficiency;
+    }
+    return PARSEC_SUCCESS;
+}
+
+static void sched_auto_display_stats(parsec_execution_stream_t* es)
+{
+    if( NULL != SCHED_AUTO_ACTIVE()->display_stats )
+        SCHED_AUTO_ACTIVE()->display_stats(es);
+}
+
+static void sched_auto_remove( parsec_context_t *master )
+{
+    parsec_execution_stream_t *es;
+    parsec_vp_t *vp;
+    int c, p, t;
+
+    if( sched_auto_verbose )
+        parsec_inform("sched_auto: %d switches over %d windows, %s was active last",
+                      sched_auto_nb_switches, sched_auto_nb_windows, SCHED_AUTO_NAME(sched_auto_active));
+    for( c = 0; c < sched_auto_nb_candidates; c++ ) {
+        for(p = 0; p < master->nb_vp; p++) {
+            vp = master->virtual_processes[p];
+            for(t = 0; t < vp->nb_cores; t++) {
+                es = vp->execution_streams[t];
+                if( NULL == es ) continue;
+                es->scheduler_object = sched_auto_cands[c].objects[sched_auto_vp_offset[p] + t];
+            }
+        }
+        sched_auto_cands[c].module->module.remove(master);
+        mca_component_close(sched_auto_cands[c].component);
+        free(sched_auto_cands[c].objects);
+        sched_auto_cands[c].objects = NULL;
+    }
+    for(p = 0; p < master->nb_vp; p++) {
+        vp = master->virtual_processes[p];
+        for(t = 0; t < vp->nb_cores; t++) {
+            es = vp->execution_streams[t];
+            if( NULL != es ) es->scheduler_object = NULL;
+        }
+    }
+    for( t = 0; t < sched_auto_nb_es; t++ )
+        free(sched_auto_es[t]);
+    free(sched_auto_es);
+    free(sched_auto_vp_offset);
+    free(sched_auto_nb_ready);
+    sched_auto_es = NULL;
+    sched_auto_vp_offset = NULL;
+    sched_auto_nb_ready = NULL;
+    sched_auto_nb_candidates = 0;
+    sched_auto_context = NULL;
+}
@@ -0,0 +1,70 @@
+/*
+ * Copyright (c) 2023      The University of Tennessee and The University
+ *                         of Tennessee Research Foundation.  All rights
+ *                         reserved.
+ * $COPYRIGHT$
+ * 
+ * Additional copyrights may follow
+ * 
+ * $HEADER$
+ */
+
+/**
+ * @file
+ *
+ * Weighted Deficit Round Robin scheduler: one queue per taskpool, served
+ * in proportion of the taskpool weights (see parsec_taskpool_set_weight).
+ *
+ */
+
+
+#ifndef MCA_SCHED_DRR_H
+#define MCA_SCHED_DRR_H
+
+#include "parsec/parsec_config.h"
+#include "parsec/mca/mca.h"
+#include "parsec/mca/sched/sched.h"
+
+
+BEGIN_C_DECLS
+
+/**
+ * Globally exported variable
+ */
+PARSEC_DECLSPEC extern const parsec_sched_base_component_t parsec_sched_drr_component;
+PARSEC_DECLSPEC extern const parsec_sched_module_t parsec_sched_drr_module;
+/* static accessor */
+mca_base_component_t *sched_drr_static_component(void);
+
+/**
+ * Service time (in timer units) a taskpool of weight 1 receives at each
+ * round.
+ */
+extern int sched_drr_quantum;
+
+/**
+ * Scheduling statistics of a taskpool
+ */
+typedef struct parsec_sched_drr_stats_s {
+    int32_t  weight;        /**< Weight of the taskpool when its queue was last served */
+    int32_t  queue_depth;   /**< Number of ready tasks in the queue of the taskpool */
+    int32_t  max_depth;     /**< Largest number of ready tasks observed in the queue */
+    uint64_t nb_scheduled;  /**< Number of tasks inserted in the queue */
+    uint64_t nb_selected;   /**< Number of tasks selected from the queue */
+    uint64_t service_time;  /**< Time (in timer units) spent by the execution streams on the
+                             *   tasks of the taskpool, from their selection to the next selection */
+} parsec_sched_drr_stats_t;
+
+/**
+ * @brief Get the scheduling statistics of a taskpool
+ *
+ * @param[in] tp the taskpool
+ * @param[out] stats the statistics of the taskpool
+ * @return PARSEC_SUCCESS, or PARSEC_ERR_NOT_FOUND if the drr scheduler is
+ *         not in use or never received a task of tp.
+ */
+PARSEC_DECLSPEC int parsec_sched_drr_taskpool_stats(const parsec_taskpool_t *tp,
+                                                    parsec_sched_drr_stats_t *stats);
+
+END_C_DECLS
+#endif /* MCA_SCHED_DRR_H */
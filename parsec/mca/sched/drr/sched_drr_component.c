@@ -0,0 +1,89 @@
+/*
+ * Copyright (c) 2023      The University of Tennessee and The University
+ *                         of Tennessee Research Foundation.  All rights
+ *                         reserved.
+ * $COPYRIGHT$
+ * 
+ * Additional copyrights may follow
+ * 
+ * $HEADER$
+ *
+ * These symbols are in a file by themselves to provide nice linker
+ * semantics.  Since linkers generally pull in symbols by object
+ * files, keeping these symbols as the only symbols in this file
+ * prevents utility programs such as "ompi_info" from having to import
+ * entire components just to query their version and parameters.
+ */
+
+#include "parsec/parsec_config.h"
+#include "parsec/runtime.h"
+
+#include "parsec/mca/sched/sched.h"
+#include "parsec/mca/sched/drr/sched_drr.h"
+#include "parsec/utils/mca_param.h"
+#include "parsec/os-spec-timing.h"
+
+int sched_drr_quantum = 100000;
+
+/*
+ * Local function
+ */
+static int sched_drr_component_query(mca_base_module_t **module, int *priority);
+static int sched_drr_component_register(void);
+
+/*
+ * Instantiate the public struct with all of our public information
+ * and pointers to our public functions in it
+ */
+const parsec_sched_base_component_t parsec_sched_drr_component = {
+
+    /* First, the mca_component_t struct containing meta information
+       about the component itself */
+
+    {
+        PARSEC_SCHED_BASE_VERSION_2_0_0,
+
+        /* Component name and version */
+        "drr",
+        "", /* options */
+        PARSEC_VERSION_MAJOR,
+        PARSEC_VERSION_MINOR,
+
+        /* Component open and close functions */
+        NULL, /*< No open: sched_drr is always available, no need to check at runtime */
+        NULL, /*< No close: open did not allocate any resource, no need to release them */
+        sched_drr_component_query, 
+        /*< specific query to return the module and add it to the list of available modules */
+        sched_drr_component_register,
+        "", /*< no reserve */
+    },
+    {
+        /* The component has no metada */
+        MCA_BASE_METADATA_PARAM_NONE,
+        "", /*< no reserve */
+    }
+};
+
+mca_base_component_t *sched_drr_static_component(void)
+{
+    return (mca_base_component_t *)&parsec_sched_drr_component;
+}
+
+static int sched_drr_component_query(mca_base_module_t **module, int *priority)
+{
+    /* module type should be: const mca_base_module_t ** */
+    void *ptr = (void*)&parsec_sched_drr_module;
+    *priority = 3;
+    *module = (mca_base_module_t *)ptr;
+    return MCA_SUCCESS;
+}
+
+static int sched_drr_component_register(void)
+{
+    parsec_mca_param_reg_int_name("sched_drr", "quantum",
+                                  "Service time (in "TIMER_UNIT") a taskpool of weight 1 receives at each round of the "
+                                  "deficit round robin. Smaller values interleave the taskpools more finely",
+                                  false, false, sched_drr_quantum, &sched_drr_quantum);
+    if( sched_drr_quantum < 1 ) sched_drr_quantum = 1;
+    return MCA_SUCCESS;
+}
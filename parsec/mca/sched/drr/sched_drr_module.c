@@ -0,0 +1,351 @@
+/**
+ * Copyright (c) 2023      The University of Tennessee and The University
+ *                         of Tennessee Research Foundation.  All rights
+ *                         reserved.
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ *
+ */
+
+#include "parsec/parsec_config.h"
+#include "parsec/parsec_internal.h"
+#include "parsec/utils/debug.h"
+#include "parsec/class/list.h"
+#include "parsec/class/parsec_hash_table.h"
+#include "parsec/os-spec-timing.h"
+
+#include "parsec/mca/sched/sched.h"
+#include "parsec/mca/sched/drr/sched_drr.h"
+#include "parsec/mca/pins/pins.h"
+
+/**
+ * Module functions
+ */
+static int sched_drr_install(parsec_context_t* master);
+static int sched_drr_schedule(parsec_execution_stream_t* es,
+                              parsec_task_t* new_context,
+                              int32_t distance);
+static parsec_task_t*
+sched_drr_select(parsec_execution_stream_t *es,
+                 int32_t* distance);
+static void sched_drr_display_stats(parsec_execution_stream_t* es);
+static void sched_drr_remove(parsec_context_t* master);
+static int flow_drr_init(parsec_execution_stream_t* es, struct parsec_barrier_t* barrier);
+
+const parsec_sched_module_t parsec_sched_drr_module = {
+    &parsec_sched_drr_component,
+    {
+        sched_drr_install,
+        flow_drr_init,
+        sched_drr_schedule,
+        sched_drr_select,
+        sched_drr_display_stats,
+        sched_drr_remove,
+        NULL,
+        NULL
+    }
+};
+
+/**
+ * The ready tasks of each taskpool are kept in a queue sorted by priority.
+ * The queues holding tasks are chained in the active list, and served in
+ * turn: at the beginning of its turn, a queue receives a quantum of service
+ * time proportional to the weight of its taskpool, and it is served as long
+ * as its deficit remains positive.
+ *
+ * The duration of a task is unknown when it is selected, so the queue is
+ * charged an estimate (the average service time of its tasks), and the
+ * difference is corrected when the execution stream comes back to select
+ * another task. The measured time thus includes the successors that the
+ * execution stream kept for itself instead of scheduling them.
+ */
+typedef struct sched_drr_flow_s {
+    parsec_list_item_t        super;        /**< Chained in the active list when the queue holds tasks */
+    parsec_hash_table_item_t  ht_item;      /**< Indexed by taskpool id */
+    parsec_taskpool_t        *taskpool;     /**< Only dereferenced while the queue holds tasks */
+    parsec_list_t             queue;        /**< Ready tasks, accessed under the scheduler lock */
+    int                       active;       /**< The queue is in the active list */
+    int64_t                   deficit;      /**< Service time the queue can still receive in this round */
+    int64_t                   avg_service;  /**< Moving average of the service time of a task */
+    parsec_sched_drr_stats_t  stats;
+} sched_drr_flow_t;
+
+typedef struct sched_drr_s {
+    parsec_atomic_lock_t  lock;
+    parsec_hash_table_t   flows;        /**< All the queues, by taskpool id */
+    parsec_list_t         active;       /**< Queues with ready tasks, in round robin order */
+    int                   nb_active;
+    int                   turn_started; /**< The head of the active list received its quantum */
+    volatile int32_t      nb_ready;     /**< Number of ready tasks in all the queues */
+} sched_drr_t;
+
+/**
+ * Per execution stream: the queue of the last selected task, that has not
+ * been charged its actual service time yet.
+ */
+typedef struct sched_drr_object_s {
+    sched_drr_flow_t *flow;
+    parsec_time_t     start;
+    int64_t           charged;
+} sched_drr_object_t;
+
+#define SCHED_DRR_OBJECT(es) ((sched_drr_object_t*)(es)->scheduler_object)
+
+static sched_drr_t *sched_drr = NULL;
+
+static int sched_drr_install( parsec_context_t *master )
+{
+    sched_drr = (sched_drr_t*)calloc(1, sizeof(sched_drr_t));
+    parsec_atomic_lock_init(&sched_drr->lock);
+    PARSEC_OBJ_CONSTRUCT(&sched_drr->flows, parsec_hash_table_t);
+    parsec_hash_table_init(&sched_drr->flows, offsetof(sched_drr_flow_t, ht_item),
+                           6, parsec_hash_table_generic_key_fn, NULL);
+    PARSEC_OBJ_CONSTRUCT(&sched_drr->active, parsec_list_t);
+    sched_drr->nb_active = 0;
+    sched_drr->turn_started = 0;
+    sched_drr->nb_ready = 0;
+    (void)master;
+    return PARSEC_SUCCESS;
+}
+
+static int flow_drr_init(parsec_execution_stream_t* es, struct parsec_barrier_t* barrier)
+{
+    es->scheduler_object = calloc(1, sizeof(sched_drr_object_t));
+    parsec_barrier_wait(barrier);
+    return PARSEC_SUCCESS;
+}
+
+/* Must be called with the scheduler lock held */
+static sched_drr_flow_t *sched_drr_get_flow(parsec_taskpool_t *tp)
+{
+    parsec_key_t key = (parsec_key_t)(uint64_t)tp->taskpool_id;
+    sched_drr_flow_t *flow;
+
+    flow = (sched_drr_flow_t*)parsec_hash_table_nolock_find(&sched_drr->flows, key);
+    if( NULL == flow ) {
+        flow = (sched_drr_flow_t*)calloc(1, sizeof(sched_drr_flow_t));
+        PARSEC_OBJ_CONSTRUCT(&flow->super, parsec_list_item_t);
+        PARSEC_OBJ_CONSTRUCT(&flow->queue, parsec_list_t);
+        flow->ht_item.key = key;
+        flow->avg_service = 1;
+        parsec_hash_table_nolock_insert(&sched_drr->flows, &flow->ht_item);
+    }
+    /* Only used while the queue holds tasks of the taskpool */
+    flow->taskpool = tp;
+    return flow;
+}
+
+/* Must be called with the scheduler lock held */
+static void sched_drr_charge(sched_drr_object_t *eo, parsec_time_t now)
+{
+    sched_drr_flow_t *flow = eo->flow;
+    int64_t service;
+
+    if( NULL == flow ) return;
+    service = (int64_t)diff_time(eo->start, now);
+    flow->deficit += eo->charged - service;
+    flow->avg_service += (service - flow->avg_service) / 8;
+    if( flow->avg_service < 1 ) flow->avg_service = 1;
+    flow->stats.service_time += service;
+    eo->flow = NULL;
+}
+
+static int sched_drr_schedule(parsec_execution_stream_t* es,
+                              parsec_task_t* new_context,
+                              int32_t distance)
+{
+    parsec_list_item_t *ring = &new_context->super, *item;
+    sched_drr_flow_t *flow = NULL;
+    parsec_taskpool_t *tp = NULL;
+    int nb = 0;
+
+    parsec_atomic_lock(&sched_drr->lock);
+    while( NULL != ring ) {
+        item = ring;
+        ring = parsec_list_item_ring_chop(item);
+        PARSEC_LIST_ITEM_SINGLETON(item);
+        if( ((parsec_task_t*)item)->taskpool != tp ) {
+            tp = ((parsec_task_t*)item)->taskpool;
+            flow = sched_drr_get_flow(tp);
+        }
+        if( distance > 0 ) {
+            /* The task could not make progress, let the others go first */
+            parsec_list_nolock_push_back(&flow->queue, item);
+        } else {
+            parsec_list_nolock_push_sorted(&flow->queue, item, parsec_execution_context_priority_comparator);
+        }
+        flow->stats.nb_scheduled++;
+        if( ++flow->stats.queue_depth > flow->stats.max_depth )
+            flow->stats.max_depth = flow->stats.queue_depth;
+        if( !flow->active ) {
+            flow->active = 1;
+            sched_drr->nb_active++;
+            parsec_list_nolock_push_back(&sched_drr->active, &flow->super);
+        }
+        nb++;
+    }
+    parsec_atomic_fetch_add_int32(&sched_drr->nb_ready, nb);
+    parsec_atomic_unlock(&sched_drr->lock);
+    (void)es;
+    return PARSEC_SUCCESS;
+}
+
+static inline int64_t sched_drr_quantum_of(sched_drr_flow_t *flow)
+{
+    flow->stats.weight = (flow->taskpool->weight < 1) ? 1 : flow->taskpool->weight;
+    return (int64_t)sched_drr_quantum * flow->stats.weight;
+}
+
+/**
+ * None of the active queues has a positive deficit after receiving its
+ * quantum: skip the rounds that would not serve any queue, instead of
+ * iterating over them.
+ */
+static void sched_drr_skip_rounds(void)
+{
+    parsec_list_item_t *item;
+    sched_drr_flow_t *flow;
+    int64_t rounds = INT64_MAX, r;
+
+    for( item = PARSEC_LIST_ITERATOR_FIRST(&sched_drr->active);
+         item != PARSEC_LIST_ITERATOR_END(&sched_drr->active);
+         item = PARSEC_LIST_ITERATOR_NEXT(item) ) {
+        flow = (sched_drr_flow_t*)item;
+        r = -flow->deficit / sched_drr_quantum_of(flow);
+        if( r < rounds ) rounds = r;
+    }
+    for( item = PARSEC_LIST_ITERATOR_FIRST(&sched_drr->active);
+         item != PARSEC_LIST_ITERATOR_END(&sched_drr->active);
+         item = PARSEC_LIST_ITERATOR_NEXT(item) ) {
+        flow = (sched_drr_flow_t*)item;
+        flow->deficit += rounds * sched_drr_quantum_of(flow);
+    }
+}
+
+static parsec_task_t*
+sched_drr_select(parsec_execution_stream_t *es,
+                 int32_t* distance)
+{
+    sched_drr_object_t *eo = SCHED_DRR_OBJECT(es);
+    parsec_task_t *task = NULL;
+    sched_drr_flow_t *flow;
+    parsec_time_t now;
+    int nb_visited = 0;
+
+    *distance = 0;
+    if( (NULL == eo->flow) && (0 == sched_drr->nb_ready) )
+        return NULL;
+    now = take_time();
+    parsec_atomic_lock(&sched_drr->lock);
+    sched_drr_charge(eo, now);
+    while( !parsec_list_nolock_is_empty(&sched_drr->active) ) {
+        flow = (sched_drr_flow_t*)PARSEC_LIST_ITERATOR_FIRST(&sched_drr->active);
+        if( !sched_drr->turn_started ) {
+            flow->deficit += sched_drr_quantum_of(flow);
+            sched_drr->turn_started = 1;
+        }
+        if( flow->deficit > 0 ) {
+            task = (parsec_task_t*)parsec_list_nolock_pop_front(&flow->queue);
+            flow->stats.queue_depth--;
+            flow->stats.nb_selected++;
+            flow->deficit -= flow->avg_service;
+            eo->flow = flow;
+            eo->start = now;
+            eo->charged = flow->avg_service;
+            if( parsec_list_nolock_is_empty(&flow->queue) ) {
+                /* An idle queue does not accumulate credit */
+                (void)parsec_list_nolock_pop_front(&sched_drr->active);
+                flow->active = 0;
+                sched_drr->nb_active--;
+                sched_drr->turn_started = 0;
+                if( flow->deficit > 0 ) flow->deficit = 0;
+            }
+            break;
+        }
+        /* End of the turn of this queue */
+        parsec_list_nolock_push_back(&sched_drr->active,
+                                     parsec_list_nolock_pop_front(&sched_drr->active));
+        sched_drr->turn_started = 0;
+        if( ++nb_visited == sched_drr->nb_active ) {
+            sched_drr_skip_rounds();
+            nb_visited = 0;
+        }
+    }
+    parsec_atomic_unlock(&sched_drr->lock);
+    if( NULL != task )
+        parsec_atomic_fetch_dec_int32(&sched_drr->nb_ready);
+    return task;
+}
+
+int parsec_sched_drr_taskpool_stats(const parsec_taskpool_t *tp,
+                                    parsec_sched_drr_stats_t *stats)
+{
+    sched_drr_flow_t *flow;
+
+    if( NULL == sched_drr ) return PARSEC_ERR_NOT_FOUND;
+    parsec_atomic_lock(&sched_drr->lock);
+    flow = (sched_drr_flow_t*)parsec_hash_table_nolock_find(&sched_drr->flows,
+                                                            (parsec_key_t)(uint64_t)tp->taskpool_id);
+    if( NULL != flow ) *stats = flow->stats;
+    parsec_atomic_unlock(&sched_drr->lock);
+    return (NULL == flow) ? PARSEC_ERR_NOT_FOUND : PARSEC_SUCCESS;
+}
+
+static void sched_drr_display_flow(void *item, void *cb_data)
+{
+    sched_drr_flow_t *flow = (sched_drr_flow_t*)item;
+    parsec_inform("DRR taskpool %"PRIu64": weight %d queue depth %d (max %d) scheduled %"PRIu64
+                  " selected %"PRIu64" service time %"PRIu64" "TIMER_UNIT,
+                  (uint64_t)flow->ht_item.key, flow->stats.weight, flow->stats.queue_depth,
+                  flow->stats.max_depth, flow->stats.nb_scheduled, flow->stats.nb_selected,
+                  flow->stats.service_time);
+    (void)cb_data;
+}
+
+static void sched_drr_display_stats(parsec_execution_stream_t* es)
+{
+    /* The queues are shared by all the execution streams */
+    if( (0 != es->th_id) || (0 != es->virtual_process->vp_id) ) return;
+    parsec_atomic_lock(&sched_drr->lock);
+    parsec_hash_table_for_all(&sched_drr->flows, sched_drr_display_flow, NULL);
+    parsec_atomic_unlock(&sched_drr->lock);
+}
+
+static void sched_drr_free_flow(void *item, void *cb_data)
+{
+    sched_drr_flow_t *flow = (sched_drr_flow_t*)item;
+    parsec_hash_table_nolock_remove((parsec_hash_table_t*)cb_data, flow->ht_item.key);
+    PARSEC_OBJ_DESTRUCT(&flow->queue);
+    PARSEC_OBJ_DESTRUCT(&flow->super);
+    free(flow);
+}
+
+static void sched_drr_remove( parsec_context_t *master )
+{
+    int p, t;
+    parsec_execution_stream_t *es;
+    parsec_vp_t *vp;
+
+    for(p = 0; p < master->nb_vp; p++) {
+        vp = master->virtual_processes[p];
+        for(t = 0; t < vp->nb_cores; t++) {
+            es = vp->execution_streams[t];
+            if( (NULL == es) || (NULL == es->scheduler_object) )
+                continue;
+            free(es->scheduler_object);
+            es->scheduler_object = NULL;
+        }
+    }
+    if( NULL == sched_drr ) return;
+    /* Forget the queues that are still chained, they are all empty */
+    while( NULL != parsec_list_nolock_pop_front(&sched_drr->active) );
+    PARSEC_OBJ_DESTRUCT(&sched_drr->active);
+    parsec_hash_table_for_all(&sched_drr->flows, sched_drr_free_flow, &sched_drr->flows);
+    parsec_hash_table_fini(&sched_drr->flows);
+    PARSEC_OBJ_DESTRUCT(&sched_drr->flows);
+    free(sched_drr);
+    sched_drr = NULL;
+}
@@ -0,0 +1,86 @@
+/*
+ * Copyright (c) 2023      The University of Tennessee and The University
+ *                         of Tennessee Research Foundation.  All rights
+ *                         reserved.
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+
+/**
+ * @file
+ *
+ * Earliest Deadline First scheduler: the ready tasks are ordered by the
+ * absolute deadline returned by the deadline function of their task class
+ * (see parsec_task_deadline_fct_t), in one heap per execution stream.
+ * Tasks without a deadline come after all the tasks with a deadline, by
+ * decreasing priority.
+ *
+ */
+
+
+#ifndef MCA_SCHED_EDF_H
+#define MCA_SCHED_EDF_H
+
+#include "parsec/parsec_config.h"
+#include "parsec/mca/mca.h"
+#include "parsec/mca/sched/sched.h"
+
+
+BEGIN_C_DECLS
+
+/**
+ * Globally exported variable
+ */
+PARSEC_DECLSPEC extern const parsec_sched_base_component_t parsec_sched_edf_component;
+PARSEC_DECLSPEC extern const parsec_sched_module_t parsec_sched_edf_module;
+/* static accessor */
+mca_base_component_t *sched_edf_static_component(void);
+
+/**
+ * Steal the earliest deadline of the virtual process at each selection,
+ * instead of only when the local heap is empty.
+ */
+extern int sched_edf_steal_earliest;
+/**
+ * Report the statistics of each execution stream when the scheduler is
+ * removed.
+ */
+extern int sched_edf_report;
+
+/**
+ * Deadline statistics, accumulated by all the execution streams
+ */
+typedef struct parsec_sched_edf_stats_s {
+    uint64_t nb_scheduled;   /**< Number of tasks inserted in the heaps */
+    uint64_t nb_selected;    /**< Number of tasks selected from the heaps */
+    uint64_t nb_deadlines;   /**< Number of selected tasks that had a deadline */
+    uint64_t nb_late_starts; /**< Number of tasks selected after their deadline */
+    uint64_t nb_misses;      /**< Number of tasks completed after their deadline */
+    uint64_t max_lateness;   /**< Largest delay (in nanoseconds) between the deadline
+                              *   and the completion of a task */
+    uint64_t nb_steals;      /**< Number of tasks selected from the heap of another
+                              *   execution stream */
+} parsec_sched_edf_stats_t;
+
+/**
+ * @brief Get the deadline statistics of the edf scheduler
+ *
+ * @details
+ * The completion of a task is observed when its execution stream comes
+ * back to the scheduler: the misses of the tasks that an execution stream
+ * executes without going through the scheduler (such as the work-first
+ * successors) are accounted to the task selected before them.
+ *
+ * @param[in] context the parsec context
+ * @param[out] stats the statistics of all the execution streams of context
+ * @return PARSEC_SUCCESS, or PARSEC_ERR_NOT_FOUND if the edf scheduler is
+ *         not in use.
+ */
+PARSEC_DECLSPEC int parsec_sched_edf_stats(parsec_context_t *context,
+                                           parsec_sched_edf_stats_t *stats);
+
+END_C_DECLS
+#endif /* MCA_SCHED_EDF_H */
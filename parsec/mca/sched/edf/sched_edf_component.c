@@ -0,0 +1,93 @@
+/*
+ * Copyright (c) 2023      The University of Tennessee and The University
+ *                         of Tennessee Research Foundation.  All rights
+ *                         reserved.
+ * $COPYRIGHT$
+ * 
+ * Additional copyrights may follow
+ * 
+ * $HEADER$
+ *
+ * These symbols are in a file by themselves to provide nice linker
+ * semantics.  Since linkers generally pull in symbols by object
+ * files, keeping these symbols as the only symbols in this file
+ * prevents utility programs such as "ompi_info" from having to import
+ * entire components just to query their version and parameters.
+ */
+
+#include "parsec/parsec_config.h"
+#include "parsec/runtime.h"
+
+#include "parsec/mca/sched/sched.h"
+#include "parsec/mca/sched/edf/sched_edf.h"
+#include "parsec/utils/mca_param.h"
+
+int sched_edf_steal_earliest = 1;
+int sched_edf_report = 0;
+
+/*
+ * Local function
+ */
+static int sched_edf_component_query(mca_base_module_t **module, int *priority);
+static int sched_edf_component_register(void);
+
+/*
+ * Instantiate the public struct with all of our public information
+ * and pointers to our public functions in it
+ */
+const parsec_sched_base_component_t parsec_sched_edf_component = {
+
+    /* First, the mca_component_t struct containing meta information
+       about the component itself */
+
+    {
+        PARSEC_SCHED_BASE_VERSION_2_0_0,
+
+        /* Component name and version */
+        "edf",
+        "", /* options */
+        PARSEC_VERSION_MAJOR,
+        PARSEC_VERSION_MINOR,
+
+        /* Component open and close functions */
+        NULL, /*< No open: sched_edf is always available, no need to check at runtime */
+        NULL, /*< No close: open did not allocate any resource, no need to release them */
+        sched_edf_component_query, 
+        /*< specific query to return the module and add it to the list of available modules */
+        sched_edf_component_register,
+        "", /*< no reserve */
+    },
+    {
+        /* The component has no metada */
+        MCA_BASE_METADATA_PARAM_NONE,
+        "", /*< no reserve */
+    }
+};
+
+mca_base_component_t *sched_edf_static_component(void)
+{
+    return (mca_base_component_t *)&parsec_sched_edf_component;
+}
+
+static int sched_edf_component_query(mca_base_module_t **module, int *priority)
+{
+    /* module type should be: const mca_base_module_t ** */
+    void *ptr = (void*)&parsec_sched_edf_module;
+    *priority = 4;
+    *module = (mca_base_module_t *)ptr;
+    return MCA_SUCCESS;
+}
+
+static int sched_edf_component_register(void)
+{
+    parsec_mca_param_reg_int_name("sched_edf", "steal_earliest",
+                                  "Compare the earliest deadline of the local heap with the earliest deadline of the "
+                                  "other execution streams at each selection, and steal the task with the earliest "
+                                  "deadline of the virtual process (0: steal only when the local heap is empty)",
+                                  false, false, sched_edf_steal_earliest, &sched_edf_steal_earliest);
+    parsec_mca_param_reg_int_name("sched_edf", "report",
+                                  "Report the number of tasks with a deadline, and the deadline misses, of each "
+                                  "execution stream when the scheduler is removed",
+                                  false, false, sched_edf_report, &sched_edf_report);
+    return MCA_SUCCESS;
+}
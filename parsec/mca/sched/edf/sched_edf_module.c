@@ -0,0 +1,327 @@
+/**
+ * Copyright (c) 2023      The University of Tennessee and The University
+ *                         of Tennessee Research Foundation.  All rights
+ *                         reserved.
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ *
+ */
+
+#include "parsec/parsec_config.h"
+#include "parsec/parsec_internal.h"
+#include "parsec/utils/debug.h"
+#include "parsec/class/list.h"
+
+#include "parsec/mca/sched/sched.h"
+#include "parsec/mca/sched/edf/sched_edf.h"
+#include "parsec/mca/pins/pins.h"
+
+/**
+ * Module functions
+ */
+static int sched_edf_install(parsec_context_t* master);
+static int sched_edf_schedule(parsec_execution_stream_t* es,
+                              parsec_task_t* new_context,
+                              int32_t distance);
+static parsec_task_t*
+sched_edf_select(parsec_execution_stream_t *es,
+                 int32_t* distance);
+static void sched_edf_display_stats(parsec_execution_stream_t* es);
+static void sched_edf_remove(parsec_context_t* master);
+static int flow_edf_init(parsec_execution_stream_t* es, struct parsec_barrier_t* barrier);
+
+const parsec_sched_module_t parsec_sched_edf_module = {
+    &parsec_sched_edf_component,
+    {
+        sched_edf_install,
+        flow_edf_init,
+        sched_edf_schedule,
+        sched_edf_select,
+        sched_edf_display_stats,
+        sched_edf_remove,
+        NULL,
+        NULL
+    }
+};
+
+/**
+ * Each execution stream owns a binary min-heap of ready tasks, stored in
+ * an array and ordered by deadline, then by decreasing priority. The
+ * deadline is evaluated once, when the task is inserted. The size of the
+ * heap and the deadline at its root are published outside of the lock,
+ * so the other execution streams can find the heap holding the earliest
+ * deadline without locking all the heaps.
+ */
+typedef struct sched_edf_entry_s {
+    uint64_t       deadline;
+    int32_t        priority;
+    parsec_task_t *task;
+} sched_edf_entry_t;
+
+typedef struct sched_edf_heap_s {
+    parsec_atomic_lock_t  lock;
+    int32_t               size;
+    int32_t               capacity;
+    sched_edf_entry_t    *entries;
+    volatile int32_t      nb_ready;  /**< Published size */
+    volatile uint64_t     earliest;  /**< Published deadline of the root, only meaningful if nb_ready > 0 */
+} sched_edf_heap_t;
+
+typedef struct sched_edf_object_s {
+    sched_edf_heap_t          heap;
+    int                       nb_peers;
+    sched_edf_heap_t        **peers;    /**< The heaps of the other execution streams of the VP */
+    uint64_t                  running;  /**< Deadline of the last selected task */
+    parsec_sched_edf_stats_t  stats;
+} sched_edf_object_t;
+
+#define SCHED_EDF_OBJECT(es) ((sched_edf_object_t*)(es)->scheduler_object)
+
+static parsec_context_t *sched_edf_context = NULL;
+
+static inline int sched_edf_before(const sched_edf_entry_t *a, const sched_edf_entry_t *b)
+{
+    return (a->deadline < b->deadline) ||
+        ((a->deadline == b->deadline) && (a->priority > b->priority));
+}
+
+/* Must be called with the heap lock held */
+static void sched_edf_heap_push(sched_edf_heap_t *heap, parsec_task_t *task)
+{
+    sched_edf_entry_t entry;
+    int i, parent;
+
+    if( heap->size == heap->capacity ) {
+        heap->capacity = (0 == heap->capacity) ? 64 : 2 * heap->capacity;
+        heap->entries = (sched_edf_entry_t*)realloc(heap->entries, heap->capacity * sizeof(sched_edf_entry_t));
+    }
+    entry.deadline = (NULL == task->task_class->deadline) ? PARSEC_DEADLINE_NONE :
+        task->task_class->deadline(task);
+    entry.priority = task->priority;
+    entry.task = task;
+    for( i = heap->size++; i > 0; i = parent ) {
+        parent = (i - 1) / 2;
+        if( !sched_edf_before(&entry, &heap->entries[parent]) ) break;
+        heap->entries[i] = heap->entries[parent];
+    }
+    heap->entries[i] = entry;
+}
+
+/* Must be called with the heap lock held, on a non-empty heap */
+static sched_edf_entry_t sched_edf_heap_pop(sched_edf_heap_t *heap)
+{
+    sched_edf_entry_t top = heap->entries[0], last;
+    int i, child;
+
+    last = heap->entries[--heap->size];
+    for( i = 0; (child = 2 * i + 1) < heap->size; i = child ) {
+        if( (child + 1 < heap->size) && sched_edf_before(&heap->entries[child + 1], &heap->entries[child]) )
+            child++;
+        if( !sched_edf_before(&heap->entries[child], &last) ) break;
+        heap->entries[i] = heap->entries[child];
+    }
+    heap->entries[i] = last;
+    return top;
+}
+
+/* Must be called with the heap lock held */
+static inline void sched_edf_heap_publish(sched_edf_heap_t *heap)
+{
+    heap->earliest = (0 == heap->size) ? PARSEC_DEADLINE_NONE : heap->entries[0].deadline;
+    parsec_atomic_wmb();
+    heap->nb_ready = heap->size;
+}
+
+static int sched_edf_install( parsec_context_t *master )
+{
+    sched_edf_context = master;
+    return PARSEC_SUCCESS;
+}
+
+static int flow_edf_init(parsec_execution_stream_t* es, struct parsec_barrier_t* barrier)
+{
+    parsec_vp_t *vp = es->virtual_process;
+    sched_edf_object_t *eo;
+    int i;
+
+    eo = (sched_edf_object_t*)calloc(1, sizeof(sched_edf_object_t));
+    parsec_atomic_lock_init(&eo->heap.lock);
+    eo->heap.earliest = PARSEC_DEADLINE_NONE;
+    eo->running = PARSEC_DEADLINE_NONE;
+    es->scheduler_object = eo;
+
+    /* All the heaps must exist before the peers are known */
+    parsec_barrier_wait(barrier);
+
+    /* The closest execution streams (by thread id) are tried first when
+     * several heaps hold the same earliest deadline */
+    eo->nb_peers = vp->nb_cores - 1;
+    eo->peers = (sched_edf_heap_t**)malloc((eo->nb_peers + 1) * sizeof(sched_edf_heap_t*));
+    for( i = 0; i < eo->nb_peers; i++ ) {
+        eo->peers[i] = &SCHED_EDF_OBJECT(vp->execution_streams[(es->th_id + i + 1) % vp->nb_cores])->heap;
+    }
+    return PARSEC_SUCCESS;
+}
+
+static int sched_edf_schedule(parsec_execution_stream_t* es,
+                              parsec_task_t* new_context,
+                              int32_t distance)
+{
+    sched_edf_object_t *eo = SCHED_EDF_OBJECT(es);
+    parsec_list_item_t *ring = &new_context->super, *item;
+
+    parsec_atomic_lock(&eo->heap.lock);
+    while( NULL != ring ) {
+        item = ring;
+        ring = parsec_list_item_ring_chop(item);
+        PARSEC_LIST_ITEM_SINGLETON(item);
+        sched_edf_heap_push(&eo->heap, (parsec_task_t*)item);
+        eo->stats.nb_scheduled++;
+    }
+    sched_edf_heap_publish(&eo->heap);
+    parsec_atomic_unlock(&eo->heap.lock);
+    /* The deadline decides the order, the distance hint is ignored */
+    (void)distance;
+    return PARSEC_SUCCESS;
+}
+
+/**
+ * The task selected last by this execution stream has completed: check it
+ * against its deadline.
+ */
+static inline void sched_edf_complete(sched_edf_object_t *eo, uint64_t now)
+{
+    if( now > eo->running ) {
+        eo->stats.nb_misses++;
+        if( now - eo->running > eo->stats.max_lateness )
+            eo->stats.max_lateness = now - eo->running;
+    }
+    eo->running = PARSEC_DEADLINE_NONE;
+}
+
+static parsec_task_t*
+sched_edf_select(parsec_execution_stream_t *es,
+                 int32_t* distance)
+{
+    sched_edf_object_t *eo = SCHED_EDF_OBJECT(es);
+    sched_edf_heap_t *victim, *heap;
+    sched_edf_entry_t entry;
+    uint64_t now = 0, earliest;
+    int i, d;
+
+    if( PARSEC_DEADLINE_NONE != eo->running ) {
+        now = parsec_deadline_now();
+        sched_edf_complete(eo, now);
+    }
+    while( 1 ) {
+        victim = NULL;
+        earliest = PARSEC_DEADLINE_NONE;
+        d = 0;
+        if( eo->heap.nb_ready > 0 ) {
+            victim = &eo->heap;
+            earliest = eo->heap.earliest;
+        }
+        if( (NULL == victim) || sched_edf_steal_earliest ) {
+            for( i = 0; i < eo->nb_peers; i++ ) {
+                heap = eo->peers[i];
+                if( heap->nb_ready <= 0 ) continue;
+                if( (NULL == victim) || (heap->earliest < earliest) ) {
+                    victim = heap;
+                    earliest = heap->earliest;
+                    d = i + 1;
+                }
+            }
+        }
+        if( NULL == victim ) return NULL;
+
+        parsec_atomic_lock(&victim->lock);
+        if( 0 == victim->size ) {
+            /* Another execution stream emptied the heap */
+            parsec_atomic_unlock(&victim->lock);
+            continue;
+        }
+        entry = sched_edf_heap_pop(victim);
+        sched_edf_heap_publish(victim);
+        parsec_atomic_unlock(&victim->lock);
+        break;
+    }
+
+    eo->stats.nb_selected++;
+    if( 0 != d ) eo->stats.nb_steals++;
+    if( PARSEC_DEADLINE_NONE != entry.deadline ) {
+        if( 0 == now ) now = parsec_deadline_now();
+        eo->stats.nb_deadlines++;
+        if( now > entry.deadline ) eo->stats.nb_late_starts++;
+        eo->running = entry.deadline;
+    }
+    *distance = d;
+    return entry.task;
+}
+
+int parsec_sched_edf_stats(parsec_context_t *context,
+                           parsec_sched_edf_stats_t *stats)
+{
+    parsec_execution_stream_t *es;
+    sched_edf_object_t *eo;
+    int p, t;
+
+    if( (NULL == sched_edf_context) || (context != sched_edf_context) )
+        return PARSEC_ERR_NOT_FOUND;
+    memset(stats, 0, sizeof(parsec_sched_edf_stats_t));
+    for(p = 0; p < context->nb_vp; p++) {
+        for(t = 0; t < context->virtual_processes[p]->nb_cores; t++) {
+            es = context->virtual_processes[p]->execution_streams[t];
+            if( (NULL == es) || (NULL == es->scheduler_object) ) continue;
+            eo = SCHED_EDF_OBJECT(es);
+            stats->nb_scheduled   += eo->stats.nb_scheduled;
+            stats->nb_selected    += eo->stats.nb_selected;
+            stats->nb_deadlines   += eo->stats.nb_deadlines;
+            stats->nb_late_starts += eo->stats.nb_late_starts;
+            stats->nb_misses      += eo->stats.nb_misses;
+            stats->nb_steals      += eo->stats.nb_steals;
+            if( eo->stats.max_lateness > stats->max_lateness )
+                stats->max_lateness = eo->stats.max_lateness;
+        }
+    }
+    return PARSEC_SUCCESS;
+}
+
+static void sched_edf_display_stats(parsec_execution_stream_t* es)
+{
+    sched_edf_object_t *eo = SCHED_EDF_OBJECT(es);
+
+    parsec_inform("EDF %d/%d: scheduled %"PRIu64" selected %"PRIu64" (stolen %"PRIu64") with a deadline %"PRIu64
+                  " started late %"PRIu64" missed %"PRIu64" max lateness %"PRIu64" ns",
+                  es->virtual_process->vp_id, es->th_id, eo->stats.nb_scheduled, eo->stats.nb_selected,
+                  eo->stats.nb_steals, eo->stats.nb_deadlines, eo->stats.nb_late_starts,
+                  eo->stats.nb_misses, eo->stats.max_lateness);
+}
+
+static void sched_edf_remove( parsec_context_t *master )
+{
+    int p, t;
+    parsec_execution_stream_t *es;
+    sched_edf_object_t *eo;
+    parsec_vp_t *vp;
+
+    for(p = 0; p < master->nb_vp; p++) {
+        vp = master->virtual_processes[p];
+        for(t = 0; t < vp->nb_cores; t++) {
+            es = vp->execution_streams[t];
+            if( (NULL == es) || (NULL == es->scheduler_object) )
+                continue;
+            eo = SCHED_EDF_OBJECT(es);
+            if( sched_edf_report )
+                sched_edf_display_stats(es);
+            assert(0 == eo->heap.size);
+            free(eo->heap.entries);
+            free(eo->peers);
+            free(eo);
+            es->scheduler_object = NULL;
+        }
+    }
+    sched_edf_context = NULL;
+}
@@ -21,6 +21,9 @@
 #include "parsec/mca/sched/sched.h"
 #include "parsec/mca/sched/gd/sched_gd.h"
 #include "parsec/papi_sde.h"
+#include "parsec/utils/mca_param.h"
+
+int sched_gd_owner_deque = 0;
 
 /*
  * Local function
@@ -81,5 +84,9 @@ static int sched_gd_component_register(void)
                               "the number of pending tasks for the GD scheduler");
     PARSEC_PAPI_SDE_DESCRIBE_COUNTER("SCHEDULER::PENDING_TASKS::QUEUE=<VPID>::SCHED=GD",
                               "the number of pending tasks for the GD scheduler on virtual process <VPID>");
+    parsec_mca_param_reg_int_name("sched_gd", "owner_deque",
+                                  "Push the tasks an execution stream schedules locally in its own work-stealing deque, "
+                                  "and let idle execution streams steal from these deques (0: use only the shared queue)",
+                                  false, false, sched_gd_owner_deque, &sched_gd_owner_deque);
     return MCA_SUCCESS;
 }
@@ -18,6 +18,7 @@
 #include "parsec/class/dequeue.h"
 #include "parsec/mca/pins/pins.h"
 #include "parsec/papi_sde.h"
+#include "parsec/mca/sched/sched_local_queues_utils.h"
 
 /**
  * Module functions
@@ -40,7 +41,9 @@ const parsec_sched_module_t parsec_sched_gd_module = {
         sched_gd_schedule,
         sched_gd_select,
         NULL,
-        sched_gd_remove
+        sched_gd_remove,
+        NULL,
+        NULL
     }
 };
 
@@ -55,6 +58,10 @@ typedef parsec_dequeue_t shared_dequeue_with_local_counter_t;
 
 #define LOCAL_SCHED_OBJECT(eu_context) ((shared_dequeue_with_local_counter_t*)(eu_context)->scheduler_object)
 
+/* Per virtual process owner deques, when sched_gd_owner_deque is set */
+static parsec_mca_sched_owner_deques_t **sched_gd_owner_deques = NULL;
+#define OWNER_DEQUES(es) ((NULL == sched_gd_owner_deques) ? NULL : sched_gd_owner_deques[(es)->virtual_process->vp_id])
+
 #if defined(PARSEC_PAPI_SDE)
 static long long int parsec_shared_dequeue_length( parsec_vp_t *vp )
 {
@@ -70,7 +77,9 @@ static long long int parsec_shared_dequeue_length( parsec_vp_t *vp )
 
 static int sched_gd_install( parsec_context_t *master )
 {
-    (void)master;
+    if( sched_gd_owner_deque ) {
+        sched_gd_owner_deques = (parsec_mca_sched_owner_deques_t**)calloc(master->nb_vp, sizeof(parsec_mca_sched_owner_deques_t*));
+    }
     return PARSEC_SUCCESS;
 }
 
@@ -91,6 +100,9 @@ static int flow_gd_init(parsec_execution_stream_t* es, struct parsec_barrier_t*
 #else
         es->scheduler_object = PARSEC_OBJ_NEW(parsec_dequeue_t);
 #endif
+        if( NULL != sched_gd_owner_deques ) {
+            sched_gd_owner_deques[vp->vp_id] = parsec_mca_sched_owner_deques_new(vp->nb_cores);
+        }
     }
     
     parsec_barrier_wait(barrier);
@@ -125,16 +137,21 @@ sched_gd_select(parsec_execution_stream_t *es,
                 int32_t* distance)
 {
     shared_dequeue_with_local_counter_t *sd = LOCAL_SCHED_OBJECT(es);
+    parsec_mca_sched_owner_deques_t *od = OWNER_DEQUES(es);
+    parsec_task_t * context;
+
+    *distance = 0;
+    if( NULL != od && NULL != (context = parsec_mca_sched_owner_deques_pop(od, es)) )
+        return context;
 #if defined(PARSEC_PAPI_SDE)
-    parsec_task_t * context =
-        (parsec_task_t*)parsec_dequeue_try_pop_front( sd->dequeue );
+    context = (parsec_task_t*)parsec_dequeue_try_pop_front( sd->dequeue );
     if(NULL != context)
         sd->local_counter--;
 #else
-    parsec_task_t * context =
-        (parsec_task_t*)parsec_dequeue_try_pop_front( sd );
+    context = (parsec_task_t*)parsec_dequeue_try_pop_front( sd );
 #endif
-    *distance = 0;
+    if( NULL == context && NULL != od )
+        context = parsec_mca_sched_owner_deques_steal(od, es, distance);
     return context;
 }
 
@@ -144,6 +161,10 @@ static int sched_gd_schedule(parsec_execution_stream_t* es,
 {
     shared_dequeue_with_local_counter_t *sd = LOCAL_SCHED_OBJECT(es);
     parsec_dequeue_t *dq;
+
+    if( NULL != OWNER_DEQUES(es) &&
+        parsec_mca_sched_owner_deques_push(OWNER_DEQUES(es), es, new_context, distance) )
+        return PARSEC_SUCCESS;
 #if defined(PARSEC_PAPI_SDE)
     int len = 0;
     _LIST_ITEM_ITERATOR(new_context, &new_context->super, item, {len++; });
@@ -183,7 +204,12 @@ static void sched_gd_remove( parsec_context_t *master )
 #endif
             es->scheduler_object = NULL;
         }
+        if( NULL != sched_gd_owner_deques && NULL != sched_gd_owner_deques[p] ) {
+            parsec_mca_sched_owner_deques_free(sched_gd_owner_deques[p]);
+        }
         PARSEC_PAPI_SDE_UNREGISTER_COUNTER("SCHEDULER::PENDING_TASKS::QUEUE=%d::SCHED=GD", p);
     }
+    free(sched_gd_owner_deques);
+    sched_gd_owner_deques = NULL;
     PARSEC_PAPI_SDE_UNREGISTER_COUNTER("SCHEDULER::PENDING_TASKS::SCHED=GD");
 }
@@ -40,15 +40,23 @@ const parsec_sched_module_t parsec_sched_ip_module = {
         sched_ip_schedule,
         sched_ip_select,
         NULL,
-        sched_ip_remove
+        sched_ip_remove,
+        NULL,
+        NULL
     }
 };
 
 #define LOCAL_SCHED_OBJECT(eu_context) ((parsec_mca_sched_list_local_counter_t*)(eu_context)->scheduler_object)
 
+/* Per virtual process owner deques, when sched_ip_owner_deque is set */
+static parsec_mca_sched_owner_deques_t **sched_ip_owner_deques = NULL;
+#define OWNER_DEQUES(es) ((NULL == sched_ip_owner_deques) ? NULL : sched_ip_owner_deques[(es)->virtual_process->vp_id])
+
 static int sched_ip_install( parsec_context_t *master )
 {
-    (void)master;
+    if( sched_ip_owner_deque ) {
+        sched_ip_owner_deques = (parsec_mca_sched_owner_deques_t**)calloc(master->nb_vp, sizeof(parsec_mca_sched_owner_deques_t*));
+    }
     return PARSEC_SUCCESS;
 }
 
@@ -58,6 +66,9 @@ static int flow_ip_init(parsec_execution_stream_t* es, struct parsec_barrier_t*
 
     if (es == vp->execution_streams[0]) {
         es->scheduler_object = parsec_mca_sched_allocate_list_local_counter(NULL);
+        if( NULL != sched_ip_owner_deques ) {
+            sched_ip_owner_deques[vp->vp_id] = parsec_mca_sched_owner_deques_new(vp->nb_cores);
+        }
     }
 
     parsec_barrier_wait(barrier);
@@ -85,8 +96,15 @@ static parsec_task_t*
 sched_ip_select(parsec_execution_stream_t *es,
                 int32_t* distance)
 {
-    parsec_task_t * context = parsec_mca_sched_list_local_counter_pop_back(LOCAL_SCHED_OBJECT(es));
+    parsec_mca_sched_owner_deques_t *od = OWNER_DEQUES(es);
+    parsec_task_t * context;
+
     *distance = 0;
+    if( NULL != od && NULL != (context = parsec_mca_sched_owner_deques_pop(od, es)) )
+        return context;
+    context = parsec_mca_sched_list_local_counter_pop_back(LOCAL_SCHED_OBJECT(es));
+    if( NULL == context && NULL != od )
+        context = parsec_mca_sched_owner_deques_steal(od, es, distance);
     return context;
 }
 
@@ -104,6 +122,9 @@ static int sched_ip_schedule(parsec_execution_stream_t* es,
         it = (parsec_list_item_t*)((parsec_list_item_t*)it)->list_next;
     } while( it != (parsec_list_item_t*)new_context );
 #endif
+    if( NULL != OWNER_DEQUES(es) &&
+        parsec_mca_sched_owner_deques_push(OWNER_DEQUES(es), es, new_context, distance) )
+        return PARSEC_SUCCESS;
     if( 0 == distance ) {
         parsec_mca_sched_list_local_counter_chain_sorted(sl, new_context, parsec_execution_context_priority_comparator);
     } else {
@@ -127,7 +148,12 @@ static void sched_ip_remove( parsec_context_t *master )
             parsec_mca_sched_free_list_local_counter(sl);
             es->scheduler_object = NULL;
         }
+        if( NULL != sched_ip_owner_deques && NULL != sched_ip_owner_deques[p] ) {
+            parsec_mca_sched_owner_deques_free(sched_ip_owner_deques[p]);
+        }
         PARSEC_PAPI_SDE_UNREGISTER_COUNTER("SCHEDULER::PENDING_TASKS::QUEUE=%d::SCHED=IP", p);
     }
+    free(sched_ip_owner_deques);
+    sched_ip_owner_deques = NULL;
     PARSEC_PAPI_SDE_UNREGISTER_COUNTER("SCHEDULER::PENDING_TASKS::SCHED=IP");
 }
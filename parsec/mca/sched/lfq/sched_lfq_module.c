@@ -33,6 +33,10 @@ static int sched_lfq_schedule(parsec_execution_stream_t* es,
 static parsec_task_t*
 sched_lfq_select(parsec_execution_stream_t *es,
                  int32_t* distance);
+static int
+sched_lfq_select_batch(parsec_execution_stream_t *es,
+                       parsec_task_t **tasks, int max,
+                       int32_t* distance);
 static void sched_lfq_remove(parsec_context_t* master);
 static int flow_lfq_init(parsec_execution_stream_t* es, struct parsec_barrier_t* barrier);
 
@@ -44,7 +48,9 @@ const parsec_sched_module_t parsec_sched_lfq_module = {
         sched_lfq_schedule,
         sched_lfq_select,
         NULL,
-        sched_lfq_remove
+        sched_lfq_remove,
+        sched_lfq_select_batch,
+        NULL
     }
 };
 
@@ -192,6 +198,34 @@ sched_lfq_select(parsec_execution_stream_t *es,
     return task;
 }
 
+/*
+ * Drain up to max tasks from the local queue, best first. If the local
+ * queue is empty, fall back to the single task selection, to avoid
+ * emptying the queues of the other execution streams.
+ */
+static int
+sched_lfq_select_batch(parsec_execution_stream_t *es,
+                       parsec_task_t **tasks, int max,
+                       int32_t* distance)
+{
+    parsec_hbbuffer_t *task_queue = PARSEC_MCA_SCHED_LOCAL_QUEUES_OBJECT(es)->task_queue;
+    int n = 0;
+
+    while( n < max ) {
+        tasks[n] = (parsec_task_t*)parsec_hbbuffer_pop_best(task_queue,
+                                                             parsec_execution_context_priority_comparator);
+        if( NULL == tasks[n] )
+            break;
+        n++;
+    }
+    if( n > 0 ) {
+        *distance = 0;
+        return n;
+    }
+    tasks[0] = sched_lfq_select(es, distance);
+    return (NULL == tasks[0]) ? 0 : 1;
+}
+
 static int sched_lfq_schedule(parsec_execution_stream_t* es,
                               parsec_task_t* new_context,
                               int32_t distance)
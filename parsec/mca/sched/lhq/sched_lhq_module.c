@@ -44,7 +44,9 @@ const parsec_sched_module_t parsec_sched_lhq_module = {
         sched_lhq_schedule,
         sched_lhq_select,
         NULL,
-        sched_lhq_remove
+        sched_lhq_remove,
+        NULL,
+        NULL
     }
 };
 
@@ -31,6 +31,10 @@ static int sched_ll_schedule(parsec_execution_stream_t* es,
 static parsec_task_t*
 sched_ll_select(parsec_execution_stream_t *es,
                  int32_t* distance);
+static int
+sched_ll_select_batch(parsec_execution_stream_t *es,
+                      parsec_task_t **tasks, int max,
+                      int32_t* distance);
 static void sched_ll_remove(parsec_context_t* master);
 static int flow_ll_init(parsec_execution_stream_t* es, struct parsec_barrier_t* barrier);
 static int sched_ll_warning_issued = 0;
@@ -43,7 +47,9 @@ const parsec_sched_module_t parsec_sched_ll_module = {
         sched_ll_schedule,
         sched_ll_select,
         NULL,
-        sched_ll_remove
+        sched_ll_remove,
+        sched_ll_select_batch,
+        NULL
     }
 };
 
@@ -205,6 +211,45 @@ static parsec_task_t* sched_ll_select(parsec_execution_stream_t *es,
     }
 }
 
+/**
+ * @brief
+ *   Selects a batch of tasks to run
+ *
+ * @details
+ *   Pop up to max tasks from the calling execution stream LIFO. If that
+ *   LIFO is empty, steal a single task from the other execution streams
+ *   LIFOs, as sched_ll_select does.
+ *
+ *   @param[INOUT] es     the calling execution stream
+ *   @param[OUT] tasks    the selected tasks
+ *   @param[IN] max       the maximal number of tasks to select
+ *   @param[OUT] distance the distance of the selected tasks
+ *   @return the number of selected tasks
+ */
+static int sched_ll_select_batch(parsec_execution_stream_t *es,
+                                 parsec_task_t **tasks, int max,
+                                 int32_t* distance)
+{
+    parsec_lifo_with_local_counter_t *es_sched_obj = (parsec_lifo_with_local_counter_t*)es->scheduler_object;
+    int n = 0;
+
+    while( n < max ) {
+        tasks[n] = (parsec_task_t*)parsec_lifo_pop(&es_sched_obj->lifo);
+        if( NULL == tasks[n] )
+            break;
+        n++;
+    }
+    if( n > 0 ) {
+#if defined(PARSEC_PAPI_SDE)
+        es_sched_obj->local_counter -= n;
+#endif
+        *distance = 0;
+        return n;
+    }
+    tasks[0] = sched_ll_select(es, distance);
+    return (NULL == tasks[0]) ? 0 : 1;
+}
+
 /**
  * @brief
  *  Schedule a set of ready tasks on the calling execution stream
@@ -36,6 +36,10 @@ static int sched_llp_schedule(parsec_execution_stream_t* es,
 static parsec_task_t*
 sched_llp_select(parsec_execution_stream_t *es,
                  int32_t* distance);
+static int
+sched_llp_select_batch(parsec_execution_stream_t *es,
+                       parsec_task_t **tasks, int max,
+                       int32_t* distance);
 static void sched_llp_remove(parsec_context_t* master);
 static int flow_llp_init(parsec_execution_stream_t* es, struct parsec_barrier_t* barrier);
 
@@ -75,7 +79,9 @@ const parsec_sched_module_t parsec_sched_llp_module = {
         sched_llp_schedule,
         sched_llp_select,
         NULL,
-        sched_llp_remove
+        sched_llp_remove,
+        sched_llp_select_batch,
+        NULL
     }
 };
 
@@ -236,6 +242,45 @@ static parsec_task_t* sched_llp_select(parsec_execution_stream_t *es,
     return task;
 }
 
+/**
+ * @brief
+ *   Selects a batch of tasks to run
+ *
+ * @details
+ *   Pop up to max tasks from the calling execution stream LIFO, in
+ *   priority order. If that LIFO is empty, steal a single task from the
+ *   other execution streams LIFOs, as sched_llp_select does.
+ *
+ *   @param[INOUT] es     the calling execution stream
+ *   @param[OUT] tasks    the selected tasks
+ *   @param[IN] max       the maximal number of tasks to select
+ *   @param[OUT] distance the distance of the selected tasks
+ *   @return the number of selected tasks
+ */
+static int sched_llp_select_batch(parsec_execution_stream_t *es,
+                                  parsec_task_t **tasks, int max,
+                                  int32_t* distance)
+{
+    parsec_lifo_with_prio_t *es_sched_obj = (parsec_lifo_with_prio_t*)es->scheduler_object;
+    int n = 0;
+
+    while( n < max ) {
+        tasks[n] = (parsec_task_t*)parsec_lifo_pop(&es_sched_obj->lifo);
+        if( NULL == tasks[n] )
+            break;
+        n++;
+    }
+    if( n > 0 ) {
+#if defined(PARSEC_PAPI_SDE)
+        es_sched_obj->local_counter -= n;
+#endif
+        *distance = 0;
+        return n;
+    }
+    tasks[0] = sched_llp_select(es, distance);
+    return (NULL == tasks[0]) ? 0 : 1;
+}
+
 /**
  * @brief
  *  Schedule a set of ready tasks on the calling execution stream
@@ -0,0 +1,46 @@
+/*
+ * Copyright (c) 2023      The University of Tennessee and The University
+ *                         of Tennessee Research Foundation.  All rights
+ *                         reserved.
+ * $COPYRIGHT$
+ * 
+ * Additional copyrights may follow
+ * 
+ * $HEADER$
+ */
+
+/**
+ * @file
+ *
+ * NUMA-aware hierarchical Work Stealing scheduler
+ *
+ */
+
+
+#ifndef MCA_SCHED_NWS_H
+#define MCA_SCHED_NWS_H
+
+#include "parsec/parsec_config.h"
+#include "parsec/mca/mca.h"
+#include "parsec/mca/sched/sched.h"
+
+
+BEGIN_C_DECLS
+
+/**
+ * Globally exported variable
+ */
+PARSEC_DECLSPEC extern const parsec_sched_base_component_t parsec_sched_nws_component;
+PARSEC_DECLSPEC extern const parsec_sched_module_t parsec_sched_nws_module;
+/* static accessor */
+mca_base_component_t *sched_nws_static_component(void);
+
+/**
+ * Number of consecutive unsuccessful selections an execution stream
+ * tolerates before it starts stealing outside of its NUMA domain.
+ */
+extern int sched_nws_remote_steal_delay;
+
+
+END_C_DECLS
+#endif /* MCA_SCHED_NWS_H */
@@ -0,0 +1,282 @@
+/**
+ * Copyright (c) 2023      The University of Tennessee and The University
+ *                         of Tennessee Research Foundation.  All rights
+ *                         reserved.
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ *
+ */
+
+#include "parsec/parsec_config.h"
+#include "parsec/parsec_internal.h"
+#include "parsec/utils/debug.h"
+#include "parsec/class/dequeue.h"
+
+#include "parsec/mca/sched/sched.h"
+#include "parsec/mca/sched/nws/sched_nws.h"
+#include "parsec/mca/pins/pins.h"
+#include "parsec/parsec_hwloc.h"
+
+/**
+ * Module functions
+ */
+static int sched_nws_install(parsec_context_t* master);
+static int sched_nws_schedule(parsec_execution_stream_t* es,
+                              parsec_task_t* new_context,
+                              int32_t distance);
+static parsec_task_t*
+sched_nws_select(parsec_execution_stream_t *es,
+                 int32_t* distance);
+static void sched_nws_display_stats(parsec_execution_stream_t* es);
+static void sched_nws_remove(parsec_context_t* master);
+static int flow_nws_init(parsec_execution_stream_t* es, struct parsec_barrier_t* barrier);
+
+const parsec_sched_module_t parsec_sched_nws_module = {
+    &parsec_sched_nws_component,
+    {
+        sched_nws_install,
+        flow_nws_init,
+        sched_nws_schedule,
+        sched_nws_select,
+        sched_nws_display_stats,
+        sched_nws_remove,
+        NULL,
+        NULL
+    }
+};
+
+/**
+ * The victims of an execution stream are grouped in rings of increasing
+ * cost. The ring index is also the distance returned by the select
+ * function, so the print_steals PINS module directly reports the locality
+ * of the steals.
+ */
+#define SCHED_NWS_RING_LOCAL   0  /**< the task was found in the local queue */
+#define SCHED_NWS_RING_SMT     1  /**< hardware threads of the same core */
+#define SCHED_NWS_RING_NUMA    2  /**< cores sharing the same NUMA node (and L3) */
+#define SCHED_NWS_RING_SOCKET  3  /**< cores of the same socket but another NUMA node */
+#define SCHED_NWS_RING_REMOTE  4  /**< cores on another socket */
+#define SCHED_NWS_NB_RINGS     5
+#define SCHED_NWS_SYSTEM_QUEUE SCHED_NWS_NB_RINGS  /**< the task was found in the shared queue */
+
+typedef struct sched_nws_object_s {
+    parsec_dequeue_t             task_queue;    /**< Only the owner pushes; the owner pops the front,
+                                                 *   thieves pop the back */
+    parsec_dequeue_t            *system_queue;  /**< Shared by all streams of the VP, receives the
+                                                 *   tasks scheduled with a positive distance */
+    int                          core_id;
+    int                          numa_id;
+    int                          socket_id;
+    int                          nb_victims;
+    int                          ring_end[SCHED_NWS_NB_RINGS]; /**< victims[ring_end[r-1]..ring_end[r]) are in ring r */
+    struct sched_nws_object_s  **victims;       /**< Ordered from the closest to the farthest */
+    int                          failed_selects; /**< Consecutive selections that found no task */
+    uint64_t                     found[SCHED_NWS_NB_RINGS+1]; /**< Number of tasks found per ring */
+} sched_nws_object_t;
+
+#define SCHED_NWS_OBJECT(es) ((sched_nws_object_t*)(es)->scheduler_object)
+
+static int sched_nws_install( parsec_context_t *master )
+{
+    (void)master;
+    return PARSEC_SUCCESS;
+}
+
+/**
+ * Classify the execution stream owning victim with respect to the one owning me.
+ * Missing topology information (negative identifiers) is considered a match, so
+ * that a machine where hwloc cannot report NUMA nodes degrades to a per-socket
+ * or a flat ordering.
+ */
+static int sched_nws_ring(const sched_nws_object_t *me, const sched_nws_object_t *victim)
+{
+    if( me->core_id == victim->core_id )
+        return SCHED_NWS_RING_SMT;
+    if( (me->numa_id < 0) || (victim->numa_id < 0) || (me->numa_id == victim->numa_id) ) {
+        if( (me->socket_id < 0) || (victim->socket_id < 0) || (me->socket_id == victim->socket_id) )
+            return SCHED_NWS_RING_NUMA;
+        return SCHED_NWS_RING_REMOTE;
+    }
+    if( (me->socket_id >= 0) && (me->socket_id == victim->socket_id) )
+        return SCHED_NWS_RING_SOCKET;
+    return SCHED_NWS_RING_REMOTE;
+}
+
+typedef struct {
+    int                 ring;
+    int                 hw_distance;
+    int                 rank;  /**< position after the owner, to spread the thieves */
+    sched_nws_object_t *obj;
+} sched_nws_victim_t;
+
+static int sched_nws_victim_compare(const void *a, const void *b)
+{
+    const sched_nws_victim_t *va = (const sched_nws_victim_t*)a;
+    const sched_nws_victim_t *vb = (const sched_nws_victim_t*)b;
+    if( va->ring != vb->ring ) return va->ring - vb->ring;
+    if( va->hw_distance != vb->hw_distance ) return va->hw_distance - vb->hw_distance;
+    return va->rank - vb->rank;
+}
+
+static int flow_nws_init(parsec_execution_stream_t* es, struct parsec_barrier_t* barrier)
+{
+    parsec_vp_t *vp = es->virtual_process;
+    sched_nws_object_t *sched_obj;
+    sched_nws_victim_t *victims;
+    int i, r, nv;
+
+    /* Every flow creates its own local object */
+    sched_obj = (sched_nws_object_t*)calloc(1, sizeof(sched_nws_object_t));
+    PARSEC_OBJ_CONSTRUCT(&sched_obj->task_queue, parsec_dequeue_t);
+    sched_obj->core_id   = es->core_id;
+#if defined(PARSEC_HAVE_HWLOC)
+    sched_obj->numa_id   = parsec_hwloc_numa_id(es->core_id);
+    sched_obj->socket_id = parsec_hwloc_socket_id(es->core_id);
+#else
+    sched_obj->numa_id   = -1;
+    sched_obj->socket_id = -1;
+#endif  /* defined(PARSEC_HAVE_HWLOC) */
+    es->scheduler_object = sched_obj;
+    if( 0 == es->th_id ) {  /* And flow 0 creates the system_queue */
+        sched_obj->system_queue = PARSEC_OBJ_NEW(parsec_dequeue_t);
+    }
+
+    /* All local allocations are now completed. Synchronize with the other
+     threads before setting up the victims hierarchy. */
+    parsec_barrier_wait(barrier);
+
+    sched_obj->system_queue = SCHED_NWS_OBJECT(vp->execution_streams[0])->system_queue;
+
+    victims = (sched_nws_victim_t*)malloc(vp->nb_cores * sizeof(sched_nws_victim_t));
+    for( nv = 0, i = 1; i < vp->nb_cores; i++ ) {
+        parsec_execution_stream_t *victim_es = vp->execution_streams[(es->th_id + i) % vp->nb_cores];
+        victims[nv].obj  = SCHED_NWS_OBJECT(victim_es);
+        victims[nv].ring = sched_nws_ring(sched_obj, victims[nv].obj);
+#if defined(PARSEC_HAVE_HWLOC)
+        victims[nv].hw_distance = parsec_hwloc_distance(es->core_id, victim_es->core_id);
+#else
+        victims[nv].hw_distance = 0;
+#endif  /* defined(PARSEC_HAVE_HWLOC) */
+        victims[nv].rank = i;
+        nv++;
+    }
+    qsort(victims, nv, sizeof(sched_nws_victim_t), sched_nws_victim_compare);
+
+    sched_obj->nb_victims = nv;
+    sched_obj->victims = (sched_nws_object_t**)malloc((nv > 0 ? nv : 1) * sizeof(sched_nws_object_t*));
+    for( i = 0, r = SCHED_NWS_RING_LOCAL; r < SCHED_NWS_NB_RINGS; r++ ) {
+        for( ; (i < nv) && (victims[i].ring == r); i++ ) {
+            sched_obj->victims[i] = victims[i].obj;
+            PARSEC_DEBUG_VERBOSE(20, parsec_debug_output, "NWS\t: %d:%d victim %d is %p in ring %d (hwloc distance %d)",
+                                 vp->vp_id, es->th_id, i, victims[i].obj, r, victims[i].hw_distance);
+        }
+        sched_obj->ring_end[r] = i;
+    }
+    free(victims);
+
+    /* Nobody can steal before everybody knows its victims */
+    parsec_barrier_wait(barrier);
+
+    return PARSEC_SUCCESS;
+}
+
+static parsec_task_t*
+sched_nws_select(parsec_execution_stream_t *es,
+                 int32_t* distance)
+{
+    sched_nws_object_t *sched_obj = SCHED_NWS_OBJECT(es);
+    parsec_task_t *task;
+    int i, r, last_ring;
+
+    task = (parsec_task_t*)parsec_dequeue_pop_front(&sched_obj->task_queue);
+    if( NULL != task ) {
+        *distance = SCHED_NWS_RING_LOCAL;
+        goto task_found;
+    }
+
+    /* Stay in the NUMA domain until it has been empty for a while */
+    last_ring = (sched_obj->failed_selects < sched_nws_remote_steal_delay) ?
+        SCHED_NWS_RING_NUMA : SCHED_NWS_RING_REMOTE;
+    for( i = 0, r = SCHED_NWS_RING_SMT; r <= last_ring; r++ ) {
+        for( ; i < sched_obj->ring_end[r]; i++ ) {
+            /* Never wait on a busy victim, there is plenty of others to try */
+            task = (parsec_task_t*)parsec_dequeue_try_pop_back(&sched_obj->victims[i]->task_queue);
+            if( NULL != task ) {
+                PARSEC_DEBUG_VERBOSE(20, parsec_debug_output, "NWS\t: %d:%d stole task %p from victim %d in ring %d",
+                                     es->virtual_process->vp_id, es->th_id, task, i, r);
+                *distance = r;
+                goto task_found;
+            }
+        }
+    }
+
+    task = (parsec_task_t*)parsec_dequeue_try_pop_front(sched_obj->system_queue);
+    if( NULL != task ) {
+        *distance = SCHED_NWS_SYSTEM_QUEUE;
+        goto task_found;
+    }
+    sched_obj->failed_selects++;
+    return NULL;
+
+  task_found:
+    sched_obj->failed_selects = 0;
+    sched_obj->found[*distance]++;
+    return task;
+}
+
+static int sched_nws_schedule(parsec_execution_stream_t* es,
+                              parsec_task_t* new_context,
+                              int32_t distance)
+{
+    sched_nws_object_t *sched_obj = SCHED_NWS_OBJECT(es);
+
+    if( distance > 0 ) {
+        /* Tasks that could not make progress are pushed out of the way,
+         * in a queue considered only once all the deques are empty. */
+        parsec_dequeue_chain_back(sched_obj->system_queue, &new_context->super);
+        return PARSEC_SUCCESS;
+    }
+    parsec_list_chain_sorted((parsec_list_t*)&sched_obj->task_queue, &new_context->super,
+                             parsec_execution_context_priority_comparator);
+    return PARSEC_SUCCESS;
+}
+
+static void sched_nws_display_stats(parsec_execution_stream_t* es)
+{
+    sched_nws_object_t *sched_obj = SCHED_NWS_OBJECT(es);
+
+    parsec_inform("NWS %d:%d found tasks: local %"PRIu64" smt %"PRIu64" numa %"PRIu64
+                  " socket %"PRIu64" remote %"PRIu64" system %"PRIu64,
+                  es->virtual_process->vp_id, es->th_id,
+                  sched_obj->found[SCHED_NWS_RING_LOCAL], sched_obj->found[SCHED_NWS_RING_SMT],
+                  sched_obj->found[SCHED_NWS_RING_NUMA], sched_obj->found[SCHED_NWS_RING_SOCKET],
+                  sched_obj->found[SCHED_NWS_RING_REMOTE], sched_obj->found[SCHED_NWS_SYSTEM_QUEUE]);
+}
+
+static void sched_nws_remove( parsec_context_t *master )
+{
+    int p, t;
+    parsec_execution_stream_t *es;
+    parsec_vp_t *vp;
+    sched_nws_object_t *sched_obj;
+
+    for(p = 0; p < master->nb_vp; p++) {
+        vp = master->virtual_processes[p];
+        for(t = 0; t < vp->nb_cores; t++) {
+            es = vp->execution_streams[t];
+            if( (NULL == es) || (NULL == es->scheduler_object) )
+                continue;
+            sched_obj = SCHED_NWS_OBJECT(es);
+            if( 0 == es->th_id ) {
+                PARSEC_OBJ_RELEASE(sched_obj->system_queue);
+            }
+            PARSEC_OBJ_DESTRUCT(&sched_obj->task_queue);
+            free(sched_obj->victims);
+            free(sched_obj);
+            es->scheduler_object = NULL;
+        }
+    }
+}
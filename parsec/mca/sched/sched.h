@@ -286,6 +286,31 @@ typedef parsec_task_t *(*parsec_sched_base_module_select_fn_t)
                  (parsec_execution_stream_t *es,
                   int32_t* distance);
 
+/**
+ * @brief Batched Selecting Function
+ *
+ * @details
+ * Optional. Select up to max candidates at once, in the order in which they
+ * should be executed, and store them in tasks. The distance is set as in
+ * the select function, and applies to all the returned tasks. The runtime
+ * keeps these tasks in a buffer private to the execution stream, and only
+ * calls the scheduler again once they all have been executed. Schedulers
+ * that do not provide this function are called through select, one task
+ * at a time.
+ *
+ * @param[inout] es the execution stream that is calling the function
+ * @param[out]   tasks the array in which to store the selected tasks
+ * @param[in]    max the maximal number of tasks to select (at least 1)
+ * @param[out]   distance the distance from which the tasks were pulled (ignored
+ *                        if no task is returned)
+ * @return The number of tasks selected, 0 if none is selectable
+ */
+typedef int (*parsec_sched_base_module_select_batch_fn_t)
+                 (parsec_execution_stream_t *es,
+                  parsec_task_t **tasks,
+                  int max,
+                  int32_t* distance);
+
 /**
  * @brief Dump runtime statistics.
  *
@@ -322,6 +347,23 @@ typedef void (*parsec_sched_base_module_stats_fn_t)(parsec_execution_stream_t* e
  */
 typedef void (*parsec_sched_base_module_remove_fn_t)(parsec_context_t* master);
 
+/**
+ * @brief Quiescent point notification.
+ *
+ * @details
+ * Optional. Called by the master thread at the end of each
+ * parsec_context_wait, once all the taskpools of the context have
+ * completed and before parsec_context_wait returns. At this point the
+ * scheduler holds no task, and all the other execution streams are
+ * waiting for the next round: the scheduler may safely reorganize the
+ * structures pointed to by the scheduler_object of any execution stream.
+ * It is also called once by parsec_fini, before the execution streams are
+ * finalized, with __parsec_internal_finalization_in_progress set.
+ *
+ * @param[inout] master the parsec_context_t that reached the quiescent point
+ */
+typedef void (*parsec_sched_base_module_quiesce_fn_t)(parsec_context_t* master);
+
 struct parsec_sched_base_module_1_0_0_t {
     parsec_sched_base_module_install_fn_t      install;
     parsec_sched_base_module_flow_init_fn_t    flow_init;
@@ -329,6 +371,8 @@ struct parsec_sched_base_module_1_0_0_t {
     parsec_sched_base_module_select_fn_t       select;
     parsec_sched_base_module_stats_fn_t        display_stats;
     parsec_sched_base_module_remove_fn_t       remove;
+    parsec_sched_base_module_select_batch_fn_t select_batch;  /**< Optional, can be NULL */
+    parsec_sched_base_module_quiesce_fn_t      quiesce;       /**< Optional, can be NULL */
 };
 
 typedef struct parsec_sched_base_module_1_0_0_t parsec_sched_base_module_1_0_0_t;
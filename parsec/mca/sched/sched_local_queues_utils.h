@@ -20,6 +20,7 @@
 
 #include "parsec/parsec_config.h"
 #include "parsec/hbbuffer.h"
+#include "parsec/class/wsdeque.h"
 
 typedef struct {
     parsec_dequeue_t   *system_queue;               /* The overflow queue itself. */
@@ -92,6 +93,98 @@ static inline void parsec_mca_sched_push_in_buffer_wrapper(void *store, parsec_l
 }
 #endif
 
+/**
+ * Owner deques
+ *
+ * @details
+ *   Optional front-end for the schedulers based on a queue shared by
+ * all the execution streams of a virtual process (ap, gd, ip). Each
+ * execution stream owns a work-stealing deque (@ref
+ * parsec_internal_classes_wsdeque) in which it pushes, without any lock,
+ * the tasks it schedules itself at distance 0. Tasks scheduled by another
+ * thread (e.g. the communication thread) or at a higher distance go to
+ * the shared queue of the scheduler.
+ *
+ * The selection pops the local deque first, then the scheduler falls back
+ * to its shared queue, and finally steals batches of tasks from the deques
+ * of the other execution streams of the virtual process. The global
+ * ordering of the scheduler is thus only enforced among the tasks of the
+ * shared queue.
+ */
+typedef struct {
+    int               nb_deques;    /* One per execution stream of the virtual process */
+    parsec_wsdeque_t *deques[1];
+} parsec_mca_sched_owner_deques_t;
+
+static inline parsec_mca_sched_owner_deques_t *parsec_mca_sched_owner_deques_new(int nb_deques)
+{
+    parsec_mca_sched_owner_deques_t *od;
+    od = (parsec_mca_sched_owner_deques_t*)malloc(sizeof(parsec_mca_sched_owner_deques_t) +
+                                                  (nb_deques-1) * sizeof(parsec_wsdeque_t*));
+    od->nb_deques = nb_deques;
+    for(int i = 0; i < nb_deques; i++) {
+        od->deques[i] = PARSEC_OBJ_NEW(parsec_wsdeque_t);
+    }
+    return od;
+}
+
+static inline void parsec_mca_sched_owner_deques_free(parsec_mca_sched_owner_deques_t *od)
+{
+    for(int i = 0; i < od->nb_deques; i++) {
+        PARSEC_OBJ_RELEASE(od->deques[i]);
+    }
+    free(od);
+}
+
+/**
+ * Push the tasks in the deque owned by es if this is allowed.
+ * Returns 1 if the tasks were pushed, 0 if the caller must store
+ * them in its shared queue.
+ */
+static inline int parsec_mca_sched_owner_deques_push(parsec_mca_sched_owner_deques_t *od,
+                                                     parsec_execution_stream_t *es,
+                                                     parsec_task_t *it, int32_t distance)
+{
+    if( 0 != distance || es != parsec_my_execution_stream() )
+        return 0;
+    parsec_wsdeque_chain(od->deques[es->th_id], &it->super);
+    return 1;
+}
+
+static inline parsec_task_t *parsec_mca_sched_owner_deques_pop(parsec_mca_sched_owner_deques_t *od,
+                                                               parsec_execution_stream_t *es)
+{
+    return (parsec_task_t*)parsec_wsdeque_pop(od->deques[es->th_id]);
+}
+
+/**
+ * Steal a batch of tasks from the other execution streams, starting
+ * with the next one. The first task is returned, the others are pushed
+ * in the deque owned by es. distance is set to the number of deques
+ * visited.
+ */
+static inline parsec_task_t *parsec_mca_sched_owner_deques_steal(parsec_mca_sched_owner_deques_t *od,
+                                                                 parsec_execution_stream_t *es,
+                                                                 int32_t *distance)
+{
+    parsec_list_item_t *ring;
+    int i, victim;
+
+    for(i = 1; i < od->nb_deques; i++) {
+        victim = (es->th_id + i) % od->nb_deques;
+        ring = parsec_wsdeque_steal_half(od->deques[victim], PARSEC_WSDEQUE_MAX_STEAL, NULL);
+        if( NULL == ring )
+            continue;
+        *distance = i;
+        if( ring->list_next != ring ) {
+            parsec_list_item_t *rest = parsec_list_item_ring_chop(ring);
+            parsec_wsdeque_chain(od->deques[es->th_id], rest);
+        }
+        return (parsec_task_t*)ring;
+    }
+    return NULL;
+}
+
 /**
  * List with local counter
  *
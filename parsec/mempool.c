@@ -6,9 +6,221 @@
 
 #include "parsec/runtime.h"
 #include "mempool.h"
+#include "parsec/sys/atomic.h"
+#include "parsec/sys/tls.h"
 #ifdef PARSEC_HAVE_STRING_H
 #include <string.h>
 #endif
+#include <pthread.h>
+
+/**
+ * A magazine is an array of free elements. Each thread owns two magazines
+ * per mempool, loaded and previous, and only exchanges magazines that are
+ * either full or empty with the depot. As previous is always full or
+ * empty, a thread that alternates allocations and frees around a magazine
+ * boundary swaps its two magazines instead of going to the depot.
+ */
+typedef struct parsec_mempool_magazine_s {
+    parsec_list_item_t super;
+    int32_t            nb_elts;
+    void              *elts[PARSEC_MEMPOOL_MAGAZINE_SIZE];
+} parsec_mempool_magazine_t;
+
+struct parsec_mempool_cache_s {
+    parsec_mempool_magazine_t *loaded;
+    parsec_mempool_magazine_t *previous;
+    int32_t                    nb_elts;  /**< Elements in loaded and previous */
+    uint64_t                   nb_hits;
+};
+
+/* The caches of a thread are at the same index in all the mempools */
+static volatile int32_t parsec_mempool_nb_caches = 0;
+static PARSEC_TLS_DECLARE(parsec_mempool_tls_index);
+#if !defined(PARSEC_HAVE_THREAD_LOCAL)
+static pthread_once_t parsec_mempool_tls_once = PTHREAD_ONCE_INIT;
+static void parsec_mempool_tls_init(void)
+{
+    PARSEC_TLS_KEY_CREATE(parsec_mempool_tls_index);
+}
+#endif  /* !defined(PARSEC_HAVE_THREAD_LOCAL) */
+
+/* The index of an exiting thread goes back here, with its caches and the
+ * elements they hold, for the next thread that needs one */
+static parsec_atomic_lock_t parsec_mempool_indexes_lock = PARSEC_ATOMIC_UNLOCKED;
+static int32_t parsec_mempool_free_indexes[PARSEC_MEMPOOL_MAX_CACHES];
+static int32_t parsec_mempool_nb_free_indexes = 0;
+static pthread_key_t  parsec_mempool_exit_key;
+static pthread_once_t parsec_mempool_exit_once = PTHREAD_ONCE_INIT;
+
+static void parsec_mempool_index_release(void *index)
+{
+    parsec_atomic_lock(&parsec_mempool_indexes_lock);
+    assert(parsec_mempool_nb_free_indexes < PARSEC_MEMPOOL_MAX_CACHES);
+    parsec_mempool_free_indexes[parsec_mempool_nb_free_indexes++] = (int32_t)(intptr_t)index;
+    parsec_atomic_unlock(&parsec_mempool_indexes_lock);
+    /* A later destructor that frees an element must not use the caches anymore */
+    PARSEC_TLS_SET_SPECIFIC(parsec_mempool_tls_index, (void*)(intptr_t)(PARSEC_MEMPOOL_MAX_CACHES + 1));
+}
+
+static void parsec_mempool_exit_key_create(void)
+{
+    pthread_key_create(&parsec_mempool_exit_key, parsec_mempool_index_release);
+}
+
+/* Indexes start at 1, PARSEC_MEMPOOL_MAX_CACHES + 1 means no cache */
+static intptr_t parsec_mempool_index_acquire(void)
+{
+    intptr_t index = PARSEC_MEMPOOL_MAX_CACHES + 1;
+
+    pthread_once(&parsec_mempool_exit_once, parsec_mempool_exit_key_create);
+    parsec_atomic_lock(&parsec_mempool_indexes_lock);
+    if( parsec_mempool_nb_free_indexes > 0 )
+        index = parsec_mempool_free_indexes[--parsec_mempool_nb_free_indexes];
+    else if( parsec_mempool_nb_caches < PARSEC_MEMPOOL_MAX_CACHES )
+        index = ++parsec_mempool_nb_caches;
+    parsec_atomic_unlock(&parsec_mempool_indexes_lock);
+    if( index <= PARSEC_MEMPOOL_MAX_CACHES )
+        pthread_setspecific(parsec_mempool_exit_key, (void*)index);
+    return index;
+}
+
+static inline void parsec_mempool_release( parsec_mempool_t *mempool, void *elt )
+{
+    if(NULL != mempool->obj_class) {
+        parsec_lifo_item_free(elt);
+    } else {
+        free(elt);
+    }
+}
+
+static parsec_mempool_magazine_t *parsec_mempool_magazine_empty( parsec_mempool_t *mempool )
+{
+    parsec_mempool_magazine_t *mag;
+
+    mag = (parsec_mempool_magazine_t*)parsec_lifo_pop(&mempool->depot_empty);
+    if( NULL == mag ) {
+        mag = (parsec_mempool_magazine_t*)parsec_lifo_item_alloc(&mempool->depot_empty,
+                                                                 sizeof(parsec_mempool_magazine_t));
+        mag->nb_elts = 0;
+    }
+    assert(0 == mag->nb_elts);
+    return mag;
+}
+
+/* Returns the number of elements released */
+static int32_t parsec_mempool_magazine_release( parsec_mempool_t *mempool, parsec_mempool_magazine_t *mag )
+{
+    int32_t i, nb = mag->nb_elts;
+
+    for( i = 0; i < nb; i++ )
+        parsec_mempool_release(mempool, mag->elts[i]);
+    mag->nb_elts = 0;
+    return nb;
+}
+
+static void parsec_mempool_depot_put( parsec_mempool_t *mempool, parsec_mempool_magazine_t *mag )
+{
+    parsec_atomic_fetch_inc_int32(&mempool->depot_nb_full);
+    parsec_atomic_fetch_inc_int64(&mempool->nb_depot_puts);
+    parsec_lifo_push(&mempool->depot_full, &mag->super);
+}
+
+static parsec_mempool_magazine_t *parsec_mempool_depot_get( parsec_mempool_t *mempool )
+{
+    parsec_mempool_magazine_t *mag;
+
+    mag = (parsec_mempool_magazine_t*)parsec_lifo_pop(&mempool->depot_full);
+    if( NULL != mag ) {
+        parsec_atomic_fetch_dec_int32(&mempool->depot_nb_full);
+        parsec_atomic_fetch_inc_int64(&mempool->nb_depot_gets);
+    }
+    return mag;
+}
+
+/* Returns the cache of the calling thread, or NULL if the thread has none */
+static inline parsec_mempool_cache_t *parsec_mempool_my_cache( parsec_mempool_t *mempool )
+{
+    parsec_mempool_cache_t *cache;
+    intptr_t index;
+    int rc;
+
+#if !defined(PARSEC_HAVE_THREAD_LOCAL)
+    pthread_once(&parsec_mempool_tls_once, parsec_mempool_tls_init);
+#endif  /* !defined(PARSEC_HAVE_THREAD_LOCAL) */
+    index = (intptr_t)PARSEC_TLS_GET_SPECIFIC(parsec_mempool_tls_index);
+    if( PARSEC_UNLIKELY(0 == index) ) {
+        /* 0 means not assigned yet */
+        index = parsec_mempool_index_acquire();
+        PARSEC_TLS_SET_SPECIFIC(parsec_mempool_tls_index, (void*)index);
+    }
+    if( index > PARSEC_MEMPOOL_MAX_CACHES )
+        return NULL;
+    cache = mempool->caches[index - 1];
+    if( PARSEC_UNLIKELY(NULL == cache) ) {
+        /* Only the calling thread creates its own cache */
+        rc = posix_memalign((void**)&cache, 64, sizeof(parsec_mempool_cache_t) < 64 ? 64 : sizeof(parsec_mempool_cache_t));
+        assert( 0 == rc && NULL != cache ); (void)rc;
+        cache->loaded = parsec_mempool_magazine_empty(mempool);
+        cache->previous = parsec_mempool_magazine_empty(mempool);
+        cache->nb_elts = 0;
+        cache->nb_hits = 0;
+        parsec_atomic_wmb();
+        mempool->caches[index - 1] = cache;
+    }
+    return cache;
+}
+
+void *parsec_mempool_cache_allocate( parsec_mempool_t *mempool )
+{
+    parsec_mempool_cache_t *cache = parsec_mempool_my_cache(mempool);
+    parsec_mempool_magazine_t *mag;
+
+    if( PARSEC_UNLIKELY(NULL == cache) )
+        return NULL;
+    if( 0 == cache->loaded->nb_elts ) {
+        if( PARSEC_MEMPOOL_MAGAZINE_SIZE == cache->previous->nb_elts ) {
+            mag = cache->loaded;
+            cache->loaded = cache->previous;
+            cache->previous = mag;
+        } else {
+            if( NULL == (mag = parsec_mempool_depot_get(mempool)) )
+                return NULL;
+            /* previous is empty */
+            parsec_lifo_push(&mempool->depot_empty, &cache->previous->super);
+            cache->previous = cache->loaded;
+            cache->loaded = mag;
+            cache->nb_elts += PARSEC_MEMPOOL_MAGAZINE_SIZE;
+        }
+    }
+    cache->nb_elts--;
+    cache->nb_hits++;
+    return cache->loaded->elts[--cache->loaded->nb_elts];
+}
+
+int parsec_mempool_cache_free( parsec_mempool_t *mempool, void *elt )
+{
+    parsec_mempool_cache_t *cache = parsec_mempool_my_cache(mempool);
+    parsec_mempool_magazine_t *mag;
+
+    if( PARSEC_UNLIKELY(NULL == cache) )
+        return 0;
+    if( PARSEC_MEMPOOL_MAGAZINE_SIZE == cache->loaded->nb_elts ) {
+        if( 0 == cache->previous->nb_elts ) {
+            mag = cache->loaded;
+            cache->loaded = cache->previous;
+            cache->previous = mag;
+        } else {
+            /* previous is full */
+            parsec_mempool_depot_put(mempool, cache->previous);
+            cache->nb_elts -= PARSEC_MEMPOOL_MAGAZINE_SIZE;
+            cache->previous = cache->loaded;
+            cache->loaded = parsec_mempool_magazine_empty(mempool);
+        }
+    }
+    cache->loaded->elts[cache->loaded->nb_elts++] = elt;
+    cache->nb_elts++;
+    return 1;
+}
 
 /** parsec_thread_mempool_construct
  *    constructs the thread-specific memory pool.
@@ -21,16 +233,21 @@ static void parsec_thread_mempool_construct( parsec_thread_mempool_t *thread_mem
     thread_mempool->nb_elt = 0;
 }
 
-static void parsec_thread_mempool_destruct( parsec_thread_mempool_t *thread_mempool )
+/* Returns the number of elements released */
+static uint64_t parsec_thread_mempool_trim( parsec_thread_mempool_t *thread_mempool )
 {
+    uint64_t nb = 0;
     void *elt;
     while(NULL != (elt = parsec_lifo_pop(&thread_mempool->mempool))) {
-        if(NULL != thread_mempool->parent->obj_class) {
-            parsec_lifo_item_free(elt);
-        } else {
-            free(elt);
-        }
+        parsec_mempool_release(thread_mempool->parent, elt);
+        nb++;
     }
+    return nb;
+}
+
+static void parsec_thread_mempool_destruct( parsec_thread_mempool_t *thread_mempool )
+{
+    parsec_thread_mempool_trim(thread_mempool);
     PARSEC_OBJ_DESTRUCT(&thread_mempool->mempool);
 }
 
@@ -51,13 +268,36 @@ void parsec_mempool_construct( parsec_mempool_t *mempool,
 
     for(tid = 0; tid < mempool->nb_thread_mempools; tid++)
         parsec_thread_mempool_construct(&mempool->thread_mempools[tid], mempool);
+
+    mempool->caches = (parsec_mempool_cache_t * volatile *)calloc(PARSEC_MEMPOOL_MAX_CACHES, sizeof(parsec_mempool_cache_t*));
+    PARSEC_OBJ_CONSTRUCT(&mempool->depot_full, parsec_lifo_t);
+    PARSEC_OBJ_CONSTRUCT(&mempool->depot_empty, parsec_lifo_t);
+    mempool->depot_nb_full = 0;
+    mempool->nb_depot_puts = 0;
+    mempool->nb_depot_gets = 0;
+    mempool->nb_released = 0;
 }
 
 uint64_t parsec_mempool_destruct( parsec_mempool_t *mempool )
 {
+    parsec_mempool_cache_t *cache;
     uint32_t tid;
     uint64_t usage_counter = 0;
 
+    for(tid = 0; tid < PARSEC_MEMPOOL_MAX_CACHES; tid++) {
+        if( NULL == (cache = mempool->caches[tid]) ) continue;
+        parsec_mempool_magazine_release(mempool, cache->loaded);
+        parsec_mempool_magazine_release(mempool, cache->previous);
+        parsec_lifo_item_free(&cache->loaded->super);
+        parsec_lifo_item_free(&cache->previous->super);
+        free(cache);
+    }
+    free((void*)mempool->caches);
+    mempool->caches = NULL;
+    parsec_mempool_trim(mempool);
+    PARSEC_OBJ_DESTRUCT(&mempool->depot_full);
+    PARSEC_OBJ_DESTRUCT(&mempool->depot_empty);
+
     for(tid = 0; tid < mempool->nb_thread_mempools; tid++) {
         usage_counter += mempool->thread_mempools[tid].nb_elt;
         parsec_thread_mempool_destruct(&mempool->thread_mempools[tid]);
@@ -88,3 +328,44 @@ void *parsec_thread_mempool_allocate_when_empty( parsec_thread_mempool_t *thread
     thread_mempool->nb_elt++;
     return elt;
 }
+
+uint64_t parsec_mempool_trim( parsec_mempool_t *mempool )
+{
+    parsec_mempool_magazine_t *mag;
+    uint64_t nb = 0;
+    uint32_t tid;
+
+    while( NULL != (mag = parsec_mempool_depot_get(mempool)) ) {
+        nb += parsec_mempool_magazine_release(mempool, mag);
+        parsec_lifo_item_free(&mag->super);
+    }
+    while( NULL != (mag = (parsec_mempool_magazine_t*)parsec_lifo_pop(&mempool->depot_empty)) ) {
+        parsec_lifo_item_free(&mag->super);
+    }
+    for(tid = 0; tid < mempool->nb_thread_mempools; tid++) {
+        nb += parsec_thread_mempool_trim(&mempool->thread_mempools[tid]);
+    }
+    parsec_atomic_fetch_add_int64(&mempool->nb_released, nb);
+    return nb;
+}
+
+void parsec_mempool_get_stats( parsec_mempool_t *mempool,
+                               parsec_mempool_stats_t *stats )
+{
+    parsec_mempool_cache_t *cache;
+    uint32_t tid;
+
+    memset(stats, 0, sizeof(parsec_mempool_stats_t));
+    for(tid = 0; tid < mempool->nb_thread_mempools; tid++) {
+        stats->nb_allocated += mempool->thread_mempools[tid].nb_elt;
+    }
+    for(tid = 0; (NULL != mempool->caches) && (tid < PARSEC_MEMPOOL_MAX_CACHES); tid++) {
+        if( NULL == (cache = mempool->caches[tid]) ) continue;
+        stats->nb_in_caches += cache->nb_elts;
+        stats->nb_cache_hits += cache->nb_hits;
+    }
+    stats->nb_released   = mempool->nb_released;
+    stats->nb_in_depot   = (uint64_t)mempool->depot_nb_full * PARSEC_MEMPOOL_MAGAZINE_SIZE;
+    stats->nb_depot_puts = mempool->nb_depot_puts;
+    stats->nb_depot_gets = mempool->nb_depot_gets;
+}
@@ -17,6 +17,14 @@
 BEGIN_C_DECLS
 
 typedef struct parsec_mempool_s parsec_mempool_t;
+typedef struct parsec_mempool_cache_s parsec_mempool_cache_t;
+
+/** Number of elements in a magazine */
+#define PARSEC_MEMPOOL_MAGAZINE_SIZE  32
+/** Number of threads alive at once that can cache elements in magazines,
+ *  the others free elements directly to the owner thread-mempool. The
+ *  caches of an exiting thread go to the next thread. */
+#define PARSEC_MEMPOOL_MAX_CACHES     256
 
 /**
  * each element that is allocated from a mempool must
@@ -31,6 +39,17 @@ typedef struct parsec_mempool_s parsec_mempool_t;
  *
  * Memory Pool memory must also be a parsec_list_item_t, to
  * be chained using LIFOs.
+ *
+ * Freed elements are first cached in the magazines of the calling
+ * thread (two arrays of PARSEC_MEMPOOL_MAGAZINE_SIZE elements, accessed
+ * without atomic operations), whatever thread-mempool owns them. Full
+ * magazines are exchanged with a depot shared by all the threads of the
+ * mempool, so elements freed by one thread are reused by the threads that
+ * allocate, one atomic operation per magazine. The memory used by a
+ * mempool is thus bounded by the largest number of elements in use at
+ * once, plus the magazines of the threads; parsec_mempool_trim returns
+ * the elements of the depot to the system. The thread-mempool LIFOs are
+ * only used by the threads that have no cache.
  */
 struct parsec_mempool_s {
     unsigned int            nb_thread_mempools; /**< Number of thread mempools that share this mempool */
@@ -40,6 +59,13 @@ struct parsec_mempool_s {
     volatile uint32_t       nb_max_elt;         /**< this reflects the maximum of the nb_elt of the other threads */
     parsec_class_t          *obj_class;         /**< the base class of the objects inside the mempool */
     parsec_thread_mempool_t *thread_mempools;   /**< Array of thread mempools (of size nb_thread_mempools) */
+    parsec_mempool_cache_t * volatile *caches;  /**< Magazines of each thread (of size PARSEC_MEMPOOL_MAX_CACHES) */
+    parsec_lifo_t           depot_full;         /**< Full magazines */
+    parsec_lifo_t           depot_empty;        /**< Empty magazines */
+    volatile int32_t        depot_nb_full;      /**< Number of magazines in depot_full */
+    volatile int64_t        nb_depot_puts;      /**< Full magazines given to the depot */
+    volatile int64_t        nb_depot_gets;      /**< Full magazines taken from the depot */
+    volatile int64_t        nb_released;        /**< Elements returned to the system */
 };
 
 struct parsec_thread_mempool_s {
@@ -49,6 +75,19 @@ struct parsec_thread_mempool_s {
     parsec_lifo_t mempool;       /**< Elements are stored in a LIFO */
 };
 
+/**
+ * Statistics of a mempool, see parsec_mempool_get_stats
+ */
+typedef struct parsec_mempool_stats_s {
+    uint64_t nb_allocated;   /**< Elements allocated from the system */
+    uint64_t nb_released;    /**< Elements returned to the system */
+    uint64_t nb_in_caches;   /**< Elements held in the magazines of the threads */
+    uint64_t nb_in_depot;    /**< Elements held in the full magazines of the depot */
+    uint64_t nb_cache_hits;  /**< Allocations served by the magazines of the calling thread */
+    uint64_t nb_depot_puts;  /**< Full magazines given to the depot */
+    uint64_t nb_depot_gets;  /**< Full magazines taken from the depot */
+} parsec_mempool_stats_t;
+
 /**
  * @brief constructs a mempool
  *
@@ -110,12 +149,40 @@ void parsec_mempool_construct( parsec_mempool_t *mempool,
  */
 void *parsec_thread_mempool_allocate_when_empty( parsec_thread_mempool_t *thread_mempool );
 
+/**
+ * @brief allocate an element from the magazines of the calling thread
+ *
+ * @details
+ *    Internal function, called by parsec_thread_mempool_allocate.
+ *    Takes an element from the magazines of the calling thread, or a
+ *    full magazine from the depot when they are empty.
+ *
+ * @param[inout] mempool the mempool from which an element should be allocated
+ * @return an element, or NULL if the magazines and the depot are empty
+ */
+void *parsec_mempool_cache_allocate( parsec_mempool_t *mempool );
+
+/**
+ * @brief free an element to the magazines of the calling thread
+ *
+ * @details
+ *    Internal function, called by parsec_thread_mempool_free.
+ *    Stores the element in the magazines of the calling thread, and
+ *    gives a full magazine to the depot when they are full.
+ *
+ * @param[inout] mempool the mempool to which elt belongs
+ * @param[inout] elt the element to free
+ * @return 1 if the element was cached, 0 if the calling thread has no cache
+ */
+int parsec_mempool_cache_free( parsec_mempool_t *mempool, void *elt );
+
 /**
  * @brief allocate an element from a mempool
  *
  * @details
  *    allocates an element of size thread_mempool->mempool->elt_size,
- *    using the internal function if the pool is empty.
+ *    from the magazines of the calling thread, then from the thread
+ *    mempool, using the internal function if both are empty.
  *
  * @param[inout] thread_mempool the thread-mempool from which an element should be allocated
  * @return the new element
@@ -123,9 +190,12 @@ void *parsec_thread_mempool_allocate_when_empty( parsec_thread_mempool_t *thread
 static inline void *parsec_thread_mempool_allocate( parsec_thread_mempool_t *thread_mempool )
 {
     void* ret;
-    ret = (void*)parsec_lifo_pop( &thread_mempool->mempool );
+    ret = parsec_mempool_cache_allocate( thread_mempool->parent );
     if( ret == NULL ) {
-        ret = parsec_thread_mempool_allocate_when_empty( thread_mempool );
+        ret = (void*)parsec_lifo_pop( &thread_mempool->mempool );
+        if( ret == NULL ) {
+            ret = parsec_thread_mempool_allocate_when_empty( thread_mempool );
+        }
     }
     return ret;
 }
@@ -135,7 +205,9 @@ static inline void *parsec_thread_mempool_allocate( parsec_thread_mempool_t *thr
  *
  * @details
  *     a shortcut to parsec_mempool_free( thread_mempool->parent, elt );
- *     the thread-mempool must be the owner of the element
+ *     the thread-mempool must be the owner of the element. The element
+ *     is cached by the calling thread, and only pushed back to the
+ *     thread-mempool if the calling thread has no cache.
  *
  * @param[inout] thread_mempool the thread-mempool to which elt should be returned
  * @param[inout] elt the element to free
@@ -143,10 +215,12 @@ static inline void *parsec_thread_mempool_allocate( parsec_thread_mempool_t *thr
 static inline void  parsec_thread_mempool_free( parsec_thread_mempool_t *thread_mempool, void *elt )
 {
 #if defined(PARSEC_DEBUG_ENABLE)
-    parsec_thread_mempool_t *owner = *(parsec_thread_mempool_t **)(_elt + mempool->pool_owner_offset);
+    parsec_thread_mempool_t *owner = *(parsec_thread_mempool_t **)((unsigned char*)elt + thread_mempool->parent->pool_owner_offset);
     assert(owner == thread_mempool);
 #endif // PARSEC_DEBUG_ENABLE
 
+    if( parsec_mempool_cache_free( thread_mempool->parent, elt ) )
+        return;
     parsec_lifo_push( &(thread_mempool->mempool), (parsec_list_item_t*)elt );
 }
 
@@ -185,6 +259,34 @@ static inline void  parsec_mempool_free( parsec_mempool_t *mempool, void *elt )
  */
 uint64_t parsec_mempool_destruct( parsec_mempool_t *mempool );
 
+/**
+ * @brief return the unused elements of a mempool to the system
+ *
+ * @details
+ *    releases the elements held in the depot and in the thread-mempool
+ *    LIFOs, and the empty magazines of the depot. The magazines of the
+ *    threads are kept, they hold at most 2 * PARSEC_MEMPOOL_MAGAZINE_SIZE
+ *    elements per thread. Can be called while other threads allocate
+ *    and free elements.
+ *
+ * @param[inout] mempool the mempool to trim
+ * @return Number of elements returned to the system
+ */
+uint64_t parsec_mempool_trim( parsec_mempool_t *mempool );
+
+/**
+ * @brief get the statistics of a mempool
+ *
+ * @details
+ *    The counters of the threads are read without synchronization, the
+ *    result is exact only when no other thread uses the mempool.
+ *
+ * @param[in] mempool the mempool
+ * @param[out] stats the statistics of mempool
+ */
+void parsec_mempool_get_stats( parsec_mempool_t *mempool,
+                               parsec_mempool_stats_t *stats );
+
 /** @} */
 
 END_C_DECLS
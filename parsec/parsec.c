@@ -15,6 +15,8 @@
 #include <errno.h>
 #include <unistd.h>
 #include <limits.h>
+#include <time.h>
+#include <sys/time.h>
 #if defined(PARSEC_HAVE_GEN_H)
 #include <libgen.h>
 #endif  /* defined(PARSEC_HAVE_GEN_H) */
@@ -153,6 +155,13 @@ static int parsec_runtime_bind_main_thread = 1;
 static int parsec_runtime_bind_threads     = 1;
 
 int parsec_runtime_keep_highest_priority_task = 1;
+int parsec_runtime_select_batch = 1;
+int parsec_runtime_critical_path_max_tasks = 1 << 18;
+int parsec_runtime_work_first = 0;
+int parsec_runtime_work_first_max_depth = 16;
+int parsec_runtime_park_threshold = 0;
+int parsec_runtime_park_timeout = 1000;
+int parsec_runtime_park_report = 0;
 
 static PARSEC_TLS_DECLARE(parsec_tls_execution_stream);
 
@@ -174,6 +183,7 @@ static void __parsec_taskpool_constructor(parsec_taskpool_t* tp)
     tp->devices_index_mask = 0;  /* no support for any device. Requires initialization */
     tp->nb_task_classes = 0;
     tp->priority = 0;
+    tp->weight = 1;
     tp->nb_pending_actions = 0;
     tp->context = NULL;  /* not atached to any context */
     tp->startup_hook = NULL;
@@ -187,6 +197,8 @@ static void __parsec_taskpool_constructor(parsec_taskpool_t* tp)
     tp->update_nb_runtime_task = NULL;
     tp->dependencies_array = NULL;
     tp->repo_array = NULL;
+    tp->critical_path = NULL;
+    tp->arena_budget = NULL;
     tp->tdm.callback = NULL;
     tp->tdm.monitor = NULL;
     tp->tdm.module = NULL;
@@ -200,6 +212,16 @@ static void __parsec_taskpool_destructor(parsec_taskpool_t* tp)
     if( NULL != tp->taskpool_name ) {
         free(tp->taskpool_name);
     }
+    if( NULL != tp->critical_path ) {
+        parsec_critical_path_free(tp->critical_path);
+        tp->critical_path = NULL;
+    }
+    if( NULL != tp->arena_budget ) {
+        PARSEC_DEBUG_VERBOSE(4, parsec_debug_output, "Taskpool %s: %"PRId64" tasks and %"PRId64" GETs held back by the arena budget, %"PRId64" resumed",
+                             (NULL != tp->taskpool_name) ? tp->taskpool_name : "", tp->arena_budget->nb_deferred_tasks,
+                             tp->arena_budget->nb_deferred_gets, tp->arena_budget->nb_resumed);
+        PARSEC_OBJ_RELEASE(tp->arena_budget);
+    }
 }
 
 /* To create object of class parsec_taskpool_t that inherits parsec_list_t
@@ -262,12 +284,26 @@ static void* __parsec_thread_init( __parsec_temporary_thread_initialization_t* s
     es->rand_seed        = tv_now.tv_usec + startup->th_id;
     es->scheduler_object = NULL;
     es->next_task        = NULL;
+    es->handoff_depth    = 0;
+    es->park_count       = 0;
+    es->park_time        = 0;
+    es->wakeup_count     = 0;
+    es->wakeup_latency   = 0;
+    es->ready_tasks_count    = 0;
+    es->ready_tasks_next     = 0;
+    es->ready_tasks_distance = 0;
+#if defined(PARSEC_PROF_PINS)
+    es->select_distance  = 0;
+#endif  /* defined(PARSEC_PROF_PINS) */
     startup->virtual_process->execution_streams[startup->th_id] = es;
     es->core_id          = startup->bindto;
 #if defined(PARSEC_HAVE_HWLOC)
     es->socket_id        = parsec_hwloc_socket_id(startup->bindto);
+    es->numa_id          = parsec_hwloc_numa_id(startup->bindto);
+    if( es->numa_id < 0 ) es->numa_id = 0;
 #else
     es->socket_id        = 0;
+    es->numa_id          = 0;
 #endif  /* defined(PARSEC_HAVE_HWLOC) */
 
     /*
@@ -348,6 +384,7 @@ static void parsec_vp_init( parsec_vp_t *vp,
 
     assert(vp_cores > 0);
     vp->nb_cores = vp_cores;
+    vp->nb_active_cores = vp_cores;
 
     barrier = (parsec_barrier_t*)malloc(sizeof(parsec_barrier_t));
     parsec_barrier_init(barrier, NULL, vp->nb_cores);
@@ -530,6 +567,38 @@ parsec_context_t* parsec_init( int nb_cores, int* pargc, char** pargv[] )
      */
     parsec_mca_param_reg_int_name("runtime", "keep_highest_priority_task", "Allow a compute thread to retain the highest priority task to be executed locally. This change makes the scheduling decision non-deterministic because some tasks will never be handled to the scheduler.", false, false,
                                   parsec_runtime_keep_highest_priority_task, &parsec_runtime_keep_highest_priority_task);
+    parsec_mca_param_reg_int_name("runtime", "work_first", "Work-first mode: a compute thread keeps the highest priority local "
+                                  "successor of the task it completes, and executes it next without going through the "
+                                  "scheduler (implies runtime_keep_highest_priority_task).", false, false,
+                                  parsec_runtime_work_first, &parsec_runtime_work_first);
+    parsec_mca_param_reg_int_name("runtime", "work_first_max_depth", "Maximal number of consecutive successors a compute thread "
+                                  "executes in work-first mode before selecting a task from the scheduler (0: no limit).",
+                                  false, false, parsec_runtime_work_first_max_depth, &parsec_runtime_work_first_max_depth);
+    parsec_mca_param_reg_int_name("runtime", "park_threshold", "Number of consecutive unsuccessful task selections after which "
+                                  "an idle compute thread stops spinning and parks until new tasks are scheduled on its "
+                                  "virtual process (0 disables parking). Only available on Linux.", false, false,
+                                  parsec_runtime_park_threshold, &parsec_runtime_park_threshold);
+    parsec_mca_param_reg_int_name("runtime", "park_timeout", "Maximal time (in micro-seconds) a compute thread stays parked "
+                                  "before checking again for tasks.", false, false,
+                                  parsec_runtime_park_timeout, &parsec_runtime_park_timeout);
+    if( parsec_runtime_park_timeout < 1 ) parsec_runtime_park_timeout = 1;
+    parsec_mca_param_reg_int_name("runtime", "park_report", "Report, for each compute thread and at the end of each "
+                                  "parsec_context_wait, the time spent parked and the wake-up latency.", false, false,
+                                  parsec_runtime_park_report, &parsec_runtime_park_report);
+    /* MCA param for the number of tasks obtained at once from the scheduler,
+     * when the scheduler supports it.
+     */
+    parsec_mca_param_reg_int_name("runtime", "select_batch", "Maximal number of ready tasks a compute thread obtains at once from "
+                                  "the schedulers that support batched selection (1 to disable). These tasks are buffered "
+                                  "locally, and executed before the scheduler is called again.", false, false,
+                                  parsec_runtime_select_batch, &parsec_runtime_select_batch);
+    if( parsec_runtime_select_batch > PARSEC_MAX_SELECT_BATCH ) parsec_runtime_select_batch = PARSEC_MAX_SELECT_BATCH;
+    /* MCA param bounding the exploration of the DAG for critical path priorities */
+    parsec_mca_param_reg_int_name("runtime", "critical_path_max_tasks", "Maximal number of tasks a single critical path "
+                                  "computation visits (0 for no limit). When the limit is reached, the DAG of the taskpool "
+                                  "is considered too large or data-dependent, and all its tasks get the taskpool priority.",
+                                  false, false,
+                                  parsec_runtime_critical_path_max_tasks, &parsec_runtime_critical_path_max_tasks);
 
     /*
      * Initialize the VPMAP, the discrete domains hosting
@@ -632,6 +701,9 @@ parsec_context_t* parsec_init( int nb_cores, int* pargc, char** pargv[] )
         vp = (parsec_vp_t *)malloc(sizeof(parsec_vp_t) + (vpmap_get_nb_threads_in_vp(p)-1) * sizeof(parsec_execution_stream_t*));
         vp->parsec_context = context;
         vp->vp_id = p;
+        vp->park_seq = 0;
+        vp->nb_parked = 0;
+        vp->park_wake_time = 0;
         context->virtual_processes[p] = vp;
         /*
          * Set the threads local variables from startup[t] -> startup[t+nb_cores].
@@ -654,6 +726,21 @@ parsec_context_t* parsec_init( int nb_cores, int* pargc, char** pargv[] )
     parsec_mca_param_reg_sizet_name("arena", "max_cached", "The maximum amount of memory each arena can"
                                    " cache in a freelist (0=no caching)",
                                    false, false, parsec_arena_max_cached_memory, &parsec_arena_max_cached_memory);
+    parsec_mca_param_reg_int_name("arena", "backing", "How the arenas back the data they allocate: 0 malloc,"
+                                  " 1 transparent huge pages, 2 2MiB huge pages, 3 1GiB huge pages (huge pages"
+                                  " fall back to transparent huge pages when none are reserved). With 1 to 3, the"
+                                  " data are carved from slabs bound to the NUMA node of the allocating thread"
+                                  " (with 3, each NUMA node maps at least a 1GiB slab)",
+                                  false, false, parsec_arena_backing, &parsec_arena_backing);
+    parsec_mca_param_reg_sizet_name("arena", "taskpool_budget", "The default maximum amount of arena memory"
+                                    " the data of each taskpool can hold (default unlimited). Tasks whose output"
+                                    " does not fit, and incoming data that does not fit, are held back until some"
+                                    " memory is released",
+                                    false, false, parsec_arena_taskpool_budget, &parsec_arena_taskpool_budget);
+    parsec_mca_param_reg_sizet_name("datarepo", "dense_max_keys", "The maximum number of keys of the directly indexed"
+                                    " data repositories of the PTG task classes whose execution space is a box of ranges."
+                                    " Larger task classes use a hash table (0 always uses hash tables)",
+                                    false, false, parsec_datarepo_dense_max_keys, &parsec_datarepo_dense_max_keys);
 
     parsec_mca_param_reg_sizet_name("task", "startup_iter", "The number of ready tasks to be generated during the startup "
                                    "before allowing the scheduler to distribute them across the entire execution context.",
@@ -1054,46 +1141,64 @@ void parsec_abort(parsec_context_t* ctx, int status)
 }
 
 #if defined(PARSEC_PROF_TRACE)
+static void parsec_mempool_stats_add(parsec_mempool_t *mp, parsec_mempool_stats_t *total, size_t *m_usage)
+{
+    parsec_mempool_stats_t stats;
+
+    parsec_mempool_get_stats(mp, &stats);
+    *m_usage += (stats.nb_allocated - stats.nb_released) * mp->elt_size;
+    total->nb_allocated  += stats.nb_allocated;
+    total->nb_released   += stats.nb_released;
+    total->nb_in_caches  += stats.nb_in_caches;
+    total->nb_in_depot   += stats.nb_in_depot;
+    total->nb_cache_hits += stats.nb_cache_hits;
+    total->nb_depot_puts += stats.nb_depot_puts;
+    total->nb_depot_gets += stats.nb_depot_gets;
+}
+
+static void parsec_mempool_stats_report(const char *name, parsec_mempool_stats_t *total, size_t m_usage)
+{
+    char meminfo[256];
+
+    snprintf(meminfo, 256, "MEMPOOL - %s - %zu bytes - %"PRIu64" allocated %"PRIu64" released "
+             "%"PRIu64" in caches %"PRIu64" in depot %"PRIu64" cache hits %"PRIu64"/%"PRIu64" depot puts/gets",
+             name, m_usage, total->nb_allocated, total->nb_released, total->nb_in_caches,
+             total->nb_in_depot, total->nb_cache_hits, total->nb_depot_puts, total->nb_depot_gets);
+    parsec_profiling_add_information("MEMORY_USAGE", meminfo);
+}
+
 static void parsec_mempool_stats(parsec_context_t *context)
 {
     int i, p;
-    unsigned int t;
     size_t m_usage;
-    char meminfo[128];
+    parsec_mempool_stats_t total;
     parsec_vp_t *vp;
-    parsec_mempool_t *mp;
 
     m_usage = 0;
+    memset(&total, 0, sizeof(parsec_mempool_stats_t));
     for(p = 0; p < context->nb_vp; p++) {
         vp = context->virtual_processes[p];
-        mp = &vp->context_mempool;
-        for(t = 0; t < mp->nb_thread_mempools; t++)
-            m_usage += mp->thread_mempools[t].nb_elt * mp->elt_size;
+        parsec_mempool_stats_add(&vp->context_mempool, &total, &m_usage);
     }
-    snprintf(meminfo, 128, "MEMPOOL - Contexts - %zu bytes", m_usage);
-    parsec_profiling_add_information("MEMORY_USAGE", meminfo);
+    parsec_mempool_stats_report("Contexts", &total, m_usage);
 
     m_usage = 0;
+    memset(&total, 0, sizeof(parsec_mempool_stats_t));
     for(p = 0; p < context->nb_vp; p++) {
         vp = context->virtual_processes[p];
         for(i = 0; i <= MAX_PARAM_COUNT; i++) {
-            mp = &vp->datarepo_mempools[i];
-            for(t = 0; t < mp->nb_thread_mempools; t++)
-                m_usage += mp->thread_mempools[t].nb_elt * mp->elt_size;
+            parsec_mempool_stats_add(&vp->datarepo_mempools[i], &total, &m_usage);
         }
     }
-    snprintf(meminfo, 128, "MEMPOOL - DataRepos - %zu bytes", m_usage);
-    parsec_profiling_add_information("MEMORY_USAGE", meminfo);
+    parsec_mempool_stats_report("DataRepos", &total, m_usage);
 
     m_usage = 0;
+    memset(&total, 0, sizeof(parsec_mempool_stats_t));
     for(p = 0; p < context->nb_vp; p++) {
         vp = context->virtual_processes[p];
-        mp = &vp->dependencies_mempool;
-        for(t = 0; t < mp->nb_thread_mempools; t++)
-            m_usage += mp->thread_mempools[t].nb_elt * mp->elt_size;
+        parsec_mempool_stats_add(&vp->dependencies_mempool, &total, &m_usage);
     }
-    snprintf(meminfo, 128, "MEMPOOL - Dependencies - %zu bytes", m_usage);
-    parsec_profiling_add_information("MEMORY_USAGE", meminfo);
+    parsec_mempool_stats_report("Dependencies", &total, m_usage);
 }
 #endif
 
@@ -1171,6 +1276,10 @@ int parsec_fini( parsec_context_t** pcontext )
 
     /* Now wait until every thread is back */
     context->__parsec_internal_finalization_in_progress = 1;
+    /* Last quiescent point, before the other threads finalize */
+    if( (NULL != parsec_current_scheduler) && (NULL != parsec_current_scheduler->module.quiesce) ) {
+        parsec_current_scheduler->module.quiesce(context);
+    }
     parsec_barrier_wait( &(context->barrier) );
 
     /**
@@ -2029,6 +2138,56 @@ parsec_taskpool_set_priority( parsec_taskpool_t* tp, int32_t new_priority )
     return old_priority;
 }
 
+int32_t
+parsec_taskpool_set_weight( parsec_taskpool_t* tp, int32_t new_weight )
+{
+    int32_t old_weight = tp->weight;
+    tp->weight = (new_weight < 1) ? 1 : new_weight;
+    return old_weight;
+}
+
+size_t
+parsec_taskpool_set_arena_budget( parsec_taskpool_t* tp, size_t max_bytes )
+{
+    size_t old_budget = 0;
+
+    if( NULL == tp->arena_budget ) {
+        if( 0 != max_bytes )
+            tp->arena_budget = parsec_arena_budget_new(max_bytes);
+        return 0;
+    }
+    old_budget = (size_t)tp->arena_budget->max_used;
+    tp->arena_budget->max_used = (int64_t)max_bytes;
+    return old_budget;
+}
+
+int
+parsec_taskpool_get_arena_budget_stats( parsec_taskpool_t* tp, parsec_taskpool_arena_budget_stats_t* stats )
+{
+    if( NULL == tp->arena_budget )
+        return PARSEC_ERR_NOT_FOUND;
+    stats->max_used          = (size_t)tp->arena_budget->max_used;
+    stats->used              = (size_t)tp->arena_budget->used;
+    stats->nb_deferred_tasks = tp->arena_budget->nb_deferred_tasks;
+    stats->nb_deferred_gets  = tp->arena_budget->nb_deferred_gets;
+    stats->nb_resumed        = tp->arena_budget->nb_resumed;
+    stats->nb_waiting        = tp->arena_budget->waitq.nb_waiters;
+    return PARSEC_SUCCESS;
+}
+
+uint64_t parsec_deadline_now(void)
+{
+#if defined(PARSEC_HAVE_CLOCK_GETTIME)
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+#else
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return (uint64_t)tv.tv_sec * 1000000000ULL + (uint64_t)tv.tv_usec * 1000ULL;
+#endif  /* defined(PARSEC_HAVE_CLOCK_GETTIME) */
+}
+
 /* TODO: Change this code to something better */
 static parsec_atomic_lock_t taskpool_array_lock = PARSEC_ATOMIC_UNLOCKED;
 static parsec_taskpool_t** taskpool_array = NULL;
@@ -2805,6 +2964,15 @@ int parsec_context_query(parsec_context_t *context, parsec_context_query_cmd_t c
 
         case PARSEC_CONTEXT_QUERY_ACTIVE_TASKPOOLS:
             return context->active_taskpools;
+
+        case PARSEC_CONTEXT_QUERY_ACTIVE_CORES:
+            {
+                int nb_active_comp_threads = 0;
+                for (int idx = 0; idx < context->nb_vp; idx++) {
+                    nb_active_comp_threads += context->virtual_processes[idx]->nb_active_cores;
+                }
+                return nb_active_comp_threads;
+            }
         /* no default */
     }
     return PARSEC_ERR_NOT_SUPPORTED;  /* unknown command */
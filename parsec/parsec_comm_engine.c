@@ -5,11 +5,21 @@
  */
 
 #include <assert.h>
+#include <inttypes.h>
+#include <string.h>
 #include "parsec/parsec_mpi_funnelled.h"
+#include "parsec/parsec_comm_shm.h"
 #include "parsec/remote_dep.h"
+#include "parsec/class/list.h"
+#include "parsec/sys/atomic.h"
+#include "parsec/utils/mca_param.h"
+#include "parsec/utils/debug.h"
 
 parsec_comm_engine_t parsec_ce;
 
+/* comm_reg_cache_size: see the corresponding mca_register */
+static int parsec_param_reg_cache_size = 256;
+
 /* This function will be called by the runtime */
 parsec_comm_engine_t *
 parsec_comm_engine_init(parsec_context_t *parsec_context)
@@ -18,6 +28,13 @@ parsec_comm_engine_init(parsec_context_t *parsec_context)
     parsec_comm_engine_t *ce = mpi_funnelled_init(parsec_context);
 
     assert(ce->capabilites.sided > 0 && ce->capabilites.sided < 3);
+    /* and the engine for the peers on the same node */
+    shm_ce_init(parsec_context);
+
+    parsec_mca_param_reg_int_name("comm", "reg_cache_size", "Number of memory registrations kept for the next transfers "
+                                  "of the same memory (0 to register the memory of every transfer).",
+                                  false, false, parsec_param_reg_cache_size, &parsec_param_reg_cache_size);
+    parsec_ce_mem_reg_cache_init(parsec_param_reg_cache_size);
     return ce;
 }
 
@@ -28,7 +45,261 @@ parsec_comm_engine_fini(parsec_comm_engine_t *comm_engine)
 {
     (void) parsec_remote_dep_fini(comm_engine->parsec_context);
     remote_dep_ce_fini(comm_engine->parsec_context);
+    /* the cached handles belong to the engines */
+    parsec_ce_mem_reg_cache_fini();
     /* call the selected module fini */
+    parsec_ce_shm.fini(&parsec_ce_shm);
     parsec_ce.fini(&parsec_ce);
     return PARSEC_SUCCESS;
 }
+
+/* ------- Memory registration cache ------- */
+
+typedef struct ce_reg_cache_entry_s ce_reg_cache_entry_t;
+struct ce_reg_cache_entry_s {
+    parsec_list_item_t          super;      /**< In the LRU list while no transfer uses it, or in the free entries */
+    ce_reg_cache_entry_t       *next_mem;   /**< Next entry registered for memory in the same bucket */
+    ce_reg_cache_entry_t       *next_lreg;  /**< Next entry with a handle in the same bucket */
+    parsec_comm_engine_t       *ce;
+    void                       *mem;
+    parsec_mem_type_t           mem_type;
+    size_t                      count;
+    parsec_datatype_t           datatype;
+    size_t                      mem_size;
+    char                       *lo, *hi;    /**< Memory covered by the registration */
+    parsec_ce_mem_reg_handle_t  lreg;       /**< NULL if the entry is free */
+    size_t                      lreg_size;
+    int32_t                     users;      /**< Transfers using the handle */
+    int32_t                     valid;      /**< Cleared when the registration is invalidated while in use */
+};
+
+static parsec_atomic_lock_t   ce_reg_cache_lock = PARSEC_ATOMIC_UNLOCKED;
+static int                    ce_reg_cache_capacity = 0;
+static uint32_t               ce_reg_cache_mask = 0;          /**< Number of buckets - 1 */
+static ce_reg_cache_entry_t  *ce_reg_cache_entries = NULL;
+static ce_reg_cache_entry_t **ce_reg_cache_by_mem = NULL;
+static ce_reg_cache_entry_t **ce_reg_cache_by_lreg = NULL;
+static parsec_list_t          ce_reg_cache_lru;               /**< Unused registrations, least recently used first */
+static parsec_list_t          ce_reg_cache_free;
+static volatile int32_t       ce_reg_cache_nb_entries = 0;    /**< Registrations held by the cache */
+static parsec_ce_mem_reg_cache_stats_t ce_reg_cache_stats;
+
+static inline uint32_t ce_reg_cache_bucket(const void *ptr)
+{
+    uintptr_t h = (uintptr_t)ptr >> 4;
+    h ^= h >> 17;
+    h *= 0x9E3779B1u;
+    return (uint32_t)(h ^ (h >> 15)) & ce_reg_cache_mask;
+}
+
+int parsec_ce_mem_reg_cache_init(int capacity)
+{
+    uint32_t nb_buckets = 1;
+    int i;
+
+    if( capacity <= 0 ) return PARSEC_SUCCESS;
+    assert(NULL == ce_reg_cache_entries);
+    while( nb_buckets < 2 * (uint32_t)capacity ) nb_buckets <<= 1;
+    ce_reg_cache_mask = nb_buckets - 1;
+    ce_reg_cache_by_mem = (ce_reg_cache_entry_t**)calloc(nb_buckets, sizeof(ce_reg_cache_entry_t*));
+    ce_reg_cache_by_lreg = (ce_reg_cache_entry_t**)calloc(nb_buckets, sizeof(ce_reg_cache_entry_t*));
+    ce_reg_cache_entries = (ce_reg_cache_entry_t*)calloc(capacity, sizeof(ce_reg_cache_entry_t));
+    PARSEC_OBJ_CONSTRUCT(&ce_reg_cache_lru, parsec_list_t);
+    PARSEC_OBJ_CONSTRUCT(&ce_reg_cache_free, parsec_list_t);
+    for(i = 0; i < capacity; i++) {
+        PARSEC_OBJ_CONSTRUCT(&ce_reg_cache_entries[i].super, parsec_list_item_t);
+        parsec_list_nolock_push_back(&ce_reg_cache_free, &ce_reg_cache_entries[i].super);
+    }
+    memset(&ce_reg_cache_stats, 0, sizeof(ce_reg_cache_stats));
+    ce_reg_cache_nb_entries = 0;
+    ce_reg_cache_capacity = capacity;
+    return PARSEC_SUCCESS;
+}
+
+static void ce_reg_cache_unlink_mem(ce_reg_cache_entry_t *e)
+{
+    ce_reg_cache_entry_t **where = &ce_reg_cache_by_mem[ce_reg_cache_bucket(e->mem)];
+    while( *where != e ) where = &(*where)->next_mem;
+    *where = e->next_mem;
+}
+
+/* Unregisters the handle of an entry no transfer uses, and frees the entry */
+static void ce_reg_cache_release(ce_reg_cache_entry_t *e)
+{
+    ce_reg_cache_entry_t **where = &ce_reg_cache_by_lreg[ce_reg_cache_bucket(e->lreg)];
+
+    assert(0 == e->users);
+    if( e->valid )
+        ce_reg_cache_unlink_mem(e);
+    while( *where != e ) where = &(*where)->next_lreg;
+    *where = e->next_lreg;
+    e->ce->mem_unregister(&e->lreg);
+    e->lreg = NULL;
+    ce_reg_cache_nb_entries--;
+    parsec_list_nolock_push_back(&ce_reg_cache_free, &e->super);
+}
+
+/* Invalidates the registrations of the memory in [lo, hi), or of the datatype */
+static void ce_reg_cache_invalidate(char *lo, char *hi, parsec_datatype_t datatype, int by_datatype)
+{
+    ce_reg_cache_entry_t *e;
+    int i;
+
+    /* Nothing cached, or the cache is gone */
+    if( 0 == ce_reg_cache_nb_entries ) return;
+    parsec_atomic_lock(&ce_reg_cache_lock);
+    for(i = 0; i < ce_reg_cache_capacity; i++) {
+        e = &ce_reg_cache_entries[i];
+        if( (NULL == e->lreg) || !e->valid ) continue;
+        if( by_datatype ? (e->datatype != datatype) : ((e->hi <= lo) || (hi <= e->lo)) ) continue;
+        ce_reg_cache_stats.nb_invalidations++;
+        if( 0 == e->users ) {
+            parsec_list_nolock_remove(&ce_reg_cache_lru, &e->super);
+            ce_reg_cache_release(e);
+        } else {
+            /* The last transfer using it will release it */
+            ce_reg_cache_unlink_mem(e);
+            e->valid = 0;
+        }
+    }
+    parsec_atomic_unlock(&ce_reg_cache_lock);
+}
+
+void parsec_ce_mem_reg_cache_fini(void)
+{
+    int i, capacity = ce_reg_cache_capacity;
+
+    if( 0 == capacity ) return;
+    parsec_debug_verbose(3, parsec_comm_output_stream,
+                         "rank %d served %"PRIu64" memory registrations from the cache, %"PRIu64" missed, "
+                         "%"PRIu64" evicted, %"PRIu64" invalidated",
+                         parsec_debug_rank, ce_reg_cache_stats.nb_hits, ce_reg_cache_stats.nb_misses,
+                         ce_reg_cache_stats.nb_evictions, ce_reg_cache_stats.nb_invalidations);
+    ce_reg_cache_invalidate(NULL, (char*)UINTPTR_MAX, PARSEC_DATATYPE_NULL, 0);
+    assert(0 == ce_reg_cache_nb_entries);
+    ce_reg_cache_capacity = 0;
+    while( NULL != parsec_list_nolock_pop_front(&ce_reg_cache_free) );
+    PARSEC_OBJ_DESTRUCT(&ce_reg_cache_free);
+    PARSEC_OBJ_DESTRUCT(&ce_reg_cache_lru);
+    for(i = 0; i < capacity; i++)
+        PARSEC_OBJ_DESTRUCT(&ce_reg_cache_entries[i].super);
+    free(ce_reg_cache_entries); ce_reg_cache_entries = NULL;
+    free(ce_reg_cache_by_mem); ce_reg_cache_by_mem = NULL;
+    free(ce_reg_cache_by_lreg); ce_reg_cache_by_lreg = NULL;
+}
+
+int parsec_ce_mem_register_cached(parsec_comm_engine_t *ce,
+                                  void *mem, parsec_mem_type_t mem_type,
+                                  size_t count, parsec_datatype_t datatype,
+                                  size_t mem_size,
+                                  parsec_ce_mem_reg_handle_t *lreg,
+                                  size_t *lreg_size)
+{
+    ce_reg_cache_entry_t *e;
+    ptrdiff_t lb, extent;
+    uint32_t b;
+    int rc;
+
+    if( 0 == ce_reg_cache_capacity )
+        return ce->mem_register(mem, mem_type, count, datatype, mem_size, lreg, lreg_size);
+
+    parsec_atomic_lock(&ce_reg_cache_lock);
+    b = ce_reg_cache_bucket(mem);
+    for(e = ce_reg_cache_by_mem[b]; NULL != e; e = e->next_mem) {
+        if( (e->mem == mem) && (e->ce == ce) && (e->mem_type == mem_type) && (e->count == count) &&
+            (e->datatype == datatype) && (e->mem_size == mem_size) ) {
+            if( 0 == e->users++ )
+                parsec_list_nolock_remove(&ce_reg_cache_lru, &e->super);
+            ce_reg_cache_stats.nb_hits++;
+            *lreg = e->lreg;
+            *lreg_size = e->lreg_size;
+            parsec_atomic_unlock(&ce_reg_cache_lock);
+            return 1;
+        }
+    }
+    ce_reg_cache_stats.nb_misses++;
+    if( NULL == (e = (ce_reg_cache_entry_t*)parsec_list_nolock_pop_front(&ce_reg_cache_free)) ) {
+        /* Make room with the registration unused for the longest time */
+        if( NULL != (e = (ce_reg_cache_entry_t*)parsec_list_nolock_pop_front(&ce_reg_cache_lru)) ) {
+            ce_reg_cache_stats.nb_evictions++;
+            ce_reg_cache_release(e);
+            e = (ce_reg_cache_entry_t*)parsec_list_nolock_pop_front(&ce_reg_cache_free);
+        }
+    }
+    if( NULL == e ) {
+        /* All the cached handles are in use, this one will not be cached */
+        parsec_atomic_unlock(&ce_reg_cache_lock);
+        return ce->mem_register(mem, mem_type, count, datatype, mem_size, lreg, lreg_size);
+    }
+    rc = ce->mem_register(mem, mem_type, count, datatype, mem_size, lreg, lreg_size);
+    e->ce        = ce;
+    e->mem       = mem;
+    e->mem_type  = mem_type;
+    e->count     = count;
+    e->datatype  = datatype;
+    e->mem_size  = mem_size;
+    e->lreg      = *lreg;
+    e->lreg_size = *lreg_size;
+    e->users     = 1;
+    e->valid     = 1;
+    if( PARSEC_MEM_TYPE_CONTIGUOUS == mem_type ) {
+        e->lo = (char*)mem;
+        e->hi = (char*)mem + mem_size;
+    } else {
+        parsec_type_extent(datatype, &lb, &extent);
+        e->lo = (char*)mem + lb;
+        e->hi = e->lo + count * extent;
+    }
+    e->next_mem = ce_reg_cache_by_mem[b];
+    ce_reg_cache_by_mem[b] = e;
+    b = ce_reg_cache_bucket(e->lreg);
+    e->next_lreg = ce_reg_cache_by_lreg[b];
+    ce_reg_cache_by_lreg[b] = e;
+    ce_reg_cache_nb_entries++;
+    parsec_atomic_unlock(&ce_reg_cache_lock);
+    return rc;
+}
+
+int parsec_ce_mem_unregister_cached(parsec_comm_engine_t *ce,
+                                    parsec_ce_mem_reg_handle_t *lreg)
+{
+    ce_reg_cache_entry_t *e = NULL;
+
+    if( 0 != ce_reg_cache_capacity ) {
+        parsec_atomic_lock(&ce_reg_cache_lock);
+        for(e = ce_reg_cache_by_lreg[ce_reg_cache_bucket(*lreg)];
+            (NULL != e) && ((e->lreg != *lreg) || (e->ce != ce)); e = e->next_lreg);
+        if( NULL != e ) {
+            assert(e->users > 0);
+            if( 0 == --e->users ) {
+                if( e->valid )  /* the most recently used */
+                    parsec_list_nolock_push_back(&ce_reg_cache_lru, &e->super);
+                else
+                    ce_reg_cache_release(e);
+            }
+            *lreg = NULL;
+        }
+        parsec_atomic_unlock(&ce_reg_cache_lock);
+    }
+    if( NULL == e )  /* not cached */
+        return ce->mem_unregister(lreg);
+    return 1;
+}
+
+void parsec_ce_mem_reg_cache_invalidate(void *mem, size_t size)
+{
+    ce_reg_cache_invalidate((char*)mem, (char*)mem + size, PARSEC_DATATYPE_NULL, 0);
+}
+
+void parsec_ce_mem_reg_cache_invalidate_datatype(parsec_datatype_t datatype)
+{
+    ce_reg_cache_invalidate(NULL, NULL, datatype, 1);
+}
+
+int parsec_ce_mem_reg_cache_get_stats(parsec_ce_mem_reg_cache_stats_t *stats)
+{
+    parsec_atomic_lock(&ce_reg_cache_lock);
+    *stats = ce_reg_cache_stats;
+    parsec_atomic_unlock(&ce_reg_cache_lock);
+    return PARSEC_SUCCESS;
+}
@@ -92,6 +92,10 @@ typedef int (*parsec_ce_onesided_callback_t)(parsec_comm_engine_t *comm_engine,
                              int remote,
                              void *cb_data);
 
+/* A put of size 0 moves the whole memory described by the handles. A
+ * nonzero size moves that many bytes from ldispl in the local memory to
+ * rdispl in the remote memory, both must then be contiguous.
+ */
 typedef int (*parsec_ce_put_fn_t)(parsec_comm_engine_t *comm_engine,
                                   parsec_ce_mem_reg_handle_t lreg,
                                   ptrdiff_t ldispl,
@@ -204,4 +208,47 @@ PARSEC_DECLSPEC extern parsec_comm_engine_t parsec_ce;
 parsec_comm_engine_t * parsec_comm_engine_init(parsec_context_t *parsec_context);
 int parsec_comm_engine_fini(parsec_comm_engine_t *comm_engine);
 
+/* ------- Memory registration cache ------- */
+
+/**
+ * The registrations of the memory of the transfers are kept in a cache of
+ * comm_reg_cache_size entries shared by all the engines, so that a buffer
+ * sent or received again with the same layout reuses its handle instead of
+ * being registered again. A handle can be in use by several transfers at
+ * once, the handles no transfer uses are evicted in least recently used
+ * order once the cache is full. The registrations covering memory released
+ * by PaRSEC (arenas, datatypes) are invalidated, the memory the application
+ * frees must be invalidated with parsec_ce_mem_reg_cache_invalidate.
+ */
+typedef struct parsec_ce_mem_reg_cache_stats_s {
+    uint64_t nb_hits;           /**< Registrations served from the cache */
+    uint64_t nb_misses;         /**< Registrations done by the engines */
+    uint64_t nb_evictions;      /**< Unused registrations dropped to make room */
+    uint64_t nb_invalidations;  /**< Registrations dropped because their memory or datatype was released */
+} parsec_ce_mem_reg_cache_stats_t;
+
+/* Set up the cache with capacity entries, 0 to register every transfer */
+int parsec_ce_mem_reg_cache_init(int capacity);
+/* Unregister all the cached handles and release the cache */
+void parsec_ce_mem_reg_cache_fini(void);
+
+/* Same as comm_engine->mem_register, through the cache */
+int parsec_ce_mem_register_cached(parsec_comm_engine_t *comm_engine,
+                                  void *mem, parsec_mem_type_t mem_type,
+                                  size_t count, parsec_datatype_t datatype,
+                                  size_t mem_size,
+                                  parsec_ce_mem_reg_handle_t *lreg,
+                                  size_t *lreg_size);
+/* Same as comm_engine->mem_unregister for a handle of parsec_ce_mem_register_cached */
+int parsec_ce_mem_unregister_cached(parsec_comm_engine_t *comm_engine,
+                                    parsec_ce_mem_reg_handle_t *lreg);
+
+/* Drop the registrations overlapping the size bytes starting at mem */
+void parsec_ce_mem_reg_cache_invalidate(void *mem, size_t size);
+/* Drop the registrations of data laid out with datatype */
+void parsec_ce_mem_reg_cache_invalidate_datatype(parsec_datatype_t datatype);
+
+/* Get the counters of the cache since it was set up */
+int parsec_ce_mem_reg_cache_get_stats(parsec_ce_mem_reg_cache_stats_t *stats);
+
 #endif /* __USE_PARSEC_COMM_ENGINE_H__ */
@@ -0,0 +1,827 @@
+/*
+ * Copyright (c) 2023      The University of Tennessee and The University
+ *                         of Tennessee Research Foundation.  All rights
+ *                         reserved.
+ */
+
+#include "parsec/parsec_config.h"
+
+#include <mpi.h>
+#include <assert.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/types.h>
+#if defined(PARSEC_HAVE_SHM_OPEN) && defined(PARSEC_HAVE_PROCESS_VM_READV)
+#include <sys/mman.h>
+#include <sys/uio.h>
+#define SHM_CE_SUPPORTED 1
+#endif
+#include "parsec/parsec_comm_shm.h"
+#include "parsec/parsec_mpi_funnelled.h"
+#include "parsec/remote_dep.h"
+#include "parsec/execution_stream.h"
+#include "parsec/class/list.h"
+#include "parsec/sys/atomic.h"
+#include "parsec/utils/debug.h"
+#include "parsec/utils/mca_param.h"
+
+parsec_comm_engine_t parsec_ce_shm;
+
+/* The internal tags of the funnelled engine are not used by this engine,
+ * the put protocol takes them over */
+#define SHM_CE_PUT_TAG_INTERNAL   PARSEC_CE_MPI_FUNNELLED_PUT_TAG_INTERNAL
+#define SHM_CE_DONE_TAG_INTERNAL  PARSEC_CE_MPI_FUNNELLED_GET_TAG_INTERNAL
+
+/* Tag of the records that fill the end of a ring before it wraps around */
+#define SHM_CE_PAD_TAG  UINT32_MAX
+#define SHM_CE_ALIGN(s) (((s) + 7) & ~(size_t)7)
+
+static int shm_ce_param_enable = 1;
+static int shm_ce_param_ring_size = 64 * 1024;
+
+/* One ring per ordered pair of local processes, written by the sender and
+ * read by the receiver. head and tail count bytes since the creation of the
+ * ring, the data follows the structure. */
+typedef struct shm_ce_ring_s {
+    volatile uint64_t head;   /**< Bytes consumed, only written by the receiver */
+    char              pad0[64 - sizeof(uint64_t)];
+    volatile uint64_t tail;   /**< Bytes produced, only written by the sender */
+    char              pad1[64 - sizeof(uint64_t)];
+} shm_ce_ring_t;
+
+typedef struct shm_ce_record_s {
+    uint32_t tag;
+    uint32_t size;
+} shm_ce_record_t;
+
+/* A message that did not fit in the ring, sent at the next progress */
+typedef struct shm_ce_pending_s {
+    parsec_list_item_t super;
+    parsec_ce_tag_t    tag;
+    size_t             size;
+    char               msg[];
+} shm_ce_pending_t;
+
+typedef struct shm_ce_tag_s {
+    parsec_ce_am_callback_t callback;
+    void                   *cb_data;
+    size_t                  msg_length;
+} shm_ce_tag_t;
+
+/* Memory handles, opaque to upper layers */
+typedef struct shm_ce_mem_reg_handle_s {
+    void             *self;
+    void             *mem;
+    parsec_datatype_t datatype;
+    int               count;
+    int               contiguous;  /**< The data is count * size bytes starting at mem */
+    size_t            bytes;       /**< Size of the packed data */
+} shm_ce_mem_reg_handle_t;
+
+/* Message asking the receiver of a put to copy the data */
+typedef struct shm_ce_put_msg_s {
+    uintptr_t src;        /**< Address of the (packed) data in the sender */
+    uint64_t  bytes;
+    uintptr_t dst_handle; /**< Memory handle of the receiver, in the receiver */
+    int64_t   rdispl;
+    uintptr_t cb_fn;      /**< AM callback of the receiver to call once the data is there */
+    uintptr_t op;         /**< Put operation of the sender, returned in the done message */
+} shm_ce_put_msg_t;
+
+/* Message completing a put on the sender (op), or notifying a get (cb_fn) */
+typedef struct shm_ce_done_msg_s {
+    uintptr_t cb_fn;
+    uintptr_t op;
+} shm_ce_done_msg_t;
+
+typedef struct shm_ce_put_s {
+    parsec_ce_onesided_callback_t l_cb;
+    void                         *l_cb_data;
+    parsec_ce_mem_reg_handle_t    lreg;
+    ptrdiff_t                     ldispl;
+    parsec_ce_mem_reg_handle_t    rreg;
+    ptrdiff_t                     rdispl;
+    size_t                        size;
+    int                           remote;
+    void                         *bounce;  /**< Packed copy of a non contiguous source */
+} shm_ce_put_t;
+
+static shm_ce_tag_t shm_ce_tags[PARSEC_MAX_REGISTERED_TAGS];
+
+static MPI_Comm          shm_ce_comm = MPI_COMM_NULL;  /**< Communicator the engine was set up for */
+static int               shm_ce_nb_local = 0;
+static int               shm_ce_my_local = -1;
+static int              *shm_ce_local_of = NULL;  /**< Local index of each rank, -1 if not local */
+static int              *shm_ce_rank_of = NULL;   /**< Rank of each local index */
+static pid_t            *shm_ce_pids = NULL;
+static char             *shm_ce_segment = NULL;
+static size_t            shm_ce_segment_size = 0;
+static size_t            shm_ce_ring_size = 0;
+static parsec_atomic_lock_t *shm_ce_send_locks = NULL;
+static parsec_list_t    *shm_ce_pending = NULL;
+static uint64_t          shm_ce_probe = 0;  /**< Read by the local peers to check they can copy from us */
+static int               shm_ce_generation = 0;
+
+static inline shm_ce_ring_t*
+shm_ce_ring(int src, int dst)
+{
+    return (shm_ce_ring_t*)(shm_ce_segment + ((size_t)src * shm_ce_nb_local + dst) *
+                            (sizeof(shm_ce_ring_t) + shm_ce_ring_size));
+}
+
+int shm_ce_reaches(int remote)
+{
+    return (NULL != shm_ce_segment) && (shm_ce_local_of[remote] >= 0);
+}
+
+/* Copies bytes from the address src of the local process local */
+static int
+shm_ce_copy_from(int local, void *dst, uintptr_t src, size_t bytes)
+{
+#if defined(SHM_CE_SUPPORTED)
+    struct iovec liov, riov;
+    ssize_t rc;
+
+    while( bytes > 0 ) {
+        liov.iov_base = dst;         liov.iov_len = bytes;
+        riov.iov_base = (void*)src;  riov.iov_len = bytes;
+        rc = process_vm_readv(shm_ce_pids[local], &liov, 1, &riov, 1, 0);
+        if( rc <= 0 ) {
+            if( (rc < 0) && (EINTR == errno) ) continue;
+            return PARSEC_ERROR;
+        }
+        dst    = (char*)dst + rc;
+        src   += rc;
+        bytes -= rc;
+    }
+    return PARSEC_SUCCESS;
+#else
+    (void)local; (void)dst; (void)src; (void)bytes;
+    return PARSEC_ERR_NOT_SUPPORTED;
+#endif  /* defined(SHM_CE_SUPPORTED) */
+}
+
+/* Appends a message to the ring, returns 0 if there is not enough room */
+static int
+shm_ce_ring_write(shm_ce_ring_t *ring, uint32_t tag, const void *msg, size_t size)
+{
+    char *data = (char*)(ring + 1);
+    size_t need = sizeof(shm_ce_record_t) + SHM_CE_ALIGN(size);
+    uint64_t tail = ring->tail, head = ring->head;
+    size_t pos = tail % shm_ce_ring_size, skip = 0;
+    shm_ce_record_t *record;
+
+    if( pos + need > shm_ce_ring_size )
+        skip = shm_ce_ring_size - pos;  /* records are never split */
+    if( tail + skip + need - head > shm_ce_ring_size )
+        return 0;
+    /* do not overwrite what the receiver may still be reading */
+    parsec_mfence();
+    if( 0 != skip ) {
+        record = (shm_ce_record_t*)(data + pos);
+        record->tag  = SHM_CE_PAD_TAG;
+        record->size = 0;
+        pos = 0;
+    }
+    record = (shm_ce_record_t*)(data + pos);
+    record->tag  = tag;
+    record->size = (uint32_t)size;
+    memcpy(record + 1, msg, size);
+    parsec_atomic_wmb();
+    ring->tail = tail + skip + need;
+    return 1;
+}
+
+int
+shm_ce_send_active_message(parsec_comm_engine_t *ce,
+                           parsec_ce_tag_t tag,
+                           int remote,
+                           void *addr, size_t size)
+{
+    int dst = shm_ce_local_of[remote];
+    shm_ce_pending_t *pending;
+    (void)ce;
+
+    assert(shm_ce_tags[tag].msg_length >= size);
+    parsec_atomic_lock(&shm_ce_send_locks[dst]);
+    /* Keep the order of the messages: nothing goes in the ring while older
+     * messages are waiting */
+    if( parsec_list_nolock_is_empty(&shm_ce_pending[dst]) &&
+        shm_ce_ring_write(shm_ce_ring(shm_ce_my_local, dst), (uint32_t)tag, addr, size) ) {
+        parsec_atomic_unlock(&shm_ce_send_locks[dst]);
+        return 1;
+    }
+    pending = (shm_ce_pending_t*)malloc(sizeof(shm_ce_pending_t) + size);
+    PARSEC_OBJ_CONSTRUCT(&pending->super, parsec_list_item_t);
+    pending->tag  = tag;
+    pending->size = size;
+    memcpy(pending->msg, addr, size);
+    parsec_list_nolock_push_back(&shm_ce_pending[dst], &pending->super);
+    parsec_atomic_unlock(&shm_ce_send_locks[dst]);
+    return 1;
+}
+
+/* This is the callback that is triggered on the receiver side of a put:
+ * copy the data from the sender, notify the upper layer and let the sender
+ * release its side.
+ */
+static int
+shm_ce_internal_put_am_callback(parsec_comm_engine_t *ce,
+                                parsec_ce_tag_t tag,
+                                void *msg,
+                                size_t msg_size,
+                                int src,
+                                void *cb_data)
+{
+    shm_ce_put_msg_t *put = (shm_ce_put_msg_t*)msg;
+    shm_ce_mem_reg_handle_t *handle = (shm_ce_mem_reg_handle_t*)put->dst_handle;
+    char *dst = (char*)handle->mem + put->rdispl;
+    shm_ce_done_msg_t done;
+    void *tmp;
+    int rc, position = 0;
+    (void)tag; (void)cb_data;
+
+    if( handle->contiguous ) {
+        rc = shm_ce_copy_from(shm_ce_local_of[src], dst, put->src,
+                              put->bytes < handle->bytes - put->rdispl ? put->bytes : handle->bytes - put->rdispl);
+    } else {
+        tmp = malloc(put->bytes);
+        rc = shm_ce_copy_from(shm_ce_local_of[src], tmp, put->src, put->bytes);
+        if( PARSEC_SUCCESS == rc )
+            parsec_ce.unpack(&parsec_ce, tmp, (int)put->bytes, &position,
+                             dst, handle->count, handle->datatype);
+        free(tmp);
+    }
+    if( PARSEC_SUCCESS != rc ) {
+        parsec_fatal("SHM:\tcopy of %"PRIu64" bytes from rank %d failed (%s)",
+                     put->bytes, src, strerror(errno));
+    }
+    if( 0 != put->cb_fn ) {
+        ((parsec_ce_am_callback_t)put->cb_fn)(ce, tag, put + 1, msg_size - sizeof(shm_ce_put_msg_t),
+                                              src, NULL);
+    }
+    done.cb_fn = 0;
+    done.op    = put->op;
+    ce->send_am(ce, SHM_CE_DONE_TAG_INTERNAL, src, &done, sizeof(shm_ce_done_msg_t));
+    return 1;
+}
+
+/* This is the callback that is triggered on the sender side once the
+ * receiver of a put has copied the data, or on the remote side of a get.
+ */
+static int
+shm_ce_internal_done_am_callback(parsec_comm_engine_t *ce,
+                                 parsec_ce_tag_t tag,
+                                 void *msg,
+                                 size_t msg_size,
+                                 int src,
+                                 void *cb_data)
+{
+    shm_ce_done_msg_t *done = (shm_ce_done_msg_t*)msg;
+    shm_ce_put_t *op = (shm_ce_put_t*)done->op;
+    (void)cb_data;
+
+    if( NULL == op ) {
+        ((parsec_ce_am_callback_t)done->cb_fn)(ce, tag, done + 1, msg_size - sizeof(shm_ce_done_msg_t),
+                                               src, NULL);
+        return 1;
+    }
+    free(op->bounce);
+    if( NULL != op->l_cb ) {
+        op->l_cb(ce, op->lreg, op->ldispl, op->rreg, op->rdispl,
+                 op->size, op->remote, op->l_cb_data);
+    }
+    free(op);
+    return 1;
+}
+
+int
+shm_ce_put(parsec_comm_engine_t *ce,
+           parsec_ce_mem_reg_handle_t lreg,
+           ptrdiff_t ldispl,
+           parsec_ce_mem_reg_handle_t rreg,
+           ptrdiff_t rdispl,
+           size_t size,
+           int remote,
+           parsec_ce_onesided_callback_t l_cb, void *l_cb_data,
+           parsec_ce_tag_t r_tag, void *r_cb_data, size_t r_cb_data_size)
+{
+    shm_ce_mem_reg_handle_t *source_memory_handle = (shm_ce_mem_reg_handle_t*)lreg;
+    shm_ce_mem_reg_handle_t *remote_memory_handle = (shm_ce_mem_reg_handle_t*)rreg;
+    shm_ce_put_t *op = (shm_ce_put_t*)malloc(sizeof(shm_ce_put_t));
+    char *src = (char*)source_memory_handle->mem + ldispl;
+    size_t bytes = source_memory_handle->bytes;
+    shm_ce_put_msg_t *put;
+    int position = 0;
+
+    op->l_cb      = l_cb;
+    op->l_cb_data = l_cb_data;
+    op->lreg      = source_memory_handle->self;
+    op->ldispl    = ldispl;
+    op->rreg      = remote_memory_handle->self;  /* the receiver's pointer, not the copy of the handle */
+    op->rdispl    = rdispl;
+    op->size      = size;
+    op->remote    = remote;
+    op->bounce    = NULL;
+    if( !source_memory_handle->contiguous ) {
+        /* The receiver copies packed data, it stays here until the done message */
+        op->bounce = malloc(bytes);
+        parsec_ce.pack(&parsec_ce, src, source_memory_handle->count, source_memory_handle->datatype,
+                       op->bounce, (int)bytes, &position);
+        src   = (char*)op->bounce;
+        bytes = position;
+    } else if( (0 != size) && (size < bytes) ) {
+        bytes = size;
+    }
+
+    put = (shm_ce_put_msg_t*)malloc(sizeof(shm_ce_put_msg_t) + r_cb_data_size);
+    put->src        = (uintptr_t)src;
+    put->bytes      = bytes;
+    put->dst_handle = (uintptr_t)remote_memory_handle->self;
+    put->rdispl     = rdispl;
+    put->cb_fn      = (uintptr_t)r_tag;
+    put->op         = (uintptr_t)op;
+    memcpy(put + 1, r_cb_data, r_cb_data_size);
+    ce->send_am(ce, SHM_CE_PUT_TAG_INTERNAL, remote, put, sizeof(shm_ce_put_msg_t) + r_cb_data_size);
+    free(put);
+    return 1;
+}
+
+int
+shm_ce_get(parsec_comm_engine_t *ce,
+           parsec_ce_mem_reg_handle_t lreg,
+           ptrdiff_t ldispl,
+           parsec_ce_mem_reg_handle_t rreg,
+           ptrdiff_t rdispl,
+           size_t size,
+           int remote,
+           parsec_ce_onesided_callback_t l_cb, void *l_cb_data,
+           parsec_ce_tag_t r_tag, void *r_cb_data, size_t r_cb_data_size)
+{
+    shm_ce_mem_reg_handle_t *local_memory_handle = (shm_ce_mem_reg_handle_t*)lreg;
+    shm_ce_mem_reg_handle_t *remote_memory_handle = (shm_ce_mem_reg_handle_t*)rreg;
+    char *dst = (char*)local_memory_handle->mem + ldispl;
+    uintptr_t src = (uintptr_t)remote_memory_handle->mem + rdispl;
+    size_t bytes = remote_memory_handle->bytes;
+    shm_ce_done_msg_t *done;
+    int rc, position = 0;
+    void *tmp;
+
+    /* The remote side is not involved, its data must be readable as is */
+    if( !remote_memory_handle->contiguous )
+        return PARSEC_ERR_NOT_SUPPORTED;
+    if( (0 != size) && (size < bytes) )
+        bytes = size;
+    if( local_memory_handle->contiguous ) {
+        rc = shm_ce_copy_from(shm_ce_local_of[remote], dst, src,
+                              bytes < local_memory_handle->bytes ? bytes : local_memory_handle->bytes);
+    } else {
+        tmp = malloc(bytes);
+        rc = shm_ce_copy_from(shm_ce_local_of[remote], tmp, src, bytes);
+        if( PARSEC_SUCCESS == rc )
+            parsec_ce.unpack(&parsec_ce, tmp, (int)bytes, &position,
+                             dst, local_memory_handle->count, local_memory_handle->datatype);
+        free(tmp);
+    }
+    if( PARSEC_SUCCESS != rc ) {
+        parsec_fatal("SHM:\tcopy of %zu bytes from rank %d failed (%s)",
+                     bytes, remote, strerror(errno));
+    }
+    if( NULL != l_cb ) {
+        l_cb(ce, local_memory_handle->self, ldispl, remote_memory_handle->self, rdispl,
+             size, remote, l_cb_data);
+    }
+    if( 0 != r_tag ) {
+        done = (shm_ce_done_msg_t*)malloc(sizeof(shm_ce_done_msg_t) + r_cb_data_size);
+        done->cb_fn = (uintptr_t)r_tag;
+        done->op    = 0;
+        memcpy(done + 1, r_cb_data, r_cb_data_size);
+        ce->send_am(ce, SHM_CE_DONE_TAG_INTERNAL, remote, done, sizeof(shm_ce_done_msg_t) + r_cb_data_size);
+        free(done);
+    }
+    return 1;
+}
+
+int
+shm_ce_mem_register(void *mem, parsec_mem_type_t mem_type,
+                    size_t count, parsec_datatype_t datatype,
+                    size_t mem_size,
+                    parsec_ce_mem_reg_handle_t *lreg,
+                    size_t *lreg_size)
+{
+    shm_ce_mem_reg_handle_t *handle = (shm_ce_mem_reg_handle_t*)malloc(sizeof(shm_ce_mem_reg_handle_t));
+    ptrdiff_t lb, extent;
+    int size;
+
+    handle->self     = handle;
+    handle->mem      = mem;
+    handle->datatype = datatype;
+    handle->count    = (int)count;
+    if( PARSEC_MEM_TYPE_CONTIGUOUS == mem_type ) {
+        handle->contiguous = 1;
+        handle->bytes      = mem_size;
+    } else {
+        /* Dense layouts are copied directly, the others are packed */
+        parsec_type_size(datatype, &size);
+        parsec_type_extent(datatype, &lb, &extent);
+        handle->contiguous = (0 == lb) && (extent == (ptrdiff_t)size);
+        if( handle->contiguous ) {
+            handle->bytes = count * (size_t)size;
+        } else {
+            parsec_ce.pack_size(&parsec_ce, (int)count, datatype, &size);
+            handle->bytes = size;
+        }
+    }
+    *lreg = handle;
+    *lreg_size = sizeof(shm_ce_mem_reg_handle_t);
+    return 1;
+}
+
+int
+shm_ce_mem_unregister(parsec_ce_mem_reg_handle_t *lreg)
+{
+    shm_ce_mem_reg_handle_t *handle = (shm_ce_mem_reg_handle_t*)*lreg;
+    free(handle->self);
+    *lreg = NULL;
+    return 1;
+}
+
+int shm_ce_get_mem_reg_handle_size(void)
+{
+    return sizeof(shm_ce_mem_reg_handle_t);
+}
+
+int
+shm_ce_mem_retrieve(parsec_ce_mem_reg_handle_t lreg,
+                    void **mem, parsec_datatype_t *datatype, int *count)
+{
+    shm_ce_mem_reg_handle_t *handle = (shm_ce_mem_reg_handle_t*)lreg;
+    *mem = handle->mem;
+    *datatype = handle->datatype;
+    *count = handle->count;
+    return 1;
+}
+
+int
+shm_ce_tag_register(parsec_ce_tag_t tag,
+                    parsec_ce_am_callback_t callback,
+                    void *cb_data,
+                    size_t msg_length)
+{
+    if(tag >= PARSEC_MAX_REGISTERED_TAGS) {
+        parsec_warning("Tag is out of range, it has to be between %d - %d\n", 0, PARSEC_MAX_REGISTERED_TAGS);
+        return PARSEC_ERR_VALUE_OUT_OF_BOUNDS;
+    }
+    if( NULL != shm_ce_tags[tag].callback ) {
+        parsec_warning("Tag: %ld is already registered (callback %p, callback data %p, msg length %d)\n",
+                       tag, shm_ce_tags[tag].callback, shm_ce_tags[tag].cb_data, (int)shm_ce_tags[tag].msg_length);
+        return PARSEC_ERR_EXISTS;
+    }
+    /* Once the rings are set up, they must be able to hold the largest message */
+    if( (0 != shm_ce_ring_size) &&
+        (4 * (sizeof(shm_ce_record_t) + SHM_CE_ALIGN(msg_length)) > shm_ce_ring_size) ) {
+        parsec_warning("Tag: %ld messages (%zu bytes) are too large for the shared memory rings (%zu bytes)\n",
+                       tag, msg_length, shm_ce_ring_size);
+        return PARSEC_ERR_VALUE_OUT_OF_BOUNDS;
+    }
+    shm_ce_tags[tag].msg_length = msg_length;
+    shm_ce_tags[tag].cb_data    = cb_data;
+    shm_ce_tags[tag].callback   = callback;
+    return PARSEC_SUCCESS;
+}
+
+int
+shm_ce_tag_unregister(parsec_ce_tag_t tag)
+{
+    shm_ce_tags[tag].callback = NULL;
+    shm_ce_tags[tag].cb_data  = NULL;
+    return PARSEC_SUCCESS;
+}
+
+/* Sends the messages that did not fit in the rings before */
+static int
+shm_ce_push_pending(void)
+{
+    shm_ce_pending_t *pending;
+    int dst, ret = 0;
+
+    for(dst = 0; dst < shm_ce_nb_local; dst++) {
+        if( parsec_list_nolock_is_empty(&shm_ce_pending[dst]) ) continue;
+        parsec_atomic_lock(&shm_ce_send_locks[dst]);
+        while( NULL != (pending = (shm_ce_pending_t*)parsec_list_nolock_pop_front(&shm_ce_pending[dst])) ) {
+            if( !shm_ce_ring_write(shm_ce_ring(shm_ce_my_local, dst), (uint32_t)pending->tag,
+                                   pending->msg, pending->size) ) {
+                parsec_list_nolock_push_front(&shm_ce_pending[dst], &pending->super);
+                break;
+            }
+            free(pending);
+            ret++;
+        }
+        parsec_atomic_unlock(&shm_ce_send_locks[dst]);
+    }
+    return ret;
+}
+
+int
+shm_ce_progress(parsec_comm_engine_t *ce)
+{
+    shm_ce_ring_t *ring;
+    shm_ce_record_t *record;
+    uint64_t head;
+    size_t pos;
+    uint32_t tag, size;
+    int src, ret = 0;
+
+    if( NULL == shm_ce_segment ) return 0;
+
+    ret += shm_ce_push_pending();
+    for(src = 0; src < shm_ce_nb_local; src++) {
+        if( src == shm_ce_my_local ) continue;
+        ring = shm_ce_ring(src, shm_ce_my_local);
+        while( (head = ring->head) != ring->tail ) {
+            parsec_atomic_rmb();
+            pos = head % shm_ce_ring_size;
+            record = (shm_ce_record_t*)((char*)(ring + 1) + pos);
+            tag  = record->tag;
+            size = record->size;
+            if( SHM_CE_PAD_TAG == tag ) {
+                ring->head = head + (shm_ce_ring_size - pos);
+                continue;
+            }
+            /* The message is handled in place, the sender cannot reuse its
+             * space before the head moves */
+            assert(tag < PARSEC_MAX_REGISTERED_TAGS && NULL != shm_ce_tags[tag].callback);
+            shm_ce_tags[tag].callback(ce, tag, record + 1, size, shm_ce_rank_of[src],
+                                      shm_ce_tags[tag].cb_data);
+            parsec_mfence();
+            ring->head = head + sizeof(shm_ce_record_t) + SHM_CE_ALIGN(size);
+            ret++;
+        }
+    }
+    return ret;
+}
+
+/* Releases the segment and the mapping of the local processes */
+static void
+shm_ce_teardown(void)
+{
+    shm_ce_pending_t *pending;
+    int i;
+
+    if( NULL != shm_ce_segment ) {
+#if defined(SHM_CE_SUPPORTED)
+        munmap(shm_ce_segment, shm_ce_segment_size);
+#endif  /* defined(SHM_CE_SUPPORTED) */
+        shm_ce_segment = NULL;
+    }
+    if( NULL != shm_ce_pending ) {
+        for(i = 0; i < shm_ce_nb_local; i++) {
+            while( NULL != (pending = (shm_ce_pending_t*)parsec_list_nolock_pop_front(&shm_ce_pending[i])) )
+                free(pending);
+            PARSEC_OBJ_DESTRUCT(&shm_ce_pending[i]);
+        }
+        free(shm_ce_pending); shm_ce_pending = NULL;
+    }
+    free((void*)shm_ce_send_locks); shm_ce_send_locks = NULL;
+    free(shm_ce_local_of); shm_ce_local_of = NULL;
+    free(shm_ce_rank_of);  shm_ce_rank_of = NULL;
+    free(shm_ce_pids);     shm_ce_pids = NULL;
+    if( MPI_COMM_NULL != shm_ce_comm )
+        MPI_Comm_free(&shm_ce_comm);
+    shm_ce_nb_local = 0;
+    shm_ce_my_local = -1;
+    shm_ce_segment_size = 0;
+    shm_ce_ring_size = 0;
+}
+
+/**
+ * Collective on the communicator of the MPI engine. Finds the processes
+ * on the same node, checks that they can copy from each other, and maps
+ * the segment holding the rings between them. If any of these steps fails
+ * the engine stays disabled and all peers are reached through MPI.
+ */
+int
+shm_ce_enable(parsec_comm_engine_t *ce)
+{
+#if defined(SHM_CE_SUPPORTED)
+    parsec_context_t *context = ce->parsec_context;
+    MPI_Comm comm = (MPI_Comm)context->comm_ctx, local;
+    struct { int rank; pid_t pid; uintptr_t probe; } me, *all = NULL;
+    char name[64];
+    uint64_t ring_size, probe;
+    int i, res, ok, all_ok, fd;
+
+    assert(-1 != context->comm_ctx);
+    if( MPI_COMM_NULL != shm_ce_comm ) {
+        /* Still valid if the processes and their order did not change */
+        MPI_Comm_compare(shm_ce_comm, comm, &res);
+        if( (MPI_IDENT == res) || (MPI_CONGRUENT == res) )
+            return PARSEC_SUCCESS;
+        shm_ce_teardown();
+    }
+    if( !shm_ce_param_enable || (1 == context->nb_nodes) )
+        return PARSEC_SUCCESS;
+
+    MPI_Comm_dup(comm, &shm_ce_comm);
+    MPI_Comm_split_type(shm_ce_comm, MPI_COMM_TYPE_SHARED, 0, MPI_INFO_NULL, &local);
+    MPI_Comm_size(local, &shm_ce_nb_local);
+    MPI_Comm_rank(local, &shm_ce_my_local);
+    if( 1 == shm_ce_nb_local ) {
+        MPI_Comm_free(&local);
+        shm_ce_nb_local = 0;
+        shm_ce_my_local = -1;
+        return PARSEC_SUCCESS;
+    }
+
+    shm_ce_probe = (uint64_t)getpid();
+    me.rank  = context->my_rank;
+    me.pid   = getpid();
+    me.probe = (uintptr_t)&shm_ce_probe;
+    all = malloc(shm_ce_nb_local * sizeof(*all));
+    MPI_Allgather(&me, sizeof(me), MPI_BYTE, all, sizeof(me), MPI_BYTE, local);
+    shm_ce_local_of = (int*)malloc(context->nb_nodes * sizeof(int));
+    for(i = 0; i < context->nb_nodes; i++) shm_ce_local_of[i] = -1;
+    shm_ce_rank_of = (int*)malloc(shm_ce_nb_local * sizeof(int));
+    shm_ce_pids = (pid_t*)malloc(shm_ce_nb_local * sizeof(pid_t));
+    for(i = 0; i < shm_ce_nb_local; i++) {
+        shm_ce_local_of[all[i].rank] = i;
+        shm_ce_rank_of[i] = all[i].rank;
+        shm_ce_pids[i] = all[i].pid;
+    }
+
+    /* Cross memory attach can be forbidden (ptrace scope, containers),
+     * check it on the next local process */
+    i = (shm_ce_my_local + 1) % shm_ce_nb_local;
+    ok = (PARSEC_SUCCESS == shm_ce_copy_from(i, &probe, all[i].probe, sizeof(uint64_t))) &&
+        (probe == (uint64_t)all[i].pid);
+    free(all);
+    MPI_Allreduce(&ok, &all_ok, 1, MPI_INT, MPI_LAND, local);
+    if( !all_ok ) {
+        parsec_debug_verbose(3, parsec_comm_output_stream,
+                             "SHM:\tprocesses on the same node cannot copy from each other (%s), using MPI",
+                             ok ? "on another process" : strerror(errno));
+        goto disable;
+    }
+
+    /* The rings must hold a few of the largest messages */
+    ring_size = shm_ce_param_ring_size;
+    for(i = 0; i < PARSEC_MAX_REGISTERED_TAGS; i++) {
+        if( NULL == shm_ce_tags[i].callback ) continue;
+        if( ring_size < 4 * (sizeof(shm_ce_record_t) + SHM_CE_ALIGN(shm_ce_tags[i].msg_length)) )
+            ring_size = 4 * (sizeof(shm_ce_record_t) + SHM_CE_ALIGN(shm_ce_tags[i].msg_length));
+    }
+    ring_size = (ring_size + 63) & ~(size_t)63;
+    MPI_Allreduce(MPI_IN_PLACE, &ring_size, 1, MPI_UINT64_T, MPI_MAX, local);
+    shm_ce_ring_size = ring_size;
+    shm_ce_segment_size = (size_t)shm_ce_nb_local * shm_ce_nb_local * (sizeof(shm_ce_ring_t) + ring_size);
+
+    /* The first local process creates the segment, the others map it, and
+     * it is unlinked once everybody holds it */
+    ok = 1; fd = -1;
+    if( 0 == shm_ce_my_local ) {
+        snprintf(name, sizeof(name), "/parsec_shm.%d.%d", (int)getpid(), shm_ce_generation++);
+        fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0600);
+        ok = (-1 != fd) && (0 == ftruncate(fd, shm_ce_segment_size));
+    }
+    MPI_Bcast(&ok, 1, MPI_INT, 0, local);
+    if( !ok ) {
+        parsec_debug_verbose(3, parsec_comm_output_stream,
+                             "SHM:\tcannot create a shared memory segment of %zu bytes, using MPI",
+                             shm_ce_segment_size);
+        if( -1 != fd ) { close(fd); shm_unlink(name); }
+        goto disable;
+    }
+    MPI_Bcast(name, sizeof(name), MPI_CHAR, 0, local);
+    if( 0 != shm_ce_my_local )
+        fd = shm_open(name, O_RDWR, 0600);
+    if( -1 != fd ) {
+        shm_ce_segment = mmap(NULL, shm_ce_segment_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if( MAP_FAILED == shm_ce_segment ) shm_ce_segment = NULL;
+        close(fd);
+    }
+    ok = (NULL != shm_ce_segment);
+    MPI_Allreduce(&ok, &all_ok, 1, MPI_INT, MPI_LAND, local);
+    if( 0 == shm_ce_my_local )
+        shm_unlink(name);
+    if( !all_ok ) {
+        parsec_debug_verbose(3, parsec_comm_output_stream,
+                             "SHM:\tcannot map the shared memory segment %s, using MPI", name);
+        goto disable;
+    }
+
+    shm_ce_send_locks = (parsec_atomic_lock_t*)malloc(shm_ce_nb_local * sizeof(parsec_atomic_lock_t));
+    shm_ce_pending = (parsec_list_t*)malloc(shm_ce_nb_local * sizeof(parsec_list_t));
+    for(i = 0; i < shm_ce_nb_local; i++) {
+        parsec_atomic_lock_init(&shm_ce_send_locks[i]);
+        PARSEC_OBJ_CONSTRUCT(&shm_ce_pending[i], parsec_list_t);
+    }
+    MPI_Comm_free(&local);
+
+    parsec_ce_shm.pack      = parsec_ce.pack;
+    parsec_ce_shm.pack_size = parsec_ce.pack_size;
+    parsec_ce_shm.unpack    = parsec_ce.unpack;
+    parsec_ce_shm.reshape   = parsec_ce.reshape;
+    parsec_ce_shm.sync      = parsec_ce.sync;
+
+    PARSEC_DEBUG_VERBOSE(10, parsec_comm_output_stream,
+                         "rank %d ENABLE shared memory communication engine with %d local processes (%zu bytes rings)",
+                         context->my_rank, shm_ce_nb_local, shm_ce_ring_size);
+    return PARSEC_SUCCESS;
+
+  disable:
+    MPI_Comm_free(&local);
+    /* Keep shm_ce_comm, the result will be the same until it changes */
+    free(shm_ce_local_of); shm_ce_local_of = NULL;
+    free(shm_ce_rank_of);  shm_ce_rank_of = NULL;
+    free(shm_ce_pids);     shm_ce_pids = NULL;
+    if( NULL != shm_ce_segment ) {
+        munmap(shm_ce_segment, shm_ce_segment_size);
+        shm_ce_segment = NULL;
+    }
+    shm_ce_nb_local = 0;
+    shm_ce_my_local = -1;
+    shm_ce_ring_size = 0;
+    return PARSEC_SUCCESS;
+#else
+    (void)ce;
+    return PARSEC_ERR_NOT_SUPPORTED;
+#endif  /* defined(SHM_CE_SUPPORTED) */
+}
+
+int
+shm_ce_disable(parsec_comm_engine_t *ce)
+{
+    (void)ce;
+    return 1;
+}
+
+int
+shm_ce_can_push_more(parsec_comm_engine_t *ce)
+{
+    (void)ce;
+    return 1;
+}
+
+parsec_comm_engine_t *
+shm_ce_init(parsec_context_t *context)
+{
+    int i;
+
+    parsec_mca_param_reg_int_name("comm", "shm_enable",
+                                  "Use shared memory and single copy transfers between the processes on the same node (1=true,0=false)",
+                                  false, false, shm_ce_param_enable, &shm_ce_param_enable);
+    parsec_mca_param_reg_int_name("comm", "shm_ring_size",
+                                  "Size in bytes of the ring holding the active messages from one local process to another "
+                                  "(increased to hold at least 4 of the largest messages)",
+                                  false, false, shm_ce_param_ring_size, &shm_ce_param_ring_size);
+
+    for(i = 0; i < PARSEC_MAX_REGISTERED_TAGS; i++) {
+        shm_ce_tags[i].callback = NULL;
+        shm_ce_tags[i].cb_data = NULL;
+        shm_ce_tags[i].msg_length = 0;
+    }
+
+    parsec_ce_shm.enable              = shm_ce_enable;
+    parsec_ce_shm.disable             = shm_ce_disable;
+    parsec_ce_shm.set_ctx             = NULL;  /* follows the MPI engine */
+    parsec_ce_shm.fini                = shm_ce_fini;
+    parsec_ce_shm.tag_register        = shm_ce_tag_register;
+    parsec_ce_shm.tag_unregister      = shm_ce_tag_unregister;
+    parsec_ce_shm.mem_register        = shm_ce_mem_register;
+    parsec_ce_shm.mem_unregister      = shm_ce_mem_unregister;
+    parsec_ce_shm.get_mem_handle_size = shm_ce_get_mem_reg_handle_size;
+    parsec_ce_shm.mem_retrieve        = shm_ce_mem_retrieve;
+    parsec_ce_shm.put                 = shm_ce_put;
+    parsec_ce_shm.get                 = shm_ce_get;
+    parsec_ce_shm.progress            = shm_ce_progress;
+    parsec_ce_shm.pack                = NULL;
+    parsec_ce_shm.pack_size           = NULL;
+    parsec_ce_shm.unpack              = NULL;
+    parsec_ce_shm.sync                = NULL;
+    parsec_ce_shm.reshape             = NULL;
+    parsec_ce_shm.can_serve           = shm_ce_can_push_more;
+    parsec_ce_shm.send_am             = shm_ce_send_active_message;
+
+    parsec_ce_shm.parsec_context      = context;
+    parsec_ce_shm.capabilites.sided   = 2;
+    parsec_ce_shm.capabilites.supports_noncontiguous_datatype = 1;
+
+    shm_ce_tag_register(SHM_CE_PUT_TAG_INTERNAL, shm_ce_internal_put_am_callback, context, 4096);
+    shm_ce_tag_register(SHM_CE_DONE_TAG_INTERNAL, shm_ce_internal_done_am_callback, context, 4096);
+    return &parsec_ce_shm;
+}
+
+int
+shm_ce_fini(parsec_comm_engine_t *ce)
+{
+    shm_ce_tag_unregister(SHM_CE_PUT_TAG_INTERNAL);
+    shm_ce_tag_unregister(SHM_CE_DONE_TAG_INTERNAL);
+    shm_ce_teardown();
+    (void)ce;
+    return 1;
+}
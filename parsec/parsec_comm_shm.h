@@ -0,0 +1,81 @@
+/*
+ * Copyright (c) 2023      The University of Tennessee and The University
+ *                         of Tennessee Research Foundation.  All rights
+ *                         reserved.
+ */
+#ifndef __USE_PARSEC_COMM_SHM_H__
+#define __USE_PARSEC_COMM_SHM_H__
+
+#include "parsec/parsec_comm_engine.h"
+
+/* ------- Shared memory implementation for co-located processes ------- */
+
+/**
+ * The shared memory engine complements the funnelled MPI engine for the
+ * peers running on the same node: active messages go through rings in a
+ * segment mapped by all the local processes, and the data of a put is
+ * copied once, by the receiver, from the memory of the sender (Linux
+ * cross memory attach). It is set up by the MPI engine communicator when
+ * the MPI engine is enabled, and the upper layer uses it for a peer when
+ * shm_ce_reaches() holds for that peer.
+ */
+PARSEC_DECLSPEC extern parsec_comm_engine_t parsec_ce_shm;
+
+parsec_comm_engine_t * shm_ce_init(parsec_context_t *parsec_context);
+int shm_ce_fini(parsec_comm_engine_t *comm_engine);
+
+/** Returns true if the messages to remote go through the shared memory engine */
+int shm_ce_reaches(int remote);
+
+int shm_ce_tag_register(parsec_ce_tag_t tag,
+                        parsec_ce_am_callback_t cb,
+                        void *cb_data,
+                        size_t msg_length);
+
+int shm_ce_tag_unregister(parsec_ce_tag_t tag);
+
+int shm_ce_mem_register(void *mem, parsec_mem_type_t mem_type,
+                        size_t count, parsec_datatype_t datatype,
+                        size_t mem_size,
+                        parsec_ce_mem_reg_handle_t *lreg,
+                        size_t *lreg_size);
+
+int shm_ce_mem_unregister(parsec_ce_mem_reg_handle_t *lreg);
+
+int shm_ce_get_mem_reg_handle_size(void);
+
+int shm_ce_mem_retrieve(parsec_ce_mem_reg_handle_t lreg, void **mem, parsec_datatype_t *datatype, int *count);
+
+int shm_ce_put(parsec_comm_engine_t *comm_engine,
+               parsec_ce_mem_reg_handle_t lreg,
+               ptrdiff_t ldispl,
+               parsec_ce_mem_reg_handle_t rreg,
+               ptrdiff_t rdispl,
+               size_t size,
+               int remote,
+               parsec_ce_onesided_callback_t l_cb, void *l_cb_data,
+               parsec_ce_tag_t r_tag, void *r_cb_data, size_t r_cb_data_size);
+
+int shm_ce_get(parsec_comm_engine_t *comm_engine,
+               parsec_ce_mem_reg_handle_t lreg,
+               ptrdiff_t ldispl,
+               parsec_ce_mem_reg_handle_t rreg,
+               ptrdiff_t rdispl,
+               size_t size,
+               int remote,
+               parsec_ce_onesided_callback_t l_cb, void *l_cb_data,
+               parsec_ce_tag_t r_tag, void *r_cb_data, size_t r_cb_data_size);
+
+int shm_ce_send_active_message(parsec_comm_engine_t *comm_engine,
+                               parsec_ce_tag_t tag,
+                               int remote,
+                               void *addr, size_t size);
+
+int shm_ce_progress(parsec_comm_engine_t *comm_engine);
+
+int shm_ce_enable(parsec_comm_engine_t *comm_engine);
+int shm_ce_disable(parsec_comm_engine_t *comm_engine);
+
+int shm_ce_can_push_more(parsec_comm_engine_t *comm_engine);
+
+#endif /* __USE_PARSEC_COMM_SHM_H__ */
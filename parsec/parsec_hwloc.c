@@ -298,15 +298,58 @@ int parsec_hwloc_numa_id(int core_id )
     hwloc_obj_t core =  hwloc_get_obj_by_type(topology, HWLOC_OBJ_CORE, core_id);
     hwloc_obj_t node = NULL;
     if( NULL == core ) return PARSEC_ERR_NOT_FOUND;  /* protect against NULL objects */
+#if HWLOC_API_VERSION >= 0x00020000
+    /* Starting with hwloc 2.0 the NUMA nodes are memory children attached
+     * to the first ancestor with a non-null memory arity. */
+    for( node = HWLOC_GET_PARENT(core); NULL != node; node = HWLOC_GET_PARENT(node) ) {
+        if( 0 != node->memory_arity ) {
+            return node->memory_first_child->logical_index;
+        }
+    }
+#else
     if( NULL != (node = hwloc_get_ancestor_obj_by_type(topology , HWLOC_OBJ_NODE, core)) ) {
         return node->logical_index;
     }
+#endif  /* HWLOC_API_VERSION >= 0x00020000 */
 #else
     (void)core_id;
 #endif  /* defined(PARSEC_HAVE_HWLOC) */
     return PARSEC_ERR_NOT_IMPLEMENTED;
 }
 
+int parsec_hwloc_nb_numa_nodes(void)
+{
+#if defined(PARSEC_HAVE_HWLOC)
+    int nb;
+    if( first_init ) return 1;  /* no topology yet */
+#if HWLOC_API_VERSION >= 0x00020000
+    nb = hwloc_get_nbobjs_by_type(topology, HWLOC_OBJ_NUMANODE);
+#else
+    nb = hwloc_get_nbobjs_by_type(topology, HWLOC_OBJ_NODE);
+#endif  /* HWLOC_API_VERSION >= 0x00020000 */
+    return (nb < 1) ? 1 : nb;
+#else
+    return 1;
+#endif  /* defined(PARSEC_HAVE_HWLOC) */
+}
+
+int parsec_hwloc_membind_numa(void *addr, size_t len, int numa_id)
+{
+#if defined(PARSEC_HAVE_HWLOC) && (HWLOC_API_VERSION >= 0x00020000)
+    hwloc_obj_t node;
+    if( first_init ) return PARSEC_ERR_NOT_FOUND;
+    node = hwloc_get_obj_by_type(topology, HWLOC_OBJ_NUMANODE, numa_id);
+    if( NULL == node ) return PARSEC_ERR_NOT_FOUND;
+    if( 0 != hwloc_set_area_membind(topology, addr, len, node->nodeset,
+                                    HWLOC_MEMBIND_BIND, HWLOC_MEMBIND_BYNODESET) )
+        return PARSEC_ERROR;
+    return PARSEC_SUCCESS;
+#else
+    (void)addr; (void)len; (void)numa_id;
+    return PARSEC_ERR_NOT_IMPLEMENTED;
+#endif  /* defined(PARSEC_HAVE_HWLOC) && (HWLOC_API_VERSION >= 0x00020000) */
+}
+
 unsigned int parsec_hwloc_nb_cores_per_obj( int level, int index )
 {
 #if defined(PARSEC_HAVE_HWLOC)
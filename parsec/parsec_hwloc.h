@@ -93,6 +93,17 @@ int parsec_hwloc_socket_id(int core_id);
  */
 int parsec_hwloc_numa_id(int core_id);
 
+/**
+ * Return the number of NUMA nodes (at least 1).
+ */
+int parsec_hwloc_nb_numa_nodes(void);
+
+/**
+ * Bind the memory area [addr, addr+len) on the NUMA node of logical
+ * index numa_id. The pages that are already touched may not move.
+ */
+int parsec_hwloc_membind_numa(void *addr, size_t len, int numa_id);
+
 /**
  * Return the depth of the first core hardware ancestor: NUMA node or socket.
  */
@@ -84,6 +84,10 @@ typedef struct parsec_dependencies_s    parsec_dependencies_t;
  * @brief A Virtual Process
  */
 typedef struct parsec_vp_s              parsec_vp_t;
+/**
+ * @brief Memoized bottom levels of the tasks of a taskpool
+ */
+typedef struct parsec_critical_path_s   parsec_critical_path_t;
 
 #include "parsec/mca/termdet/termdet.h"
 
@@ -135,6 +139,7 @@ struct parsec_taskpool_s {
     uint16_t                   devices_index_mask; /**< A bitmask of devices indexes this taskpool has been registered with */
     uint32_t                   nb_task_classes;    /**< Number of task classes in the taskpool */
     int32_t                    priority;           /**< A constant used to bump the priority of tasks related to this taskpool */
+    int32_t                    weight;             /**< Share of the resources given to this taskpool by fair-sharing schedulers */
     volatile int32_t           nb_pending_actions; /**< Internal counter of pending actions tracking all runtime
                                                     *   activities (such as communications, data movement, and
                                                     *   so on). Also, its value is increase by one for all the tasks
@@ -163,6 +168,10 @@ struct parsec_taskpool_s {
                                                      *   Indexed on the same index as task_classes_array */
     data_repo_t**               repo_array; /**< Array of data repositories
                                              *   Indexed on the same index as functions array */
+    parsec_critical_path_t*     critical_path; /**< Memoized bottom levels of the tasks, when the DSL
+                                                *   computes the priorities from the critical path */
+    struct parsec_arena_budget_s* arena_budget; /**< Memory budget of the arena data of the taskpool,
+                                                 *   NULL for unlimited */
 };
 
 PARSEC_DECLSPEC PARSEC_OBJ_CLASS_DECLARATION(parsec_taskpool_t);
@@ -439,6 +448,7 @@ struct parsec_task_class_s {
     parsec_sim_cost_fct_t       *sim_cost_fct;
 #endif
     parsec_time_estimate_fct_t  *time_estimate;
+    parsec_task_deadline_fct_t  *deadline;       /**< Absolute deadline of a task, NULL if the tasks have none */
     parsec_datatype_lookup_t    *get_datatype;
     parsec_hook_t               *prepare_input;
     const __parsec_chore_t      *incarnations;
@@ -465,7 +475,8 @@ struct parsec_data_pair_s {
                                                       * Setup on during data lookup and used during release deps. */
     int                           fulfill;     /* flag used during data lookup to indicated that the input data of the task
                                                 * has already been reshaped.
-                                                * Necessary as data lookup can return ASYNC when reshaping each input flow. */
+                                                * Necessary as data lookup can return ASYNC when reshaping each input flow.
+                                                * 2 when the data is a NEW copy, given back if the task is held back. */
 };
 
 /**
@@ -493,6 +504,44 @@ PARSEC_DECLSPEC extern int parsec_slow_bind_warning;
  */
 PARSEC_DECLSPEC extern int parsec_runtime_keep_highest_priority_task;
 
+/**
+ * Global configuration variables for the work-first mode. When enabled,
+ * the thread completing a task keeps the highest priority task among the
+ * local successors that became ready (and not only the first one), and
+ * executes it next, up to parsec_runtime_work_first_max_depth consecutive
+ * hand-offs (0 for no limit) before going back to the scheduler.
+ */
+PARSEC_DECLSPEC extern int parsec_runtime_work_first;
+PARSEC_DECLSPEC extern int parsec_runtime_work_first_max_depth;
+
+/**
+ * Global configuration variables for the parking of idle compute threads.
+ * After parsec_runtime_park_threshold consecutive unsuccessful selections
+ * (0 to never park), a compute thread sleeps on its virtual process until
+ * tasks are scheduled there, or for at most parsec_runtime_park_timeout
+ * micro-seconds. With parsec_runtime_park_report set, the parking counters
+ * of each compute thread are reported at the end of parsec_context_wait.
+ */
+PARSEC_DECLSPEC extern int parsec_runtime_park_threshold;
+PARSEC_DECLSPEC extern int parsec_runtime_park_timeout;
+PARSEC_DECLSPEC extern int parsec_runtime_park_report;
+
+/**
+ * Global configuration variable controlling how many tasks an execution
+ * stream obtains at once from schedulers that provide a select_batch
+ * function. The tasks are kept in a per execution stream buffer, and
+ * executed before the scheduler is asked again. 1 disables the batched
+ * selection.
+ */
+PARSEC_DECLSPEC extern int parsec_runtime_select_batch;
+
+/**
+ * Global configuration variable bounding the number of tasks visited by
+ * one critical path computation. Taskpools whose DAG cannot be explored
+ * within this bound fall back to the taskpool priority. 0 means no limit.
+ */
+PARSEC_DECLSPEC extern int parsec_runtime_critical_path_max_tasks;
+
 /**
  * Description of the state of the task. It indicates what will be the next
  * next stage in the life-time of a task to be executed.
@@ -705,6 +754,20 @@ parsec_release_local_OUT_dependencies(parsec_execution_stream_t* es,
                                       parsec_data_copy_t* target_dc,
                                       data_repo_entry_t* target_repo_entry);
 
+/**
+ * Priority of a task derived from the critical path of the DAG: the bottom
+ * level of the task, i.e. the largest cumulated cost of a path from the task
+ * to a sink of the taskpool. The cost of a task is its simulation cost, its
+ * time estimate on the CPU (in micro-seconds), or 1. The DAG below the task
+ * is discovered through the iterate_successors of the task classes, and the
+ * bottom levels are memoized in tp->critical_path for the lifetime of the
+ * taskpool.
+ */
+PARSEC_DECLSPEC int parsec_critical_path_priority(parsec_taskpool_t *tp,
+                                                  const parsec_task_class_t *tc,
+                                                  const parsec_assignment_t *locals);
+void parsec_critical_path_free(parsec_critical_path_t *cp);
+
 /* Set internal TLS variable parsec_tls_execution_stream */
 void parsec_set_my_execution_stream(parsec_execution_stream_t *es);
 
@@ -236,7 +236,8 @@ typedef struct mpi_funnelled_handshake_info_s {
     parsec_ce_mem_reg_handle_t source_memory_handle;
     parsec_ce_mem_reg_handle_t remote_memory_handle;
     uintptr_t cb_fn;
-
+    ptrdiff_t rdispl;  /**< Where the data of a put starts in the remote memory */
+    uint64_t size;     /**< Bytes of a put, 0 for the whole memory of the handles */
 } mpi_funnelled_handshake_info_t;
 
 /* This is the callback that is triggered on the sender side for a
@@ -298,6 +299,7 @@ mpi_funnelled_internal_get_am_callback(parsec_comm_engine_t *ce,
     cb->onesided.fct = NULL;
     cb->onesided.lreg = remote_memory_handle;
     cb->onesided.ldispl = 0;
+    cb->onesided.size = 0;
     cb->onesided.remote = src;
     cb->onesided.tag = handshake_info->tag;
 
@@ -356,8 +358,14 @@ mpi_funnelled_internal_put_am_callback(parsec_comm_engine_t *ce,
         cb = &item->cb;
     }
 
-    MPI_Irecv(remote_memory_handle->mem, remote_memory_handle->count, remote_memory_handle->datatype,
-              src, handshake_info->tag, parsec_ce_mpi_comm, request);
+    if( 0 != handshake_info->size ) {
+        /* A part of contiguous memory */
+        MPI_Irecv((char*)remote_memory_handle->mem + handshake_info->rdispl, handshake_info->size, MPI_BYTE,
+                  src, handshake_info->tag, parsec_ce_mpi_comm, request);
+    } else {
+        MPI_Irecv(remote_memory_handle->mem, remote_memory_handle->count, remote_memory_handle->datatype,
+                  src, handshake_info->tag, parsec_ce_mpi_comm, request);
+    }
 
     /* we(the remote side) requested the source to forward us callback data that will be passed
      * to the callback function to notify upper level that the data has reached. We are copying
@@ -892,9 +900,7 @@ mpi_no_thread_put(parsec_comm_engine_t *ce,
                   parsec_ce_onesided_callback_t l_cb, void *l_cb_data,
                   parsec_ce_tag_t r_tag, void *r_cb_data, size_t r_cb_data_size)
 {
-    assert(mpi_funnelled_last_active_req < current_size_of_total_reqs);
-
-    (void)r_cb_data; (void) size;
+    (void)r_cb_data;
 
     mpi_funnelled_callback_t *cb;
 
@@ -912,6 +918,10 @@ mpi_no_thread_put(parsec_comm_engine_t *ce,
                                                                          instead of copying the whole
                                                                          memory_handle */
     handshake_info.cb_fn = (uintptr_t) r_tag;
+    /* A nonzero size moves that many bytes of contiguous memory between the
+     * displacements, otherwise the whole memory described by the handles */
+    handshake_info.rdispl = rdispl;
+    handshake_info.size = size;
 
     /* We pack the static message(handshake_info) and the callback data
      * the other side have sent us, to be forwarded.
@@ -941,9 +951,15 @@ mpi_no_thread_put(parsec_comm_engine_t *ce,
 
     if(post_in_static_array) {
         cb = &array_of_callbacks[mpi_funnelled_last_active_req];
-        MPI_Isend((char *)source_memory_handle->mem + ldispl, source_memory_handle->count,
-                  source_memory_handle->datatype, remote, tag, parsec_ce_mpi_comm,
-                  &array_of_requests[mpi_funnelled_last_active_req]);
+        if( 0 != size ) {
+            MPI_Isend((char *)source_memory_handle->mem + ldispl, size, MPI_BYTE,
+                      remote, tag, parsec_ce_mpi_comm,
+                      &array_of_requests[mpi_funnelled_last_active_req]);
+        } else {
+            MPI_Isend((char *)source_memory_handle->mem + ldispl, source_memory_handle->count,
+                      source_memory_handle->datatype, remote, tag, parsec_ce_mpi_comm,
+                      &array_of_requests[mpi_funnelled_last_active_req]);
+        }
     } else {
         item = (mpi_funnelled_dynamic_req_t *)parsec_thread_mempool_allocate(mpi_funnelled_dynamic_req_mempool->thread_mempools);
         item->post_isend = 1;
@@ -962,7 +978,7 @@ mpi_no_thread_put(parsec_comm_engine_t *ce,
     cb->onesided.ldispl = ldispl;
     cb->onesided.rreg = remote_memory_handle;
     cb->onesided.rdispl = rdispl;
-    cb->onesided.size = source_memory_handle->count;
+    cb->onesided.size = size;
     cb->onesided.remote = remote;
     cb->onesided.tag = tag;
 
@@ -1004,6 +1020,8 @@ mpi_no_thread_get(parsec_comm_engine_t *ce,
     handshake_info.remote_memory_handle = remote_memory_handle->self; /* we store the actual pointer, as we
                                                                          do not pass the while handle */
     handshake_info.cb_fn = r_tag; /* This is what the other side has passed to us to invoke when the GET is done */
+    handshake_info.rdispl = 0;
+    handshake_info.size = 0;
 
     /* Packing the callback data the other side has sent us and sending it back to them */
     int buf_size = sizeof(mpi_funnelled_handshake_info_t) + r_cb_data_size;
@@ -1174,9 +1192,15 @@ mpi_no_thread_push_posted_req(parsec_comm_engine_t *ce)
 
     if(item->post_isend) {
         mpi_funnelled_mem_reg_handle_t *ldata = (mpi_funnelled_mem_reg_handle_t *) item->cb.onesided.lreg;
-        MPI_Isend((char *)ldata->mem + item->cb.onesided.ldispl, ldata->count,
-                  ldata->datatype, item->cb.onesided.remote, item->cb.onesided.tag, parsec_ce_mpi_comm,
-                  &array_of_requests[mpi_funnelled_last_active_req]);
+        if( 0 != item->cb.onesided.size ) {
+            MPI_Isend((char *)ldata->mem + item->cb.onesided.ldispl, item->cb.onesided.size,
+                      MPI_BYTE, item->cb.onesided.remote, item->cb.onesided.tag, parsec_ce_mpi_comm,
+                      &array_of_requests[mpi_funnelled_last_active_req]);
+        } else {
+            MPI_Isend((char *)ldata->mem + item->cb.onesided.ldispl, ldata->count,
+                      ldata->datatype, item->cb.onesided.remote, item->cb.onesided.tag, parsec_ce_mpi_comm,
+                      &array_of_requests[mpi_funnelled_last_active_req]);
+        }
     }
 
     mpi_funnelled_last_active_req++;
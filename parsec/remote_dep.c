@@ -43,6 +43,12 @@ static int parsec_param_comm_coll_bcast = 1;
 static int remote_dep_bcast_chainpipeline_child(int me, int him);
 static int remote_dep_bcast_binomial_child(int me, int him);
 static int (*remote_dep_bcast_child)(int me, int him) = remote_dep_bcast_chainpipeline_child;
+/* comm_coll_hierarchical and comm_coll_node_size: see the corresponding mca_register */
+static int parsec_param_comm_coll_hierarchical = 1;
+static int parsec_param_comm_coll_node_size = 0;
+/* Node of each process when the broadcasts use the two-level topology, NULL otherwise */
+static int *remote_dep_node_of = NULL;
+static int remote_dep_nb_node_groups = 0;
 #else
 #define remote_dep_bcast_child(me, him) remote_dep_bcast_start_child(me, him)
 #endif
@@ -184,6 +190,7 @@ parsec_remote_deps_t* remote_deps_allocate( parsec_lifo_t* lifo )
     remote_deps->pending_ack     = 0;
     remote_deps->incoming_mask   = 0;
     remote_deps->outgoing_mask   = 0;
+    remote_deps->pipelined_mask  = 0;
     PARSEC_DEBUG_VERBOSE(30, parsec_comm_output_stream, "remote_deps_allocate: %p", remote_deps);
     return remote_deps;
 }
@@ -194,6 +201,7 @@ inline void remote_deps_free(parsec_remote_deps_t* deps)
     assert(0 == deps->pending_ack);
     assert(0 == deps->incoming_mask);
     assert(0 == deps->outgoing_mask);
+    assert(0 == deps->pipelined_mask);
     for( k = 0; k < parsec_remote_dep_context.max_dep_count; k++ ) {
         if( 0 == deps->output[k].count_bits ) continue;
         for(a = 0; a < (parsec_remote_dep_context.max_nodes_number + 31)/32; a++)
@@ -280,6 +288,12 @@ int parsec_remote_dep_init(parsec_context_t* context)
         remote_dep_bcast_child = remote_dep_bcast_star_child;
         break;
     }
+    parsec_mca_param_reg_int_name("runtime", "comm_coll_hierarchical", "Broadcast across the nodes first, once to a leader process on each node, "
+                                  "which then broadcasts to the processes of its node. Both levels use the comm_coll_bcast topology (1=true,0=false).",
+                                  false, false, parsec_param_comm_coll_hierarchical, &parsec_param_comm_coll_hierarchical);
+    parsec_mca_param_reg_int_name("runtime", "comm_coll_node_size", "Group the processes by that many consecutive ranks for the two-level broadcasts, "
+                                  "instead of the processes sharing a node (0).",
+                                  false, false, parsec_param_comm_coll_node_size, &parsec_param_comm_coll_node_size);
 #endif
 
     (void)remote_dep_dequeue_init(context);
@@ -301,6 +315,25 @@ int parsec_remote_dep_reconfigure(parsec_context_t* context)
 {
     if(context->nb_nodes > 1)
         context->remote_dep_fw_mask_sizeof = ((context->nb_nodes + 31) / 32) * sizeof(uint32_t);
+#ifdef PARSEC_DIST_COLLECTIVES
+    free(remote_dep_node_of);
+    remote_dep_node_of = NULL;
+    if( parsec_param_comm_coll_hierarchical && (context->nb_nodes > 2) ) {
+        int *node_of = (int*)malloc(context->nb_nodes * sizeof(int)), i;
+        if( parsec_param_comm_coll_node_size > 0 ) {
+            for(i = 0; i < context->nb_nodes; i++)
+                node_of[i] = i / parsec_param_comm_coll_node_size;
+            remote_dep_nb_node_groups = node_of[context->nb_nodes - 1] + 1;
+        } else {
+            remote_dep_nb_node_groups = remote_dep_ce_nodes(context, node_of);
+        }
+        /* With a single node, or a process per node, there is a single level */
+        if( (1 < remote_dep_nb_node_groups) && (remote_dep_nb_node_groups < context->nb_nodes) )
+            remote_dep_node_of = node_of;
+        else
+            free(node_of);
+    }
+#endif  /* PARSEC_DIST_COLLECTIVES */
     return PARSEC_SUCCESS;
 }
 
@@ -308,6 +341,10 @@ int parsec_remote_dep_fini(parsec_context_t* context)
 {
     int rc = remote_dep_dequeue_fini(context);
     remote_deps_allocation_fini();
+#ifdef PARSEC_DIST_COLLECTIVES
+    free(remote_dep_node_of);
+    remote_dep_node_of = NULL;
+#endif  /* PARSEC_DIST_COLLECTIVES */
     return rc;
 }
 
@@ -357,6 +394,22 @@ static int remote_dep_bcast_binomial_child(int me, int him)
     return him == me;
 }
 
+/**
+ * The two-level topology uses the broadcast topology between the leaders
+ * of the nodes, indexed in the order they are met with the root first,
+ * and from each leader to the processes of its node, indexed in the same
+ * order with the leader first. A process that is not a leader has an
+ * index -1 among the leaders, and a leader is not a child of a process of
+ * its node.
+ */
+static int remote_dep_bcast_two_level_child(int my_leader, int my_local,
+                                            int his_leader, int his_local,
+                                            int same_node)
+{
+    if( his_leader >= 0 ) return remote_dep_bcast_child(my_leader, his_leader);
+    return same_node && remote_dep_bcast_child(my_local, his_local);
+}
+
 /**
  * This function is called from the successor iterator in order to rebuilt
  * the information needed to propagate the collective in a meaningful way. In
@@ -447,6 +500,12 @@ int parsec_remote_dep_activate(parsec_execution_stream_t* es,
     int i, my_idx, idx, current_mask, keeper = 0;
     unsigned int array_index, count, bit_index;
     struct remote_dep_output_param_s* output;
+#ifdef PARSEC_DIST_COLLECTIVES
+    /* For the two-level topology: the participants met on each node, and the
+     * indexes among the leaders of the nodes and among the participants of a node */
+    int *node_seen = NULL, nb_leaders = 0, my_node = -1;
+    int my_leader = -1, my_local = -1, his_leader = -1, his_local = -1;
+#endif  /* PARSEC_DIST_COLLECTIVES */
 
     assert(es->virtual_process->parsec_context->nb_nodes > 1);
 
@@ -473,6 +532,12 @@ int parsec_remote_dep_activate(parsec_execution_stream_t* es,
     /* Mark the root of the collective as rank 0 */
     remote_dep_mark_forwarded(es, remote_deps, remote_deps->root);
     assert((propagation_mask & remote_deps->outgoing_mask) == remote_deps->outgoing_mask);
+#ifdef PARSEC_DIST_COLLECTIVES
+    if( (NULL != remote_dep_node_of) && (PARSEC_TASKPOOL_TYPE_PTG == task->taskpool->taskpool_type) ) {
+        node_seen = (int*)malloc(remote_dep_nb_node_groups * sizeof(int));
+        my_node = remote_dep_node_of[es->virtual_process->parsec_context->my_rank];
+    }
+#endif  /* PARSEC_DIST_COLLECTIVES */
 
     for( i = 0; propagation_mask >> i; i++ ) {
         if( !((1U << i) & propagation_mask )) continue;
@@ -481,6 +546,15 @@ int parsec_remote_dep_activate(parsec_execution_stream_t* es,
 
         my_idx = (remote_deps->root == es->virtual_process->parsec_context->my_rank) ? 0 : -1;
         idx = 0;
+#ifdef PARSEC_DIST_COLLECTIVES
+        if( NULL != node_seen ) {
+            /* The root leads its node, the first participant met on another node leads that node */
+            memset(node_seen, 0, remote_dep_nb_node_groups * sizeof(int));
+            node_seen[remote_dep_node_of[remote_deps->root]] = 1;
+            nb_leaders = 1;
+            my_leader = my_local = my_idx;
+        }
+#endif  /* PARSEC_DIST_COLLECTIVES */
         /**
          * Increase the refcount of each local output data once, to ensure the
          * data is protected during the entire execution of the communication,
@@ -514,11 +588,21 @@ int parsec_remote_dep_activate(parsec_execution_stream_t* es,
                     continue;
                 }
                 idx++;
+#ifdef PARSEC_DIST_COLLECTIVES
+                if( NULL != node_seen ) {
+                    his_local = node_seen[remote_dep_node_of[rank]]++;
+                    his_leader = (0 == his_local) ? nb_leaders++ : -1;
+                }
+#endif  /* PARSEC_DIST_COLLECTIVES */
                 if(my_idx == -1) {
                     PARSEC_DEBUG_VERBOSE(20, parsec_comm_output_stream, "[%d:%d] task %s my_idx %d idx %d rank %d -- skip",
                             remote_deps->root, i, tmp, my_idx, idx, rank);
                     if(rank == es->virtual_process->parsec_context->my_rank) {
                         my_idx = idx;
+#ifdef PARSEC_DIST_COLLECTIVES
+                        my_leader = his_leader;
+                        my_local = his_local;
+#endif  /* PARSEC_DIST_COLLECTIVES */
                     }
                     remote_dep_mark_forwarded(es, remote_deps, rank);
                     continue;
@@ -532,7 +616,12 @@ int parsec_remote_dep_activate(parsec_execution_stream_t* es,
                     remote_dep_bcast_child_permits = remote_dep_bcast_star_child(my_idx, idx);
                 } else {
 #ifdef PARSEC_DIST_COLLECTIVES
-                    remote_dep_bcast_child_permits = remote_dep_bcast_child(my_idx, idx);
+                    if( NULL != node_seen )
+                        remote_dep_bcast_child_permits =
+                            remote_dep_bcast_two_level_child(my_leader, my_local, his_leader, his_local,
+                                                             my_node == remote_dep_node_of[rank]);
+                    else
+                        remote_dep_bcast_child_permits = remote_dep_bcast_child(my_idx, idx);
 #else
                     remote_dep_bcast_child_permits = remote_dep_bcast_star_child(my_idx, idx);
 #endif  /* PARSEC_DIST_COLLECTIVES */
@@ -574,6 +663,9 @@ int parsec_remote_dep_activate(parsec_execution_stream_t* es,
             }
         }
     }
+#ifdef PARSEC_DIST_COLLECTIVES
+    free(node_seen);
+#endif  /* PARSEC_DIST_COLLECTIVES */
     remote_dep_complete_and_cleanup(&remote_deps, (keeper ? 1 : 0));
     return 0;
 }
@@ -54,6 +54,7 @@ typedef struct remote_dep_wire_get_s {
     remote_dep_datakey_t       remote_callback_data;
     remote_dep_datakey_t       output_mask;
     uintptr_t                  callback_fn;
+    uint64_t                   fragment;  /**< bytes of the fragments the data can be put in, 0 for a single put */
     parsec_ce_mem_reg_handle_t remote_memory_handle;
 } remote_dep_wire_get_t;
 
@@ -127,6 +128,8 @@ struct remote_dep_output_param_s {
     int32_t                              priority;    /**< the priority of the message */
     uint32_t                             count_bits;  /**< The number of participants */
     uint32_t*                            rank_bits;   /**< The array of bits representing the propagation path */
+    size_t                               received;    /**< Bytes received from the start of the data, while it is
+                                                       forwarded before its reception completes */
 };
 
 struct parsec_remote_deps_s {
@@ -138,6 +141,7 @@ struct parsec_remote_deps_s {
     int32_t                          root;          /**< The root of the control message */
     uint32_t                         incoming_mask; /**< track all incoming actions (receives) */
     uint32_t                         outgoing_mask; /**< track all outgoing actions (send) */
+    uint32_t                         pipelined_mask; /**< the incoming actions whose propagation started with their reception */
     remote_dep_wire_activate_t       msg;           /**< A copy of the message control */
     void                            *eager_msg;     /**< A pointer to the eager buffer if this is an eager msg, otherwise NULL */
     int32_t                          max_priority;
@@ -236,6 +240,27 @@ int remote_dep_dequeue_delayed_dep_release(parsec_remote_deps_t *deps);
 /* Reconfigure the remote_dep part of the communication engine */
 int parsec_remote_dep_reconfigure(parsec_context_t* context);
 
+/* Find the node of each process (collective), returns the number of nodes */
+int remote_dep_ce_nodes(parsec_context_t* context, int* node_of);
+
+/**
+ * Counters of the aggregation of the activation messages (see the
+ * runtime_comm_aggregate MCA parameters), since the communication engine
+ * was initialized. The aggregation ratio is nb_activations / nb_messages.
+ */
+typedef struct parsec_remote_dep_aggregate_stats_s {
+    uint64_t nb_activations;    /**< Activations sent to the other processes */
+    uint64_t nb_messages;       /**< Messages they were packed in */
+    uint64_t nb_bytes;          /**< Total size of these messages */
+    uint64_t nb_flush_full;     /**< Messages sent once comm_aggregate_size was reached */
+    uint64_t nb_flush_timeout;  /**< Messages sent once comm_aggregate_timeout expired */
+    uint64_t nb_flush_idle;     /**< Messages sent because the communication thread was idle */
+} parsec_remote_dep_aggregate_stats_t;
+
+/* Get the counters of the activation messages sent by this process */
+int parsec_remote_dep_get_aggregate_stats(parsec_context_t* context,
+                                          parsec_remote_dep_aggregate_stats_t* stats);
+
 #if defined(PARSEC_DIST_COLLECTIVES)
 /* Propagate an activation order from the current node down the original tree */
 int parsec_remote_dep_propagate(parsec_execution_stream_t* es,
@@ -252,6 +277,7 @@ int parsec_remote_dep_propagate(parsec_execution_stream_t* es,
 #define parsec_remote_dep_activate(ctx, o, r) -1
 #define parsec_remote_dep_new_taskpool(ctx)    0
 #define remote_dep_mpi_initialize_execution_stream(ctx) 0
+#define parsec_remote_dep_get_aggregate_stats(ctx, s) PARSEC_ERR_NOT_SUPPORTED
 #endif /* DISTRIBUTED */
 
 /* check if this data description represents a CTL dependency */
@@ -19,6 +19,8 @@
 #include "parsec/interfaces/dtd/insert_function_internal.h"
 #include "parsec/remote_dep.h"
 #include "parsec/class/dequeue.h"
+#include "parsec/class/fifo.h"
+#include "parsec/parsec_comm_shm.h"
 
 #include "parsec/parsec_binary_profile.h"
 
@@ -47,7 +49,14 @@ static int parsec_param_nb_tasks_extracted = 20;
  * comm_short_limit respectively.
  */
 static size_t parsec_param_short_limit = RDEP_MSG_SHORT_LIMIT;
-static int parsec_param_enable_aggregate = 0;
+static int parsec_param_enable_aggregate = 1;
+static int parsec_param_aggregate_size = 0;
+static int parsec_param_aggregate_timeout = 50;
+/* For the meaning of the fragments and of the pipeline depth refer to the
+ * param register help text for comm_fragment_size and comm_pipeline_depth.
+ */
+static size_t parsec_param_fragment_size = 1024 * 1024;
+static int parsec_param_pipeline_depth = 4;
 
 parsec_mempool_t *parsec_remote_dep_cb_data_mempool = NULL;
 
@@ -60,8 +69,29 @@ typedef struct remote_dep_cb_data_s {
     uint64_t event_id;
 #endif /* PARSEC_PROF_TRACE */
     int k;
+    /* The data of a GET order can be put in fragments, see comm_fragment_size */
+    int peer;                   /* put: the receiver */
+    int inflight;               /* put: fragments posted and not completed yet */
+    int waiting;                /* put: chained in dep_put_pipelined */
+    size_t length;              /* bytes of the data */
+    size_t fragment;            /* bytes of a fragment, 0 if the data is put at once */
+    size_t done;                /* put: bytes posted, get: bytes received */
+    uint8_t *arrived;           /* get: the fragments received, when the data is forwarded as it arrives */
+    uintptr_t callback_fn;      /* put: the callback of the receiver */
+    remote_dep_datakey_t remote_callback_data;  /* put: and its data */
+    parsec_ce_mem_reg_handle_t remote_memory_handle;  /* put: the memory handle of the receiver */
 } remote_dep_cb_data_t;
 
+/* Given back to the receiver of a GET order with each put: its callback data,
+ * and the part of the data the put carried (all of it if length is 0).
+ */
+typedef struct remote_dep_put_notice_s {
+    remote_dep_datakey_t remote_callback_data;
+    uint64_t             offset;
+    uint64_t             length;
+    uint64_t             total;
+} remote_dep_put_notice_t;
+
 PARSEC_DECLSPEC PARSEC_OBJ_CLASS_DECLARATION(remote_dep_cb_data_t);
 
 PARSEC_OBJ_CLASS_INSTANCE(remote_dep_cb_data_t, parsec_list_item_t,
@@ -96,11 +126,15 @@ remote_dep_cmd_to_string(remote_dep_wire_activate_t* origin,
 #define datakey_count 3
 
 static pthread_t dep_thread_id;
-parsec_dequeue_t dep_cmd_queue;
+parsec_fifo_t    dep_cmd_queue;            /* lock-free, filled by all threads */
 parsec_list_t    dep_cmd_fifo;             /* ordered non threaded fifo */
+static dep_cmd_item_t *dep_cmd_barrier = NULL;  /* DEP_CTL waiting for dep_cmd_fifo to drain */
 parsec_list_t    dep_activates_fifo;       /* ordered non threaded fifo */
 parsec_list_t    dep_activates_noobj_fifo; /* non threaded fifo of dep activates related to taskpools not actually known */
 parsec_list_t    dep_put_fifo;             /* ordered non threaded fifo */
+parsec_list_t    dep_deferred_gets_fifo;   /* non threaded fifo of GETs held back until some arena memory is released */
+static parsec_list_t dep_put_pipelined;    /* non threaded fifo of the puts waiting for the fragments of a forwarded data */
+static volatile int32_t dep_deferred_gets_resumable = 0;  /* number of held back GETs to retry */
 
 /* help manage the messages in the same category, where a category is either messages
  * to the same destination, or with the same action key.
@@ -108,6 +142,25 @@ parsec_list_t    dep_put_fifo;             /* ordered non threaded fifo */
 static dep_cmd_item_t** parsec_mpi_same_pos_items;
 static int parsec_mpi_same_pos_items_size = 0;
 
+/* Activations packed for a peer and not sent yet, see comm_aggregate */
+typedef struct remote_dep_aggregate_s {
+    parsec_list_item_t  super;     /**< Chained in dep_aggregates_pending while not empty */
+    parsec_list_item_t *ring;      /**< Commands packed in the buffer, released once it is sent */
+    char               *buffer;    /**< DEP_SHORT_BUFFER_SIZE bytes, allocated on first use */
+    uint64_t            start;     /**< Date (in ns) the first activation was packed */
+    int                 peer;
+    int                 position;  /**< Bytes packed in the buffer */
+    int                 nb_deps;   /**< Activations packed in the buffer */
+} remote_dep_aggregate_t;
+
+static remote_dep_aggregate_t* dep_aggregates = NULL;  /* one per peer */
+static int dep_aggregates_size = 0;
+static parsec_list_t dep_aggregates_pending;  /* non threaded fifo of the non empty aggregates, oldest first */
+/* Counters of parsec_remote_dep_aggregate_stats_t, the activations are sent by the
+ * computation threads with a multithreaded MPI */
+static volatile int64_t dep_aggregate_stats[6];
+enum { AGG_ACTIVATIONS, AGG_MESSAGES, AGG_BYTES, AGG_FLUSH_FULL, AGG_FLUSH_TIMEOUT, AGG_FLUSH_IDLE };
+
 static int mpi_initialized = 0;
 #if defined(PARSEC_REMOTE_DEP_USE_THREADS)
 static pthread_mutex_t mpi_thread_mutex;
@@ -142,6 +195,27 @@ parsec_execution_stream_t parsec_comm_es = {
 static void remote_dep_mpi_put_start(parsec_execution_stream_t* es, dep_cmd_item_t* item);
 static void remote_dep_mpi_get_start(parsec_execution_stream_t* es, parsec_remote_deps_t* deps);
 
+/* The peers on the same node are reached through the shared memory engine */
+static inline parsec_comm_engine_t* remote_dep_ce(int peer)
+{
+    return shm_ce_reaches(peer) ? &parsec_ce_shm : &parsec_ce;
+}
+
+/* Returns the bytes of count elements of dtt when they are contiguous in
+ * memory, and 0 otherwise */
+static size_t remote_dep_mpi_contiguous_size(MPI_Datatype dtt, uint64_t count)
+{
+    MPI_Aint lb, extent, true_lb, true_extent;
+    int size;
+
+    MPI_Type_size(dtt, &size);
+    MPI_Type_get_extent(dtt, &lb, &extent);
+    MPI_Type_get_true_extent(dtt, &true_lb, &true_extent);
+    if( (0 != true_lb) || (size != extent) || (size != true_extent) )
+        return 0;
+    return (size_t)size * count;
+}
+
 static void remote_dep_mpi_get_end(parsec_execution_stream_t* es,
                                    int idx,
                                    parsec_remote_deps_t* deps);
@@ -164,6 +238,9 @@ remote_dep_mpi_put_end_cb(parsec_comm_engine_t *ce,
                        int remote,
                        void *cb_data);
 
+static void remote_dep_mpi_put_continue(parsec_comm_engine_t* ce, remote_dep_cb_data_t* put);
+static void remote_dep_mpi_put_resume(parsec_remote_deps_t* deps, int k);
+
 static parsec_remote_deps_t*
 remote_dep_release_incoming(parsec_execution_stream_t* es,
                             parsec_remote_deps_t* origin,
@@ -177,6 +254,8 @@ static int local_dep_nothread_reshape(parsec_execution_stream_t* es,
                                       dep_cmd_item_t *item);
 
 static int remote_dep_mpi_progress(parsec_execution_stream_t* es);
+static int remote_dep_aggregate_flush_pending(parsec_execution_stream_t* es, int idle);
+static void remote_dep_aggregate_release(void);
 
 static void remote_dep_mpi_new_taskpool(parsec_execution_stream_t* es,
                                         dep_cmd_item_t *dep_cmd_item);
@@ -207,8 +286,25 @@ static void remote_dep_mpi_params(parsec_context_t* context) {
         parsec_param_short_limit = RDEP_MSG_SHORT_LIMIT;
     }
 #endif
-    parsec_mca_param_reg_int_name("runtime", "comm_aggregate", "Aggregate multiple dependencies in the same short message (1=true,0=false).",
+    parsec_mca_param_reg_int_name("runtime", "comm_aggregate", "Aggregate multiple dependencies in the same short message (1=true,0=false). "
+                                  "The activations for a peer are packed in a buffer, sent once it is full, once the oldest activation "
+                                  "waited comm_aggregate_timeout, or when the communication thread is idle.",
                                   false, false, parsec_param_enable_aggregate, &parsec_param_enable_aggregate);
+    parsec_mca_param_reg_int_name("runtime", "comm_aggregate_size", "Send the activations aggregated for a peer once they use that many "
+                                  "bytes (0 or more than the short message buffer: when the next activation does not fit).",
+                                  false, false, parsec_param_aggregate_size, &parsec_param_aggregate_size);
+    if( (parsec_param_aggregate_size <= 0) || (parsec_param_aggregate_size > (int)DEP_SHORT_BUFFER_SIZE) )
+        parsec_param_aggregate_size = DEP_SHORT_BUFFER_SIZE;
+    parsec_mca_param_reg_int_name("runtime", "comm_aggregate_timeout", "Maximum time (in micro-seconds) an activation waits for others to the "
+                                  "same peer while the communication thread is busy.",
+                                  false, false, parsec_param_aggregate_timeout, &parsec_param_aggregate_timeout);
+    parsec_mca_param_reg_sizet_name("runtime", "comm_fragment_size", "Put the contiguous data larger than that many bytes in fragments of that size, "
+                                    "and forward the fragments of a collective to the next peers as they arrive (0 to put each data at once).",
+                                    false, false, parsec_param_fragment_size, &parsec_param_fragment_size);
+    parsec_mca_param_reg_int_name("runtime", "comm_pipeline_depth", "Maximum number of fragments of a data in flight to a peer.",
+                                  false, false, parsec_param_pipeline_depth, &parsec_param_pipeline_depth);
+    if( parsec_param_pipeline_depth < 1 )
+        parsec_param_pipeline_depth = 1;
 }
 
 int
@@ -267,7 +363,7 @@ remote_dep_dequeue_init(parsec_context_t* context)
         }
     }
 
-    PARSEC_OBJ_CONSTRUCT(&dep_cmd_queue, parsec_dequeue_t);
+    PARSEC_OBJ_CONSTRUCT(&dep_cmd_queue, parsec_fifo_t);
     PARSEC_OBJ_CONSTRUCT(&dep_cmd_fifo, parsec_list_t);
 
     /* Build the condition used to drive the MPI thread */
@@ -328,7 +424,7 @@ remote_dep_dequeue_fini(parsec_context_t* context)
         item->action = DEP_CTL;
         item->cmd.ctl.enable = -1;  /* turn off and return from the MPI thread */
         item->priority = 0;
-        parsec_dequeue_push_back(&dep_cmd_queue, (parsec_list_item_t*) item);
+        parsec_fifo_push(&dep_cmd_queue, (parsec_list_item_t*) item);
 
         /* I am supposed to own the lock. Wake the MPI thread */
         pthread_cond_signal(&mpi_thread_condition);
@@ -337,7 +433,7 @@ remote_dep_dequeue_fini(parsec_context_t* context)
         assert((parsec_context_t*)ret == context);
     }
 
-    assert(NULL == parsec_dequeue_pop_front(&dep_cmd_queue));
+    assert(NULL == dep_cmd_barrier && NULL == parsec_fifo_pop(&dep_cmd_queue));
     PARSEC_OBJ_DESTRUCT(&dep_cmd_queue);
     assert(NULL == parsec_dequeue_pop_front(&dep_cmd_fifo));
     PARSEC_OBJ_DESTRUCT(&dep_cmd_fifo);
@@ -401,7 +497,7 @@ remote_dep_dequeue_off(parsec_context_t* context)
     while( 3 != parsec_communication_engine_up ) sched_yield();
     PARSEC_DEBUG_VERBOSE(20, parsec_comm_output_stream, "MPI: comm engine signalled OFF on process %d/%d",
                          context->my_rank, context->nb_nodes);
-    parsec_dequeue_push_back(&dep_cmd_queue, (parsec_list_item_t*) item);
+    parsec_fifo_push(&dep_cmd_queue, (parsec_list_item_t*) item);
 
     /* wait until we own the PaRSEC MPI synchronization mutex */
     pthread_mutex_lock(&mpi_thread_mutex);
@@ -456,6 +552,7 @@ void* remote_dep_dequeue_main(parsec_context_t* context)
         assert( parsec_communication_engine_up == 2 );
 
         parsec_ce.enable(&parsec_ce);
+        parsec_ce_shm.enable(&parsec_ce_shm);
         remote_dep_ce_reconfigure(context);
         parsec_remote_dep_reconfigure(context);
 
@@ -492,7 +589,7 @@ int remote_dep_dequeue_new_taskpool(parsec_taskpool_t* tp)
     item->action = DEP_NEW_TASKPOOL;
     item->priority = 0;
     item->cmd.new_taskpool.tp = tp;
-    parsec_dequeue_push_back(&dep_cmd_queue, (parsec_list_item_t*)item);
+    parsec_fifo_push(&dep_cmd_queue, (parsec_list_item_t*)item);
     return 1;
 }
 
@@ -505,7 +602,7 @@ remote_dep_dequeue_delayed_dep_release(parsec_remote_deps_t *deps)
     item->action = DEP_DTD_DELAYED_RELEASE;
     item->priority = 0;
     item->cmd.release.deps = deps;
-    parsec_dequeue_push_back(&dep_cmd_queue, (parsec_list_item_t*)item);
+    parsec_fifo_push(&dep_cmd_queue, (parsec_list_item_t*)item);
     return 1;
 }
 
@@ -530,7 +627,7 @@ remote_dep_dequeue_send(parsec_execution_stream_t* es, int rank,
         remote_dep_nothread_send(es, &item);
     }
     else {
-        parsec_dequeue_push_back(&dep_cmd_queue, (parsec_list_item_t*)item);
+        parsec_fifo_push(&dep_cmd_queue, (parsec_list_item_t*)item);
     }
     return 1;
 }
@@ -568,7 +665,7 @@ void parsec_remote_dep_memcpy(parsec_execution_stream_t* es,
     PARSEC_OBJ_RETAIN(src);
     remote_dep_inc_flying_messages(tp);
 
-    parsec_dequeue_push_back(&dep_cmd_queue, (parsec_list_item_t*) item);
+    parsec_fifo_push(&dep_cmd_queue, (parsec_list_item_t*) item);
 }
 
 static inline parsec_data_copy_t*
@@ -580,6 +677,10 @@ remote_dep_copy_allocate(parsec_dep_type_description_t* data)
         return NULL;
     }
     dc = parsec_arena_get_copy(data->arena, data->dst_count, 0, data->dst_datatype);
+    if( NULL == dc ) {
+        parsec_fatal("MPI:	Cannot allocate %"PRIu64" elements of %zu bytes from arena %p",
+                     (uint64_t)data->dst_count, data->arena->elem_size, data->arena);
+    }
 
     dc->coherency_state = PARSEC_DATA_COHERENCY_EXCLUSIVE;
     PARSEC_DEBUG_VERBOSE(20, parsec_comm_output_stream, "MPI:\tMalloc new remote tile %p size %" PRIu64 " count = %" PRIu64 " displ = %" PRIi64 " %p",
@@ -587,6 +688,79 @@ remote_dep_copy_allocate(parsec_dep_type_description_t* data)
     return dc;
 }
 
+/* Lets the communication thread retry a held back GET once memory is released */
+static void remote_dep_mpi_resume_gets(void *cb_data)
+{
+    (void)cb_data;
+    parsec_atomic_fetch_inc_int32(&dep_deferred_gets_resumable);
+}
+
+/**
+ * Allocates the local copies that receive the incoming data of deps,
+ * charging them to the arena budget of the taskpool. If one does not fit,
+ * the copies allocated so far are released and the GET is held back until
+ * some memory is released.
+ *
+ * @return 1 if all the copies are allocated, 0 if the GET is held back.
+ */
+static int
+remote_dep_mpi_get_allocate(parsec_remote_deps_t* deps)
+{
+    parsec_arena_budget_t *budget = deps->taskpool->arena_budget;
+    parsec_dep_type_description_t* type;
+    uint32_t allocated;
+    size_t given_back;
+    int k, j, rc;
+
+    do {
+        allocated = 0;
+        for(k = 0; deps->incoming_mask >> k; k++) {
+            if( !((1U<<k) & deps->incoming_mask) ) continue;
+            if( NULL != deps->output[k].data.data ) continue;
+            type = &deps->output[k].data.remote;
+            if( NULL == type->arena ) {
+                assert(0 == type->dst_count);
+                continue;
+            }
+            deps->output[k].data.data = parsec_arena_get_copy_budget(type->arena, type->dst_count, 0,
+                                                                     type->dst_datatype, budget);
+            if( NULL == deps->output[k].data.data ) break;
+            deps->output[k].data.data->coherency_state = PARSEC_DATA_COHERENCY_EXCLUSIVE;
+            allocated |= (1U<<k);
+        }
+        if( 0 == (deps->incoming_mask >> k) )
+            return 1;
+        /* Do not hold memory while waiting for more */
+        given_back = 0;
+        for(j = 0; j < k; j++) {
+            if( (1U<<j) & allocated ) {
+                given_back += parsec_arena_copy_bytes(deps->output[j].data.data);
+                PARSEC_DATA_COPY_RELEASE(deps->output[j].data.data);
+                deps->output[j].data.data = NULL;
+            }
+        }
+        rc = parsec_arena_wait(type->arena, type->dst_count, given_back, budget,
+                               remote_dep_mpi_resume_gets, NULL);
+        if( PARSEC_ERR_VALUE_OUT_OF_BOUNDS == rc ) {
+            parsec_fatal("MPI:	Incoming data of %"PRIu64" elements of %zu bytes (and %zu bytes for its other flows) "
+                         "can never fit in arena %p and the arena budget",
+                         (uint64_t)type->dst_count, type->arena->elem_size, given_back, type->arena);
+        }
+    } while( (PARSEC_ERR_EXISTS == rc) && (0 == given_back) );
+
+    if( PARSEC_ERR_EXISTS == rc ) {
+        /* What was given back fits again, but retrying now could fail the
+         * same way forever: retry once the transfers in flight progressed */
+        parsec_atomic_fetch_inc_int32(&dep_deferred_gets_resumable);
+    }
+    PARSEC_DEBUG_VERBOSE(10, parsec_comm_output_stream, "MPI:	FROM	%d	Get HELD BACK	k=%d	with datakey %lx until some memory is released",
+                         deps->from, k, deps->msg.deps);
+    if( NULL != budget )
+        parsec_atomic_fetch_inc_int64(&budget->nb_deferred_gets);
+    parsec_list_nolock_push_back(&dep_deferred_gets_fifo, (parsec_list_item_t*)deps);
+    return 0;
+}
+
 /**
  *
  * Allocate a new datacopy for a reshape.
@@ -706,7 +880,7 @@ void parsec_local_reshape_cb(parsec_base_future_t *future, ... )
     item->cmd.memcpy_reshape.task = task;
 
     remote_dep_inc_flying_messages(tp);
-    parsec_dequeue_push_back(&dep_cmd_queue, (parsec_list_item_t*) item);
+    parsec_fifo_push(&dep_cmd_queue, (parsec_list_item_t*) item);
 }
 
 #define is_inplace(ctx,dep) NULL
@@ -993,7 +1167,8 @@ remote_dep_release_incoming(parsec_execution_stream_t* es,
 
 #ifdef PARSEC_DIST_COLLECTIVES
     /* Corresponding comment below on the propagation part */
-    if(0 == origin->incoming_mask && PARSEC_TASKPOOL_TYPE_PTG == origin->taskpool->taskpool_type) {
+    if(0 == origin->incoming_mask && 0 == origin->pipelined_mask &&
+       PARSEC_TASKPOOL_TYPE_PTG == origin->taskpool->taskpool_type) {
         remote_dep_inc_flying_messages(task.taskpool);
         (void)parsec_atomic_fetch_inc_int32(&origin->pending_ack);
     }
@@ -1032,13 +1207,20 @@ remote_dep_release_incoming(parsec_execution_stream_t* es,
      * lines above). Once the propagation is started we can release the
      * references on the allocated data and on the dependency.
      */
-    uint32_t mask = origin->outgoing_mask;
-    origin->outgoing_mask = 0;
+    uint32_t mask;
+    if( 0 != origin->pipelined_mask ) {
+        /* The propagation started with the reception (remote_dep_mpi_pipeline_start) */
+        mask = origin->pipelined_mask;
+        origin->pipelined_mask = 0;
+    } else {
+        mask = origin->outgoing_mask;
+        origin->outgoing_mask = 0;
 
 #if defined(PARSEC_DIST_COLLECTIVES)
-    if( PARSEC_TASKPOOL_TYPE_PTG == origin->taskpool->taskpool_type ) /* indicates it is a PTG taskpool */
-        parsec_remote_dep_propagate(es, &task, origin);
+        if( PARSEC_TASKPOOL_TYPE_PTG == origin->taskpool->taskpool_type ) /* indicates it is a PTG taskpool */
+            parsec_remote_dep_propagate(es, &task, origin);
 #endif  /* PARSEC_DIST_COLLECTIVES */
+    }
     /**
      * Release the dependency owned by the communication engine for all data
      * internally allocated by the engine.
@@ -1076,16 +1258,20 @@ remote_dep_dequeue_nothread_progress(parsec_execution_stream_t* es,
  check_pending_queues:
     if( cycles >= 0 )
         if( 0 == cycles--) return executed_tasks;  /* report how many events were progressed */
+    if( !parsec_list_nolock_is_empty(&dep_aggregates_pending) )
+        remote_dep_aggregate_flush_pending(es, 0);
 
     /* Move a number of transfers from the shared dequeue into our ordered lifo. */
     how_many = 0;
-    while( NULL != (item = (dep_cmd_item_t*) parsec_dequeue_try_pop_front(&dep_cmd_queue)) ) {
+    while( NULL != (item = (NULL != dep_cmd_barrier) ? dep_cmd_barrier
+                                                     : (dep_cmd_item_t*) parsec_fifo_try_pop(&dep_cmd_queue)) ) {
+        dep_cmd_barrier = NULL;
         if( DEP_CTL == item->action ) {
             /* A DEP_CTL is a barrier that must not be crossed, flush the
              * ordered fifo and don't add anything until it is consumed */
             if( parsec_list_nolock_is_empty(&dep_cmd_fifo) && parsec_list_nolock_is_empty(&temp_list) )
                 goto handle_now;
-            parsec_dequeue_push_front(&dep_cmd_queue, (parsec_list_item_t*)item);
+            dep_cmd_barrier = item;
             break;
         }
         how_many++;
@@ -1133,6 +1319,8 @@ remote_dep_dequeue_nothread_progress(parsec_execution_stream_t* es,
         /* only progress MPI if necessary */
         if (context->nb_nodes > 1) {
             ret = remote_dep_mpi_progress(es);
+            if( 0 == ret )  /* nothing else to do, send the aggregated activations */
+                ret = remote_dep_aggregate_flush_pending(es, 1);
             if( 0 == ret
                 && ((comm_yield == 2)
                     || (comm_yield == 1  /* communication list is full, we need to forcefully drain the network */
@@ -1151,6 +1339,7 @@ remote_dep_dequeue_nothread_progress(parsec_execution_stream_t* es,
     position = (DEP_ACTIVATE == item->action) ? item->cmd.activate.peer : (context->nb_nodes + item->action);
     switch(item->action) {
     case DEP_CTL:
+        remote_dep_aggregate_flush_pending(es, 1);
         ret = item->cmd.ctl.enable;
         PARSEC_OBJ_DESTRUCT(&temp_list);
         PARSEC_DEBUG_VERBOSE(10, parsec_comm_output_stream, "rank %d DISABLE MPI communication engine", parsec_debug_rank);
@@ -1455,52 +1644,30 @@ static int local_dep_nothread_reshape(parsec_execution_stream_t* es,
 }
 
 /**
- * Starting with a particular item pack as many remote_dep_wire_activate
- * messages with the same destination (from the item ring associated with
- * pos_list) into a buffer. Upon completion the entire buffer is send to the
- * remote peer, the completed messages are released and the header is updated to
- * the next unsent message.
+ * Send the buffer of packed remote_dep_wire_activate messages to the remote
+ * peer, and release the commands (from the ring chained by their list item)
+ * whose activations were packed in it.
  */
-static int remote_dep_nothread_send(parsec_execution_stream_t* es,
-                                    dep_cmd_item_t **head_item)
+static void remote_dep_nothread_send_packed(parsec_execution_stream_t* es,
+                                            int peer,
+                                            char* packed_buffer,
+                                            int position,
+                                            parsec_list_item_t* ring)
 {
-    (void)es;
     parsec_remote_deps_t *deps;
-    dep_cmd_item_t *item = *head_item;
-    parsec_list_item_t* ring = NULL;
-    char packed_buffer[DEP_SHORT_BUFFER_SIZE];
-    int peer, position = 0;
-
-    peer = item->cmd.activate.peer;  /* this doesn't change */
-
-  pack_more:
-    assert(peer == item->cmd.activate.peer);
-    deps = (parsec_remote_deps_t*)item->cmd.activate.task.source_deps;
-
-    parsec_list_item_singleton((parsec_list_item_t*)item);
-    if( 0 == remote_dep_mpi_pack_dep(peer, item, packed_buffer,
-                                     DEP_SHORT_BUFFER_SIZE, &position) ) {
-        /* space left on the buffer. Move to the next item with the same destination */
-        dep_cmd_item_t* next = (dep_cmd_item_t*)parsec_list_item_ring_chop(&item->pos_list);
-        if( NULL == ring ) ring = (parsec_list_item_t*)item;
-        else parsec_list_item_ring_push(ring, (parsec_list_item_t*)item);
-        if( NULL != next ) {
-            item = container_of(next, dep_cmd_item_t, pos_list);
-            assert(DEP_ACTIVATE == item->action);
-            if( parsec_param_enable_aggregate )
-                goto pack_more;
-        } else item = NULL;
-    }
-    *head_item = item;
-    assert(NULL != ring);
+    dep_cmd_item_t *item;
+    (void)es;
 
+    deps = (parsec_remote_deps_t*)((dep_cmd_item_t*)ring)->cmd.activate.task.source_deps;
     /* dep index is meaningless in this context, set to -1 */
     TAKE_TIME_WITH_INFO(es->es_profile, MPI_Activate_sk, 0, -1,
                         es->virtual_process->parsec_context->my_rank, peer,
                         deps->msg, position, PARSEC_DATATYPE_PACKED);
-    parsec_ce.send_am(&parsec_ce, PARSEC_CE_REMOTE_DEP_ACTIVATE_TAG, peer, packed_buffer, position);
+    remote_dep_ce(peer)->send_am(remote_dep_ce(peer), PARSEC_CE_REMOTE_DEP_ACTIVATE_TAG, peer, packed_buffer, position);
     TAKE_TIME(es->es_profile, MPI_Activate_ek, 0);
     DEBUG_MARK_CTL_MSG_ACTIVATE_SENT(peer, (void*)&deps->msg, &deps->msg);
+    parsec_atomic_fetch_inc_int64(&dep_aggregate_stats[AGG_MESSAGES]);
+    parsec_atomic_fetch_add_int64(&dep_aggregate_stats[AGG_BYTES], position);
 
     do {
         item = (dep_cmd_item_t*)ring;
@@ -1511,9 +1678,148 @@ static int remote_dep_nothread_send(parsec_execution_stream_t* es,
 
         remote_dep_complete_and_cleanup(&deps, 1);
     } while( NULL != ring );
+}
+
+static inline uint64_t remote_dep_aggregate_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * Send the activations aggregated for a peer, and account for the reason
+ * in the counter provided by the caller.
+ */
+static void remote_dep_aggregate_flush(parsec_execution_stream_t* es,
+                                       remote_dep_aggregate_t* agg,
+                                       int reason)
+{
+    assert(0 != agg->nb_deps);
+    parsec_list_nolock_remove(&dep_aggregates_pending, &agg->super);
+    parsec_atomic_fetch_inc_int64(&dep_aggregate_stats[reason]);
+    remote_dep_nothread_send_packed(es, agg->peer, agg->buffer, agg->position, agg->ring);
+    agg->ring     = NULL;
+    agg->position = 0;
+    agg->nb_deps  = 0;
+}
+
+/**
+ * Send the aggregated activations that waited more than comm_aggregate_timeout
+ * or, when the communication thread is idle, all of them.
+ *
+ * @returns the number of messages sent.
+ */
+static int remote_dep_aggregate_flush_pending(parsec_execution_stream_t* es, int idle)
+{
+    remote_dep_aggregate_t* agg;
+    uint64_t now = 0;
+    int nb = 0;
+
+    while( !parsec_list_nolock_is_empty(&dep_aggregates_pending) ) {
+        agg = (remote_dep_aggregate_t*)PARSEC_LIST_ITERATOR_FIRST(&dep_aggregates_pending);
+        if( !idle ) {
+            if( 0 == now ) now = remote_dep_aggregate_now();
+            /* the aggregates are ordered by age, the others are younger */
+            if( (now - agg->start) < (uint64_t)parsec_param_aggregate_timeout * 1000 ) break;
+        }
+        remote_dep_aggregate_flush(es, agg, idle ? AGG_FLUSH_IDLE : AGG_FLUSH_TIMEOUT);
+        nb++;
+    }
+    return nb;
+}
+
+/* Release the aggregation buffers, once all of them have been sent */
+static void remote_dep_aggregate_release(void)
+{
+    if( NULL == dep_aggregates ) return;
+    assert(parsec_list_nolock_is_empty(&dep_aggregates_pending));
+    for(int i = 0; i < dep_aggregates_size; i++) {
+        free(dep_aggregates[i].buffer);
+        PARSEC_OBJ_DESTRUCT(&dep_aggregates[i].super);
+    }
+    free(dep_aggregates); dep_aggregates = NULL;
+    dep_aggregates_size = 0;
+}
+
+/**
+ * Starting with a particular item pack as many remote_dep_wire_activate
+ * messages with the same destination (from the item ring associated with
+ * pos_list) into a buffer. Without aggregation the buffer holds a single
+ * activation and is sent right away, and the header is updated to the next
+ * unsent message. With aggregation all the messages are packed in the
+ * buffer of the peer, which is sent each time it reaches
+ * comm_aggregate_size; what is left is sent later, on timeout or once
+ * the communication thread is idle. The computation threads that send
+ * their activations themselves (multithreaded MPI) do not aggregate them.
+ */
+static int remote_dep_nothread_send(parsec_execution_stream_t* es,
+                                    dep_cmd_item_t **head_item)
+{
+    dep_cmd_item_t *item = *head_item, *next;
+    remote_dep_aggregate_t *agg;
+    char packed_buffer[DEP_SHORT_BUFFER_SIZE];
+    int peer, position = 0;
+
+    peer = item->cmd.activate.peer;  /* this doesn't change */
+
+    if( !parsec_param_enable_aggregate || (es != &parsec_comm_es) ) {
+        parsec_list_item_singleton((parsec_list_item_t*)item);
+        remote_dep_mpi_pack_dep(peer, item, packed_buffer,
+                                DEP_SHORT_BUFFER_SIZE, &position);
+        next = (dep_cmd_item_t*)parsec_list_item_ring_chop(&item->pos_list);
+        *head_item = (NULL != next) ? container_of(next, dep_cmd_item_t, pos_list) : NULL;
+        parsec_atomic_fetch_inc_int64(&dep_aggregate_stats[AGG_ACTIVATIONS]);
+        remote_dep_nothread_send_packed(es, peer, packed_buffer, position, (parsec_list_item_t*)item);
+        return 0;
+    }
+
+    agg = &dep_aggregates[peer];
+    if( NULL == agg->buffer )
+        agg->buffer = (char*)malloc(DEP_SHORT_BUFFER_SIZE);
+  pack_more:
+    assert(peer == item->cmd.activate.peer);
+    parsec_list_item_singleton((parsec_list_item_t*)item);
+    if( 0 != remote_dep_mpi_pack_dep(peer, item, agg->buffer,
+                                     DEP_SHORT_BUFFER_SIZE, &agg->position) ) {
+        /* no room left, send what is already packed and start again from an empty buffer */
+        remote_dep_aggregate_flush(es, agg, AGG_FLUSH_FULL);
+        goto pack_more;
+    }
+    parsec_atomic_fetch_inc_int64(&dep_aggregate_stats[AGG_ACTIVATIONS]);
+    if( 0 == agg->nb_deps++ ) {
+        agg->ring  = (parsec_list_item_t*)item;
+        agg->start = remote_dep_aggregate_now();
+        parsec_list_nolock_push_back(&dep_aggregates_pending, &agg->super);
+    } else {
+        parsec_list_item_ring_push(agg->ring, (parsec_list_item_t*)item);
+    }
+    /* Move to the next item with the same destination */
+    next = (dep_cmd_item_t*)parsec_list_item_ring_chop(&item->pos_list);
+    if( agg->position >= parsec_param_aggregate_size )
+        remote_dep_aggregate_flush(es, agg, AGG_FLUSH_FULL);
+    if( NULL != next ) {
+        item = container_of(next, dep_cmd_item_t, pos_list);
+        assert(DEP_ACTIVATE == item->action);
+        goto pack_more;
+    }
+    *head_item = NULL;
     return 0;
 }
 
+int parsec_remote_dep_get_aggregate_stats(parsec_context_t* context,
+                                          parsec_remote_dep_aggregate_stats_t* stats)
+{
+    (void)context;
+    stats->nb_activations   = dep_aggregate_stats[AGG_ACTIVATIONS];
+    stats->nb_messages      = dep_aggregate_stats[AGG_MESSAGES];
+    stats->nb_bytes         = dep_aggregate_stats[AGG_BYTES];
+    stats->nb_flush_full    = dep_aggregate_stats[AGG_FLUSH_FULL];
+    stats->nb_flush_timeout = dep_aggregate_stats[AGG_FLUSH_TIMEOUT];
+    stats->nb_flush_idle    = dep_aggregate_stats[AGG_FLUSH_IDLE];
+    return PARSEC_SUCCESS;
+}
+
 /**
  * Progress the network pushing as many of the pending commands as possible.
  * First, extract actions from the cmd queue, and rearrange them (priority and
@@ -1527,7 +1833,18 @@ static int remote_dep_mpi_progress(parsec_execution_stream_t* es)
     if( !PARSEC_THREAD_IS_MASTER(es) ) return 0;
 
     ret = parsec_ce.progress(&parsec_ce);
-
+    ret += parsec_ce_shm.progress(&parsec_ce_shm);
+
+    if( 0 != dep_deferred_gets_resumable ) {
+        /* Some memory was released, retry as many GETs held back as there
+         * were waiters resumed (each held back GET has one waiter) */
+        parsec_remote_deps_t* deps;
+        int32_t nb = dep_deferred_gets_resumable;
+        parsec_atomic_fetch_add_int32(&dep_deferred_gets_resumable, -nb);
+        while( (nb-- > 0) &&
+               (NULL != (deps = (parsec_remote_deps_t*)parsec_list_nolock_pop_front(&dep_deferred_gets_fifo))) )
+            parsec_list_nolock_push_sorted(&dep_activates_fifo, (parsec_list_item_t*)deps, rdep_prio);
+    }
     if(parsec_ce.can_serve(&parsec_ce) && !parsec_list_nolock_is_empty(&dep_activates_fifo)) {
             parsec_remote_deps_t* deps = (parsec_remote_deps_t*)parsec_list_nolock_pop_front(&dep_activates_fifo);
         remote_dep_mpi_get_start(es, deps);
@@ -1607,6 +1924,7 @@ remote_dep_mpi_put_start(parsec_execution_stream_t* es,
     remote_dep_wire_get_t* task = &(item->cmd.activate.task);
 #if !defined(PARSEC_PROF_DRY_DEP)
     parsec_remote_deps_t* deps = (parsec_remote_deps_t*) (uintptr_t) task->source_deps;
+    parsec_comm_engine_t* ce = remote_dep_ce(item->cmd.activate.peer);
     int k, nbdtt;
     void* dataptr;
     MPI_Datatype dtt;
@@ -1683,21 +2001,21 @@ remote_dep_mpi_put_start(parsec_execution_stream_t* es,
         parsec_ce_mem_reg_handle_t source_memory_handle;
         size_t source_memory_handle_size;
 
-        if(parsec_ce.capabilites.supports_noncontiguous_datatype) {
-            parsec_ce.mem_register(dataptr, PARSEC_MEM_TYPE_NONCONTIGUOUS,
-                                   nbdtt, dtt,
-                                   -1,
-                                   &source_memory_handle, &source_memory_handle_size);
+        if(ce->capabilites.supports_noncontiguous_datatype) {
+            parsec_ce_mem_register_cached(ce, dataptr, PARSEC_MEM_TYPE_NONCONTIGUOUS,
+                                          nbdtt, dtt,
+                                          -1,
+                                          &source_memory_handle, &source_memory_handle_size);
         } else {
             /* TODO: Implement converter to pack and unpack
              * register the whole region including the holes because we don't support sparse
              * registration. */
             ptrdiff_t extent, lb;
             parsec_type_extent(dtt, &lb, &extent); (void)lb;
-            parsec_ce.mem_register(dataptr, PARSEC_MEM_TYPE_CONTIGUOUS,
-                                   -1, parsec_datatype_uint8_t,
-                                   nbdtt * extent,
-                                   &source_memory_handle, &source_memory_handle_size);
+            parsec_ce_mem_register_cached(ce, dataptr, PARSEC_MEM_TYPE_CONTIGUOUS,
+                                          -1, parsec_datatype_uint8_t,
+                                          nbdtt * extent,
+                                          &source_memory_handle, &source_memory_handle_size);
 
         }
 
@@ -1711,8 +2029,20 @@ remote_dep_mpi_put_start(parsec_execution_stream_t* es,
 
         remote_dep_cb_data_t *cb_data = (remote_dep_cb_data_t *) parsec_thread_mempool_allocate
                                             (parsec_remote_dep_cb_data_mempool->thread_mempools);
-        cb_data->deps  = deps;
-        cb_data->k     = k;
+        cb_data->deps     = deps;
+        cb_data->k        = k;
+        cb_data->memory_handle = source_memory_handle;
+        cb_data->peer     = item->cmd.activate.peer;
+        cb_data->inflight = 0;
+        cb_data->waiting  = 0;
+        cb_data->done     = 0;
+        /* The receiver asks for fragments when its memory is contiguous, ours must be too */
+        cb_data->length   = remote_dep_mpi_contiguous_size(dtt, nbdtt);
+        cb_data->fragment = (cb_data->length > task->fragment) ? task->fragment : 0;
+        cb_data->callback_fn = task->callback_fn;
+        cb_data->remote_callback_data = task->remote_callback_data;
+        cb_data->remote_memory_handle = malloc(ce->get_mem_handle_size());
+        memcpy(cb_data->remote_memory_handle, remote_memory_handle, ce->get_mem_handle_size());
 
 #if defined(PARSEC_PROF_TRACE)
         uint64_t event_id = remote_dep_mpi_profiling_event_id();
@@ -1722,14 +2052,8 @@ remote_dep_mpi_put_start(parsec_execution_stream_t* es,
                             es->virtual_process->parsec_context->my_rank,
                             item->cmd.activate.peer, deps->msg, nbdtt, dtt);
 
-        /* the remote side should send us 8 bytes as the callback data to be passed back to them */
-        parsec_ce.put(&parsec_ce, source_memory_handle, 0,
-                      remote_memory_handle, 0,
-                      0, item->cmd.activate.peer,
-                      remote_dep_mpi_put_end_cb, cb_data,
-                      (parsec_ce_tag_t)task->callback_fn, &task->remote_callback_data, sizeof(uintptr_t));
-
-        parsec_comm_puts++;
+        /* counted in parsec_comm_puts once its first put is posted */
+        remote_dep_mpi_put_continue(ce, cb_data);
     }
 #endif  /* !defined(PARSEC_PROF_DRY_DEP) */
     if(0 == task->output_mask) {
@@ -1751,27 +2075,122 @@ remote_dep_mpi_put_end_cb(parsec_comm_engine_t *ce,
                        int remote,
                        void *cb_data)
 {
-    (void) ldispl; (void) rdispl; (void) size; (void) remote; (void) rreg;
+    (void) ldispl; (void) rdispl; (void) size; (void) remote; (void) rreg; (void) lreg;
+    remote_dep_cb_data_t *put = (remote_dep_cb_data_t *)cb_data;
     /* Retrieve deps from callback_data */
-    parsec_remote_deps_t* deps = ((remote_dep_cb_data_t *)cb_data)->deps;
+    parsec_remote_deps_t* deps = put->deps;
+
+    PARSEC_DEBUG_VERBOSE(6, parsec_debug_output, "MPI:\tTO\tna\tPut END  \tunknown \tk=%d\twith deps %p\tparams bla\t(src_mem_handle = %p, dst_mem_handle=%p, %zu/%zu bytes)",
+            put->k, deps, lreg, rreg, put->done, put->length);
 
-    PARSEC_DEBUG_VERBOSE(6, parsec_debug_output, "MPI:\tTO\tna\tPut END  \tunknown \tk=%d\twith deps %p\tparams bla\t(src_mem_handle = %p, dst_mem_handle=%p",
-            ((remote_dep_cb_data_t *)cb_data)->k, deps, lreg, rreg);
+    put->inflight--;
+    if( put->done < put->length )  /* more fragments to put */
+        remote_dep_mpi_put_continue(ce, put);
+    if( (0 != put->inflight) || (put->done < put->length) )
+        return 1;
 
 #if defined(PARSEC_PROF_TRACE)
-    TAKE_TIME(parsec_comm_es.es_profile, MPI_Data_plds_ek,
-              ((remote_dep_cb_data_t *)cb_data)->event_id);
+    TAKE_TIME(parsec_comm_es.es_profile, MPI_Data_plds_ek, put->event_id);
 #endif /* PARSEC_PROF_TRACE */
 
     remote_dep_complete_and_cleanup(&deps, 1);
 
-    ce->mem_unregister(&lreg);
-    parsec_thread_mempool_free(parsec_remote_dep_cb_data_mempool->thread_mempools, cb_data);
+    parsec_ce_mem_unregister_cached(ce, &put->memory_handle);
+    free(put->remote_memory_handle);
+    parsec_thread_mempool_free(parsec_remote_dep_cb_data_mempool->thread_mempools, put);
 
     parsec_comm_puts--;
     return 1;
 }
 
+/**
+ * Posts the puts of a GET order that are ready: the whole data at once, or
+ * its next fragments while less than comm_pipeline_depth are in flight.
+ * When the data is forwarded while it is received, only the part already
+ * received is ready.
+ *
+ * @return 1 once all the data is posted, 0 otherwise.
+ */
+static int
+remote_dep_mpi_put_post(parsec_comm_engine_t* ce,
+                        remote_dep_cb_data_t* put)
+{
+    parsec_remote_deps_t* deps = put->deps;
+    int receiving = !!(deps->pipelined_mask & deps->incoming_mask & (1U<<put->k));
+    remote_dep_put_notice_t notice;
+    size_t size;
+
+    notice.remote_callback_data = put->remote_callback_data;
+    if( 0 == put->fragment ) {
+        if( receiving ) return 0;
+        notice.offset = notice.length = notice.total = 0;
+        put->inflight++;
+        put->done = put->length;
+        ce->put(ce, put->memory_handle, 0,
+                put->remote_memory_handle, 0,
+                0, put->peer,
+                remote_dep_mpi_put_end_cb, put,
+                (parsec_ce_tag_t)put->callback_fn, &notice, sizeof(remote_dep_put_notice_t));
+        parsec_comm_puts++;
+        return 1;
+    }
+    while( (put->done < put->length) && (put->inflight < parsec_param_pipeline_depth) ) {
+        size = put->length - put->done;
+        if( size > put->fragment ) size = put->fragment;
+        if( receiving && (put->done + size > deps->output[put->k].received) )
+            break;  /* not here yet */
+        notice.offset = put->done;
+        notice.length = size;
+        notice.total  = put->length;
+        if( 0 == put->done ) parsec_comm_puts++;
+        put->inflight++;
+        put->done += size;
+        ce->put(ce, put->memory_handle, notice.offset,
+                put->remote_memory_handle, notice.offset,
+                size, put->peer,
+                remote_dep_mpi_put_end_cb, put,
+                (parsec_ce_tag_t)put->callback_fn, &notice, sizeof(remote_dep_put_notice_t));
+    }
+    return put->done == put->length;
+}
+
+/* Posts what is ready of a put, and keeps it in dep_put_pipelined while it
+ * waits for the data it forwards */
+static void
+remote_dep_mpi_put_continue(parsec_comm_engine_t* ce,
+                            remote_dep_cb_data_t* put)
+{
+    parsec_remote_deps_t* deps = put->deps;
+
+    if( remote_dep_mpi_put_post(ce, put) ) {
+        if( put->waiting ) {
+            parsec_list_nolock_remove(&dep_put_pipelined, &put->super);
+            put->waiting = 0;
+        }
+    } else if( !put->waiting && (deps->pipelined_mask & deps->incoming_mask & (1U<<put->k)) ) {
+        parsec_list_nolock_push_back(&dep_put_pipelined, &put->super);
+        put->waiting = 1;
+    }
+}
+
+/* More of the data of output k of deps is here, put it to the peers that
+ * wait for it */
+static void
+remote_dep_mpi_put_resume(parsec_remote_deps_t* deps, int k)
+{
+    parsec_list_item_t *item, *next;
+    remote_dep_cb_data_t *put;
+
+    for(item = PARSEC_LIST_ITERATOR_FIRST(&dep_put_pipelined);
+        item != PARSEC_LIST_ITERATOR_END(&dep_put_pipelined);
+        item = next) {
+        next = PARSEC_LIST_ITERATOR_NEXT(item);
+        put = (remote_dep_cb_data_t*)item;
+        if( (put->deps != deps) || (put->k != k) ) continue;
+        remote_dep_mpi_put_continue(remote_dep_ce(put->peer), put);
+    }
+}
+
 
 /**
  * An activation message has been received, and the remote_dep_wire_activate_t
@@ -2039,11 +2458,83 @@ remote_dep_mpi_release_delayed_deps(parsec_execution_stream_t* es,
     PARSEC_PINS(es, ACTIVATE_CB_END, NULL);
 }
 
+/* Returns the bytes of the fragments the data of output k of deps can be
+ * received in, and stores in length the bytes of the data when it is
+ * contiguous */
+static size_t remote_dep_mpi_get_fragment(parsec_remote_deps_t* deps, int k, size_t *length)
+{
+    *length = remote_dep_mpi_contiguous_size(deps->output[k].data.remote.dst_datatype,
+                                             deps->output[k].data.remote.dst_count);
+    if( (0 == parsec_param_fragment_size) || (*length <= parsec_param_fragment_size) )
+        return 0;
+    return parsec_param_fragment_size;
+}
+
+#if defined(PARSEC_DIST_COLLECTIVES)
+/**
+ * The propagation of a collective can start with the reception of its data
+ * when all the data is received in fragments, and none of it is small
+ * enough to be sent with the activation to the next peers.
+ */
+static int remote_dep_mpi_can_pipeline(parsec_remote_deps_t* deps)
+{
+    size_t length;
+    int k, dsize;
+
+    if( PARSEC_TASKPOOL_TYPE_PTG != deps->taskpool->taskpool_type )
+        return 0;
+    for(k = 0; deps->incoming_mask >> k; k++) {
+        if( !((1U<<k) & deps->incoming_mask) ) continue;
+        if( 0 == remote_dep_mpi_get_fragment(deps, k, &length) )
+            return 0;
+        parsec_ce.pack_size(&parsec_ce, deps->output[k].data.remote.src_count,
+                            deps->output[k].data.remote.src_datatype, &dsize);
+        if( dsize < (int)DEP_SHORT_BUFFER_SIZE )
+            return 0;
+    }
+    return 1;
+}
+
+/**
+ * Starts the propagation of a collective while its data is received. The
+ * next peers are activated now, and the fragments of the data are put to
+ * them as they arrive (remote_dep_mpi_put_resume). Like for a propagation
+ * started once all the data is here, the communication engine holds the
+ * deps until the reception completes in remote_dep_release_incoming, which
+ * then releases the copies the engine allocated.
+ */
+static void remote_dep_mpi_pipeline_start(parsec_execution_stream_t* es,
+                                          parsec_remote_deps_t* deps)
+{
+    parsec_task_t task;
+    int i;
+
+    task.taskpool = deps->taskpool;
+    task.task_class = task.taskpool->task_classes_array[deps->msg.task_class_id];
+    task.priority = deps->priority;
+    for(i = 0; i < task.task_class->nb_locals;
+        task.locals[i] = deps->msg.locals[i], i++);
+    for(i = 0; i < task.task_class->nb_flows;
+        task.data[i].data_in = task.data[i].data_out = NULL, task.data[i].source_repo_entry = NULL, task.data[i].source_repo = NULL, i++);
+    task.repo_entry = NULL;
+
+    for(i = 0; deps->incoming_mask >> i; i++)
+        deps->output[i].received = 0;
+
+    remote_dep_inc_flying_messages(task.taskpool);
+    (void)parsec_atomic_fetch_inc_int32(&deps->pending_ack);
+    deps->pipelined_mask = deps->outgoing_mask;  /* the safekeeper of remote_dep_get_datatypes */
+    deps->outgoing_mask = 0;
+    parsec_remote_dep_propagate(es, &task, deps);
+}
+#endif  /* PARSEC_DIST_COLLECTIVES */
+
 static void remote_dep_mpi_get_start(parsec_execution_stream_t* es,
                                      parsec_remote_deps_t* deps)
 {
     remote_dep_wire_activate_t* task = &(deps->msg);
-    int from = deps->from, k, count, nbdtt;
+    int from = deps->from, k, count, nbdtt, pipelined = 0;
+    parsec_comm_engine_t* ce = remote_dep_ce(from);
     remote_dep_wire_get_t msg;
     MPI_Datatype dtt;
 #if defined(PARSEC_DEBUG_NOISIER)
@@ -2055,7 +2546,12 @@ static void remote_dep_mpi_get_start(parsec_execution_stream_t* es,
         if( ((1U<<k) & deps->incoming_mask) ) count++;
 
     (void)es;
+    if( !remote_dep_mpi_get_allocate(deps) )
+        return;  /* held back until some memory is released */
     DEBUG_MARK_CTL_MSG_ACTIVATE_RECV(from, (void*)task, task);
+#if defined(PARSEC_DIST_COLLECTIVES)
+    pipelined = remote_dep_mpi_can_pipeline(deps);
+#endif  /* PARSEC_DIST_COLLECTIVES */
 
     msg.source_deps = task->deps; /* the deps copied from activate message from source */
     msg.callback_fn = (uintptr_t)remote_dep_mpi_get_end_cb; /* We let the source know to call this
@@ -2076,15 +2572,20 @@ static void remote_dep_mpi_get_start(parsec_execution_stream_t* es,
                                                     (parsec_remote_dep_cb_data_mempool->thread_mempools);
         callback_data->deps = deps;
         callback_data->k    = k;
+        callback_data->done = 0;
+        callback_data->arrived = NULL;
 
-        /* prepare the local receiving data */
-        assert(NULL == deps->output[k].data.data); /* we do not support in-place tiles now, make sure it doesn't happen yet */
-        if(NULL == deps->output[k].data.data) {
-            deps->output[k].data.data = remote_dep_copy_allocate(&deps->output[k].data.remote);
-        }
+        /* the local receiving data was allocated by remote_dep_mpi_get_allocate */
         dtt   = deps->output[k].data.remote.dst_datatype;
         nbdtt = deps->output[k].data.remote.dst_count;
 
+        /* Ask for the data in fragments when our memory is contiguous */
+        callback_data->fragment = remote_dep_mpi_get_fragment(deps, k, &callback_data->length);
+        msg.fragment = callback_data->fragment;
+        if( pipelined )  /* track the fragments to forward the data received without hole */
+            callback_data->arrived = (uint8_t*)calloc((callback_data->length + callback_data->fragment - 1) / callback_data->fragment,
+                                                      sizeof(uint8_t));
+
         /* We have the remote mem_handle.
          * Let's allocate our mem_reg_handle
          * and let the source know.
@@ -2092,21 +2593,21 @@ static void remote_dep_mpi_get_start(parsec_execution_stream_t* es,
         parsec_ce_mem_reg_handle_t receiver_memory_handle;
         size_t receiver_memory_handle_size;
 
-        if(parsec_ce.capabilites.supports_noncontiguous_datatype) {
-            parsec_ce.mem_register(PARSEC_DATA_COPY_GET_PTR(deps->output[k].data.data), PARSEC_MEM_TYPE_NONCONTIGUOUS,
-                                   nbdtt, dtt,
-                                   -1,
-                                   &receiver_memory_handle, &receiver_memory_handle_size);
+        if(ce->capabilites.supports_noncontiguous_datatype) {
+            parsec_ce_mem_register_cached(ce, PARSEC_DATA_COPY_GET_PTR(deps->output[k].data.data), PARSEC_MEM_TYPE_NONCONTIGUOUS,
+                                          nbdtt, dtt,
+                                          -1,
+                                          &receiver_memory_handle, &receiver_memory_handle_size);
         } else {
             /* TODO: Implement converter to pack and unpack
              * register the whole region including the holes because we don't support sparse
              * registration. */
             ptrdiff_t extent, lb;
             parsec_type_extent(dtt, &lb, &extent); (void)lb;
-            parsec_ce.mem_register(PARSEC_DATA_COPY_GET_PTR(deps->output[k].data.data), PARSEC_MEM_TYPE_CONTIGUOUS,
-                                   -1, parsec_datatype_uint8_t,
-                                   nbdtt * extent,
-                                   &receiver_memory_handle, &receiver_memory_handle_size);
+            parsec_ce_mem_register_cached(ce, PARSEC_DATA_COPY_GET_PTR(deps->output[k].data.data), PARSEC_MEM_TYPE_CONTIGUOUS,
+                                          -1, parsec_datatype_uint8_t,
+                                          nbdtt * extent,
+                                          &receiver_memory_handle, &receiver_memory_handle_size);
 
         }
 
@@ -2150,13 +2651,17 @@ static void remote_dep_mpi_get_start(parsec_execution_stream_t* es,
         TAKE_TIME_WITH_INFO(es->es_profile, MPI_Data_ctl_sk, event_id, k,
                             from, es->virtual_process->parsec_context->my_rank,
                             *task, nbdtt, dtt);
-        parsec_ce.send_am(&parsec_ce, PARSEC_CE_REMOTE_DEP_GET_DATA_TAG, from, buf, buf_size);
+        ce->send_am(ce, PARSEC_CE_REMOTE_DEP_GET_DATA_TAG, from, buf, buf_size);
         TAKE_TIME(es->es_profile, MPI_Data_ctl_ek, event_id);
 
         free(buf);
 
         parsec_comm_gets++;
     }
+#if defined(PARSEC_DIST_COLLECTIVES)
+    if( pipelined )
+        remote_dep_mpi_pipeline_start(es, deps);
+#endif  /* PARSEC_DIST_COLLECTIVES */
 }
 
 static void remote_dep_mpi_get_end(parsec_execution_stream_t* es,
@@ -2175,15 +2680,35 @@ remote_dep_mpi_get_end_cb(parsec_comm_engine_t *ce,
                           int src,
                           void *cb_data)
 {
-    (void) ce; (void) tag; (void) msg_size; (void) cb_data; (void) src;
+    (void) tag; (void) msg_size; (void) cb_data; (void) src;
     parsec_execution_stream_t* es = &parsec_comm_es;
 
     /* We send 8 bytes to the source to give it back to us when the PUT is completed,
-     * let's retrieve that
+     * it comes back with the part of the data the PUT carried, let's retrieve that
      */
-    uintptr_t *retrieve_pointer_to_callback = (uintptr_t *)msg;
-    remote_dep_cb_data_t *callback_data = (remote_dep_cb_data_t *)*retrieve_pointer_to_callback;
+    remote_dep_put_notice_t *notice = (remote_dep_put_notice_t *)msg;
+    remote_dep_cb_data_t *callback_data = (remote_dep_cb_data_t *)notice->remote_callback_data;
     parsec_remote_deps_t *deps = (parsec_remote_deps_t *)callback_data->deps;
+    int k = callback_data->k, forwarded = (NULL != callback_data->arrived);
+    size_t f, nb;
+
+    if( 0 != notice->length ) {  /* a fragment */
+        callback_data->done += notice->length;
+        if( forwarded ) {
+            struct remote_dep_output_param_s* output = &deps->output[k];
+            nb = (callback_data->length + callback_data->fragment - 1) / callback_data->fragment;
+            if( (f = notice->offset / callback_data->fragment) < nb )
+                callback_data->arrived[f] = 1;
+            if( notice->offset == output->received ) {
+                for( f = output->received / callback_data->fragment;
+                     (f < nb) && callback_data->arrived[f]; f++ ) ;
+                output->received = (f < nb) ? f * callback_data->fragment : callback_data->length;
+                remote_dep_mpi_put_resume(deps, k);
+            }
+        }
+        if( callback_data->done < notice->total )
+            return 1;  /* more to come */
+    }
 
 #if defined(PARSEC_DEBUG_NOISIER)
     char tmp[MAX_TASK_STRLEN];
@@ -2197,11 +2722,14 @@ remote_dep_mpi_get_end_cb(parsec_comm_engine_t *ce,
 #if defined(PARSEC_PROF_TRACE)
     TAKE_TIME(es->es_profile, MPI_Data_pldr_ek, callback_data->event_id);
 #endif /* PARSEC_PROF_TRACE */
-    remote_dep_mpi_get_end(es, callback_data->k, deps);
-
-    parsec_ce.mem_unregister(&callback_data->memory_handle);
+    parsec_ce_mem_unregister_cached(ce, &callback_data->memory_handle);
+    free(callback_data->arrived);
     parsec_thread_mempool_free(parsec_remote_dep_cb_data_mempool->thread_mempools, callback_data);
 
+    remote_dep_mpi_get_end(es, k, deps);
+    if( forwarded )  /* the peers still waiting can now get all of it */
+        remote_dep_mpi_put_resume(deps, k);
+
     parsec_comm_gets--;
 
     return 1;
@@ -2222,6 +2750,7 @@ int remote_dep_ce_reconfigure(parsec_context_t* context)
         free(parsec_mpi_same_pos_items); parsec_mpi_same_pos_items = NULL;
         parsec_mpi_same_pos_items_size = 0;
     }
+    remote_dep_aggregate_release();
     /**
      * Finalize the initialization of the upper level structures
      * Worst case: one of the DAGs is going to use up to
@@ -2233,6 +2762,12 @@ int remote_dep_ce_reconfigure(parsec_context_t* context)
     assert( NULL == parsec_mpi_same_pos_items );
     parsec_mpi_same_pos_items = (dep_cmd_item_t**)calloc(parsec_mpi_same_pos_items_size,
                                                         sizeof(dep_cmd_item_t*));
+    dep_aggregates_size = context->nb_nodes;
+    dep_aggregates = (remote_dep_aggregate_t*)calloc(dep_aggregates_size, sizeof(remote_dep_aggregate_t));
+    for(int i = 0; i < dep_aggregates_size; i++) {
+        PARSEC_OBJ_CONSTRUCT(&dep_aggregates[i].super, parsec_list_item_t);
+        dep_aggregates[i].peer = i;
+    }
 
     if(1 < context->nb_nodes) {
         /* if nb_nodes==1, the parsec comm engine does not run with its own thread, so don't change the thread
@@ -2242,6 +2777,44 @@ int remote_dep_ce_reconfigure(parsec_context_t* context)
     return PARSEC_SUCCESS;
 }
 
+/* The first rank of the node of each process, for the communicator it was computed on */
+static MPI_Comm remote_dep_nodes_comm = MPI_COMM_NULL;
+static int     *remote_dep_nodes_first = NULL;
+
+/**
+ * Collective on the communicator of the communication engine, unless it
+ * did not change since the last call. Stores in node_of the node of each
+ * process, the nodes being numbered in the order of their first rank, and
+ * returns the number of nodes.
+ */
+int remote_dep_ce_nodes(parsec_context_t* context, int* node_of)
+{
+    MPI_Comm comm = (MPI_Comm)context->comm_ctx, local;
+    int i, res, first, nb = 0;
+
+    assert(-1 != context->comm_ctx);
+    if( MPI_COMM_NULL != remote_dep_nodes_comm ) {
+        /* Still valid if the processes and their order did not change */
+        MPI_Comm_compare(remote_dep_nodes_comm, comm, &res);
+        if( (MPI_IDENT != res) && (MPI_CONGRUENT != res) ) {
+            MPI_Comm_free(&remote_dep_nodes_comm);
+            free(remote_dep_nodes_first); remote_dep_nodes_first = NULL;
+        }
+    }
+    if( MPI_COMM_NULL == remote_dep_nodes_comm ) {
+        MPI_Comm_dup(comm, &remote_dep_nodes_comm);
+        MPI_Comm_split_type(remote_dep_nodes_comm, MPI_COMM_TYPE_SHARED, 0, MPI_INFO_NULL, &local);
+        MPI_Allreduce(&context->my_rank, &first, 1, MPI_INT, MPI_MIN, local);
+        MPI_Comm_free(&local);
+        remote_dep_nodes_first = (int*)malloc(context->nb_nodes * sizeof(int));
+        MPI_Allgather(&first, 1, MPI_INT, remote_dep_nodes_first, 1, MPI_INT, remote_dep_nodes_comm);
+    }
+    /* The first rank of a node is numbered before the other ranks of the node */
+    for(i = 0; i < context->nb_nodes; i++)
+        node_of[i] = (remote_dep_nodes_first[i] == i) ? nb++ : node_of[remote_dep_nodes_first[i]];
+    return nb;
+}
+
 int
 remote_dep_ce_init(parsec_context_t* context)
 {
@@ -2252,6 +2825,10 @@ remote_dep_ce_init(parsec_context_t* context)
     PARSEC_OBJ_CONSTRUCT(&dep_activates_fifo, parsec_list_t);
     PARSEC_OBJ_CONSTRUCT(&dep_activates_noobj_fifo, parsec_list_t);
     PARSEC_OBJ_CONSTRUCT(&dep_put_fifo, parsec_list_t);
+    PARSEC_OBJ_CONSTRUCT(&dep_deferred_gets_fifo, parsec_list_t);
+    PARSEC_OBJ_CONSTRUCT(&dep_put_pipelined, parsec_list_t);
+    PARSEC_OBJ_CONSTRUCT(&dep_aggregates_pending, parsec_list_t);
+    memset((void*)dep_aggregate_stats, 0, sizeof(dep_aggregate_stats));
 
     /* Register Persistant requests */
     rc = parsec_ce.tag_register(PARSEC_CE_REMOTE_DEP_ACTIVATE_TAG, remote_dep_mpi_save_activate_cb, context,
@@ -2269,6 +2846,11 @@ remote_dep_ce_init(parsec_context_t* context)
         parsec_comm_engine_fini(&parsec_ce);
         return rc;
     }
+    /* The same messages go through the shared memory engine for the local peers */
+    parsec_ce_shm.tag_register(PARSEC_CE_REMOTE_DEP_ACTIVATE_TAG, remote_dep_mpi_save_activate_cb, context,
+                               DEP_SHORT_BUFFER_SIZE * sizeof(char));
+    parsec_ce_shm.tag_register(PARSEC_CE_REMOTE_DEP_GET_DATA_TAG, remote_dep_mpi_save_put_cb, context,
+                               4096);
 
     parsec_remote_dep_cb_data_mempool = (parsec_mempool_t*) malloc (sizeof(parsec_mempool_t));
     parsec_mempool_construct(parsec_remote_dep_cb_data_mempool,
@@ -2289,6 +2871,8 @@ int remote_dep_ce_fini(parsec_context_t* context)
     parsec_ce.tag_unregister(PARSEC_CE_REMOTE_DEP_ACTIVATE_TAG);
     parsec_ce.tag_unregister(PARSEC_CE_REMOTE_DEP_GET_DATA_TAG);
     //parsec_ce.tag_unregister(PARSEC_CE_REMOTE_DEP_PUT_END_TAG);
+    parsec_ce_shm.tag_unregister(PARSEC_CE_REMOTE_DEP_ACTIVATE_TAG);
+    parsec_ce_shm.tag_unregister(PARSEC_CE_REMOTE_DEP_GET_DATA_TAG);
 
     if( NULL != parsec_remote_dep_cb_data_mempool ) {
         parsec_mempool_destruct(parsec_remote_dep_cb_data_mempool);
@@ -2298,11 +2882,25 @@ int remote_dep_ce_fini(parsec_context_t* context)
         free(parsec_mpi_same_pos_items); parsec_mpi_same_pos_items = NULL;
         parsec_mpi_same_pos_items_size = 0;
     }
+    parsec_debug_verbose(3, parsec_comm_output_stream,
+                         "rank %d sent %"PRId64" activations in %"PRId64" messages (%"PRId64" bytes): "
+                         "%"PRId64" full, %"PRId64" on timeout, %"PRId64" when idle",
+                         parsec_debug_rank, dep_aggregate_stats[AGG_ACTIVATIONS], dep_aggregate_stats[AGG_MESSAGES],
+                         dep_aggregate_stats[AGG_BYTES], dep_aggregate_stats[AGG_FLUSH_FULL],
+                         dep_aggregate_stats[AGG_FLUSH_TIMEOUT], dep_aggregate_stats[AGG_FLUSH_IDLE]);
+    remote_dep_aggregate_release();
 
     PARSEC_OBJ_DESTRUCT(&dep_activates_fifo);
     PARSEC_OBJ_DESTRUCT(&dep_activates_noobj_fifo);
     PARSEC_OBJ_DESTRUCT(&dep_put_fifo);
+    PARSEC_OBJ_DESTRUCT(&dep_deferred_gets_fifo);
+    PARSEC_OBJ_DESTRUCT(&dep_put_pipelined);
+    PARSEC_OBJ_DESTRUCT(&dep_aggregates_pending);
 
+    if( MPI_COMM_NULL != remote_dep_nodes_comm ) {
+        MPI_Comm_free(&remote_dep_nodes_comm);
+        free(remote_dep_nodes_first); remote_dep_nodes_first = NULL;
+    }
     return 0;
 }
 
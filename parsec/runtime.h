@@ -295,7 +295,8 @@ typedef enum parsec_context_query_cmd_e {
     PARSEC_CONTEXT_QUERY_RANK,
     PARSEC_CONTEXT_QUERY_DEVICES,
     PARSEC_CONTEXT_QUERY_CORES,
-    PARSEC_CONTEXT_QUERY_ACTIVE_TASKPOOLS
+    PARSEC_CONTEXT_QUERY_ACTIVE_TASKPOOLS,
+    PARSEC_CONTEXT_QUERY_ACTIVE_CORES
 } parsec_context_query_cmd_t;
 
 /**
@@ -314,6 +315,29 @@ typedef enum parsec_context_query_cmd_e {
  */
 int parsec_context_query(parsec_context_t* context, parsec_context_query_cmd_t cmd, ... );
 
+/**
+ * @brief Change the number of compute threads executing tasks in a context
+ *
+ * @details
+ * Lend cores back to the application, or reclaim them, without finalizing
+ * the context. The compute threads created by parsec_init are kept, but only
+ * nb_cores of them select tasks: the others complete the tasks they already
+ * own, and then sleep until they are reactivated or the context is
+ * finalized. The active threads are spread evenly over the virtual
+ * processes, and each virtual process keeps at least one active thread
+ * (the master thread always remains active). This function can be called
+ * at any time, including while tasks are executing, but not concurrently
+ * with itself.
+ *
+ * @param[inout] context the PaRSEC context
+ * @param[in] nb_cores the number of compute threads to keep active, between
+ *            the number of virtual processes and the number of compute threads
+ *            created by parsec_init. Any value lower than 1 reactivates all the
+ *            compute threads.
+ * @return the number of active compute threads.
+ */
+int parsec_context_set_active_cores(parsec_context_t* context, int nb_cores);
+
 /**
  * @brief Start taskpool that were enqueued into the PaRSEC context
  *
@@ -660,6 +684,91 @@ void parsec_usage(void);
  */
 int32_t parsec_taskpool_set_priority( parsec_taskpool_t* taskpool, int32_t new_priority );
 
+/**
+ * @brief Change the weight of an entire taskpool
+ *
+ * @details
+ * The weight is the share of the execution resources a taskpool receives
+ * from the fair-sharing schedulers (such as drr) when several taskpools
+ * have ready tasks: a taskpool of weight 4 receives four times the service
+ * time of a taskpool of weight 1. Other schedulers ignore it. The default
+ * weight is 1, and weights lower than 1 are set to 1. This function can be
+ * used during the lifetime of a taskpool, and takes effect at the next
+ * round of the scheduler.
+ *
+ * @param[inout] taskpool the taskpool to weight
+ * @param[in] new_weight the new weight of the taskpool
+ * @return The weight of the taskpool before being assigned to new_weight
+ */
+int32_t parsec_taskpool_set_weight( parsec_taskpool_t* taskpool, int32_t new_weight );
+
+/**
+ * @brief Limits the arena memory held by the data of a taskpool
+ *
+ * @details
+ * The data that the tasks of the taskpool allocate from arenas (their
+ * NEW outputs and the data they receive from other ranks) are charged to
+ * the budget of the taskpool until they are released. When an allocation
+ * does not fit, either in the budget or in the max_used of its arena, the
+ * task is held back instead of failing, and the communication engine
+ * holds back the incoming data, until some memory is released. A budget
+ * of 0 is unlimited. The default budget is the arena_taskpool_budget MCA
+ * parameter.
+ *
+ * @param[inout] taskpool the taskpool to limit
+ * @param[in] max_bytes the new budget of the taskpool, in bytes
+ * @return The budget of the taskpool before being assigned to max_bytes
+ */
+size_t parsec_taskpool_set_arena_budget( parsec_taskpool_t* taskpool, size_t max_bytes );
+
+/**
+ * @brief Counters of the arena budget of a taskpool
+ */
+typedef struct parsec_taskpool_arena_budget_stats_s {
+    size_t  max_used;           /**< Budget of the taskpool, in bytes */
+    size_t  used;               /**< Arena memory held by the data of the taskpool */
+    int64_t nb_deferred_tasks;  /**< Tasks held back because their output did not fit */
+    int64_t nb_deferred_gets;   /**< Incoming data held back because they did not fit */
+    int64_t nb_resumed;         /**< Held back work resumed after some memory was released */
+    int32_t nb_waiting;         /**< Work currently held back by the budget */
+} parsec_taskpool_arena_budget_stats_t;
+
+/**
+ * @brief Gets the counters of the arena budget of a taskpool
+ *
+ * @return PARSEC_SUCCESS, or PARSEC_ERR_NOT_FOUND if the taskpool has no budget
+ */
+int parsec_taskpool_get_arena_budget_stats( parsec_taskpool_t* taskpool,
+                                            parsec_taskpool_arena_budget_stats_t* stats );
+
+/**
+ * @brief Deadline of the tasks that have no deadline
+ */
+#define PARSEC_DEADLINE_NONE UINT64_MAX
+
+/**
+ * @brief Prototype of the deadline function of a task class
+ *
+ * @details
+ * Returns the absolute time, in nanoseconds on the clock of
+ * parsec_deadline_now(), before which the task should complete, or
+ * PARSEC_DEADLINE_NONE. The deadline-aware schedulers (such as edf)
+ * evaluate it once, when the task becomes ready; the other schedulers
+ * ignore it.
+ */
+typedef uint64_t (parsec_task_deadline_fct_t)(const parsec_task_t *task);
+
+/**
+ * @brief Current time on the clock of the task deadlines
+ *
+ * @details
+ * A monotonic clock, in nanoseconds from an arbitrary origin, common to
+ * all the threads of the process.
+ *
+ * @return the current time in nanoseconds
+ */
+uint64_t parsec_deadline_now(void);
+
 /**
  * @brief Human-readable print function for tasks
  *
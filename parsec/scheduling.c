@@ -17,6 +17,7 @@
 #include "parsec/remote_dep.h"
 #include "parsec/scheduling.h"
 #include "parsec/papi_sde.h"
+#include "parsec/arena.h"
 
 #include "parsec/debug_marks.h"
 #include "parsec/ayudame.h"
@@ -39,6 +40,12 @@
 #if defined(PARSEC_HAVE_UNISTD_H)
 #include <unistd.h>
 #endif  /* defined(PARSEC_HAVE_UNISTD_H) */
+#if defined(PARSEC_HAVE_LINUX_FUTEX_H)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <limits.h>
+#include <time.h>
+#endif  /* defined(PARSEC_HAVE_LINUX_FUTEX_H) */
 #if defined(PARSEC_PROF_RUSAGE_EU) && defined(PARSEC_HAVE_GETRUSAGE) && defined(PARSEC_HAVE_RUSAGE_THREAD) && !defined(__bgp__)
 #include <sys/time.h>
 #include <sys/resource.h>
@@ -86,6 +93,198 @@ static void parsec_rusage_per_es(parsec_execution_stream_t* es, bool print)
 #define parsec_rusage_per_es(eu, b) do {} while(0)
 #endif /* defined(PARSEC_HAVE_GETRUSAGE) defined(PARSEC_PROF_RUSAGE_EU) */
 
+/*
+ * Parking of the idle execution streams.
+ *
+ * An idle execution stream announces itself in the nb_parked counter of its
+ * VP, checks the scheduler one last time, and then sleeps on the park_seq
+ * futex of its VP. A thread inserting tasks in the scheduler on behalf of a
+ * VP checks nb_parked after the insertion and, if needed, increases park_seq
+ * and wakes up as many parked execution streams as it inserted tasks. The
+ * full memory barriers on both sides guarantee that either the parking
+ * stream finds the new tasks, or the inserting thread sees the parking
+ * stream (and then park_seq has changed and the futex wait returns
+ * immediately). Tasks that reach the scheduler without going through
+ * __parsec_schedule are found at the latest when the park times out.
+ */
+#if defined(PARSEC_HAVE_LINUX_FUTEX_H)
+static inline uint64_t __parsec_park_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static inline int __parsec_may_park(parsec_execution_stream_t* es, uint64_t misses_in_a_row)
+{
+    if( (parsec_runtime_park_threshold <= 0) ||
+        (misses_in_a_row <= (uint64_t)parsec_runtime_park_threshold) )
+        return 0;
+#if defined(DISTRIBUTED)
+    /* The thread progressing the communications cannot sleep */
+    if( PARSEC_THREAD_IS_MASTER(es) && (1 == parsec_communication_engine_up) &&
+        (es->virtual_process[0].parsec_context->nb_nodes == 1) )
+        return 0;
+#else
+    (void)es;
+#endif  /* defined(DISTRIBUTED) */
+    return 1;
+}
+
+static inline int32_t __parsec_park_prepare(parsec_execution_stream_t* es)
+{
+    parsec_vp_t* vp = es->virtual_process;
+    int32_t seq = vp->park_seq;
+
+    (void)parsec_atomic_fetch_inc_int32(&vp->nb_parked);
+    parsec_mfence();  /* announce ourselves before checking the scheduler */
+    return seq;
+}
+
+static void __parsec_park_wait(parsec_execution_stream_t* es, int32_t seq)
+{
+    parsec_vp_t* vp = es->virtual_process;
+    struct timespec timeout;
+    uint64_t start, end, wake;
+
+    timeout.tv_sec  = parsec_runtime_park_timeout / 1000000;
+    timeout.tv_nsec = (parsec_runtime_park_timeout % 1000000) * 1000;
+    start = __parsec_park_now();
+    (void)syscall(SYS_futex, &vp->park_seq, FUTEX_WAIT_PRIVATE, seq, &timeout, NULL, 0);
+    end = __parsec_park_now();
+
+    es->park_count++;
+    es->park_time += end - start;
+    if( seq != vp->park_seq ) {
+        wake = vp->park_wake_time;
+        if( (wake >= start) && (wake <= end) ) {
+            es->wakeup_count++;
+            es->wakeup_latency += end - wake;
+        }
+    }
+}
+
+static inline void __parsec_park_leave(parsec_execution_stream_t* es)
+{
+    (void)parsec_atomic_fetch_dec_int32(&es->virtual_process->nb_parked);
+}
+
+static void __parsec_unpark_vp(parsec_vp_t* vp, int nb)
+{
+    int32_t parked;
+
+    parsec_mfence();  /* the new tasks must be visible before we check for parked streams */
+    parked = vp->nb_parked;
+    if( parked <= 0 ) return;
+    if( nb > parked ) nb = parked;
+    vp->park_wake_time = __parsec_park_now();
+    (void)parsec_atomic_fetch_inc_int32(&vp->park_seq);
+    (void)syscall(SYS_futex, &vp->park_seq, FUTEX_WAKE_PRIVATE, nb, NULL, NULL, 0);
+}
+
+static void __parsec_wake_retired(parsec_vp_t* vp)
+{
+    (void)syscall(SYS_futex, &vp->nb_active_cores, FUTEX_WAKE_PRIVATE, INT_MAX, NULL, NULL, 0);
+}
+
+static void __parsec_unpark_all(parsec_context_t* context)
+{
+    for(int vp = 0; vp < context->nb_vp; vp++ ) {
+        if( context->virtual_processes[vp]->nb_active_cores < context->virtual_processes[vp]->nb_cores )
+            __parsec_wake_retired(context->virtual_processes[vp]);
+        if( parsec_runtime_park_threshold > 0 )
+            __parsec_unpark_vp(context->virtual_processes[vp],
+                               context->virtual_processes[vp]->nb_cores);
+    }
+}
+#else
+#define __parsec_wake_retired(vp)    do { (void)(vp); } while(0)
+#define __parsec_unpark_all(context) do { (void)(context); } while(0)
+#endif  /* defined(PARSEC_HAVE_LINUX_FUTEX_H) */
+
+/*
+ * Retired execution streams (see parsec_context_set_active_cores) sleep on
+ * the nb_active_cores field of their VP, for at most runtime_park_timeout,
+ * and are woken up when this field changes or when the work is completed.
+ */
+static inline int __parsec_is_retired(parsec_execution_stream_t* es)
+{
+    return (es->th_id >= es->virtual_process->nb_active_cores) &&
+        (NULL == es->next_task) && (es->ready_tasks_next >= es->ready_tasks_count);
+}
+
+static void __parsec_retired_wait(parsec_execution_stream_t* es)
+{
+    parsec_vp_t* vp = es->virtual_process;
+    int32_t nb_active = vp->nb_active_cores;
+    struct timespec timeout;
+
+    if( es->th_id < nb_active ) return;
+    timeout.tv_sec  = parsec_runtime_park_timeout / 1000000;
+    timeout.tv_nsec = (parsec_runtime_park_timeout % 1000000) * 1000;
+#if defined(PARSEC_HAVE_LINUX_FUTEX_H)
+    (void)syscall(SYS_futex, &vp->nb_active_cores, FUTEX_WAIT_PRIVATE, nb_active, &timeout, NULL, 0);
+#else
+    nanosleep(&timeout, NULL);
+#endif  /* defined(PARSEC_HAVE_LINUX_FUTEX_H) */
+}
+
+int parsec_context_set_active_cores(parsec_context_t* context, int nb_cores)
+{
+    int *nb_active, left, progress, total = 0;
+    parsec_vp_t* vp;
+
+    nb_active = (int*)malloc(context->nb_vp * sizeof(int));
+    for(int p = 0; p < context->nb_vp; p++ ) {
+        nb_active[p] = 1;
+        total += context->virtual_processes[p]->nb_cores;
+    }
+    if( (nb_cores < 1) || (nb_cores > total) ) nb_cores = total;
+    /* Distribute the active streams evenly over the VPs */
+    left = nb_cores - context->nb_vp;
+    do {
+        progress = 0;
+        for(int p = 0; (p < context->nb_vp) && (left > 0); p++ ) {
+            if( nb_active[p] < context->virtual_processes[p]->nb_cores ) {
+                nb_active[p]++;
+                left--;
+                progress = 1;
+            }
+        }
+    } while( progress && (left > 0) );
+
+    total = 0;
+    for(int p = 0; p < context->nb_vp; p++ ) {
+        vp = context->virtual_processes[p];
+        if( vp->nb_active_cores != nb_active[p] ) {
+            int32_t previous = vp->nb_active_cores;
+            vp->nb_active_cores = nb_active[p];
+            parsec_mfence();
+            if( nb_active[p] > previous ) {
+                __parsec_wake_retired(vp);
+            }
+            parsec_debug_verbose(4, parsec_debug_output, "VP %d now has %d active execution streams out of %d",
+                                 vp->vp_id, nb_active[p], vp->nb_cores);
+        }
+        total += nb_active[p];
+    }
+    free(nb_active);
+    return total;
+}
+
+static void __parsec_park_report(parsec_execution_stream_t* es)
+{
+    if( parsec_runtime_park_report && (0 != es->park_count) ) {
+        parsec_inform("VP %d Thread %d parked %"PRIu64" times for %.3f ms, woken up %"PRIu64" times "
+                      "with an average latency of %.3f us",
+                      es->virtual_process->vp_id, es->th_id, es->park_count,
+                      (double)es->park_time / 1e6, es->wakeup_count,
+                      (0 == es->wakeup_count) ? 0.0 : (double)es->wakeup_latency / (1e3 * (double)es->wakeup_count));
+    }
+    es->park_count = es->park_time = 0;
+    es->wakeup_count = es->wakeup_latency = 0;
+}
+
 #if 0
 /*
  * Disabled by now.
@@ -233,7 +432,10 @@ void parsec_taskpool_termination_detected(parsec_taskpool_t *tp)
     if( NULL != tp->on_complete ) {
         (void)tp->on_complete( tp, tp->on_complete_data );
     }
-    (void)parsec_atomic_fetch_dec_int32( &(tp->context->active_taskpools) );
+    if( 1 == parsec_atomic_fetch_dec_int32( &(tp->context->active_taskpools) ) ) {
+        /* parked execution streams must notice the end of the work */
+        __parsec_unpark_all(tp->context);
+    }
     PARSEC_PINS_TASKPOOL_FINI(tp);
 }
 
@@ -294,6 +496,9 @@ __parsec_schedule(parsec_execution_stream_t* es,
                   int32_t distance)
 {
     int ret;
+#if defined(PARSEC_HAVE_LINUX_FUTEX_H)
+    int nb_tasks = 0;
+#endif  /* defined(PARSEC_HAVE_LINUX_FUTEX_H) */
 #ifdef PARSEC_PROF_PINS
     parsec_execution_stream_t* local_es = parsec_my_execution_stream();
 #endif  /* PARSEC_PROF_PINS */
@@ -341,8 +546,25 @@ __parsec_schedule(parsec_execution_stream_t* es,
     }
 #endif  /* defined(PARSEC_PAPI_SDE) */
 
+#if defined(PARSEC_HAVE_LINUX_FUTEX_H)
+    if( parsec_runtime_park_threshold > 0 ) {
+        /* There is no need to count more tasks than execution streams to wake up */
+        parsec_task_t *task = tasks_ring;
+        do {
+            nb_tasks++;
+            task = (parsec_task_t*)task->super.list_next;
+        } while( (task != tasks_ring) && (nb_tasks < es->virtual_process->nb_cores) );
+    }
+#endif  /* defined(PARSEC_HAVE_LINUX_FUTEX_H) */
+
     ret = parsec_current_scheduler->module.schedule(es, tasks_ring, distance);
 
+#if defined(PARSEC_HAVE_LINUX_FUTEX_H)
+    if( (nb_tasks > 0) && (PARSEC_SUCCESS == ret) ) {
+        __parsec_unpark_vp(es->virtual_process, nb_tasks);
+    }
+#endif  /* defined(PARSEC_HAVE_LINUX_FUTEX_H) */
+
     PARSEC_PINS(local_es, SCHEDULE_END, tasks_ring);
 
     return ret;
@@ -376,7 +598,11 @@ int __parsec_schedule_vp(parsec_execution_stream_t* es,
     assert( (NULL == es) || (parsec_my_execution_stream() == es) );
 #endif  /* defined(PARSEC_DEBUG_PARANOID) */
 
-    if( NULL == es || !parsec_runtime_keep_highest_priority_task || NULL == es->scheduler_object) {
+    if( NULL == es || NULL == es->scheduler_object ||
+        !(parsec_runtime_keep_highest_priority_task || parsec_runtime_work_first) ||
+        (es->th_id >= es->virtual_process->nb_active_cores) ||  /* retired streams keep no task */
+        (parsec_runtime_work_first && (parsec_runtime_work_first_max_depth > 0) &&
+         (es->handoff_depth >= parsec_runtime_work_first_max_depth)) ) {
         for(int vp = 0; vp < es->virtual_process->parsec_context->nb_vp; vp++ ) {
             parsec_task_t* ring = task_rings[vp];
             if( NULL == ring ) continue;
@@ -399,8 +625,22 @@ int __parsec_schedule_vp(parsec_execution_stream_t* es,
 
         if( vp == es->virtual_process->vp_id ) {
             if( NULL == es->next_task ) {
-                es->next_task = ring;
-                ring = (parsec_task_t*)parsec_list_item_ring_chop(&ring->super);
+                if( parsec_runtime_work_first ) {
+                    /* The ring is not necessarily sorted: look for the highest priority task */
+                    parsec_task_t* best = ring;
+                    _LIST_ITEM_ITERATOR(ring, &ring->super, item, {
+                            if( ((parsec_task_t*)item)->priority > best->priority )
+                                best = (parsec_task_t*)item;
+                        });
+                    if( best == ring )
+                        ring = (parsec_task_t*)parsec_list_item_ring_chop(&ring->super);
+                    else
+                        parsec_list_item_ring_chop(&best->super);
+                    es->next_task = best;
+                } else {
+                    es->next_task = ring;
+                    ring = (parsec_task_t*)parsec_list_item_ring_chop(&ring->super);
+                }
                 if( NULL == ring ) {
                     task_rings[vp] = NULL;  /* remove the tasks already scheduled */
                     continue;
@@ -426,7 +666,8 @@ int __parsec_schedule_vp(parsec_execution_stream_t* es,
  *          execution unit. To find the most appropriate execution unit
  *          we start from the next execution unit after the current one, and
  *          iterate over all existing execution units (in the current VP,
- *          then on the next VP and so on).
+ *          then on the next VP and so on). Retired execution units do not
+ *          select tasks, so only the active ones are considered.
  *
  * @param [IN] es, the start execution_stream (normal it is the current one).
  * @param [IN] task, the task to be rescheduled.
@@ -439,17 +680,15 @@ int __parsec_reschedule(parsec_execution_stream_t* es, parsec_task_t* task)
     parsec_vp_t* vp_context = es->virtual_process;
 
     int vp, start_vp = vp_context->vp_id;
-    int start_eu = (es->th_id + 1) % context->virtual_processes[start_vp]->nb_cores;
+    /* The first execution stream of a VP is always active */
+    int start_eu = (es->th_id + 1) % vp_context->nb_active_cores;
 
     vp = start_vp;
     do {
-        if( 1 != context->virtual_processes[vp]->nb_cores ) {
+        if( (vp != start_vp) || (start_eu != es->th_id) ) {
+            /* Not me: the next active stream of my VP, or the first of another VP */
             return __parsec_schedule(context->virtual_processes[vp]->execution_streams[start_eu], task, 0);
         }
-        else if ( context->virtual_processes[vp]->vp_id != vp_context->vp_id ) {
-            /* VP contains only one EU, and it's not my VP, so not me */
-            return __parsec_schedule(context->virtual_processes[vp]->execution_streams[0], task, 0);
-        }
         start_eu = 0;  /* with the exception of the first es, we always iterate from 0 */
         vp = (vp + 1) % context->nb_vp;
     } while( vp != start_vp );
@@ -554,23 +793,46 @@ int __parsec_task_progress( parsec_execution_stream_t* es,
 }
 
 /**
- * Get the next task to execute, either from local storage or from the scheduler.
- * Update the distance accordingly.
+ * Get the next task to execute, either from local storage (the next task
+ * retained by the execution stream, then the tasks remaining from the last
+ * batched selection) or from the scheduler. Update the distance accordingly.
  *
  * @return either a valid task or NULL if no ready tasks exists.
  */
-static inline parsec_task_t*
+parsec_task_t*
 __parsec_get_next_task( parsec_execution_stream_t *es,
                         int* distance )
 {
     parsec_task_t* task;
 
-    if( NULL == (task = es->next_task) ) {
-        task = parsec_current_scheduler->module.select(es, distance);
-    } else {
+    if( NULL != (task = es->next_task) ) {
         es->next_task = NULL;
+        es->handoff_depth++;
         *distance = 1;
+    } else if( es->ready_tasks_next < es->ready_tasks_count ) {
+        es->handoff_depth = 0;
+        task = es->ready_tasks[es->ready_tasks_next++];
+        *distance = es->ready_tasks_distance;
+    } else if( (parsec_runtime_select_batch > 1) &&
+               (NULL != parsec_current_scheduler->module.select_batch) ) {
+        es->handoff_depth = 0;
+        es->ready_tasks_count = parsec_current_scheduler->module.select_batch(es, es->ready_tasks,
+                                                                              parsec_runtime_select_batch,
+                                                                              &es->ready_tasks_distance);
+        if( es->ready_tasks_count > 0 ) {
+            task = es->ready_tasks[0];
+            es->ready_tasks_next = 1;
+            *distance = es->ready_tasks_distance;
+        } else {
+            es->ready_tasks_count = es->ready_tasks_next = 0;
+        }
+    } else {
+        es->handoff_depth = 0;
+        task = parsec_current_scheduler->module.select(es, distance);
     }
+#if defined(PARSEC_PROF_PINS)
+    es->select_distance = *distance;
+#endif  /* defined(PARSEC_PROF_PINS) */
     return task;
 }
 
@@ -658,6 +920,7 @@ static int __parsec_taskpool_wait( parsec_taskpool_t* tp, parsec_execution_strea
 #endif /* defined(DISTRIBUTED) */
 
         if( misses_in_a_row > 1 ) {
+            parsec_obj_biased_flush();
             rqtp.tv_nsec = parsec_exponential_backoff(es, misses_in_a_row);
             nanosleep(&rqtp, NULL);
         }
@@ -717,6 +980,10 @@ int __parsec_context_wait( parsec_execution_stream_t* es )
     parsec_task_t* task;
     int nbiterations = 0, distance, rc;
     struct timespec rqtp;
+#if defined(PARSEC_HAVE_LINUX_FUTEX_H)
+    int32_t park_seq = 0;
+    int parked = 0;
+#endif  /* defined(PARSEC_HAVE_LINUX_FUTEX_H) */
 
     rqtp.tv_sec = 0;
     misses_in_a_row = 1;
@@ -783,13 +1050,37 @@ int __parsec_context_wait( parsec_execution_stream_t* es )
         }
 #endif /* defined(DISTRIBUTED) */
 
+        if( PARSEC_UNLIKELY(__parsec_is_retired(es)) ) {
+            __parsec_retired_wait(es);
+            continue;
+        }
+
         if( misses_in_a_row > 1 ) {
-            rqtp.tv_nsec = parsec_exponential_backoff(es, misses_in_a_row);
-            nanosleep(&rqtp, NULL);
+            /* Free the biased objects released by the other threads */
+            parsec_obj_biased_flush();
+#if defined(PARSEC_HAVE_LINUX_FUTEX_H)
+            if( __parsec_may_park(es, misses_in_a_row) ) {
+                park_seq = __parsec_park_prepare(es);
+                parked = 1;
+            } else
+#endif  /* defined(PARSEC_HAVE_LINUX_FUTEX_H) */
+            {
+                rqtp.tv_nsec = parsec_exponential_backoff(es, misses_in_a_row);
+                nanosleep(&rqtp, NULL);
+            }
         }
         misses_in_a_row++;  /* assume we fail to extract a task */
 
         task = __parsec_get_next_task(es, &distance);
+#if defined(PARSEC_HAVE_LINUX_FUTEX_H)
+        if( parked ) {
+            if( (NULL == task) && !all_tasks_done(parsec_context) ) {
+                __parsec_park_wait(es, park_seq);
+            }
+            __parsec_park_leave(es);
+            parked = 0;
+        }
+#endif  /* defined(PARSEC_HAVE_LINUX_FUTEX_H) */
         if( NULL != task ) {
             misses_in_a_row = 0;  /* reset the misses counter */
 
@@ -802,7 +1093,9 @@ int __parsec_context_wait( parsec_execution_stream_t* es )
         }
     }
 
+    parsec_obj_biased_flush();
     parsec_rusage_per_es(es, true);
+    __parsec_park_report(es);
 
     /* We're all done ? */
     parsec_barrier_wait( &(parsec_context->barrier) );
@@ -830,6 +1123,11 @@ int __parsec_context_wait( parsec_execution_stream_t* es )
         goto wait_for_the_next_round;
     }
 
+    /* All the other execution streams are waiting for the next round */
+    if( NULL != parsec_current_scheduler->module.quiesce ) {
+        parsec_current_scheduler->module.quiesce(parsec_context);
+    }
+
  finalize_progress:
     // final select end - can we mark this as special somehow?
     // actually, it will already be obviously special, since it will be the only select
@@ -854,6 +1152,9 @@ int parsec_context_add_taskpool( parsec_context_t* context, parsec_taskpool_t* t
     }
 
     tp->context = context;  /* save the context */
+    if( (NULL == tp->arena_budget) && (0 != parsec_arena_taskpool_budget) ) {
+        parsec_taskpool_set_arena_budget(tp, parsec_arena_taskpool_budget);
+    }
 
     PARSEC_PINS_TASKPOOL_INIT(tp);  /* PINS taskpool initialization */
 
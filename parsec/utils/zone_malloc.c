@@ -24,6 +24,109 @@ static inline segment_t *SEGMENT_AT_TID(zone_malloc_t *gdata, int tid)
     return &gdata->segments[tid];
 }
 
+static inline int zone_msb(uint32_t v)
+{
+#if defined(__GNUC__)
+    return 31 - __builtin_clz(v);
+#else
+    int r = 0;
+    while( v >>= 1 ) r++;
+    return r;
+#endif  /* defined(__GNUC__) */
+}
+
+static inline int zone_lsb(uint32_t v)
+{
+#if defined(__GNUC__)
+    return __builtin_ctz(v);
+#else
+    int r = 0;
+    while( !(v & 1) ) { v >>= 1; r++; }
+    return r;
+#endif  /* defined(__GNUC__) */
+}
+
+/* Size class of a segment of nb_units units */
+static inline void zone_mapping(int64_t nb_units, int *fl, int *sl)
+{
+    int msb;
+    if( nb_units < ZONE_SL_COUNT ) {
+        *fl = 0;
+        *sl = (int)nb_units;
+        return;
+    }
+    msb = zone_msb((uint32_t)nb_units);
+    *fl = msb - ZONE_SL_LOG2 + 1;
+    *sl = (int)(nb_units >> (msb - ZONE_SL_LOG2)) - ZONE_SL_COUNT;
+}
+
+static void zone_insert_free(zone_malloc_t *gdata, int tid)
+{
+    segment_t *segment = SEGMENT_AT_TID(gdata, tid);
+    int fl, sl, head;
+
+    zone_mapping(segment->nb_units, &fl, &sl);
+    head = gdata->free_heads[fl][sl];
+    segment->status    = SEGMENT_EMPTY;
+    segment->prev_free = -1;
+    segment->next_free = head;
+    if( head >= 0 )
+        gdata->segments[head].prev_free = tid;
+    gdata->free_heads[fl][sl] = tid;
+    gdata->sl_bitmap[fl] |= (1U << sl);
+    gdata->fl_bitmap     |= (1U << fl);
+}
+
+static void zone_remove_free(zone_malloc_t *gdata, int tid)
+{
+    segment_t *segment = SEGMENT_AT_TID(gdata, tid);
+    int fl, sl;
+
+    zone_mapping(segment->nb_units, &fl, &sl);
+    if( segment->next_free >= 0 )
+        gdata->segments[segment->next_free].prev_free = segment->prev_free;
+    if( segment->prev_free >= 0 ) {
+        gdata->segments[segment->prev_free].next_free = segment->next_free;
+    } else {
+        assert(gdata->free_heads[fl][sl] == tid);
+        gdata->free_heads[fl][sl] = segment->next_free;
+        if( segment->next_free < 0 ) {
+            gdata->sl_bitmap[fl] &= ~(1U << sl);
+            if( 0 == gdata->sl_bitmap[fl] )
+                gdata->fl_bitmap &= ~(1U << fl);
+        }
+    }
+    segment->next_free = segment->prev_free = -1;
+}
+
+/**
+ * Returns the first free segment of the smallest populated class whose
+ * segments all hold at least nb_units units, or -1.
+ */
+static int zone_find_suitable(zone_malloc_t *gdata, int64_t nb_units)
+{
+    uint32_t sl_map, fl_map;
+    int fl, sl;
+
+    /* Round up to the next class, so that any segment of the class fits */
+    if( nb_units >= ZONE_SL_COUNT )
+        nb_units += ((int64_t)1 << (zone_msb((uint32_t)nb_units) - ZONE_SL_LOG2)) - 1;
+    zone_mapping(nb_units, &fl, &sl);
+    if( fl >= ZONE_FL_COUNT )
+        return -1;
+
+    sl_map = gdata->sl_bitmap[fl] & (~0U << sl);
+    if( 0 == sl_map ) {
+        fl_map = gdata->fl_bitmap & (~0U << (fl + 1));
+        if( 0 == fl_map )
+            return -1;
+        fl = zone_lsb(fl_map);
+        sl_map = gdata->sl_bitmap[fl];
+    }
+    sl = zone_lsb(sl_map);
+    return gdata->free_heads[fl][sl];
+}
+
 zone_malloc_t* zone_malloc_init(void* base_ptr, int _max_segment, size_t _unit_size)
 {
     zone_malloc_t *gdata;
@@ -39,7 +142,13 @@ zone_malloc_t* zone_malloc_init(void* base_ptr, int _max_segment, size_t _unit_s
     gdata->unit_size          = _unit_size;
     gdata->max_segment        = _max_segment;
 
-    gdata->next_tid = 0;
+    gdata->units_in_use = 0;
+    gdata->fl_bitmap    = 0;
+    for(int fl = 0; fl < ZONE_FL_COUNT; fl++) {
+        gdata->sl_bitmap[fl] = 0;
+        for(int sl = 0; sl < ZONE_SL_COUNT; sl++)
+            gdata->free_heads[fl][sl] = -1;
+    }
     gdata->segments = (segment_t *)malloc(sizeof(segment_t) * _max_segment);
 #if defined(PARSEC_DEBUG)
     for(int i = 0; i < _max_segment; i++) {
@@ -50,6 +159,7 @@ zone_malloc_t* zone_malloc_init(void* base_ptr, int _max_segment, size_t _unit_s
     head->status = SEGMENT_EMPTY;
     head->nb_units = _max_segment;
     head->nb_prev  = 1; /**< This is to force SEGMENT_OF_TID( 0 - prev ) to return NULL */
+    zone_insert_free(gdata, 0);
 
     return gdata;
 }
@@ -71,53 +181,47 @@ void* zone_malloc_fini(zone_malloc_t** gdata)
 void *zone_malloc(zone_malloc_t *gdata, size_t size)
 {
     segment_t *current_segment, *next_segment, *new_segment;
-    int next_tid, current_tid, new_tid;
-    int cycled_through = 0, nb_units;
+    int current_tid, new_tid, fl, sl;
+    int64_t nb_units;
 
-    /* Let's start with the last remembered free slot */
-    current_tid = gdata->next_tid;
     nb_units = (size + gdata->unit_size - 1) / gdata->unit_size;
+    if( 0 == nb_units )
+        nb_units = 1;
+    if( nb_units > gdata->max_segment )
+        return NULL;
 
-    do {
-        current_segment = SEGMENT_AT_TID(gdata, current_tid);
-        if( NULL == current_segment ) {
-            /* Maybe there is a free slot in the beginning. Let's cycle at least once before we bail out */
-            if( cycled_through == 0 ) {
-                current_tid = 0;
-                cycled_through = 1;
-                current_segment = SEGMENT_AT_TID(gdata, current_tid);
-            } else {
-                return NULL;
-            }
-        }
-
-        if( current_segment->status == SEGMENT_EMPTY && current_segment->nb_units >= nb_units ) {
-            current_segment->status = SEGMENT_FULL;
-            if( current_segment->nb_units > nb_units ) {
-                next_tid = current_tid + current_segment->nb_units;
-
-                next_segment = SEGMENT_AT_TID(gdata, next_tid);
-                if( NULL != next_segment )
-                    next_segment->nb_prev -= nb_units;
-
-                new_tid = current_tid + nb_units;
-                new_segment = SEGMENT_AT_TID(gdata, new_tid);
-                new_segment->status = SEGMENT_EMPTY;
-                new_segment->nb_prev  = nb_units;
-                new_segment->nb_units = current_segment->nb_units - nb_units;
-
-                /* new_tid is a free slot, remember for next malloc */
-                gdata->next_tid = new_tid;
-
-                current_segment->nb_units = nb_units;
-            }
-            return (void*)(gdata->base + (current_tid * gdata->unit_size));
-        }
-
-        current_tid += current_segment->nb_units;
-    } while( current_tid != gdata->next_tid );
+    current_tid = zone_find_suitable(gdata, nb_units);
+    if( current_tid < 0 ) {
+        /* No class is guaranteed to fit, but the class of the request may
+         * still hold a segment large enough. */
+        zone_mapping(nb_units, &fl, &sl);
+        for(current_tid = gdata->free_heads[fl][sl];
+            (current_tid >= 0) && (gdata->segments[current_tid].nb_units < nb_units);
+            current_tid = gdata->segments[current_tid].next_free);
+        if( current_tid < 0 )
+            return NULL;
+    }
 
-    return NULL;
+    current_segment = SEGMENT_AT_TID(gdata, current_tid);
+    assert(SEGMENT_EMPTY == current_segment->status && current_segment->nb_units >= nb_units);
+    zone_remove_free(gdata, current_tid);
+    current_segment->status = SEGMENT_FULL;
+    if( current_segment->nb_units > nb_units ) {
+        /* Give the tail back to the free lists */
+        new_tid = current_tid + (int)nb_units;
+        new_segment = SEGMENT_AT_TID(gdata, new_tid);
+        new_segment->nb_prev  = (int32_t)nb_units;
+        new_segment->nb_units = current_segment->nb_units - (int32_t)nb_units;
+
+        next_segment = SEGMENT_AT_TID(gdata, current_tid + current_segment->nb_units);
+        if( NULL != next_segment )
+            next_segment->nb_prev = new_segment->nb_units;
+
+        current_segment->nb_units = (int32_t)nb_units;
+        zone_insert_free(gdata, new_tid);
+    }
+    gdata->units_in_use += current_segment->nb_units;
+    return (void*)(gdata->base + (current_tid * gdata->unit_size));
 }
 
 void zone_free(zone_malloc_t *gdata, void *add)
@@ -136,12 +240,12 @@ void zone_free(zone_malloc_t *gdata, void *add)
         return;
     }
 
-    if( SEGMENT_EMPTY == current_segment->status ) {
+    if( SEGMENT_FULL != current_segment->status ) {
         zone_malloc_error("double free (or other buffer overflow) error in ZONE allocation");
         return;
     }
 
-    current_segment->status = SEGMENT_EMPTY;
+    gdata->units_in_use -= current_segment->nb_units;
 
     prev_tid = current_tid - current_segment->nb_prev;
     prev_segment = SEGMENT_AT_TID(gdata, prev_tid);
@@ -151,72 +255,73 @@ void zone_free(zone_malloc_t *gdata, void *add)
 
     if( NULL != prev_segment && prev_segment->status == SEGMENT_EMPTY ) {
         /* We can merge prev and current */
-        if( NULL != next_segment ) {
-            next_segment->nb_prev += prev_segment->nb_units;
-        }
+        zone_remove_free(gdata, prev_tid);
         prev_segment->nb_units += current_segment->nb_units;
+#if defined(PARSEC_DEBUG)
+        current_segment->status = SEGMENT_UNDEFINED;
+#endif /* defined(PARSEC_DEBUG) */
 
         /* Pretend we are now our prev, so that we merge with next if needed */
         current_segment = prev_segment;
         current_tid     = prev_tid;
     }
 
-    /* current_tid is a free slot, remember for next malloc */
-    gdata->next_tid = current_tid;
-
     if( NULL != next_segment && next_segment->status == SEGMENT_EMPTY ) {
         /* We can merge current and next */
-        next_tid += next_segment->nb_units;
+        zone_remove_free(gdata, next_tid);
         current_segment->nb_units += next_segment->nb_units;
-        next_segment = SEGMENT_AT_TID(gdata, next_tid);
-        if( NULL != next_segment ) {
-            next_segment->nb_prev = current_segment->nb_units;
-        }
+#if defined(PARSEC_DEBUG)
+        next_segment->status = SEGMENT_UNDEFINED;
+#endif /* defined(PARSEC_DEBUG) */
     }
+
+    next_segment = SEGMENT_AT_TID(gdata, current_tid + current_segment->nb_units);
+    if( NULL != next_segment ) {
+        next_segment->nb_prev = current_segment->nb_units;
+    }
+    zone_insert_free(gdata, current_tid);
 }
 
 size_t zone_in_use(zone_malloc_t *gdata)
 {
-    size_t ret = 0;
-    segment_t *current_segment;
-    int current_tid;
-    for(current_tid = 0;
-        (current_segment = SEGMENT_AT_TID(gdata, current_tid)) != NULL;
-        current_tid += current_segment->nb_units) {
-        if( current_segment->status == SEGMENT_FULL ) {
-            ret += gdata->unit_size * current_segment->nb_units;
-        }
-    }
-    return ret;
+    return gdata->unit_size * (size_t)gdata->units_in_use;
 }
 
 
 size_t zone_debug(zone_malloc_t *gdata, int level, int output_id, const char *prefix)
 {
     segment_t *current_segment;
-    int current_tid;
-    size_t ret = 0;
+    int current_tid, nb_free = 0;
+    size_t ret = 0, largest = 0;
 
     for(current_tid = 0;
         (current_segment = SEGMENT_AT_TID(gdata, current_tid)) != NULL;
         current_tid += current_segment->nb_units) {
         if( current_segment->status == SEGMENT_EMPTY ) {
             ret += gdata->unit_size * current_segment->nb_units;
+            if( gdata->unit_size * current_segment->nb_units > largest )
+                largest = gdata->unit_size * current_segment->nb_units;
+            nb_free++;
             if( NULL != prefix )
-                parsec_debug_verbose(level, output_id, "%sfree: %d units (%d bytes) from %p to %p",
+                parsec_debug_verbose(level, output_id, "%sfree: %d units (%zu bytes) from %p to %p",
                                      prefix,
                                      current_segment->nb_units, gdata->unit_size*current_segment->nb_units,
                                      gdata->base + current_tid * gdata->unit_size,
                                      gdata->base + (current_tid+current_segment->nb_units) * gdata->unit_size - 1);
         } else {
             if( NULL != prefix )
-                parsec_debug_verbose(level, output_id, "%sused: %d units (%d bytes) from %p to %p",
+                parsec_debug_verbose(level, output_id, "%sused: %d units (%zu bytes) from %p to %p",
                                      prefix,
                                      current_segment->nb_units, gdata->unit_size*current_segment->nb_units,
                                      gdata->base + current_tid * gdata->unit_size,
                                      gdata->base + (current_tid+current_segment->nb_units) * gdata->unit_size - 1);
         }
     }
+    if( NULL != prefix )
+        parsec_debug_verbose(level, output_id, "%sfragmentation: %d free segments, %zu bytes free, largest %zu bytes (%.1f%% of the free memory is fragmented), %zu bytes used",
+                             prefix, nb_free, ret, largest,
+                             (0 == ret) ? 0.0 : 100.0 * (1.0 - (double)largest / (double)ret),
+                             zone_in_use(gdata));
 
     return ret;
 }
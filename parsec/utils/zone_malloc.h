@@ -10,6 +10,7 @@
 #include "parsec/parsec_config.h"
 
 #include <stdlib.h>
+#include <stdint.h>
 #include <assert.h>
 
 BEGIN_C_DECLS
@@ -18,10 +19,23 @@ BEGIN_C_DECLS
 #define SEGMENT_FULL       2
 #define SEGMENT_UNDEFINED  3
 
+/**
+ * Free segments are kept in segregated lists, indexed by a two-level size
+ * class (TLSF): the first level is the power of two of the number of
+ * units, the second level splits each power of two in ZONE_SL_COUNT
+ * linear ranges. Segments of less than ZONE_SL_COUNT units all fall in
+ * the first level 0, one class per size.
+ */
+#define ZONE_SL_LOG2       4
+#define ZONE_SL_COUNT      (1 << ZONE_SL_LOG2)
+#define ZONE_FL_COUNT      (32 - ZONE_SL_LOG2)
+
 typedef struct segment {
     int status;     /* True if this segment is full, false if it is free */
     int32_t nb_units;   /* Number of units on this segment */
     int32_t nb_prev;    /* Number of units on the segment before */
+    int32_t next_free;  /* Next free segment in the same size class, -1 if none */
+    int32_t prev_free;  /* Previous free segment in the same size class, -1 if none */
 } segment_t;
 
 typedef struct zone_malloc_s {
@@ -29,7 +43,10 @@ typedef struct zone_malloc_s {
     segment_t *segments;             /* Array of available segments */
     size_t     unit_size;            /* Basic Unit                */
     int        max_segment;          /* Maximum number of segment */
-    int        next_tid;             /* Next TID to look at for a malloc */
+    int32_t    units_in_use;         /* Number of units in allocated segments */
+    uint32_t   fl_bitmap;            /* First levels with at least one free segment */
+    uint32_t   sl_bitmap[ZONE_FL_COUNT];  /* Non-empty second levels of each first level */
+    int32_t    free_heads[ZONE_FL_COUNT][ZONE_SL_COUNT];  /* TID of the first free segment of each class */
 } zone_malloc_t;
 
 
@@ -46,8 +63,10 @@ zone_malloc_t* zone_malloc_init(void* base_ptr, int _max_segment, size_t _unit_s
 void* zone_malloc_fini(zone_malloc_t** gdata);
 
 /**
- * Allocate a memory area of length size bytes. In worst case the search is linear
- * with the number of existing allocations.
+ * Allocate a memory area of length size bytes. The search is done in
+ * constant time, in the free lists of the size classes large enough to
+ * hold the request. When none of them is populated, only the list of the
+ * class of the request is walked before giving up.
  */
 void *zone_malloc(zone_malloc_t *gdata, size_t size);
 
@@ -58,13 +77,15 @@ void *zone_malloc(zone_malloc_t *gdata, size_t size);
 void zone_free(zone_malloc_t *gdata, void *add);
 
 /**
- * Computes how much memory is in use
+ * Computes how much memory is in use, in constant time
  */
 size_t zone_in_use(zone_malloc_t *gdata);
 
 /**
- * Prints information on the amount of available blocks
- * Do not print anything if prefix is NULL
+ * Prints information on the amount of available blocks, followed by a
+ * fragmentation report: the number of free segments, the largest one and
+ * the fraction of the free memory that is not in the largest segment.
+ * Do not print anything if prefix is NULL. Returns the amount of free memory.
  */
 size_t zone_debug(zone_malloc_t *gdata, int level, int output_id, const char *prefix);
 
@@ -8,6 +8,11 @@ if(MPI_Fortran_FOUND AND CMAKE_Fortran_COMPILER_WORKS AND CMAKE_Fortran_COMPILER
 endif()
 
 parsec_addtest_cmd(api/compose ${SHM_TEST_CMD_LIST} api/compose)
+parsec_addtest_cmd(api/elastic ${SHM_TEST_CMD_LIST} api/elastic)
+# Every scheduler must run the tasks queued on the retired threads
+foreach(_sched ${MCA_sched})
+  parsec_addtest_cmd(api/elastic:${_sched} ${SHM_TEST_CMD_LIST} api/elastic -- --mca mca_sched ${_sched})
+endforeach()
 
 if( MPI_C_FOUND )
   parsec_addtest_cmd(api/init_fini:mp ${MPI_TEST_CMD_LIST} 4 api/init_fini)
@@ -0,0 +1,165 @@
+/*
+ * Copyright (c) 2023      The University of Tennessee and The University
+ *                         of Tennessee Research Foundation.  All rights
+ *                         reserved.
+ */
+
+#include "parsec.h"
+#include "parsec/execution_stream.h"
+#include "parsec/data_dist/matrix/two_dim_rectangle_cyclic.h"
+#include <string.h>
+
+#define TYPE  PARSEC_MATRIX_INTEGER
+
+static parsec_matrix_block_cyclic_t dcA;
+static int N = 1000;
+static int block = 10;
+static int32_t executed_by_retired = 0;
+static int32_t nb_executed = 0;
+static int32_t shrink_at = -1;
+static int shrink_queued = 0;
+static int nb_active = 0;
+
+static int
+parsec_operator_check_active( struct parsec_execution_stream_s *es,
+                              const void* src,
+                              void* dst,
+                              void* op_data, ... )
+{
+    int32_t nb = parsec_atomic_fetch_inc_int32(&nb_executed);
+
+    if( es->th_id >= es->virtual_process->nb_active_cores )
+        (void)parsec_atomic_fetch_inc_int32(&executed_by_retired);
+    if( nb == shrink_at ) {
+        /* retire half of the streams while tasks are running */
+        nb_active = parsec_context_set_active_cores(es->virtual_process->parsec_context, nb_active / 2);
+    }
+    (void)src; (void)dst; (void)op_data;
+    return PARSEC_HOOK_RETURN_DONE;
+}
+
+static int run(parsec_context_t* parsec, const char* name)
+{
+    parsec_taskpool_t *tp;
+    int rc;
+
+    nb_executed = 0;
+    executed_by_retired = 0;
+    tp = parsec_map_operator_New((parsec_tiled_matrix_t*)&dcA,
+                                 NULL,
+                                 parsec_operator_check_active,
+                                 (void*)name);
+    rc = parsec_context_add_taskpool(parsec, tp);
+    PARSEC_CHECK_ERROR(rc, "parsec_context_add_taskpool");
+    if( shrink_queued ) {
+        /* The startup tasks are queued on every thread: retire all but one
+         * thread per VP before they run, the others must steal them */
+        nb_active = parsec_context_set_active_cores(parsec, 1);
+    }
+    rc = parsec_context_start(parsec);
+    PARSEC_CHECK_ERROR(rc, "parsec_context_start");
+    rc = parsec_context_wait(parsec);
+    PARSEC_CHECK_ERROR(rc, "parsec_context_wait");
+    parsec_taskpool_free(tp);
+
+    printf("%s: %d tasks executed with %d active threads out of %d (%d by retired threads)\n",
+           name, nb_executed, parsec_context_query(parsec, PARSEC_CONTEXT_QUERY_ACTIVE_CORES),
+           parsec_context_query(parsec, PARSEC_CONTEXT_QUERY_CORES), executed_by_retired);
+    if( nb_executed != dcA.super.mt * dcA.super.nt ) {
+        fprintf(stderr, "%s: expected %d tasks, %d were executed\n",
+                name, dcA.super.mt * dcA.super.nt, nb_executed);
+        return 1;
+    }
+    return 0;
+}
+
+int main(int argc, char* argv[])
+{
+    parsec_context_t* parsec;
+    int nodes, rank, i, nb_cores, ret = 0;
+
+#if defined(PARSEC_HAVE_MPI)
+    MPI_Init_thread(&argc, &argv, MPI_THREAD_SERIALIZED, &nodes);
+    MPI_Comm_size(MPI_COMM_WORLD, &nodes);
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+#else
+    nodes = 1;
+    rank = 0;
+#endif
+
+    int pargc = 0; char **pargv = NULL;
+    for( i = 1; i < argc; i++) {
+        if( 0 == strncmp(argv[i], "--", 3) ) {
+            pargc = argc - i;
+            pargv = argv + i;
+            break;
+        }
+        if( 0 == strncmp(argv[i], "-n=", 3) ) {
+            N = strtol(argv[i]+3, NULL, 10);
+            if( 0 >= N ) N = 1000;
+            continue;
+        }
+        if( 0 == strncmp(argv[i], "-h", 2) ) {
+            printf("-h: help\n"
+                   "-n=<nb> the number of elements on a dimension\n");
+            exit(0);
+        }
+    }
+
+    parsec = parsec_init(4, &pargc, &pargv);
+    assert( NULL != parsec );
+    nb_cores = parsec_context_query(parsec, PARSEC_CONTEXT_QUERY_CORES);
+
+    /* One column per thread: the startup queues a task on each of them */
+    parsec_matrix_block_cyclic_init( &dcA, TYPE, PARSEC_MATRIX_TILE,
+                               rank,
+                               block, 1, N, nb_cores,
+                               0, 0, N, nb_cores, nodes, 1, 1, 1, 0, 0);
+    parsec_data_collection_set_key(&dcA.super.super, "A");
+    dcA.mat = parsec_data_allocate( N * nb_cores * parsec_datadist_getsizeoftype(TYPE) );
+    for( int i = 0; i < N * nb_cores; ((int*)dcA.mat)[i++] = 1);
+
+    /* Retire all but one thread per VP: no task can run on a retired thread */
+    nb_active = parsec_context_set_active_cores(parsec, 1);
+    if( nb_active != parsec->nb_vp ) {
+        fprintf(stderr, "expected %d active threads, found %d\n", parsec->nb_vp, nb_active);
+        ret = 1;
+    }
+    ret |= run(parsec, "shrunk");
+    if( 0 != executed_by_retired ) {
+        fprintf(stderr, "shrunk: %d tasks were executed by retired threads\n", executed_by_retired);
+        ret = 1;
+    }
+
+    /* Reclaim all the threads */
+    nb_active = parsec_context_set_active_cores(parsec, 0);
+    if( nb_active != nb_cores ) {
+        fprintf(stderr, "expected %d active threads, found %d\n", nb_cores, nb_active);
+        ret = 1;
+    }
+    ret |= run(parsec, "grown");
+
+    /* Shrink while the tasks are executing, then grow back */
+    shrink_at = (dcA.super.mt * dcA.super.nt) / 2;
+    ret |= run(parsec, "shrunk while running");
+    shrink_at = -1;
+    nb_active = parsec_context_set_active_cores(parsec, nb_cores);
+    ret |= run(parsec, "grown again");
+
+    /* Shrink while the startup tasks are queued on the retired threads */
+    shrink_queued = 1;
+    ret |= run(parsec, "shrunk while queued");
+    if( 0 != executed_by_retired ) {
+        fprintf(stderr, "shrunk while queued: %d tasks were executed by retired threads\n", executed_by_retired);
+        ret = 1;
+    }
+
+    parsec_fini(&parsec);
+
+    free(dcA.mat);
+
+#ifdef PARSEC_HAVE_MPI
+    MPI_Finalize();
+#endif
+    return ret;
+}
@@ -0,0 +1,3 @@
+parsec_addtest_cmd(apps/generalized_reduction ${SHM_TEST_CMD_LIST} apps/generalized_reduction/BT_reduction 10000)
+# Same run with hash table data repositories, to compare with the directly indexed ones
+parsec_addtest_cmd(apps/generalized_reduction:hashrepo ${SHM_TEST_CMD_LIST} apps/generalized_reduction/BT_reduction 10000 -- --mca datarepo_dense_max_keys 0)
@@ -1,7 +1,10 @@
 parsec_addtest_cmd(apps/haar_tree ${SHM_TEST_CMD_LIST} apps/haar_tree/project -x)
 if( MPI_C_FOUND )
   parsec_addtest_cmd(apps/haar_tree:mp ${MPI_TEST_CMD_LIST} 4 apps/haar_tree/project -x)
+  # One activation per message, and aggregated activations sent as soon as the comm thread looks at them
+  parsec_addtest_cmd(apps/haar_tree:mp:noaggregate ${MPI_TEST_CMD_LIST} 4 apps/haar_tree/project -x -- --mca runtime_comm_aggregate 0)
+  parsec_addtest_cmd(apps/haar_tree:mp:aggregate_timeout ${MPI_TEST_CMD_LIST} 4 apps/haar_tree/project -x -- --mca runtime_comm_aggregate_timeout 0)
   if(TEST apps/haar_tree:mp)
-    set_tests_properties(apps/haar_tree:mp PROPERTIES DEPENDS launch:mp)
+    set_tests_properties(apps/haar_tree:mp apps/haar_tree:mp:noaggregate apps/haar_tree:mp:aggregate_timeout PROPERTIES DEPENDS launch:mp)
   endif()
 endif( MPI_C_FOUND )
@@ -0,0 +1,16 @@
+if( MPI_C_FOUND )
+  parsec_addtest_cmd(apps/pingpong:bw:mp ${MPI_TEST_CMD_LIST} 2 apps/pingpong/bw_test -n 10 -f 8 -l 1048576)
+  # Same transfers without the shared memory engine, to compare with MPI for co-located ranks
+  parsec_addtest_cmd(apps/pingpong:bw:mpi ${MPI_TEST_CMD_LIST} 2 apps/pingpong/bw_test -n 10 -f 8 -l 1048576 -- --mca comm_shm_enable 0)
+  # Broadcasts of large tiles, forwarded in fragments along the collective tree as they arrive
+  parsec_addtest_cmd(apps/pingpong:bcast:mp ${MPI_TEST_CMD_LIST} 4 apps/pingpong/bcast_test -n 10 -l 1048576 -- --mca runtime_comm_fragment_size 65536)
+  parsec_addtest_cmd(apps/pingpong:bcast:mpi ${MPI_TEST_CMD_LIST} 4 apps/pingpong/bcast_test -n 10 -l 1048576 -- --mca runtime_comm_fragment_size 65536 --mca comm_shm_enable 0)
+  parsec_addtest_cmd(apps/pingpong:bcast:nofrag ${MPI_TEST_CMD_LIST} 4 apps/pingpong/bcast_test -n 10 -l 1048576 -- --mca runtime_comm_fragment_size 0)
+  # Two-level broadcasts, with the processes grouped by pairs as if they were on different nodes
+  parsec_addtest_cmd(apps/pingpong:bcast:nodes ${MPI_TEST_CMD_LIST} 4 apps/pingpong/bcast_test -n 10 -l 1048576 -- --mca runtime_comm_coll_node_size 2 --mca runtime_comm_coll_bcast 2)
+  if(TEST apps/pingpong:bw:mp)
+    set_tests_properties(apps/pingpong:bw:mp apps/pingpong:bw:mpi
+                         apps/pingpong:bcast:mp apps/pingpong:bcast:mpi apps/pingpong:bcast:nofrag apps/pingpong:bcast:nodes
+                         PROPERTIES DEPENDS launch:mp)
+  endif()
+endif( MPI_C_FOUND )
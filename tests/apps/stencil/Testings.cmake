@@ -5,3 +5,5 @@ if( MPI_C_FOUND )
     set_tests_properties(apps/stencil:mp PROPERTIES DEPENDS launch:mp)
   endif()
 endif( MPI_C_FOUND )
+# Same run with hash table data repositories, to compare with the directly indexed ones
+parsec_addtest_cmd(apps/stencil:hashrepo ${SHM_TEST_CMD_LIST} apps/stencil/testing_stencil_1D -t 100 -T 100 -N 1000 -M 1000 -I 10 -R 2 -m 1 -- --mca datarepo_dense_max_keys 0)
@@ -2,9 +2,18 @@ if(TARGET atomics)
   add_test(class/atomics ${SHM_TEST_CMD_LIST} class/atomics -c 4)
 endif()
 add_test(class/rwlock ${SHM_TEST_CMD_LIST} class/rwlock -c 4)
+add_test(class/rwlock:readers ${SHM_TEST_CMD_LIST} class/rwlock -m 0 -M 4 -R -w 1000)
 add_test(class/lifo ${SHM_TEST_CMD_LIST} class/lifo -c 4)
+add_test(class/fifo ${SHM_TEST_CMD_LIST} class/fifo -p 2 -c 2 -n 200000 -b 1024)
+add_test(class/wsdeque ${SHM_TEST_CMD_LIST} class/wsdeque -c 4)
 add_test(class/list ${SHM_TEST_CMD_LIST} class/list -c 4)
 add_test(class/hash ${SHM_TEST_CMD_LIST} class/hash -\# 65536 -r 4 -n)
+add_test(class/hash:scaling ${SHM_TEST_CMD_LIST} class/hash -c 4 -S -\# 65536 -r 2)
+add_test(class/mempool ${SHM_TEST_CMD_LIST} class/mempool -n 1000000 -w 4096)
+add_test(class/refcount ${SHM_TEST_CMD_LIST} class/refcount -c 4 -n 1000000)
+add_test(class/arena ${SHM_TEST_CMD_LIST} class/arena -n 4096 -r 16)
+add_test(class/zone_malloc ${SHM_TEST_CMD_LIST} class/zone_malloc -n 65536 -o 1000000)
+add_test(class/reg_cache ${SHM_TEST_CMD_LIST} class/reg_cache -n 1000000)
 add_test(class/future ${SHM_TEST_CMD_LIST} class/future -c 4)
 add_test(class/future_datacopy ${SHM_TEST_CMD_LIST} class/future_datacopy)
 
@@ -0,0 +1,155 @@
+/*
+ * Copyright (c) 2023      The University of Tennessee and The University
+ *                         of Tennessee Research Foundation.  All rights
+ *                         reserved.
+ */
+
+#include "parsec/runtime.h"
+#undef NDEBUG
+#include <stdarg.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <inttypes.h>
+#include <time.h>
+
+#include "parsec/arena.h"
+#include "parsec/data_internal.h"
+#include "parsec/utils/debug.h"
+#if defined(PARSEC_HAVE_MPI)
+#include <mpi.h>
+#endif  /* defined(PARSEC_HAVE_MPI) */
+
+/**
+ * Allocates NBELT copies from an arena backed by huge page slabs, releases
+ * them and allocates them again: every copy must be carved from a slab,
+ * and the second round must reuse the chunks of the first one. Then
+ * compares the time of the allocation rounds with a malloc backed arena.
+ */
+
+static unsigned int NBELT = 4096;
+static unsigned int ELTSIZE = 8192;
+static unsigned int ROUNDS = 16;
+
+static void fatal(const char *format, ...)
+{
+    va_list va;
+    va_start(va, format);
+    vprintf(format, va);
+    va_end(va);
+    raise(SIGABRT);
+}
+
+static double now(void)
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec / 1e9;
+}
+
+static double run(parsec_arena_t *arena, parsec_data_copy_t **copies)
+{
+    double start = now();
+    unsigned int r, i;
+    char *ptr;
+
+    for(r = 0; r < ROUNDS; r++) {
+        for(i = 0; i < NBELT; i++) {
+            copies[i] = parsec_arena_get_copy(arena, 1, 0, parsec_datatype_int8_t);
+            if( NULL == copies[i] )
+                fatal(" ! Error: allocation %u of round %u failed\n", i, r);
+            ptr = (char*)copies[i]->device_private;
+            if( (NULL == ptr) || (0 != ((uintptr_t)ptr % arena->alignment)) )
+                fatal(" ! Error: %p is not aligned on %zu bytes\n", ptr, arena->alignment);
+            memset(ptr, (int)i, ELTSIZE);
+        }
+        for(i = 0; i < NBELT; i++)
+            PARSEC_DATA_COPY_RELEASE(copies[i]);
+    }
+    return now() - start;
+}
+
+int main(int argc, char *argv[])
+{
+    parsec_context_t *parsec;
+    parsec_arena_t *arena;
+    parsec_arena_stats_t stats;
+    parsec_data_copy_t **copies;
+    double duration[2];
+    int ch, backing;
+
+    backing = PARSEC_ARENA_BACKING_THP;
+    while( (ch = getopt(argc, argv, "b:n:s:r:h")) != -1 ) {
+        switch(ch) {
+        case 'b':
+            backing = atoi(optarg);
+            break;
+        case 'n':
+            NBELT = atoi(optarg);
+            break;
+        case 's':
+            ELTSIZE = atoi(optarg);
+            break;
+        case 'r':
+            ROUNDS = atoi(optarg);
+            break;
+        case 'h':
+        default:
+            fprintf(stderr,
+                    "Usage: %s [-b backing] [-n NBELT] [-s ELTSIZE] [-r ROUNDS]\n"
+                    "   Allocates and releases ROUNDS times NBELT copies of ELTSIZE bytes (default %u, %u, %u)\n"
+                    "   from an arena with the given backing (default %d, transparent huge pages)\n",
+                    argv[0], ROUNDS, NBELT, ELTSIZE, backing);
+            exit(1);
+        }
+    }
+#if defined(PARSEC_HAVE_MPI)
+    {
+        int provided;
+        MPI_Init_thread(&argc, &argv, MPI_THREAD_SERIALIZED, &provided);
+    }
+#endif  /* defined(PARSEC_HAVE_MPI) */
+    parsec = parsec_init(1, NULL, NULL);
+    if( NULL == parsec )
+        fatal(" ! Error: parsec_init failed\n");
+    copies = (parsec_data_copy_t**)calloc(NBELT, sizeof(parsec_data_copy_t*));
+
+    arena = PARSEC_OBJ_NEW(parsec_arena_t);
+    parsec_arena_construct_ex(arena, ELTSIZE, PARSEC_ARENA_ALIGNMENT_CL1,
+                              SIZE_MAX, (size_t)NBELT * ELTSIZE);
+    duration[0] = run(arena, copies);
+    PARSEC_OBJ_RELEASE(arena);
+
+    arena = PARSEC_OBJ_NEW(parsec_arena_t);
+    parsec_arena_construct_ex(arena, ELTSIZE, PARSEC_ARENA_ALIGNMENT_CL1,
+                              SIZE_MAX, (size_t)NBELT * ELTSIZE);
+    if( PARSEC_SUCCESS != parsec_arena_set_backing(arena, backing) )
+        fatal(" ! Error: backing %d is not supported\n", backing);
+    duration[1] = run(arena, copies);
+
+    parsec_arena_get_stats(arena, &stats);
+    printf("malloc: %g s, backing %d: %g s for %u rounds of %u allocations of %u bytes\n"
+           "%"PRId64" chunks on huge pages, %"PRId64" chunks advised to use transparent huge pages, "
+           "%"PRId64" chunks on normal pages, %"PRId64" slabs (%"PRId64" bytes)\n",
+           duration[0], backing, duration[1], ROUNDS, NBELT, ELTSIZE,
+           stats.nb_hugepage_chunks, stats.nb_thp_chunks, stats.nb_fallback_chunks, stats.nb_slabs, stats.slab_bytes);
+    if( PARSEC_ARENA_BACKING_MALLOC != backing ) {
+        if( (stats.nb_hugepage_chunks + stats.nb_thp_chunks + stats.nb_fallback_chunks) != (int64_t)NBELT )
+            fatal(" ! Error: %"PRId64" chunks were allocated for %u copies in use at most\n",
+                  stats.nb_hugepage_chunks + stats.nb_thp_chunks + stats.nb_fallback_chunks, NBELT);
+        if( (0 == stats.nb_slabs) || (stats.slab_bytes < (int64_t)NBELT * ELTSIZE) )
+            fatal(" ! Error: %"PRId64" bytes in %"PRId64" slabs for %u copies of %u bytes\n",
+                  stats.slab_bytes, stats.nb_slabs, NBELT, ELTSIZE);
+        if( PARSEC_SUCCESS == parsec_arena_set_backing(arena, PARSEC_ARENA_BACKING_MALLOC) )
+            fatal(" ! Error: the backing of an arena in use was changed\n");
+    }
+    PARSEC_OBJ_RELEASE(arena);
+    free(copies);
+    parsec_fini(&parsec);
+#if defined(PARSEC_HAVE_MPI)
+    MPI_Finalize();
+#endif  /* defined(PARSEC_HAVE_MPI) */
+    return 0;
+}
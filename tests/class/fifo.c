@@ -0,0 +1,209 @@
+/*
+ * Copyright (c) 2023      The University of Tennessee and The University
+ *                         of Tennessee Research Foundation.  All rights
+ *                         reserved.
+ */
+
+#include "parsec/runtime.h"
+#undef NDEBUG
+#include <pthread.h>
+#include <sched.h>
+#include <stdarg.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <inttypes.h>
+#include <time.h>
+
+#include "parsec/class/fifo.h"
+#include "parsec/class/list.h"
+#include "parsec/sys/atomic.h"
+
+/**
+ * PRODUCERS threads push NBELT elements each in a queue, while CONSUMERS
+ * threads pop them. Every element must be popped exactly once, and each
+ * consumer must see the elements of a producer in the order they were
+ * pushed. The same run is timed on a locked list (the former FIFO), on
+ * the lock-free FIFO, and on the lock-free FIFO bounded to CAPACITY
+ * elements, whose memory must then stay bounded.
+ */
+
+static unsigned int PRODUCERS = 2;
+static unsigned int CONSUMERS = 2;
+static unsigned int NBELT = 1000000;
+static unsigned int CAPACITY = 1024;
+
+static void fatal(const char *format, ...)
+{
+    va_list va;
+    va_start(va, format);
+    vprintf(format, va);
+    va_end(va);
+    raise(SIGABRT);
+}
+
+static double now(void)
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec / 1e9;
+}
+
+typedef struct {
+    parsec_list_item_t list;
+    unsigned int       producer;
+    unsigned int       seq;
+} elt_t;
+
+static elt_t            *elts;
+static unsigned char    *seen;
+static parsec_list_t     list;
+static parsec_fifo_t     fifo;
+static int               use_fifo;
+static volatile int32_t  nb_popped;
+static pthread_barrier_t barrier;
+
+static void *producer(void *arg)
+{
+    unsigned int p = (unsigned int)(uintptr_t)arg, i;
+    elt_t *elt;
+
+    pthread_barrier_wait(&barrier);
+    for(i = 0; i < NBELT; i++) {
+        elt = &elts[p * NBELT + i];
+        if( use_fifo )
+            parsec_fifo_push(&fifo, &elt->list);
+        else
+            parsec_list_push_back(&list, &elt->list);
+    }
+    return NULL;
+}
+
+static void *consumer(void *arg)
+{
+    unsigned int *last = (unsigned int*)calloc(PRODUCERS, sizeof(unsigned int));
+    int32_t total = (int32_t)(PRODUCERS * NBELT);
+    elt_t *elt;
+    (void)arg;
+
+    pthread_barrier_wait(&barrier);
+    while( nb_popped < total ) {
+        elt = (elt_t*)(use_fifo ? parsec_fifo_pop(&fifo) : parsec_list_pop_front(&list));
+        if( NULL == elt ) {
+            sched_yield();
+            continue;
+        }
+        if( seen[elt->producer * NBELT + elt->seq]++ )
+            fatal(" ! Error: element %u of producer %u was popped twice\n", elt->seq, elt->producer);
+        /* last holds one more than the last element seen from each producer */
+        if( elt->seq < last[elt->producer] )
+            fatal(" ! Error: element %u of producer %u was popped after element %u\n",
+                  elt->seq, elt->producer, last[elt->producer] - 1);
+        last[elt->producer] = elt->seq + 1;
+        parsec_atomic_fetch_inc_int32(&nb_popped);
+    }
+    free(last);
+    return NULL;
+}
+
+static double run(int kind, size_t capacity, int *nb_segments)
+{
+    pthread_t *threads = (pthread_t*)malloc((PRODUCERS + CONSUMERS) * sizeof(pthread_t));
+    double start, duration;
+    unsigned int t, i;
+
+    use_fifo = kind;
+    nb_popped = 0;
+    memset(seen, 0, PRODUCERS * NBELT);
+    for(i = 0; i < PRODUCERS * NBELT; i++)
+        PARSEC_OBJ_CONSTRUCT(&elts[i].list, parsec_list_item_t);
+    if( use_fifo ) {
+        PARSEC_OBJ_CONSTRUCT(&fifo, parsec_fifo_t);
+        parsec_fifo_set_capacity(&fifo, capacity);
+    } else {
+        PARSEC_OBJ_CONSTRUCT(&list, parsec_list_t);
+    }
+
+    pthread_barrier_init(&barrier, NULL, PRODUCERS + CONSUMERS + 1);
+    for(t = 0; t < PRODUCERS; t++)
+        pthread_create(&threads[t], NULL, producer, (void*)(uintptr_t)t);
+    for(t = 0; t < CONSUMERS; t++)
+        pthread_create(&threads[PRODUCERS + t], NULL, consumer, NULL);
+    start = now();
+    pthread_barrier_wait(&barrier);
+    for(t = 0; t < PRODUCERS + CONSUMERS; t++)
+        pthread_join(threads[t], NULL);
+    duration = now() - start;
+    pthread_barrier_destroy(&barrier);
+
+    for(i = 0; i < PRODUCERS * NBELT; i++)
+        if( 1 != seen[i] )
+            fatal(" ! Error: element %u of producer %u was popped %d times\n", i % NBELT, i / NBELT, seen[i]);
+    if( use_fifo ) {
+        if( !parsec_fifo_is_empty(&fifo) || (NULL != parsec_fifo_pop(&fifo)) )
+            fatal(" ! Error: the FIFO is not empty after all elements were popped\n");
+        if( (0 != capacity) && (fifo.nb_segments > fifo.max_segments) )
+            fatal(" ! Error: %d segments were allocated for a FIFO bounded to %d segments\n",
+                  fifo.nb_segments, fifo.max_segments);
+        *nb_segments = fifo.nb_segments;
+        PARSEC_OBJ_DESTRUCT(&fifo);
+    } else {
+        *nb_segments = 0;
+        PARSEC_OBJ_DESTRUCT(&list);
+    }
+    free(threads);
+    return duration;
+}
+
+int main(int argc, char *argv[])
+{
+    static const char *names[] = { "locked list", "lock-free FIFO", "bounded lock-free FIFO" };
+    double duration;
+    int ch, kind, nb_segments;
+
+    while( (ch = getopt(argc, argv, "p:c:n:b:h")) != -1 ) {
+        switch(ch) {
+        case 'p':
+            PRODUCERS = atoi(optarg);
+            break;
+        case 'c':
+            CONSUMERS = atoi(optarg);
+            break;
+        case 'n':
+            NBELT = atoi(optarg);
+            break;
+        case 'b':
+            CAPACITY = atoi(optarg);
+            break;
+        case 'h':
+        default:
+            fprintf(stderr,
+                    "Usage: %s [-p PRODUCERS] [-c CONSUMERS] [-n NBELT] [-b CAPACITY]\n"
+                    "   PRODUCERS threads push NBELT elements each, CONSUMERS threads pop them (default %u, %u, %u)\n"
+                    "   on a locked list, a lock-free FIFO and a lock-free FIFO bounded to CAPACITY elements (default %u)\n",
+                    argv[0], PRODUCERS, CONSUMERS, NBELT, CAPACITY);
+            exit(1);
+        }
+    }
+    elts = (elt_t*)malloc(PRODUCERS * NBELT * sizeof(elt_t));
+    seen = (unsigned char*)malloc(PRODUCERS * NBELT);
+    for(unsigned int i = 0; i < PRODUCERS * NBELT; i++) {
+        elts[i].producer = i / NBELT;
+        elts[i].seq = i % NBELT;
+    }
+
+    for(kind = 0; kind < 3; kind++) {
+        duration = run(kind > 0, (2 == kind) ? CAPACITY : 0, &nb_segments);
+        printf("%-24s %u producers, %u consumers: %g s, %g Mop/s", names[kind],
+               PRODUCERS, CONSUMERS, duration, 2e-6 * PRODUCERS * NBELT / duration);
+        if( kind > 0 )
+            printf(", %d segments of %d elements", nb_segments, PARSEC_FIFO_SEGMENT_SIZE);
+        printf("\n");
+    }
+
+    free(elts);
+    free(seen);
+    return 0;
+}
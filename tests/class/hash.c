@@ -115,6 +115,98 @@ static void *do_perf_test(void *_param)
     return (void*)(uintptr_t)max_duration;
 }
 
+static double scaling_phase_time[3];
+static int32_t scaling_errors = 0;
+static const char *scaling_phase_name[3] = { "insert", "find", "remove" };
+
+static double scaling_now(void)
+{
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec + tv.tv_usec * 1e-6;
+}
+
+/**
+ * All threads insert their keys at once into a table that starts with 8
+ * buckets, so the table is resized (and migrated) many times while it is
+ * being filled; then they find and remove all their keys. Thread 0 reports
+ * the throughput of each phase and the number of resizes, and each thread
+ * returns the longest time it spent in a single insertion: with the
+ * incremental resize, no insertion waits for the whole table to be copied.
+ */
+static void *do_scaling_test(void *_param)
+{
+    param_t *param = (param_t*)_param;
+    int id = param->id;
+    int nbthreads = param->nbthreads;
+    int nbtests = param->nb_tests / nbthreads + (id < (param->nb_tests % nbthreads));
+    parsec_time_t t0, t1;
+    uint64_t duration, max_duration = 0;
+    empty_hash_item_t *item_array;
+    double start = 0.0;
+    int l, t, phase;
+    void *rc;
+
+    parsec_bindthread(id%nbcores, 0);
+
+    item_array = malloc(sizeof(empty_hash_item_t)*nbtests);
+    for(t = 0; t < nbtests; t++) {
+        item_array[t].ht_item.key = param->keys[nbthreads * t + id];
+        item_array[t].thread_id = id;
+        item_array[t].nbthreads = nbthreads;
+        item_array[t].thread_key = nbthreads * t + id;
+    }
+    if( 0 == id )
+        memset(scaling_phase_time, 0, sizeof(scaling_phase_time));
+
+    for(l = 0; l < param->nb_loops; l++) {
+        if( 0 == id ) {
+            parsec_hash_table_init(&hash_table, offsetof(empty_hash_item_t, ht_item), 3, key_functions, NULL);
+        }
+        for(phase = 0; phase < 3; phase++) {
+            parsec_barrier_wait(&barrier1);
+            if( 0 == id ) start = scaling_now();
+            for(t = 0; t < nbtests; t++) {
+                if( 0 == phase ) {
+                    t0 = take_time();
+                    parsec_hash_table_insert(&hash_table, &item_array[t].ht_item);
+                    t1 = take_time();
+                    duration = diff_time(t0, t1);
+                    if(duration > max_duration)
+                        max_duration = duration;
+                    continue;
+                }
+                if( 1 == phase ) {
+                    rc = parsec_hash_table_find(&hash_table, item_array[t].ht_item.key);
+                } else {
+                    rc = parsec_hash_table_remove(&hash_table, item_array[t].ht_item.key);
+                }
+                if( rc != &item_array[t] ) {
+                    fprintf(stderr, "Error in implementation of the hash table: item with key %"PRIu64" is not to be found during the %s phase\n",
+                            (uint64_t)item_array[t].ht_item.key, scaling_phase_name[phase]);
+                    parsec_atomic_fetch_inc_int32(&scaling_errors);
+                }
+            }
+            parsec_barrier_wait(&barrier1);
+            if( 0 == id ) scaling_phase_time[phase] += scaling_now() - start;
+        }
+        if( 0 == id ) {
+            if( l == param->nb_loops-1 ) {
+                printf("%d threads, %d items: %d resizes", nbthreads, param->nb_tests, hash_table.nb_resizes);
+                for(phase = 0; phase < 3; phase++)
+                    printf(", %s %.3g ops/s", scaling_phase_name[phase],
+                           (double)param->nb_tests * param->nb_loops / scaling_phase_time[phase]);
+                printf("\n");
+            }
+            parsec_hash_table_fini(&hash_table);
+        }
+    }
+    parsec_barrier_wait(&barrier2);
+    free(item_array);
+
+    return (void*)(uintptr_t)max_duration;
+}
+
 static void *do_test(void *_param)
 {
     param_t *param = (param_t*)_param;
@@ -406,6 +498,7 @@ int main(int argc, char *argv[])
     int md_tuning_inc = 1;
     int md_tuning;
     int simple_perf = 0;
+    int scaling_perf = 0;
     bool use_handle = 0;
     int nb_tests = 30000;
     int nb_loops = 300;
@@ -429,7 +522,7 @@ int main(int argc, char *argv[])
         fprintf(stderr, "Warning: unable to find the hash table hint, tuning behavior will be disabled\n");
     }
 
-    while( (ch = getopt(argc, argv, "c:m:M:t:T:i:d:D:I:#:s:r:3hnpH?")) != -1 ) {
+    while( (ch = getopt(argc, argv, "c:m:M:t:T:i:d:D:I:#:s:r:3hnpSH?")) != -1 ) {
         switch(ch) {
         case 'c':
             ch = strtol(optarg, &m, 0);
@@ -522,6 +615,9 @@ int main(int argc, char *argv[])
         case 'p':
             simple_perf = 1;
             break;
+        case 'S':
+            scaling_perf = 1;
+            break;
         case 'H':
             use_handle = true;
             break;
@@ -537,6 +633,7 @@ int main(int argc, char *argv[])
                     "          [-d max_table_depth_min -D max_table_depth_max -I max_table_depth_inc]\n"
                     "          [-# number of items to insert][-r number of loops of the test][-n use a new hash table for each test]\n"
                     "          [-p (run simple performance test)]\n"
+                    "          [-S (run concurrent insert/find/remove scaling test, with resizes)]\n"
                     "          [-s key generator seed (default: -1, random)]\n"
                     "          [-3 use structured 3D key space instead of random keys (false)]\n"
                     "          [-H (use key handles for locking buckets)]\n", argv[0]);
@@ -630,6 +727,11 @@ int main(int argc, char *argv[])
                         pthread_create(&threads[e], NULL, do_perf_test, &params[e]);
                     }
                     maxtime = (uint64_t)do_perf_test(&params[nbthreads]);
+                } else if( scaling_perf ) {
+                    for(e = 0; e < nbthreads; e++) {
+                        pthread_create(&threads[e], NULL, do_scaling_test, &params[e]);
+                    }
+                    maxtime = (uint64_t)do_scaling_test(&params[nbthreads]);
                 } else {
                     for(e = 0; e < nbthreads; e++) {
                         pthread_create(&threads[e], NULL, do_test, &params[e]);
@@ -643,8 +745,12 @@ int main(int argc, char *argv[])
                 }
                 parsec_barrier_destroy(&barrier1);
                 parsec_barrier_destroy(&barrier2);
-                printf("%lu threads %"PRIu64" "TIMER_UNIT" max_coll %d max_table_depth %d\n",
-                       (long)(nbthreads+1), maxtime, mc_tuning, md_tuning);
+                if( scaling_perf )
+                    printf("%lu threads longest insertion %"PRIu64" "TIMER_UNIT" max_coll %d max_table_depth %d\n",
+                           (long)(nbthreads+1), maxtime, mc_tuning, md_tuning);
+                else
+                    printf("%lu threads %"PRIu64" "TIMER_UNIT" max_coll %d max_table_depth %d\n",
+                           (long)(nbthreads+1), maxtime, mc_tuning, md_tuning);
                 fflush(stdout);
             }
         }
@@ -652,4 +758,5 @@ int main(int argc, char *argv[])
     free(threads);
     free(keys);
     free(params);
+    return (0 == scaling_errors) ? 0 : 1;
 }
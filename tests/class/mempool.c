@@ -0,0 +1,177 @@
+/*
+ * Copyright (c) 2023      The University of Tennessee and The University
+ *                         of Tennessee Research Foundation.  All rights
+ *                         reserved.
+ */
+
+#include "parsec/runtime.h"
+#undef NDEBUG
+#include <pthread.h>
+#include <stdarg.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <inttypes.h>
+#include <time.h>
+
+#include "parsec/mempool.h"
+#include "parsec/class/lifo.h"
+#include "parsec/sys/atomic.h"
+
+/**
+ * A producer thread allocates elements that a consumer thread frees, with
+ * at most WINDOW elements in flight. The elements freed by the consumer
+ * must come back to the producer through the depot, so the memory used by
+ * the mempool must stay bounded by the window and the caches, whatever the
+ * number of elements that go through it. Then more threads than
+ * PARSEC_MEMPOOL_MAX_CACHES run one after the other: each must get the
+ * caches of the threads that exited before it.
+ */
+
+static unsigned int NBELT = 1000000;
+static unsigned int WINDOW = 4096;
+
+static void fatal(const char *format, ...)
+{
+    va_list va;
+    va_start(va, format);
+    vprintf(format, va);
+    va_end(va);
+    raise(SIGABRT);
+}
+
+typedef struct {
+    parsec_list_item_t       list;
+    parsec_thread_mempool_t *owner;
+    unsigned int             value;
+} elt_t;
+
+static parsec_mempool_t mempool;
+static parsec_lifo_t    handoff;
+static volatile int32_t in_flight = 0;
+
+static void *producer(void *_)
+{
+    unsigned int i;
+    elt_t *elt;
+
+    for(i = 0; i < NBELT; i++) {
+        while( in_flight >= (int32_t)WINDOW ) sched_yield();
+        elt = (elt_t*)parsec_thread_mempool_allocate(&mempool.thread_mempools[0]);
+        if( elt->owner != &mempool.thread_mempools[0] )
+            fatal(" ! Error: element %p has no owner\n", elt);
+        elt->value = i;
+        parsec_atomic_fetch_inc_int32(&in_flight);
+        parsec_lifo_push(&handoff, &elt->list);
+    }
+    return _;
+}
+
+static void *consumer(void *_)
+{
+    unsigned int i;
+    elt_t *elt;
+
+    for(i = 0; i < NBELT; i++) {
+        while( NULL == (elt = (elt_t*)parsec_lifo_pop(&handoff)) ) sched_yield();
+        if( elt->value >= NBELT )
+            fatal(" ! Error: element %p is corrupt (value %u)\n", elt, elt->value);
+        elt->value = NBELT;
+        parsec_atomic_fetch_dec_int32(&in_flight);
+        parsec_mempool_free(&mempool, elt);
+    }
+    return _;
+}
+
+/* Frees an element and allocates it again from the caches of the thread */
+static void *short_lived(void *_)
+{
+    elt_t *elt = (elt_t*)parsec_thread_mempool_allocate(&mempool.thread_mempools[0]);
+    parsec_mempool_free(&mempool, elt);
+    elt = (elt_t*)parsec_thread_mempool_allocate(&mempool.thread_mempools[0]);
+    parsec_mempool_free(&mempool, elt);
+    return _;
+}
+
+int main(int argc, char *argv[])
+{
+    pthread_t threads[2];
+    parsec_mempool_stats_t stats;
+    struct timespec start, end;
+    uint64_t live, bound, trimmed, hits;
+    double duration;
+    int ch;
+
+    while( (ch = getopt(argc, argv, "n:w:h")) != -1 ) {
+        switch(ch) {
+        case 'n':
+            NBELT = atoi(optarg);
+            break;
+        case 'w':
+            WINDOW = atoi(optarg);
+            break;
+        case 'h':
+        default:
+            fprintf(stderr,
+                    "Usage: %s [-n NBELT] [-w WINDOW]\n"
+                    "   NBELT elements go from a producer thread to a consumer thread (default %u)\n"
+                    "   with at most WINDOW elements in flight (default %u)\n",
+                    argv[0], NBELT, WINDOW);
+            exit(1);
+        }
+    }
+
+    parsec_mempool_construct(&mempool, PARSEC_OBJ_CLASS(parsec_list_item_t), sizeof(elt_t),
+                             offsetof(elt_t, owner), 1);
+    PARSEC_OBJ_CONSTRUCT(&handoff, parsec_lifo_t);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    pthread_create(&threads[0], NULL, producer, NULL);
+    pthread_create(&threads[1], NULL, consumer, NULL);
+    pthread_join(threads[0], NULL);
+    pthread_join(threads[1], NULL);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    duration = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+
+    parsec_mempool_get_stats(&mempool, &stats);
+    live = stats.nb_allocated - stats.nb_released;
+    printf("%u elements in %g s (%g elements/s)\n"
+           "%"PRIu64" allocated, %"PRIu64" released, %"PRIu64" in caches, %"PRIu64" in depot\n"
+           "%"PRIu64" cache hits, %"PRIu64" depot puts, %"PRIu64" depot gets\n",
+           NBELT, duration, NBELT / duration,
+           stats.nb_allocated, stats.nb_released, stats.nb_in_caches, stats.nb_in_depot,
+           stats.nb_cache_hits, stats.nb_depot_puts, stats.nb_depot_gets);
+
+    /* The window, and the two magazines of each thread */
+    bound = WINDOW + 2 * 2 * PARSEC_MEMPOOL_MAGAZINE_SIZE;
+    if( live > bound )
+        fatal(" ! Error: %"PRIu64" elements are used by the mempool, more than %"PRIu64"\n", live, bound);
+    if( (NBELT > 4 * (WINDOW + PARSEC_MEMPOOL_MAGAZINE_SIZE)) && (0 == stats.nb_depot_gets) )
+        fatal(" ! Error: the elements freed by the consumer were never reused by the producer\n");
+    if( stats.nb_in_caches + stats.nb_in_depot != live )
+        fatal(" ! Error: %"PRIu64" elements are in use, %"PRIu64" are cached\n",
+              live, stats.nb_in_caches + stats.nb_in_depot);
+
+    trimmed = parsec_mempool_trim(&mempool);
+    parsec_mempool_get_stats(&mempool, &stats);
+    printf("%"PRIu64" elements trimmed, %"PRIu64" still in caches\n", trimmed, stats.nb_in_caches);
+    if( (0 != stats.nb_in_depot) || (stats.nb_allocated - stats.nb_released != stats.nb_in_caches) )
+        fatal(" ! Error: the depot holds %"PRIu64" elements after the trim\n", stats.nb_in_depot);
+
+    hits = stats.nb_cache_hits;
+    for(ch = 0; ch < 2 * PARSEC_MEMPOOL_MAX_CACHES; ch++) {
+        pthread_create(&threads[0], NULL, short_lived, NULL);
+        pthread_join(threads[0], NULL);
+    }
+    parsec_mempool_get_stats(&mempool, &stats);
+    printf("%"PRIu64" cache hits for %d short-lived threads\n", stats.nb_cache_hits - hits, 2 * PARSEC_MEMPOOL_MAX_CACHES);
+    if( stats.nb_cache_hits - hits < 2 * PARSEC_MEMPOOL_MAX_CACHES )
+        fatal(" ! Error: the threads did not get the caches of the exited threads\n");
+
+    parsec_mempool_destruct(&mempool);
+    PARSEC_OBJ_DESTRUCT(&handoff);
+    return 0;
+}
@@ -0,0 +1,214 @@
+/*
+ * Copyright (c) 2023      The University of Tennessee and The University
+ *                         of Tennessee Research Foundation.  All rights
+ *                         reserved.
+ */
+
+#include "parsec/runtime.h"
+#undef NDEBUG
+#include <pthread.h>
+#include <stdarg.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <inttypes.h>
+#include <time.h>
+
+#include "parsec/class/parsec_object.h"
+#include "parsec/sys/atomic.h"
+
+/**
+ * Compares the atomic and the biased reference counts: each thread
+ * retains and releases an object it owns, and from time to time an object
+ * owned by another thread. Then checks that the objects released by other
+ * threads than their owner are freed once their owner flushes its queue.
+ */
+
+static unsigned int NBTIMES = 1000000;
+static unsigned int NBOBJS = 1000;
+static unsigned int REMOTE_PERIOD = 64;
+
+static void fatal(const char *format, ...)
+{
+    va_list va;
+    va_start(va, format);
+    vprintf(format, va);
+    va_end(va);
+    raise(SIGABRT);
+}
+
+static volatile int32_t nb_destructed = 0;
+
+typedef struct {
+    parsec_object_t super;
+    int             value;
+} plain_obj_t;
+
+static void obj_destruct(plain_obj_t *obj)
+{
+    (void)obj;
+    parsec_atomic_fetch_inc_int32(&nb_destructed);
+}
+
+PARSEC_OBJ_CLASS_DECLARATION(plain_obj_t);
+PARSEC_OBJ_CLASS_INSTANCE(plain_obj_t, parsec_object_t, NULL, obj_destruct);
+
+typedef plain_obj_t biased_obj_t;
+PARSEC_OBJ_CLASS_DECLARATION(biased_obj_t);
+PARSEC_OBJ_CLASS_INSTANCE_BIASED(biased_obj_t, parsec_object_t, NULL, obj_destruct);
+
+static int nb_threads;
+static pthread_barrier_t barrier;
+static parsec_object_t **owned;     /* One object per thread */
+static parsec_object_t **handoff;   /* NBOBJS objects per thread */
+static int biased;
+
+static double now(void)
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec / 1e9;
+}
+
+static parsec_object_t *new_obj(void)
+{
+    if( biased )
+        return (parsec_object_t*)PARSEC_OBJ_NEW(biased_obj_t);
+    return (parsec_object_t*)PARSEC_OBJ_NEW(plain_obj_t);
+}
+
+static void *do_retain_release(void *_id)
+{
+    int id = (int)(intptr_t)_id;
+    parsec_object_t *mine, *other;
+    unsigned int i;
+
+    owned[id] = new_obj();
+    pthread_barrier_wait(&barrier);
+    mine = owned[id];
+    other = owned[(id + 1) % nb_threads];
+    for(i = 0; i < NBTIMES; i++) {
+        PARSEC_OBJ_RETAIN(mine);
+        PARSEC_OBJ_RELEASE(mine);
+        if( 0 == (i % REMOTE_PERIOD) ) {
+            PARSEC_OBJ_RETAIN(other);
+            PARSEC_OBJ_RELEASE(other);
+        }
+    }
+    pthread_barrier_wait(&barrier);
+    PARSEC_OBJ_RELEASE(owned[id]);
+    return NULL;
+}
+
+/* Every thread gives NBOBJS objects with two references to the next
+ * thread, then both threads release one reference, in a different order
+ * for odd and even objects */
+static void *do_handoff(void *_id)
+{
+    int id = (int)(intptr_t)_id, from = (id + nb_threads - 1) % nb_threads;
+    parsec_object_t *obj;
+    unsigned int i;
+
+    for(i = 0; i < NBOBJS; i++) {
+        obj = new_obj();
+        PARSEC_OBJ_RETAIN(obj);
+        handoff[id * NBOBJS + i] = obj;
+    }
+    pthread_barrier_wait(&barrier);
+    for(i = 0; i < NBOBJS; i += 2) {
+        obj = handoff[from * NBOBJS + i];
+        PARSEC_OBJ_RELEASE(obj);
+    }
+    pthread_barrier_wait(&barrier);
+    for(i = 0; i < NBOBJS; i++) {
+        obj = handoff[id * NBOBJS + i];
+        PARSEC_OBJ_RELEASE(obj);
+    }
+    pthread_barrier_wait(&barrier);
+    for(i = 1; i < NBOBJS; i += 2) {
+        obj = handoff[from * NBOBJS + i];
+        PARSEC_OBJ_RELEASE(obj);
+    }
+    pthread_barrier_wait(&barrier);
+    parsec_obj_biased_flush();
+    return NULL;
+}
+
+static double run(void *(*fct)(void *))
+{
+    pthread_t *threads = (pthread_t*)malloc(nb_threads * sizeof(pthread_t));
+    double start = now();
+    int i;
+
+    nb_destructed = 0;
+    for(i = 1; i < nb_threads; i++)
+        pthread_create(&threads[i], NULL, fct, (void*)(intptr_t)i);
+    fct((void*)(intptr_t)0);
+    for(i = 1; i < nb_threads; i++)
+        pthread_join(threads[i], NULL);
+    free(threads);
+    return now() - start;
+}
+
+int main(int argc, char *argv[])
+{
+    double duration[2];
+    int ch, ret = 0;
+
+    nb_threads = 4;
+    while( (ch = getopt(argc, argv, "c:n:o:h")) != -1 ) {
+        switch(ch) {
+        case 'c':
+            nb_threads = atoi(optarg);
+            break;
+        case 'n':
+            NBTIMES = atoi(optarg);
+            break;
+        case 'o':
+            NBOBJS = atoi(optarg);
+            break;
+        case 'h':
+        default:
+            fprintf(stderr,
+                    "Usage: %s [-c nb threads] [-n NBTIMES] [-o NBOBJS]\n"
+                    "   Each thread retains and releases its object NBTIMES times (default %u),\n"
+                    "   and the object of another thread every %u times,\n"
+                    "   then gives NBOBJS objects to another thread (default %u)\n",
+                    argv[0], NBTIMES, REMOTE_PERIOD, NBOBJS);
+            exit(1);
+        }
+    }
+    if( nb_threads < 1 ) nb_threads = 1;
+
+    pthread_barrier_init(&barrier, NULL, nb_threads);
+    owned = (parsec_object_t**)calloc(nb_threads, sizeof(parsec_object_t*));
+    handoff = (parsec_object_t**)calloc(nb_threads * NBOBJS, sizeof(parsec_object_t*));
+
+    for(biased = 0; biased < 2; biased++) {
+        duration[biased] = run(do_retain_release);
+        if( nb_destructed != nb_threads ) {
+            fprintf(stderr, " ! Error: %d objects out of %d were destructed (%s)\n",
+                    nb_destructed, nb_threads, biased ? "biased" : "atomic");
+            ret = 1;
+        }
+        printf("%8s: %d threads, %g retain/release per second and thread\n",
+               biased ? "biased" : "atomic", nb_threads,
+               NBTIMES * (1.0 + 1.0 / REMOTE_PERIOD) / duration[biased]);
+
+        run(do_handoff);
+        if( nb_destructed != (int32_t)(nb_threads * NBOBJS) ) {
+            fprintf(stderr, " ! Error: %d objects out of %u given to another thread were destructed (%s)\n",
+                    nb_destructed, nb_threads * NBOBJS, biased ? "biased" : "atomic");
+            ret = 1;
+        }
+    }
+    printf("speedup of the biased reference count: %g\n", duration[0] / duration[1]);
+
+    free(owned);
+    free(handoff);
+    pthread_barrier_destroy(&barrier);
+    if( ret ) fatal(" ! Test failed\n");
+    return 0;
+}
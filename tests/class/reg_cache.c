@@ -0,0 +1,263 @@
+/*
+ * Copyright (c) 2023      The University of Tennessee and The University
+ *                         of Tennessee Research Foundation.  All rights
+ *                         reserved.
+ */
+
+#include "parsec/runtime.h"
+#undef NDEBUG
+#include <stdarg.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <inttypes.h>
+#include <time.h>
+
+#include "parsec/parsec_comm_engine.h"
+
+/**
+ * Checks the memory registration cache of the comm engines on top of an
+ * engine that only counts its registrations: the handles are reused for the
+ * same memory and layout, the unused ones are evicted in least recently used
+ * order, a handle in use is never dropped, and the invalidated registrations
+ * are unregistered once no transfer uses them. Then times NBOPS registrations
+ * of NBBUF buffers with and without the cache.
+ */
+
+#define NBBUF   8
+#define BUFSIZE 4096
+
+static unsigned int NBOPS = 1000000;
+
+static void fatal(const char *format, ...)
+{
+    va_list va;
+    va_start(va, format);
+    vprintf(format, va);
+    va_end(va);
+    raise(SIGABRT);
+}
+
+static double now(void)
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec / 1e9;
+}
+
+typedef struct {
+    void  *mem;
+    size_t size;
+} fake_handle_t;
+
+static int   nb_registered = 0;    /**< Handles created by the engine */
+static int   nb_live = 0;          /**< Handles not unregistered yet */
+static void *last_unregistered = NULL;
+
+static int fake_mem_register(void *mem, parsec_mem_type_t mem_type,
+                             size_t count, parsec_datatype_t datatype,
+                             size_t mem_size,
+                             parsec_ce_mem_reg_handle_t *lreg,
+                             size_t *lreg_size)
+{
+    fake_handle_t *h = (fake_handle_t*)malloc(sizeof(fake_handle_t));
+    (void)mem_type; (void)count; (void)datatype;
+    h->mem = mem;
+    h->size = mem_size;
+    *lreg = (parsec_ce_mem_reg_handle_t)h;
+    *lreg_size = sizeof(fake_handle_t);
+    nb_registered++;
+    nb_live++;
+    return 1;
+}
+
+static int fake_mem_unregister(parsec_ce_mem_reg_handle_t *lreg)
+{
+    fake_handle_t *h = (fake_handle_t*)*lreg;
+    last_unregistered = h->mem;
+    free(h);
+    *lreg = NULL;
+    nb_live--;
+    return 1;
+}
+
+static parsec_comm_engine_t ce;
+static char *bufs;
+
+static parsec_ce_mem_reg_handle_t reg(int b, size_t size, parsec_datatype_t datatype)
+{
+    parsec_ce_mem_reg_handle_t lreg;
+    size_t lreg_size;
+    parsec_ce_mem_register_cached(&ce, bufs + b * BUFSIZE, PARSEC_MEM_TYPE_CONTIGUOUS,
+                                  -1, datatype, size, &lreg, &lreg_size);
+    if( (NULL == lreg) || (((fake_handle_t*)lreg)->mem != bufs + b * BUFSIZE) )
+        fatal(" ! Error: the handle for buffer %d does not describe it\n", b);
+    return lreg;
+}
+
+static void unreg(parsec_ce_mem_reg_handle_t lreg)
+{
+    parsec_ce_mem_unregister_cached(&ce, &lreg);
+}
+
+/* Registers and unregisters buffer b, and checks it was a hit or a miss */
+static void use(int b, int hit)
+{
+    int before = nb_registered;
+    unreg(reg(b, BUFSIZE, parsec_datatype_uint8_t));
+    if( hit != (before == nb_registered) )
+        fatal(" ! Error: buffer %d was %s the cache\n", b, hit ? "not found in" : "found in");
+}
+
+static void check(int live, const char *step)
+{
+    if( live != nb_live )
+        fatal(" ! Error: %d handles are registered instead of %d after %s\n", nb_live, live, step);
+}
+
+static void check_stats(uint64_t hits, uint64_t misses, uint64_t evictions, uint64_t invalidations)
+{
+    parsec_ce_mem_reg_cache_stats_t stats;
+    parsec_ce_mem_reg_cache_get_stats(&stats);
+    if( (stats.nb_hits != hits) || (stats.nb_misses != misses) ||
+        (stats.nb_evictions != evictions) || (stats.nb_invalidations != invalidations) )
+        fatal(" ! Error: the cache counted %"PRIu64" hits, %"PRIu64" misses, %"PRIu64" evictions and %"PRIu64" invalidations "
+              "instead of %"PRIu64", %"PRIu64", %"PRIu64" and %"PRIu64"\n",
+              stats.nb_hits, stats.nb_misses, stats.nb_evictions, stats.nb_invalidations,
+              hits, misses, evictions, invalidations);
+}
+
+static void check_cache(void)
+{
+    parsec_ce_mem_reg_handle_t h[5], a;
+
+    parsec_ce_mem_reg_cache_init(4);
+    use(0, 0);
+    check(1, "caching a registration");
+    use(0, 1);
+    a = reg(0, BUFSIZE / 2, parsec_datatype_uint8_t);
+    if( 2 != nb_registered )
+        fatal(" ! Error: a registration of another size was found in the cache\n");
+    unreg(a);
+    /* The cache holds 0 (BUFSIZE / 2), 0, 1, 2 */
+    use(1, 0);
+    use(2, 0);
+    use(0, 1);
+    /* 0 (BUFSIZE / 2) was unused for the longest time */
+    use(3, 0);
+    if( bufs != last_unregistered )
+        fatal(" ! Error: %p was evicted instead of %p\n", last_unregistered, bufs);
+    use(0, 1);
+    /* 1 is now the least recently used */
+    use(4, 0);
+    if( bufs + BUFSIZE != last_unregistered )
+        fatal(" ! Error: %p was evicted instead of %p\n", last_unregistered, bufs + BUFSIZE);
+    check(4, "evictions");
+    check_stats(3, 6, 2, 0);
+
+    /* All the handles in use: the next registration is not cached */
+    h[0] = reg(0, BUFSIZE, parsec_datatype_uint8_t);
+    h[1] = reg(2, BUFSIZE, parsec_datatype_uint8_t);
+    h[2] = reg(3, BUFSIZE, parsec_datatype_uint8_t);
+    h[3] = reg(4, BUFSIZE, parsec_datatype_uint8_t);
+    h[4] = reg(5, BUFSIZE, parsec_datatype_uint8_t);
+    check(5, "a registration while the cache is in use");
+    unreg(h[4]);
+    check(4, "releasing a registration not cached");
+
+    /* Invalidated in use: dropped once the last transfer is done */
+    a = reg(2, BUFSIZE, parsec_datatype_uint8_t);
+    if( a != h[1] )
+        fatal(" ! Error: two transfers of the same buffer got different handles\n");
+    parsec_ce_mem_reg_cache_invalidate(bufs + 2 * BUFSIZE + 100, 1);
+    unreg(a);
+    check(4, "invalidating a registration in use");
+    unreg(h[1]);
+    check(3, "releasing an invalidated registration");
+    unreg(h[0]);
+    unreg(h[2]);
+    unreg(h[3]);
+    use(2, 0);
+    check_stats(8, 8, 2, 1);
+
+    /* The cache holds 0, 3, 4, 2 */
+    parsec_ce_mem_reg_cache_invalidate(bufs + BUFSIZE - 1, 2);
+    if( bufs != last_unregistered )
+        fatal(" ! Error: %p was unregistered instead of %p\n", last_unregistered, bufs);
+    check(3, "invalidating a memory range");
+    unreg(reg(6, BUFSIZE, parsec_datatype_double_t));
+    parsec_ce_mem_reg_cache_invalidate_datatype(parsec_datatype_double_t);
+    if( bufs + 6 * BUFSIZE != last_unregistered )
+        fatal(" ! Error: %p was unregistered instead of %p\n", last_unregistered, bufs + 6 * BUFSIZE);
+    check(3, "invalidating a datatype");
+    check_stats(8, 9, 2, 3);
+
+    parsec_ce_mem_reg_cache_fini();
+    check(0, "releasing the cache");
+
+    /* Without cache, every transfer registers its memory */
+    parsec_ce_mem_reg_cache_init(0);
+    use(0, 0);
+    use(0, 0);
+    check(0, "registrations without cache");
+    parsec_ce_mem_reg_cache_fini();
+}
+
+static double time_registrations(int capacity)
+{
+    double start, duration;
+    unsigned int i;
+
+    parsec_ce_mem_reg_cache_init(capacity);
+    start = now();
+    for(i = 0; i < NBOPS; i++)
+        unreg(reg(i % NBBUF, BUFSIZE, parsec_datatype_uint8_t));
+    duration = now() - start;
+    parsec_ce_mem_reg_cache_fini();
+    check(0, "the timed registrations");
+    return duration;
+}
+
+int main(int argc, char *argv[])
+{
+    double duration;
+    int ch;
+
+    while( (ch = getopt(argc, argv, "n:h")) != -1 ) {
+        switch(ch) {
+        case 'n':
+            NBOPS = atoi(optarg);
+            break;
+        case 'h':
+        default:
+            fprintf(stderr,
+                    "Usage: %s [-n NBOPS]\n"
+                    "   checks the memory registration cache, then times NBOPS registrations (default %u)\n",
+                    argv[0], NBOPS);
+            exit(1);
+        }
+    }
+    memset(&ce, 0, sizeof(ce));
+    ce.mem_register = fake_mem_register;
+    ce.mem_unregister = fake_mem_unregister;
+    bufs = (char*)malloc(NBBUF * BUFSIZE);
+
+    check_cache();
+    printf("memory registration cache checked\n");
+
+    nb_registered = 0;
+    duration = time_registrations(0);
+    printf("%-20s %u registrations: %g s, %g Mop/s, %d registered\n", "without cache",
+           NBOPS, duration, 1e-6 * NBOPS / duration, nb_registered);
+    nb_registered = 0;
+    duration = time_registrations(NBBUF);
+    printf("%-20s %u registrations: %g s, %g Mop/s, %d registered\n", "with cache",
+           NBOPS, duration, 1e-6 * NBOPS / duration, nb_registered);
+    if( NBBUF < nb_registered )
+        fatal(" ! Error: %d registrations for %d buffers fitting in the cache\n", nb_registered, NBBUF);
+
+    free(bufs);
+    return 0;
+}
@@ -11,6 +11,7 @@
 #include <string.h>
 #include <unistd.h>
 #include <signal.h>
+#include <sys/time.h>
 #include "parsec/class/parsec_rwlock.h"
 #include "parsec/class/barrier.h"
 #include "parsec/bindthread.h"
@@ -20,6 +21,7 @@
 #define NB_TESTS 10
 #define NB_LOOPS 300000
 #define ARRAY_SIZE 12
+#define NB_READS 1000000
 
 /*
  * When we build outside PaRSEC, we do not have access to the atomic define for
@@ -89,6 +91,45 @@ static void *do_test(void *param)
     return (void*)(uintptr_t)duration;
 }
 
+static int write_period = 0;
+
+/*
+ * Read-mostly workload: each thread takes the lock in read mode NB_READS
+ * times, and in write mode once every write_period reads (never if 0).
+ * Returns the time spent by the thread, in microseconds.
+ */
+static void *do_read_test(void *param)
+{
+    int id = (int)(intptr_t)param;
+    int i, j, v;
+    struct timeval t0, t1;
+
+    parsec_bindthread(id, 0);
+    parsec_barrier_wait(&barrier);
+    gettimeofday(&t0, NULL);
+
+    for(i = 1; i <= NB_READS; i++) {
+        parsec_atomic_rwlock_rdlock(&rwlock);
+        for(j = 1; j < ARRAY_SIZE; j++) {
+            if( large_array[j-1] != large_array[j] ) {
+                raise(SIGABRT);
+            }
+        }
+        parsec_atomic_rwlock_rdunlock(&rwlock);
+        if( (write_period > 0) && (0 == (i % write_period)) ) {
+            parsec_atomic_rwlock_wrlock(&rwlock);
+            v = large_array[0];
+            for(j = 0; j < ARRAY_SIZE; j++) {
+                large_array[j] = v+1;
+            }
+            parsec_atomic_rwlock_wrunlock(&rwlock);
+        }
+    }
+    gettimeofday(&t1, NULL);
+
+    return (void*)(uintptr_t)((t1.tv_sec - t0.tv_sec) * 1000000 + (t1.tv_usec - t0.tv_usec));
+}
+
 int main(int argc, char *argv[])
 {
     pthread_t *threads;
@@ -96,10 +137,11 @@ int main(int argc, char *argv[])
     char *m;
     uint64_t maxtime;
     void *retval;
+    int readers = 0;
 
     parsec_hwloc_init();
 
-    while( (ch = getopt(argc, argv, "c:m:M:h?")) != -1 ) {
+    while( (ch = getopt(argc, argv, "c:m:M:Rw:h?")) != -1 ) {
         switch(ch) {
         case 'c':
             ch = strtol(optarg, &m, 0);
@@ -122,10 +164,22 @@ int main(int argc, char *argv[])
             }
             maxthreads = (uintptr_t)ch;
             break;
+        case 'R':
+            readers = 1;
+            break;
+        case 'w':
+            ch = strtol(optarg, &m, 0);
+            if( (ch < 0) || (m[0] != '\0') ) {
+                fprintf(stderr, "%s: invalid -w value\n", argv[0]);
+            }
+            write_period = ch;
+            break;
         case 'h':
         case '?':
         default:
-            fprintf(stderr, "Usage: %s [-c nbthreads|-m minthreads -M maxthreads]\n", argv[0]);
+            fprintf(stderr, "Usage: %s [-c nbthreads|-m minthreads -M maxthreads]\n"
+                    "          [-R (measure the readers per second of a read-mostly workload)]\n"
+                    "          [-w one write every that many reads with -R (default: 0, no writes)]\n", argv[0]);
             exit(1);
             break;
         }
@@ -144,15 +198,19 @@ int main(int argc, char *argv[])
         parsec_barrier_init(&barrier, NULL, nbthreads+1);
 
         for(e = 0; e < nbthreads; e++) {
-            pthread_create(&threads[e], NULL, do_test, (void*)(intptr_t)e);
+            pthread_create(&threads[e], NULL, readers ? do_read_test : do_test, (void*)(intptr_t)e);
         }
-        maxtime = (uint64_t)do_test((void*)(intptr_t)(nbthreads+1));
+        maxtime = (uint64_t)(readers ? do_read_test : do_test)((void*)(intptr_t)(nbthreads+1));
         for(e = 0; e < nbthreads; e++) {
             pthread_join(threads[e], &retval);
             if( (uint64_t)retval > maxtime )
                 maxtime = (uint64_t)retval;
         }
-        printf("%d threads %"PRIu64" "TIMER_UNIT"\n", nbthreads+1, maxtime);
+        if( readers )
+            printf("%d threads %g readers/s (one write every %d reads)\n", nbthreads+1,
+                   (double)NB_READS * (nbthreads+1) * 1e6 / (double)(maxtime > 0 ? maxtime : 1), write_period);
+        else
+            printf("%d threads %"PRIu64" "TIMER_UNIT"\n", nbthreads+1, maxtime);
         fflush(stdout);
     }
 }
@@ -0,0 +1,334 @@
+/*
+ * Copyright (c) 2023      The University of Tennessee and The University
+ *                         of Tennessee Research Foundation.  All rights
+ *                         reserved.
+ */
+
+#include "parsec/runtime.h"
+#undef NDEBUG
+#include <pthread.h>
+#include <stdarg.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <inttypes.h>
+#if defined(PARSEC_HAVE_MPI)
+#include <mpi.h>
+#endif
+
+#include "parsec/class/wsdeque.h"
+#include "parsec/sys/atomic.h"
+#include "parsec/os-spec-timing.h"
+
+static unsigned int NBELT = 8192;
+static unsigned int NBTIMES = 1000000;
+
+static void fatal(const char *format, ...)
+{
+    va_list va;
+    va_start(va, format);
+    vprintf(format, va);
+    va_end(va);
+    raise(SIGABRT);
+}
+
+typedef struct {
+    parsec_list_item_t list;
+    unsigned int base;
+} elt_t;
+
+static parsec_wsdeque_t deque;
+static elt_t *elts = NULL;
+static int32_t *taken = NULL;
+
+static void take(elt_t *elt, const char *who)
+{
+    if( elt->base >= NBTIMES )
+        fatal(" ! Error: %s got an element with base %u outside boundaries\n", who, elt->base);
+    if( 0 != parsec_atomic_fetch_inc_int32(&taken[elt->base]) )
+        fatal(" ! Error: %s got the element %u, which was already taken\n", who, elt->base);
+}
+
+static void check_sequential(void)
+{
+    parsec_list_item_t *ring;
+    elt_t *elt;
+    unsigned int e;
+    int nb;
+
+    printf(" - push %u elements, and pop them back in reverse order\n", NBELT);
+    for(e = 0; e < NBELT; e++)
+        parsec_wsdeque_push(&deque, &elts[e].list);
+    if( (int64_t)NBELT != parsec_wsdeque_size(&deque) )
+        fatal(" ! Error: expected %u elements in the deque, found %"PRId64"\n", NBELT, parsec_wsdeque_size(&deque));
+    for(e = NBELT; e > 0; e--) {
+        elt = (elt_t*)parsec_wsdeque_pop(&deque);
+        if( NULL == elt )
+            fatal(" ! Error: element number %u was not found in the deque\n", e-1);
+        if( elt->base != e-1 )
+            fatal(" ! Error: popped element %u instead of %u\n", elt->base, e-1);
+    }
+    if( NULL != parsec_wsdeque_pop(&deque) || !parsec_wsdeque_is_empty(&deque) )
+        fatal(" ! Error: the deque should be empty\n");
+
+    printf(" - push %u elements, and steal them back in order\n", NBELT);
+    for(e = 0; e < NBELT; e++)
+        parsec_wsdeque_push(&deque, &elts[e].list);
+    for(e = 0; e < NBELT; e++) {
+        elt = (elt_t*)parsec_wsdeque_steal(&deque);
+        if( NULL == elt )
+            fatal(" ! Error: element number %u was not found in the deque\n", e);
+        if( elt->base != e )
+            fatal(" ! Error: stole element %u instead of %u\n", elt->base, e);
+    }
+    if( NULL != parsec_wsdeque_steal(&deque) )
+        fatal(" ! Error: the deque should be empty\n");
+
+    printf(" - chain a ring of %u elements, and steal them by halves\n", NBELT);
+    ring = parsec_list_item_singleton(&elts[0].list);
+    for(e = 1; e < NBELT; e++)
+        parsec_list_item_ring_push(ring, parsec_list_item_singleton(&elts[e].list));
+    parsec_wsdeque_chain(&deque, ring);
+    /* The first element of the ring is the next one for the owner: thieves
+     * see the ring in reverse order */
+    e = NBELT;
+    while( NULL != (ring = parsec_wsdeque_steal_half(&deque, NBELT, &nb)) ) {
+        if( nb < 1 || nb > PARSEC_WSDEQUE_MAX_STEAL )
+            fatal(" ! Error: stole %d elements at once\n", nb);
+        _LIST_ITEM_ITERATOR(ring, ring, it, {
+                elt = (elt_t*)it;
+                if( elt->base != e-1 )
+                    fatal(" ! Error: stole element %u instead of %u\n", elt->base, e-1);
+                e--;
+                nb--;
+            });
+        if( 0 != nb )
+            fatal(" ! Error: the stolen ring does not hold the announced number of elements\n");
+    }
+    if( 0 != e )
+        fatal(" ! Error: %u elements were not stolen\n", e);
+}
+
+static pthread_mutex_t heavy_synchro_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t  heavy_synchro_cond = PTHREAD_COND_INITIALIZER;
+static unsigned int    heavy_synchro = 0;
+static volatile int32_t owner_done = 0;
+
+static void wait_start(void)
+{
+    pthread_mutex_lock(&heavy_synchro_lock);
+    while( heavy_synchro == 0 ) {
+        pthread_cond_wait(&heavy_synchro_cond, &heavy_synchro_lock);
+    }
+    pthread_mutex_unlock(&heavy_synchro_lock);
+}
+
+static void *owner_thread(void *params)
+{
+    uint64_t *p = (uint64_t*)params;
+    parsec_time_t start, end;
+    elt_t *elt;
+    unsigned int i;
+
+    wait_start();
+    start = take_time();
+    for(i = 0; i < NBTIMES; i++) {
+        parsec_wsdeque_push(&deque, &elts[i].list);
+        /* Consume about a third of what we produce, in bursts */
+        if( 2 == (i % 3) ) {
+            if( NULL != (elt = (elt_t*)parsec_wsdeque_pop(&deque)) )
+                take(elt, "the owner");
+        }
+    }
+    while( NULL != (elt = (elt_t*)parsec_wsdeque_pop(&deque)) )
+        take(elt, "the owner");
+    end = take_time();
+    parsec_atomic_wmb();
+    owner_done = 1;
+    *p = diff_time(start, end);
+    return NULL;
+}
+
+static void *thief_thread(void *params)
+{
+    uint64_t *p = (uint64_t*)params;
+    int batch = (int)p[1], nb;
+    parsec_list_item_t *ring;
+    parsec_time_t start, end;
+    uint64_t stolen = 0;
+
+    wait_start();
+    start = take_time();
+    while( !owner_done || !parsec_wsdeque_is_empty(&deque) ) {
+        if( 1 == batch ) {
+            ring = parsec_wsdeque_steal(&deque);
+            nb = (NULL == ring) ? 0 : 1;
+        } else {
+            ring = parsec_wsdeque_steal_half(&deque, batch, &nb);
+        }
+        if( NULL == ring )
+            continue;
+        _LIST_ITEM_ITERATOR(ring, ring, it, { take((elt_t*)it, "a thief"); });
+        stolen += nb;
+    }
+    end = take_time();
+    p[0] = diff_time(start, end);
+    p[1] = stolen;
+    return NULL;
+}
+
+static void run_parallel(unsigned int nbthreads, int batch)
+{
+    pthread_t *threads;
+    uint64_t *times, owner_time;
+    uint64_t min_time = 0, max_time = 0, sum_time = 0, sum_stolen = 0;
+    unsigned int e;
+
+    memset(taken, 0, NBTIMES * sizeof(int32_t));
+    owner_done = 0;
+    heavy_synchro = 0;
+
+    threads = (pthread_t*)calloc(sizeof(pthread_t), nbthreads);
+    times = (uint64_t*)calloc(2 * sizeof(uint64_t), nbthreads);
+    pthread_create(&threads[0], NULL, owner_thread, &owner_time);
+    for(e = 1; e < nbthreads; e++) {
+        times[2*e+1] = batch;
+        pthread_create(&threads[e], NULL, thief_thread, &times[2*e]);
+    }
+
+    pthread_mutex_lock(&heavy_synchro_lock);
+    heavy_synchro = NBTIMES;
+    pthread_cond_broadcast(&heavy_synchro_cond);
+    pthread_mutex_unlock(&heavy_synchro_lock);
+
+    pthread_join(threads[0], NULL);
+    for(e = 1; e < nbthreads; e++) {
+        pthread_join(threads[e], NULL);
+        if( 1 == e ) {
+            min_time = times[2*e];
+            max_time = times[2*e];
+        } else {
+            if( min_time > times[2*e] ) min_time = times[2*e];
+            if( max_time < times[2*e] ) max_time = times[2*e];
+        }
+        sum_time += times[2*e];
+        sum_stolen += times[2*e+1];
+    }
+    for(e = 0; e < NBTIMES; e++) {
+        if( 1 != taken[e] )
+            fatal(" ! Error: element %u was taken %d times\n", e, taken[e]);
+    }
+
+    printf("== Owner + %u thieves (steal %s), %u elements:\n"
+           "== OWNER %"PRIu64" %s\n",
+           nbthreads-1, (1 == batch) ? "one" : "half", NBTIMES,
+           owner_time, TIMER_UNIT);
+    if( nbthreads > 1 ) {
+        printf("== STOLEN %"PRIu64" (%g%%)\n"
+               "== MIN %"PRIu64" %s\n"
+               "== MAX %"PRIu64" %s\n"
+               "== AVG %g %s\n",
+               sum_stolen, 100.0 * (double)sum_stolen / (double)NBTIMES,
+               min_time, TIMER_UNIT,
+               max_time, TIMER_UNIT,
+               (double)sum_time / (double)(nbthreads-1), TIMER_UNIT);
+    }
+    free(threads);
+    free(times);
+}
+
+static void usage(const char *name, const char *msg)
+{
+    if( NULL != msg ) {
+        fprintf(stderr, "%s\n", msg);
+    }
+    fprintf(stderr,
+            "Usage: \n"
+            "   %s [-c cores|-n nbelt|-N nbtimes|-h|-?]\n"
+            " where\n"
+            "   -c cores:   cores (integer >0) defines the maximal number of threads to test (the owner and cores-1 thieves)\n"
+            "   -n nbelt:   nbelt (integer >0) defines the number of elements to use in the sequential test (default %u)\n"
+            "   -N nbtimes: nbtimes (integer >0) defines the number of elements the owner produces in the parallel test (default %u)\n",
+            name,
+            NBELT,
+            NBTIMES);
+    exit(1);
+}
+
+int main(int argc, char *argv[])
+{
+    unsigned int e, nbthreads = 1;
+    int ch;
+    char *m;
+
+#if defined(PARSEC_HAVE_MPI)
+    {
+        int provided;
+        MPI_Init_thread(&argc, &argv, MPI_THREAD_SERIALIZED, &provided);
+    }
+#endif
+    while( (ch = getopt(argc, argv, "c:n:N:h?")) != -1 ) {
+        switch(ch) {
+        case 'c': {
+            long nth = strtol(optarg, &m, 0);
+            if( (nth <= 0) || (m[0] != '\0') ) {
+                usage(argv[0], "invalid -c value");
+            }
+            nbthreads = nth;
+            break;
+        }
+        case 'n':
+            NBELT = strtol(optarg, &m, 0);
+            if( (NBELT <= 0) || (m[0] != '\0') ) {
+                usage(argv[0], "invalid -n value");
+            }
+            break;
+        case 'N':
+            NBTIMES = strtol(optarg, &m, 0);
+            if( (NBTIMES <= 0) || (m[0] != '\0') ) {
+                usage(argv[0], "invalid -N value");
+            }
+            break;
+        case 'h':
+        case '?':
+        default:
+            usage(argv[0], NULL);
+            break;
+        }
+    }
+
+    e = NBELT > NBTIMES ? NBELT : NBTIMES;
+    elts = (elt_t*)calloc(sizeof(elt_t), e);
+    taken = (int32_t*)calloc(sizeof(int32_t), NBTIMES);
+    for(; e > 0; e--)
+        elts[e-1].base = e-1;
+
+    PARSEC_OBJ_CONSTRUCT(&deque, parsec_wsdeque_t);
+
+    printf("Sequential test.\n");
+    check_sequential();
+
+    printf("Parallel test.\n");
+    for(e = 1; e <= nbthreads; e *= 2) {
+        run_parallel(e, 1);
+        if( e > 1 )
+            run_parallel(e, PARSEC_WSDEQUE_MAX_STEAL);
+    }
+    if( (e / 2) != nbthreads ) {
+        run_parallel(nbthreads, 1);
+        run_parallel(nbthreads, PARSEC_WSDEQUE_MAX_STEAL);
+    }
+
+    PARSEC_OBJ_DESTRUCT(&deque);
+    free(elts);
+    free(taken);
+
+    printf(" - all tests passed\n");
+
+#if defined(PARSEC_HAVE_MPI)
+    MPI_Finalize();
+#endif
+    return 0;
+}
@@ -0,0 +1,245 @@
+/*
+ * Copyright (c) 2023      The University of Tennessee and The University
+ *                         of Tennessee Research Foundation.  All rights
+ *                         reserved.
+ */
+
+#include "parsec/parsec_config.h"
+#undef NDEBUG
+#include <stdarg.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <inttypes.h>
+#include <time.h>
+
+#include "parsec/utils/zone_malloc.h"
+#include "parsec/utils/debug.h"
+
+/**
+ * Replays a mixed-size allocation trace on a zone carved from host
+ * memory. The trace is either read from a file, one operation per line
+ * ("a <id> <bytes>" to allocate, "f <id>" to free), or generated with
+ * tiles of a few different sizes and random lifetimes. A first replay
+ * checks that no two live allocations overlap and that the zone is
+ * entirely merged back at the end, a second one measures the time per
+ * operation.
+ */
+
+static unsigned int NBUNITS = 65536;
+static unsigned int UNIT = 256;
+static unsigned int NBOPS = 1000000;
+
+typedef struct {
+    int    id;     /* Allocation the operation refers to */
+    size_t size;   /* Bytes to allocate, 0 for a free */
+} op_t;
+
+static void fatal(const char *format, ...)
+{
+    va_list va;
+    va_start(va, format);
+    vprintf(format, va);
+    va_end(va);
+    raise(SIGABRT);
+}
+
+static double now(void)
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec / 1e9;
+}
+
+static op_t *read_trace(const char *name, unsigned int *nb_ops, int *nb_ids)
+{
+    unsigned int size = 1024, n = 0;
+    op_t *ops = (op_t*)malloc(size * sizeof(op_t));
+    char kind;
+    size_t bytes;
+    int id;
+    FILE *f;
+
+    if( NULL == (f = fopen(name, "r")) )
+        fatal(" ! Error: cannot open trace %s\n", name);
+    *nb_ids = 0;
+    while( 2 <= fscanf(f, " %c %d", &kind, &id) ) {
+        bytes = 0;
+        if( ('a' == kind) && (1 != fscanf(f, "%zu", &bytes)) )
+            fatal(" ! Error: allocation %u of %s has no size\n", n, name);
+        if( n == size ) {
+            size *= 2;
+            ops = (op_t*)realloc(ops, size * sizeof(op_t));
+        }
+        ops[n].id = id;
+        ops[n].size = ('a' == kind) ? (bytes ? bytes : 1) : 0;
+        if( id >= *nb_ids ) *nb_ids = id + 1;
+        n++;
+    }
+    fclose(f);
+    *nb_ops = n;
+    return ops;
+}
+
+/* Tiles of mixed sizes, allocated while the zone is less than 3/4 full */
+static op_t *generate_trace(unsigned int nb_ops, int *nb_ids)
+{
+    static const size_t sizes[] = { 1, 3, 8, 17, 64, 100, 256, 500 };
+    op_t *ops = (op_t*)malloc(nb_ops * sizeof(op_t));
+    int *live = (int*)malloc(nb_ops * sizeof(int));
+    size_t *live_size = (size_t*)malloc(nb_ops * sizeof(size_t));
+    size_t in_use = 0, limit = (size_t)NBUNITS * UNIT / 4 * 3;
+    unsigned int i, nb_live = 0, seed = 1;
+    int k;
+
+    *nb_ids = 0;
+    for(i = 0; i < nb_ops; i++) {
+        size_t size = sizes[rand_r(&seed) % (sizeof(sizes)/sizeof(sizes[0]))] * UNIT
+            - (rand_r(&seed) % UNIT);
+        if( (0 == nb_live) || ((in_use + size < limit) && (rand_r(&seed) % 2)) ) {
+            ops[i].id = *nb_ids;
+            ops[i].size = size;
+            live[nb_live] = (*nb_ids)++;
+            live_size[nb_live++] = size;
+            in_use += size;
+        } else {
+            k = rand_r(&seed) % nb_live;
+            ops[i].id = live[k];
+            ops[i].size = 0;
+            in_use -= live_size[k];
+            live[k] = live[--nb_live];
+            live_size[k] = live_size[nb_live];
+        }
+    }
+    free(live);
+    free(live_size);
+    return ops;
+}
+
+/* Replays the trace, returns the number of allocations that failed */
+static unsigned int replay(zone_malloc_t *zone, op_t *ops, unsigned int nb_ops,
+                           void **ptrs, int *owner)
+{
+    unsigned int i, failed = 0;
+    size_t u, first, nb;
+
+    for(i = 0; i < nb_ops; i++) {
+        if( 0 != ops[i].size ) {
+            ptrs[ops[i].id] = zone_malloc(zone, ops[i].size);
+            if( NULL == ptrs[ops[i].id] ) {
+                failed++;
+                continue;
+            }
+            if( NULL == owner ) continue;
+            first = ((char*)ptrs[ops[i].id] - zone->base) / UNIT;
+            nb = (ops[i].size + UNIT - 1) / UNIT;
+            if( first + nb > NBUNITS )
+                fatal(" ! Error: allocation %d of %zu bytes overflows the zone\n", ops[i].id, ops[i].size);
+            for(u = first; u < first + nb; u++) {
+                if( -1 != owner[u] )
+                    fatal(" ! Error: allocation %d overlaps allocation %d\n", ops[i].id, owner[u]);
+                owner[u] = ops[i].id;
+            }
+        } else {
+            if( NULL == ptrs[ops[i].id] ) continue;
+            if( NULL != owner ) {
+                for(u = ((char*)ptrs[ops[i].id] - zone->base) / UNIT;
+                    (u < NBUNITS) && (owner[u] == ops[i].id); u++)
+                    owner[u] = -1;
+            }
+            zone_free(zone, ptrs[ops[i].id]);
+            ptrs[ops[i].id] = NULL;
+        }
+    }
+    return failed;
+}
+
+int main(int argc, char *argv[])
+{
+    const char *trace = NULL;
+    zone_malloc_t *zone;
+    unsigned int nb_ops, failed, u;
+    int ch, i, nb_ids, verbose = 0, *owner;
+    void **ptrs;
+    char *base;
+    op_t *ops;
+    double duration;
+
+    while( (ch = getopt(argc, argv, "f:n:u:o:vh")) != -1 ) {
+        switch(ch) {
+        case 'f':
+            trace = optarg;
+            break;
+        case 'n':
+            NBUNITS = atoi(optarg);
+            break;
+        case 'u':
+            UNIT = atoi(optarg);
+            break;
+        case 'o':
+            NBOPS = atoi(optarg);
+            break;
+        case 'v':
+            verbose = 1;
+            break;
+        case 'h':
+        default:
+            fprintf(stderr,
+                    "Usage: %s [-f trace] [-n NBUNITS] [-u UNIT] [-o NBOPS] [-v]\n"
+                    "   Replays a trace of allocations on a zone of NBUNITS units of UNIT bytes (default %u, %u)\n"
+                    "   The trace is read from a file, or NBOPS operations (default %u) are generated\n"
+                    "   -v prints the zone and its fragmentation once the trace has been replayed\n",
+                    argv[0], NBUNITS, UNIT, NBOPS);
+            exit(1);
+        }
+    }
+    parsec_debug_init();
+
+    if( NULL != trace ) {
+        ops = read_trace(trace, &nb_ops, &nb_ids);
+    } else {
+        nb_ops = NBOPS;
+        ops = generate_trace(nb_ops, &nb_ids);
+    }
+    ptrs = (void**)calloc(nb_ids, sizeof(void*));
+    owner = (int*)malloc(NBUNITS * sizeof(int));
+    for(u = 0; u < NBUNITS; u++) owner[u] = -1;
+    base = (char*)malloc((size_t)NBUNITS * UNIT);
+
+    zone = zone_malloc_init(base, NBUNITS, UNIT);
+    failed = replay(zone, ops, nb_ops, ptrs, owner);
+    if( verbose )
+        zone_debug(zone, 0, 0, "zone: ");
+    for(i = 0; i < nb_ids; i++) {
+        if( NULL != ptrs[i] ) {
+            zone_free(zone, ptrs[i]);
+            ptrs[i] = NULL;
+        }
+    }
+    if( 0 != zone_in_use(zone) )
+        fatal(" ! Error: %zu bytes still in use after the trace\n", zone_in_use(zone));
+    if( (size_t)NBUNITS * UNIT != zone_debug(zone, 0, 0, NULL) )
+        fatal(" ! Error: the zone was not merged back, %zu bytes free out of %zu\n",
+              zone_debug(zone, 0, 0, NULL), (size_t)NBUNITS * UNIT);
+    if( NULL == (ptrs[0] = zone_malloc(zone, (size_t)NBUNITS * UNIT)) )
+        fatal(" ! Error: the zone was not merged back in a single segment\n");
+    zone_free(zone, ptrs[0]);
+    ptrs[0] = NULL;
+    if( (NULL == trace) && (0 != failed) )
+        fatal(" ! Error: %u allocations failed with the zone at most 3/4 full\n", failed);
+
+    duration = now();
+    replay(zone, ops, nb_ops, ptrs, NULL);
+    duration = now() - duration;
+    printf("%u operations on %d allocations in %g s (%g ns per operation), %u allocations failed\n",
+           nb_ops, nb_ids, duration, 1e9 * duration / nb_ops, failed);
+
+    zone_malloc_fini(&zone);
+    free(base);
+    free(owner);
+    free(ptrs);
+    free(ops);
+    return 0;
+}
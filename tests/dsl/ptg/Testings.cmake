@@ -2,6 +2,7 @@ include(${CMAKE_CURRENT_LIST_DIR}/ptgpp/Testings.cmake)
 include(${CMAKE_CURRENT_LIST_DIR}/user-defined-functions/Testings.cmake)
 include(${CMAKE_CURRENT_LIST_DIR}/branching/Testings.cmake)
 include(${CMAKE_CURRENT_LIST_DIR}/multisize_bcast/Testings.cmake)
+include(${CMAKE_CURRENT_LIST_DIR}/critical-path/Testings.cmake)
 
 parsec_addtest_cmd(dsl/ptg/startup1 ${SHM_TEST_CMD_LIST} dsl/ptg/startup -i=10 -j=10 -k=10 -v=5)
 parsec_addtest_cmd(dsl/ptg/startup2 ${SHM_TEST_CMD_LIST} dsl/ptg/startup -i=10 -j=20 -k=30 -v=5)
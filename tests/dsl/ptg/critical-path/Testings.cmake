@@ -0,0 +1 @@
+parsec_addtest_cmd(dsl/ptg/critical-path ${SHM_TEST_CMD_LIST} dsl/ptg/critical-path/critical_path)
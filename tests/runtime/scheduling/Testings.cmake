@@ -1,9 +1,23 @@
 foreach(_sched ${MCA_sched})
     parsec_addtest_cmd(runtime/scheduling:${_sched} ${MPI_TEST_CMD_LIST} 1 runtime/scheduling/schedmicro -t 10 -l 8 -n 512 -- --mca mca_sched ${_sched})
 endforeach()
+# parking idle threads is opt-in
+parsec_addtest_cmd(runtime/scheduling:lfq:park ${MPI_TEST_CMD_LIST} 1 runtime/scheduling/schedmicro -t 10 -l 8 -n 512 -- --mca mca_sched lfq --mca runtime_park_threshold 32)
+# batched selection is opt-in
+foreach(_sched lfq ll llp)
+    parsec_addtest_cmd(runtime/scheduling:${_sched}:batch ${MPI_TEST_CMD_LIST} 1 runtime/scheduling/schedmicro -t 10 -l 8 -n 512 -- --mca mca_sched ${_sched} --mca runtime_select_batch 4)
+endforeach()
 
 if( MPI_C_FOUND )
   foreach(_sched ${MCA_sched})
         parsec_addtest_cmd(runtime/scheduling:mp:${_sched} ${MPI_TEST_CMD_LIST} 2 runtime/scheduling/schedmicro -t 10 -l 8 -n 512 -- --mca mca_sched ${_sched})
     endforeach()
 endif( MPI_C_FOUND )
+
+parsec_addtest_cmd(runtime/scheduling/fair_share ${SHM_TEST_CMD_LIST} runtime/scheduling/fair_share)
+parsec_addtest_cmd(runtime/scheduling/deadline ${SHM_TEST_CMD_LIST} runtime/scheduling/deadline)
+parsec_addtest_cmd(runtime/scheduling/auto_switch ${SHM_TEST_CMD_LIST} runtime/scheduling/auto_switch)
+parsec_addtest_cmd(runtime/scheduling/taskpool_budget ${SHM_TEST_CMD_LIST} runtime/scheduling/taskpool_budget)
+if( MPI_C_FOUND )
+  parsec_addtest_cmd(runtime/scheduling/taskpool_budget:mp ${MPI_TEST_CMD_LIST} 2 runtime/scheduling/taskpool_budget)
+endif( MPI_C_FOUND )